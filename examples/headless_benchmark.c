@@ -0,0 +1,125 @@
+/*
+ * Headless benchmark.
+ *
+ * Renders a window without a display, moves the pointer over it and clicks
+ * for a number of frames, then reports the frame rate and saves the last
+ * frame, so that it runs in CI on Mesa's llvmpipe:
+ *
+ *   gcc headless_benchmark.c -o headless_benchmark -I../include \
+ *       -L/usr/local/lib -lGooeyGUI-1 -lGLPS -lfreetype -lcjson -lm
+ *   ./headless_benchmark 500 frame.ppm
+ *
+ * The arguments are the frame count, 300 by default, and where to write the
+ * last frame as a PPM image. Any other example runs headless with
+ * GOOEY_HEADLESS=1 set in its environment.
+ */
+
+#include "gooey.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_WIDTH 640
+#define BENCH_HEIGHT 480
+#define BENCH_DEFAULT_FRAMES 300
+
+static GooeyWindow *win;
+static GooeyTimer *timer;
+static int frames, frame_count;
+static const char *output_path;
+static double start_ms;
+
+static double wall_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void save_frame(void)
+{
+    unsigned char *rgba = malloc(BENCH_WIDTH * BENCH_HEIGHT * 4);
+    if (!rgba || !GooeyWindow_ReadPixels(win, rgba, BENCH_WIDTH, BENCH_HEIGHT))
+    {
+        free(rgba);
+        return;
+    }
+
+    FILE *file = output_path ? fopen(output_path, "wb") : NULL;
+    if (file)
+    {
+        fprintf(file, "P6\n%d %d\n255\n", BENCH_WIDTH, BENCH_HEIGHT);
+        for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; ++i)
+            fwrite(rgba + i * 4, 1, 3, file);
+        fclose(file);
+    }
+    free(rgba);
+}
+
+static void next_frame(void *user_data)
+{
+    (void)user_data;
+
+    // A sweep across the window with a click on the button every 30 frames.
+    GooeyEvent event = {.type = GOOEY_EVENT_MOUSE_MOVE};
+    event.mouse_move.x = frames * 7 % BENCH_WIDTH;
+    event.mouse_move.y = frames * 3 % BENCH_HEIGHT;
+    GooeyWindow_InjectEvent(win, &event);
+    if (frames % 30 == 0)
+    {
+        event = (GooeyEvent){.type = GOOEY_EVENT_CLICK_PRESS};
+        event.click.x = 80;
+        event.click.y = 100;
+        GooeyWindow_InjectEvent(win, &event);
+        event.type = GOOEY_EVENT_CLICK_RELEASE;
+        GooeyWindow_InjectEvent(win, &event);
+    }
+    GooeyWindow_RequestRedraw(win);
+
+    if (++frames < frame_count)
+        return;
+
+    GooeyTimer_Stop(timer);
+    // Reading back waits for the last frame, it is part of the measure.
+    save_frame();
+    const double elapsed = wall_ms() - start_ms;
+    GooeyRenderStats stats;
+    GooeyWindow_GetRenderStats(win, &stats);
+    printf("%d frames in %.0f ms, %.1f frames per second, %zu draw calls in the last one\n", frames, elapsed,
+           frames * 1000.0 / elapsed, stats.draw_calls);
+    GooeyWindow_RequestCleanup(win);
+}
+
+int main(int argc, char **argv)
+{
+    if (Gooey_InitWithFlags(GOOEY_INIT_HEADLESS) != 0)
+    {
+        fprintf(stderr, "Headless rendering is unavailable\n");
+        return 1;
+    }
+
+    frame_count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_FRAMES;
+    if (frame_count <= 0)
+        frame_count = BENCH_DEFAULT_FRAMES;
+    output_path = argc > 2 ? argv[2] : NULL;
+
+    win = GooeyWindow_Create("Headless benchmark", 0, 0, BENCH_WIDTH, BENCH_HEIGHT, true);
+    if (!win)
+        return 1;
+
+    GooeyWindow_RegisterWidget(win, GooeyLabel_Create("Rendered without a display", 18.0f, 20, 40));
+    GooeyWindow_RegisterWidget(win, GooeyButton_Create("Button", 20, 80, 120, 40, NULL, NULL));
+    GooeyWindow_RegisterWidget(win, GooeySlider_Create(20, 160, 300, 0, 100, true, NULL, NULL));
+    GooeyWindow_RegisterWidget(win, GooeySwitch_Create(20, 220, false, true, NULL, NULL));
+
+    start_ms = wall_ms();
+    timer = GooeyTimer_Create();
+    // Fires every millisecond, each time the loop drew the previous frame.
+    GooeyTimer_SetCallback(1, timer, next_frame, NULL);
+
+    GooeyWindow_Run(1, win);
+
+    GooeyTimer_Destroy(timer);
+    GooeyWindow_Cleanup(1, win);
+    return 0;
+}
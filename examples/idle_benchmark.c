@@ -0,0 +1,77 @@
+/*
+ * Idle CPU benchmark.
+ *
+ * Opens a window with a few widgets, leaves it alone for a while and reports
+ * how much CPU the process burned meanwhile, as a percentage of one core.
+ * An idle window should cost next to nothing:
+ *
+ *   gcc idle_benchmark.c -o idle_benchmark -I../include \
+ *       -L/usr/local/lib -lGooeyGUI-1 -lGLPS -lfreetype -lcjson -lm
+ *
+ * Pass the duration in seconds as the first argument, 10 by default. Run it
+ * on a build before and after a main loop change to compare.
+ */
+
+#include "gooey.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_SECONDS 10
+
+static double start_wall_ms;
+static double start_cpu_ms;
+
+static double wall_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static double cpu_ms(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+static void on_done(void *user_data)
+{
+    GooeyWindow *win = user_data;
+    const double wall = wall_ms() - start_wall_ms;
+    const double cpu = cpu_ms() - start_cpu_ms;
+
+    printf("Idle for %.0f ms, %.1f ms of CPU, %.2f%% of one core\n", wall, cpu, 100.0 * cpu / wall);
+    GooeyWindow_RequestCleanup(win);
+}
+
+int main(int argc, char **argv)
+{
+    Gooey_Init();
+
+    const int seconds = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_SECONDS;
+
+    GooeyWindow *win = GooeyWindow_Create("Idle benchmark", 0, 0, 400, 300, true);
+    if (!win)
+        return 1;
+
+    GooeyWindow_RegisterWidget(win, GooeyLabel_Create("Leave this window alone", 18.0f, 20, 40));
+    GooeyWindow_RegisterWidget(win, GooeyButton_Create("Button", 20, 80, 120, 40, NULL, NULL));
+    GooeyWindow_RegisterWidget(win, GooeySwitch_Create(20, 150, false, true, NULL, NULL));
+
+    // Measured from startup on, the first frames are part of it but are over within milliseconds.
+    start_wall_ms = wall_ms();
+    start_cpu_ms = cpu_ms();
+
+    GooeyTimer *timer = GooeyTimer_Create();
+    GooeyTimer_SetCallback((uint64_t)(seconds > 0 ? seconds : BENCH_DEFAULT_SECONDS) * 1000, timer, on_done, win);
+
+    GooeyWindow_Run(1, win);
+
+    GooeyTimer_Destroy(timer);
+    GooeyWindow_Cleanup(1, win);
+    return 0;
+}
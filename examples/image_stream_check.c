@@ -0,0 +1,120 @@
+/*
+ * Streamed image orientation check.
+ *
+ * Pushes one frame with a different color in each quadrant into an image
+ * widget, renders it without a display and reads the window back. Both
+ * backends must show the frame the way it was given, top row first:
+ *
+ *   gcc image_stream_check.c -o image_stream_check -I../include \
+ *       -L/usr/local/lib -lGooeyGUI-1 -lGLPS -lfreetype -lcjson -lm
+ *   ./image_stream_check
+ *   GOOEY_SOFTWARE=1 ./image_stream_check
+ *
+ * Exits with 0 when every quadrant has its color, 1 otherwise.
+ */
+
+#include "gooey.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK_SIZE 64
+#define CHECK_FRAMES 3
+
+static const unsigned char quadrant_colors[4][3] = {
+    {255, 0, 0},     // Top left.
+    {0, 255, 0},     // Top right.
+    {0, 0, 255},     // Bottom left.
+    {255, 255, 255}, // Bottom right.
+};
+static const char *quadrant_names[4] = {"top left", "top right", "bottom left", "bottom right"};
+
+static GooeyWindow *win;
+static GooeyTimer *timer;
+static int frames;
+static int result = 1;
+
+static int quadrant_of(int x, int y)
+{
+    return (y >= CHECK_SIZE / 2) * 2 + (x >= CHECK_SIZE / 2);
+}
+
+static bool check_window(void)
+{
+    unsigned char rgba[CHECK_SIZE * CHECK_SIZE * 4];
+    if (!GooeyWindow_ReadPixels(win, rgba, CHECK_SIZE, CHECK_SIZE))
+    {
+        fprintf(stderr, "The window could not be read back\n");
+        return false;
+    }
+
+    bool matches = true;
+    for (int q = 0; q < 4; ++q)
+    {
+        // Quadrant centers, away from the edges filtering blends.
+        const int x = (q % 2) * CHECK_SIZE / 2 + CHECK_SIZE / 4;
+        const int y = (q / 2) * CHECK_SIZE / 2 + CHECK_SIZE / 4;
+        const unsigned char *pixel = rgba + ((size_t)y * CHECK_SIZE + x) * 4;
+        const unsigned char *expected = quadrant_colors[q];
+        if (abs(pixel[0] - expected[0]) > 8 || abs(pixel[1] - expected[1]) > 8 || abs(pixel[2] - expected[2]) > 8)
+        {
+            fprintf(stderr, "%s is %d %d %d instead of %d %d %d\n", quadrant_names[q], pixel[0], pixel[1], pixel[2],
+                    expected[0], expected[1], expected[2]);
+            matches = false;
+        }
+    }
+    return matches;
+}
+
+static void next_frame(void *user_data)
+{
+    (void)user_data;
+
+    GooeyWindow_RequestRedraw(win);
+    if (++frames < CHECK_FRAMES)
+        return;
+
+    GooeyTimer_Stop(timer);
+    result = check_window() ? 0 : 1;
+    printf("Streamed image %s\n", result == 0 ? "is drawn upright" : "is not drawn as given");
+    GooeyWindow_RequestCleanup(win);
+}
+
+int main(void)
+{
+    if (Gooey_InitWithFlags(GOOEY_INIT_HEADLESS) != 0)
+    {
+        fprintf(stderr, "Headless rendering is unavailable\n");
+        return 1;
+    }
+
+    win = GooeyWindow_Create("Image stream check", 0, 0, CHECK_SIZE, CHECK_SIZE, true);
+    if (!win)
+        return 1;
+    GooeyImage *image = GooeyImage_Create(NULL, 0, 0, CHECK_SIZE, CHECK_SIZE, NULL, NULL);
+    GooeyWindow_RegisterWidget(win, image);
+
+    unsigned char frame[CHECK_SIZE * CHECK_SIZE * 4];
+    for (int y = 0; y < CHECK_SIZE; ++y)
+    {
+        for (int x = 0; x < CHECK_SIZE; ++x)
+        {
+            unsigned char *pixel = frame + ((size_t)y * CHECK_SIZE + x) * 4;
+            const unsigned char *color = quadrant_colors[quadrant_of(x, y)];
+            pixel[0] = color[0];
+            pixel[1] = color[1];
+            pixel[2] = color[2];
+            pixel[3] = 255;
+        }
+    }
+    if (!GooeyImage_UpdatePixels(image, frame, 0, CHECK_SIZE, CHECK_SIZE))
+        return 1;
+
+    timer = GooeyTimer_Create();
+    GooeyTimer_SetCallback(1, timer, next_frame, NULL);
+
+    GooeyWindow_Run(1, win);
+
+    GooeyTimer_Destroy(timer);
+    GooeyWindow_Cleanup(1, win);
+    return result;
+}
@@ -0,0 +1,71 @@
+/*
+ * Streamed image.
+ *
+ * A thread renders frames as fast as it can and pushes them into an image
+ * widget, the way a camera or video decoder would:
+ *
+ *   gcc image_stream_example.c -o image_stream_example -I../include \
+ *       -L/usr/local/lib -lGooeyGUI-1 -lGLPS -lfreetype -lcjson -lm -lpthread
+ *   ./image_stream_example
+ *
+ * Frames the display had no time to show are dropped, the count is
+ * printed on exit.
+ */
+
+#include "gooey.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FRAME_WIDTH 640
+#define FRAME_HEIGHT 360
+
+static atomic_bool running = true;
+
+static void *produce_frames(void *data)
+{
+    GooeyImage *image = data;
+    unsigned char *frame = malloc(FRAME_WIDTH * FRAME_HEIGHT * 4);
+    if (!frame)
+        return NULL;
+
+    for (unsigned int t = 0; atomic_load(&running); ++t)
+    {
+        for (int y = 0; y < FRAME_HEIGHT; ++y)
+        {
+            unsigned char *pixel = frame + (size_t)y * FRAME_WIDTH * 4;
+            for (int x = 0; x < FRAME_WIDTH; ++x, pixel += 4)
+            {
+                pixel[0] = (unsigned char)(x + t);
+                pixel[1] = (unsigned char)(y + t / 2);
+                pixel[2] = (unsigned char)((x ^ y) + t);
+                pixel[3] = 255;
+            }
+        }
+        GooeyImage_UpdatePixels(image, frame, 0, FRAME_WIDTH, FRAME_HEIGHT);
+    }
+    free(frame);
+    return NULL;
+}
+
+int main(void)
+{
+    Gooey_Init();
+
+    GooeyWindow *win = GooeyWindow_Create("Image stream", 0, 0, FRAME_WIDTH, FRAME_HEIGHT, true);
+    GooeyImage *image = GooeyImage_Create(NULL, 0, 0, FRAME_WIDTH, FRAME_HEIGHT, NULL, NULL);
+    GooeyWindow_RegisterWidget(win, image);
+    GooeyWindow_EnableDebugOverlay(win, true);
+
+    pthread_t producer;
+    pthread_create(&producer, NULL, produce_frames, image);
+
+    GooeyWindow_Run(1, win);
+
+    atomic_store(&running, false);
+    pthread_join(producer, NULL);
+    printf("Dropped %llu frames\n", (unsigned long long)GooeyImage_GetDroppedFrames(image));
+    GooeyWindow_Cleanup(1, win);
+    return 0;
+}
@@ -0,0 +1,41 @@
+/*
+ * Gigapixel image viewer.
+ *
+ * Shows a tile pyramid, drag to pan and scroll to zoom:
+ *
+ *   gcc image_viewer_example.c -o image_viewer_example -I../include \
+ *       -L/usr/local/lib -lGooeyGUI-1 -lGLPS -lfreetype -lcjson -lm
+ *   ./image_viewer_example "tiles/%d/%d_%d.png" 200000 100000 256
+ *
+ * The arguments are the tile path pattern (level, column, row), the full
+ * resolution width and height, and the tile size. Level 0 is the full
+ * resolution image, each next level half the size of the previous one,
+ * down to a single tile.
+ */
+
+#include "gooey.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+{
+    if (argc < 5)
+    {
+        fprintf(stderr, "Usage: %s <tile pattern> <width> <height> <tile size>\n", argv[0]);
+        return 1;
+    }
+
+    Gooey_Init();
+
+    GooeyWindow *win = GooeyWindow_Create("Image viewer", 0, 0, 1280, 720, true);
+    GooeyImageViewer *viewer = GooeyImageViewer_Create(argv[1], atoi(argv[2]), atoi(argv[3]), atoi(argv[4]),
+                                                       0, 0, 1280, 720);
+    if (!viewer)
+        return 1;
+    GooeyWindow_RegisterWidget(win, viewer);
+    GooeyWindow_EnableDebugOverlay(win, true);
+
+    GooeyWindow_Run(1, win);
+    GooeyWindow_Cleanup(1, win);
+    return 0;
+}
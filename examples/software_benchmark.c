@@ -0,0 +1,80 @@
+/*
+ * Software rasterizer benchmark.
+ *
+ * Redraws a window on the CPU for a number of frames and reports how many
+ * pixels per second each kind of primitive was drawn at:
+ *
+ *   gcc software_benchmark.c -o software_benchmark -I../include \
+ *       -L/usr/local/lib -lGooeyGUI-1 -lGLPS -lfreetype -lcjson -lm
+ *   GOOEY_SOFT_OUTPUT=none ./software_benchmark 500
+ *
+ * The argument is the frame count, 300 by default. Leave GOOEY_SOFT_OUTPUT
+ * unset to show the frames on /dev/fb0, any other example runs on the CPU
+ * with GOOEY_SOFTWARE=1 set in its environment.
+ */
+
+#include "gooey.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_DEFAULT_FRAMES 300
+
+static const char *primitive_names[GOOEY_RASTER_PRIMITIVE_COUNT] = {
+    "rectangles", "rounded rectangles", "lines", "arcs", "images", "glyphs"};
+
+static GooeyWindow *win;
+static GooeyTimer *timer;
+static int frames, frame_count;
+
+static void next_frame(void *user_data)
+{
+    (void)user_data;
+
+    GooeyEvent event = {.type = GOOEY_EVENT_MOUSE_MOVE};
+    event.mouse_move.x = frames * 7 % 640;
+    event.mouse_move.y = frames * 3 % 480;
+    GooeyWindow_InjectEvent(win, &event);
+    GooeyWindow_RequestRedraw(win);
+
+    if (++frames < frame_count)
+        return;
+
+    GooeyTimer_Stop(timer);
+    GooeyRenderStats stats;
+    GooeyWindow_GetRenderStats(win, &stats);
+    for (int i = 0; i < GOOEY_RASTER_PRIMITIVE_COUNT; ++i)
+        printf("%-20s %12llu pixels %8.1f Mpixels/s\n", primitive_names[i],
+               (unsigned long long)stats.raster_pixels[i], stats.raster_pixels_per_second[i] / 1e6);
+    GooeyWindow_RequestCleanup(win);
+}
+
+int main(int argc, char **argv)
+{
+    if (Gooey_InitWithFlags(GOOEY_INIT_SOFTWARE) != 0)
+    {
+        fprintf(stderr, "Software rendering is unavailable\n");
+        return 1;
+    }
+
+    frame_count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_FRAMES;
+    if (frame_count <= 0)
+        frame_count = BENCH_DEFAULT_FRAMES;
+
+    win = GooeyWindow_Create("Software benchmark", 0, 0, 640, 480, true);
+    if (!win)
+        return 1;
+
+    GooeyWindow_RegisterWidget(win, GooeyLabel_Create("Drawn by the CPU", 18.0f, 20, 40));
+    GooeyWindow_RegisterWidget(win, GooeyButton_Create("Button", 20, 80, 120, 40, NULL, NULL));
+    GooeyWindow_RegisterWidget(win, GooeySlider_Create(20, 160, 300, 0, 100, true, NULL, NULL));
+    GooeyWindow_RegisterWidget(win, GooeySwitch_Create(20, 220, false, true, NULL, NULL));
+
+    timer = GooeyTimer_Create();
+    GooeyTimer_SetCallback(1, timer, next_frame, NULL);
+
+    GooeyWindow_Run(1, win);
+
+    GooeyTimer_Destroy(timer);
+    GooeyWindow_Cleanup(1, win);
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Text rendering micro-benchmark.
+ *
+ * Draws a screen full of text through the backend for a fixed number of
+ * frames and reports glyphs per millisecond, submission plus swap included.
+ * It talks to the backend directly, so build it from this directory against
+ * the library and the internal headers:
+ *
+ *   gcc text_benchmark.c -o text_benchmark -I../include -I../internal \
+ *       -L/usr/local/lib -lGooeyGUI-1 -lGLPS -lfreetype -lcjson -lm
+ *
+ * Run it on a build before and after a text path change to compare, pass
+ * "sdf" as the first argument to measure signed distance field text. The
+ * timed loop only uses calls the first release already had, so the same
+ * file builds against every version; render stats and the text mode are
+ * used where the headers announce them.
+ */
+
+#include "gooey.h"
+#include "backends/gooey_backend_internal.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_FRAMES 300
+#define BENCH_WARMUP_FRAMES 30
+#define BENCH_LINES 40
+
+static const char *bench_line = "The quick brown fox jumps over the lazy dog 0123456789 {}[]();:!?";
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void draw_frame(GooeyWindow *win, int frame)
+{
+    // Moving the text a pixel every other frame changes every glyph, damage tracking cannot skip the frame.
+    const int x = 8 + (frame & 1);
+
+    active_backend->Clear(win);
+    for (int line = 0; line < BENCH_LINES; ++line)
+        active_backend->DrawGooeyText(x, 20 + line * 18, bench_line, 0x000000, 14.0f, win->creation_id, NULL);
+    active_backend->Render(win);
+}
+
+int main(int argc, char **argv)
+{
+    Gooey_Init();
+
+    const bool sdf = argc > 1 && strcmp(argv[1], "sdf") == 0;
+#ifdef GOOEY_HAS_TEXT_RENDER_MODE
+    Gooey_SetTextRenderMode(sdf ? GOOEY_TEXT_RENDER_SDF : GOOEY_TEXT_RENDER_BITMAP);
+#else
+    if (sdf)
+    {
+        fprintf(stderr, "This version only draws bitmap text\n");
+        return 1;
+    }
+#endif
+
+    GooeyWindow *win = GooeyWindow_Create("Text benchmark", 0, 0, 800, 760, true);
+    if (!win)
+        return 1;
+
+    // Spaces produce no quads but still go through the glyph lookup, count them like any other character.
+    const size_t glyphs_per_frame = strlen(bench_line) * BENCH_LINES;
+
+    for (int frame = 0; frame < BENCH_WARMUP_FRAMES; ++frame)
+        draw_frame(win, frame);
+
+    const double start = now_ms();
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame)
+        draw_frame(win, frame);
+    const double elapsed = now_ms() - start;
+
+    const double glyphs = (double)glyphs_per_frame * BENCH_FRAMES;
+    printf("%d frames, %zu glyphs/frame, %.2f ms total\n", BENCH_FRAMES, glyphs_per_frame, elapsed);
+    printf("%.1f glyphs/ms, %.3f ms/frame\n", glyphs / elapsed, elapsed / BENCH_FRAMES);
+
+#ifdef GOOEY_HAS_RENDER_STATS
+    GooeyRenderStats stats;
+    GooeyWindow_GetRenderStats(win, &stats);
+    printf("%s text: %zu draw calls/frame, %zu glyphs resident, %.1f KB of atlas\n",
+           sdf ? "SDF" : "Bitmap", stats.draw_calls, stats.glyph_cache_glyphs, stats.glyph_cache_bytes / 1024.0);
+#endif
+
+    GooeyWindow_Cleanup(1, win);
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Monitoring windows drawn on their own threads.
+ *
+ * Opens six windows, each plotting a signal refreshed every 16 ms. The
+ * first one plots far more points than the others and takes much longer
+ * to draw; with GOOEY_INIT_THREADED the other five keep their frame rate,
+ * shown by the debug overlay of each window:
+ *
+ *   gcc threaded_windows_example.c -o threaded_windows_example -I../include \
+ *       -L/usr/local/lib -lGooeyGUI-1 -lGLPS -lfreetype -lcjson -lm
+ *   ./threaded_windows_example
+ *
+ * Initialize with GOOEY_INIT_DEFAULT instead to see every window slow down
+ * to the pace of the first.
+ */
+
+#include "gooey.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define WINDOW_COUNT 6
+#define SLOW_POINTS 200000
+#define FAST_POINTS 500
+
+typedef struct
+{
+    GooeyWindow *win;
+    GooeyPlot *plot;
+    GooeyPlotData data;
+    float *x_data, *y_data;
+    size_t count;
+} Monitor;
+
+static Monitor monitors[WINDOW_COUNT];
+static int tick;
+
+static void fill_signal(Monitor *monitor)
+{
+    for (size_t i = 0; i < monitor->count; ++i)
+        monitor->y_data[i] = sinf((float)(i + tick * 8) * 0.01f) * 50.0f + 50.0f;
+}
+
+static void refresh(void *user_data)
+{
+    (void)user_data;
+
+    // Runs between the windows' passes, none of them is drawing the data meanwhile.
+    tick++;
+    for (int i = 0; i < WINDOW_COUNT; ++i)
+    {
+        fill_signal(&monitors[i]);
+        GooeyPlot_Update(monitors[i].plot, &monitors[i].data);
+        GooeyWindow_RequestRedraw(monitors[i].win);
+    }
+}
+
+int main(void)
+{
+    if (Gooey_InitWithFlags(GOOEY_INIT_THREADED) != 0)
+        return 1;
+
+    for (int i = 0; i < WINDOW_COUNT; ++i)
+    {
+        Monitor *monitor = &monitors[i];
+        monitor->count = i == 0 ? SLOW_POINTS : FAST_POINTS;
+        monitor->x_data = malloc(monitor->count * sizeof(float));
+        monitor->y_data = malloc(monitor->count * sizeof(float));
+        if (!monitor->x_data || !monitor->y_data)
+            return 1;
+        for (size_t j = 0; j < monitor->count; ++j)
+            monitor->x_data[j] = (float)j;
+        fill_signal(monitor);
+
+        monitor->data = (GooeyPlotData){
+            .x_data = monitor->x_data,
+            .y_data = monitor->y_data,
+            .data_count = monitor->count,
+            .title = i == 0 ? "Slow monitor" : "Monitor",
+        };
+        monitor->win = GooeyWindow_Create(i == 0 ? "Slow monitor" : "Monitor", 0, 0, 480, 320, true);
+        if (!monitor->win)
+            return 1;
+        monitor->plot = GooeyPlot_Create(GOOEY_PLOT_LINE, &monitor->data, 10, 10, 460, 300);
+        GooeyWindow_RegisterWidget(monitor->win, monitor->plot);
+        GooeyWindow_EnableDebugOverlay(monitor->win, true);
+    }
+
+    GooeyTimer *timer = GooeyTimer_Create();
+    GooeyTimer_SetCallback(16, timer, refresh, NULL);
+
+    GooeyWindow_Run(WINDOW_COUNT, monitors[0].win, monitors[1].win, monitors[2].win, monitors[3].win,
+                    monitors[4].win, monitors[5].win);
+
+    GooeyTimer_Destroy(timer);
+    GooeyWindow_Cleanup(WINDOW_COUNT, monitors[0].win, monitors[1].win, monitors[2].win, monitors[3].win,
+                        monitors[4].win, monitors[5].win);
+    for (int i = 0; i < WINDOW_COUNT; ++i)
+    {
+        free(monitors[i].x_data);
+        free(monitors[i].y_data);
+    }
+    return 0;
+}
@@ -86,10 +86,10 @@ struct GooeyEvent
     {
         GooeyMouseData click;
         GooeyMouseData mouse_move;
-        GooeyMouseData mouse_scroll;
         GooeyKeyPressData key_press;
         GooeyDropData drop_data;
     };
+    GooeyMouseData mouse_scroll; /**< Apart so that the pointer position survives scrolling. */
 };
 
 typedef enum
@@ -115,7 +115,8 @@ typedef enum
     WIDGET_CTXMENU,
     WIDGET_NODE_EDITOR,
     WIDGET_NOTIFICATIONS,
-    WIDGET_TABS
+    WIDGET_TABS,
+    WIDGET_IMAGE_VIEWER
 } WIDGET_TYPE;
 
 typedef struct
@@ -134,6 +135,104 @@ typedef struct
     void *timer_ptr;
 } GooeyTimer;
 
+/**
+ * @brief Primitive kinds the software backend counts pixels for, see GooeyRenderStats.
+ */
+typedef enum
+{
+    GOOEY_RASTER_RECT,         /**< Rectangles and their outlines, window clears included. */
+    GOOEY_RASTER_ROUNDED_RECT, /**< Rectangles with rounded corners and their outlines. */
+    GOOEY_RASTER_LINE,         /**< Lines and polylines. */
+    GOOEY_RASTER_ARC,          /**< Arcs, rings and pies. */
+    GOOEY_RASTER_IMAGE,
+    GOOEY_RASTER_GLYPH,
+    GOOEY_RASTER_PRIMITIVE_COUNT
+} GooeyRasterPrimitive;
+
+/**
+ * @brief Renderer counters, see GooeyWindow_GetRenderStats().
+ *
+ * Cache counters are cumulative since startup and shared by every window.
+ */
+typedef struct
+{
+    size_t draw_calls;       /**< Draw calls the window issued for its last frame. */
+    size_t repainted_pixels; /**< Pixels its last frame cleared and redrew, 0 if nothing changed. */
+    size_t gl_calls_issued;  /**< State changes and context switches its last frame sent to the driver. */
+    size_t gl_calls_skipped; /**< Those it dropped because they would have changed nothing. */
+    size_t glyph_cache_hits;
+    size_t glyph_cache_misses;
+    size_t glyph_cache_evictions;
+    size_t glyph_cache_glyphs; /**< Glyphs currently resident. */
+    size_t glyph_cache_pages;  /**< Atlas pages in use, out of GLYPH_ATLAS_MAX_PAGES. */
+    size_t glyph_cache_bytes;  /**< VRAM reserved by every glyph atlas created so far. */
+    size_t text_metrics_hits;  /**< Measurements answered from the text metrics cache. */
+    size_t text_metrics_misses;
+    size_t layer_hits;    /**< Cached layers composited without drawing their content. */
+    size_t layer_renders; /**< Layers whose content was drawn into their texture again. */
+    size_t layer_bytes;   /**< VRAM held by layer textures, out of LAYER_CACHE_BUDGET_MB. */
+    size_t texture_cache_hits;      /**< Image loads that reused a resident texture. */
+    size_t texture_cache_misses;
+    size_t texture_cache_evictions; /**< Unused textures deleted to stay within TEXTURE_CACHE_BUDGET_MB. */
+    size_t texture_cache_textures;  /**< Image textures resident, used or not. */
+    size_t texture_cache_bytes;
+    /** Pixels the software backend wrote per primitive kind since startup, 0 for the GPU backends. */
+    uint64_t raster_pixels[GOOEY_RASTER_PRIMITIVE_COUNT];
+    /** Rate the software backend wrote them at while drawing, per primitive kind. */
+    double raster_pixels_per_second[GOOEY_RASTER_PRIMITIVE_COUNT];
+} GooeyRenderStats;
+
+/**
+ * @brief Extent of a run of text at a given font size, in pixels.
+ */
+typedef struct
+{
+    float width;   /**< Sum of the glyph advances. */
+    float height;  /**< Tallest glyph. */
+    float ascent;  /**< Highest point above the baseline. */
+    float descent; /**< Lowest point below the baseline, positive downwards. */
+} GooeyTextMetrics;
+
+/**
+ * @brief How text glyphs are rasterized, see Gooey_SetTextRenderMode().
+ */
+typedef enum
+{
+    GOOEY_TEXT_RENDER_BITMAP, /**< Coverage bitmaps rasterized once and scaled, sharpest near 28px. */
+    GOOEY_TEXT_RENDER_SDF     /**< Signed distance fields, crisp from small to very large sizes. */
+} GooeyTextRenderMode;
+
+/**
+ * @brief How the segments of a polyline meet, see GooeyBackend::DrawPolyline.
+ */
+typedef enum
+{
+    GOOEY_LINE_JOIN_MITER, /**< Sharp corners, beveled once the point would reach past twice the line width. */
+    GOOEY_LINE_JOIN_BEVEL, /**< Corners cut flat. */
+    GOOEY_LINE_JOIN_ROUND  /**< Rounded corners and ends. */
+} GooeyLineJoin;
+
+/**
+ * @brief Options of Gooey_InitWithFlags, combined with |.
+ */
+typedef enum
+{
+    GOOEY_INIT_DEFAULT = 0,
+    GOOEY_INIT_HEADLESS = 1 << 0, /**< No display: windows render offscreen, input comes from GooeyWindow_InjectEvent. */
+    GOOEY_INIT_SOFTWARE = 1 << 1, /**< No GPU: windows are drawn by the CPU and shown on the framebuffer device, a file or shared memory. */
+    GOOEY_INIT_THREADED = 1 << 2  /**< Every window handles its input and builds its frames on its own thread. */
+} GooeyInitFlags;
+
+/**
+ * @brief Primitives a widget drew, recorded by the backend and replayed while the widget is unchanged.
+ */
+typedef struct GooeyDisplayList GooeyDisplayList;
+
+/**
+ * @brief Offscreen texture holding the static part of a widget, see GooeyWidget_SetLayerCached().
+ */
+typedef struct GooeyLayer GooeyLayer;
+
 typedef struct
 {
     GooeyTFT_Sprite *sprite;
@@ -143,6 +242,10 @@ typedef struct
     char __padding[2];
     int x, y;
     int width, height;
+    GooeyDisplayList *display_list; /**< Last recording of the widget, NULL until it is first drawn. */
+    uint64_t display_key;           /**< Widget state the recording was made from, 0 forces a new one. */
+    GooeyLayer *layer;              /**< Cached static content, NULL until the widget is drawn with layer_cached set. */
+    bool layer_cached;
 } GooeyWidget;
 
 typedef enum
@@ -561,17 +664,66 @@ typedef struct
     GooeyPlotData *data;
 } GooeyPlot;
 
-typedef struct
+typedef struct GooeyImage GooeyImage;
+
+/**
+ * @brief Frames handed to an image by GooeyImage_UpdatePixels(), see gooey_image_internal.h.
+ */
+typedef struct GooeyImageStream GooeyImageStream;
+
+struct GooeyImage
 {
     GooeyWidget core;
     unsigned int texture_id;
     bool is_loaded;
     bool needs_refresh;
-    char __padding[2];
+    bool downscale; /**< Load large files at the size they are displayed at. */
+    char __padding[1];
     void (*callback)(void *user_data);
     void *user_data;
     const char *image_path;
-} GooeyImage;
+    int texture_width, texture_height; /**< Size the texture was requested at, 0 for full size. */
+    unsigned int load_request;         /**< Pending asynchronous load, 0 when none. */
+    GooeyWindow *window;       /**< Window redrawn when the pending load lands. */
+    void (*load_callback)(GooeyImage *image, bool loaded, void *user_data);
+    void *load_user_data;
+    GooeyImageStream *stream; /**< Mailbox of pushed frames, shown instead of the file once one arrived. */
+};
+
+typedef struct GooeyImageViewer GooeyImageViewer;
+
+/**
+ * @brief One tile of the pyramid, resident or being decoded.
+ */
+typedef struct
+{
+    GooeyImageViewer *viewer;
+    int level, column, row;
+    unsigned int texture_id;
+    unsigned int load_request; /**< Pending asynchronous load, 0 when none. */
+    bool loaded;               /**< Loading finished, texture_id is 0 when it failed. */
+    bool used;                 /**< The slot holds a tile. */
+    char __padding[2];
+    uint64_t last_used;        /**< Frame the tile was last drawn or wanted on. */
+} GooeyImageViewerTile;
+
+struct GooeyImageViewer
+{
+    GooeyWidget core;
+    char *tile_path;                 /**< printf pattern taking the level, column and row. */
+    int image_width, image_height;   /**< Full resolution size. */
+    int tile_size;
+    int levels;                      /**< Level 0 is full resolution, each next one is half the size. */
+    double zoom;                     /**< Screen pixels per full resolution pixel. */
+    double center_x, center_y;       /**< Full resolution point shown at the widget's center. */
+    GooeyImageViewerTile *tiles;     /**< IMAGE_VIEWER_MAX_TILES slots. */
+    size_t pending;                  /**< Tiles being decoded. */
+    uint64_t frame;
+    bool dragging;
+    char __padding[3];
+    int drag_x, drag_y;              /**< Pointer position the view last followed. */
+    GooeyWindow *window;             /**< Window redrawn when a tile lands. */
+};
 
 typedef struct
 {
@@ -774,6 +926,8 @@ struct GooeyWindow
     GooeySwitch **switches;
     GooeyWebview **webviews;
     GooeyNodeEditor **node_editors;
+    GooeyImageViewer **image_viewers;
+    size_t image_viewer_count;
     size_t notification_count;
     size_t node_editor_count;
     size_t webview_count;
@@ -33,6 +33,29 @@ void GooeyWidget_MoveTo(void* widget, int x, int y);
  */
 void GooeyWidget_Resize(void* widget, int w, int h);
 
+/**
+ * @brief Redraws the widget on the next frame even if it looks unchanged.
+ *
+ * Widgets are redrawn automatically when any of their fields change. Call
+ * this after changing data the widget only holds a pointer to.
+ *
+ * @param widget Pointer to the widget.
+ */
+void GooeyWidget_Invalidate(void* widget);
+
+/**
+ * @brief Caches the static part of an expensive widget in an offscreen texture.
+ *
+ * The texture is drawn once and composited on later frames until the widget
+ * changes. Supported by plots (background, axes, ticks and grid) and node
+ * editors (background and grid); other widgets ignore it. Layers are
+ * evicted once LAYER_CACHE_BUDGET_MB is reached.
+ *
+ * @param widget Pointer to the widget.
+ * @param cached true to cache, false to draw the widget directly every frame.
+ */
+void GooeyWidget_SetLayerCached(void* widget, bool cached);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
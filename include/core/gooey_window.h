@@ -143,6 +143,45 @@ void GooeyWindow_UnRegisterWidget(GooeyWindow *win, void* widget);
 void GooeyWindow_MakeTransparent(GooeyWindow* win, int blur_radius, float opacity);
 
 void GooeyWindow_MoveTo(GooeyWindow* win, int x, int y);
+
+/**
+ * @brief Retrieves renderer counters (draw calls, glyph cache hits, misses and evictions).
+ *
+ * Useful to size caches such as GLYPH_ATLAS_MAX_PAGES. Fields the active
+ * backend does not track are left at zero.
+ *
+ * @param win The window whose per-frame counters are reported.
+ * @param stats Filled with the current counters.
+ */
+void GooeyWindow_GetRenderStats(GooeyWindow *win, GooeyRenderStats *stats);
+
+/** Defined where GooeyWindow_GetRenderStats() exists, for code that also builds against older versions. */
+#define GOOEY_HAS_RENDER_STATS 1
+
+/**
+ * @brief Delivers input to a window as if it came from the window system.
+ *
+ * The event is handled, and the window redrawn if it asks for it, before
+ * this returns. Call it from the thread running GooeyWindow_Run(), for
+ * instance from a timer. Clicks move the pointer to where they happen.
+ * With GOOEY_INIT_THREADED the event is queued for the window's thread
+ * instead, and handled after the ones queued before it.
+ *
+ * @param win The window receiving the input.
+ * @param event The input, its type selects which fields are read.
+ */
+void GooeyWindow_InjectEvent(GooeyWindow *win, const GooeyEvent *event);
+
+/**
+ * @brief Reads back what a headless window last rendered.
+ *
+ * Waits for rendering to finish, so it also marks the end of a measured frame.
+ *
+ * @param win A window of a backend initialized with GOOEY_INIT_HEADLESS.
+ * @param rgba Receives @p width x @p height RGBA pixels, rows from the top, taken from the top left of the window.
+ * @return false when the backend cannot read pixels back.
+ */
+bool GooeyWindow_ReadPixels(GooeyWindow *win, unsigned char *rgba, int width, int height);
 #ifdef __cplusplus
 }
 #endif
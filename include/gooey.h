@@ -25,6 +25,7 @@
 #include "core/gooey_widget.h"
 #include "widgets/gooey_appbar.h"
 #include "widgets/gooey_image.h"
+#include "widgets/gooey_image_viewer.h"
 #include "widgets/gooey_button.h"
 #include "widgets/gooey_canvas.h"
 #include "widgets/gooey_checkbox.h"
@@ -70,6 +71,60 @@ extern "C" {
  */
 int Gooey_Init();
 
+/**
+ * @brief Initializes the Gooey system with options.
+ *
+ * With GOOEY_INIT_HEADLESS, or whenever the GOOEY_HEADLESS environment
+ * variable is set to anything but 0, windows render into offscreen
+ * framebuffers through EGL, surfaceless where the driver allows it. Mesa's
+ * llvmpipe runs it without a display server or a GPU, for benchmarks and
+ * CI: drive the windows with GooeyWindow_InjectEvent() and check them with
+ * GooeyWindow_ReadPixels().
+ *
+ * With GOOEY_INIT_SOFTWARE, or the GOOEY_SOFTWARE environment variable, the
+ * CPU draws the windows instead, for boards without a GPU. Frames go where
+ * GOOEY_SOFT_OUTPUT points: the framebuffer device, numbered PPM files or
+ * shared memory for a compositor (see soft_output_internal.h).
+ *
+ * With GOOEY_INIT_THREADED, or the GOOEY_THREADED environment variable,
+ * each window runs on a thread of its own: a slow window no longer holds
+ * back the frames of the others. Widget callbacks and the drawing of a
+ * window then run on its thread, while timers, image load callbacks and
+ * GL submission stay on the thread calling GooeyWindow_Run(). Application
+ * state shared between windows must be guarded by the application.
+ *
+ * @param flags GooeyInitFlags.
+ * @return 0 on success, non-zero when the backend cannot run that way.
+ */
+int Gooey_InitWithFlags(GooeyInitFlags flags);
+
+/**
+ * @brief Selects how text is rasterized, can be changed at any time.
+ *
+ * GOOEY_TEXT_RENDER_SDF keeps glyph edges crisp at any font size from a
+ * single rasterization; it falls back to bitmaps when the FreeType in use
+ * cannot produce distance fields. Compare both through
+ * GooeyWindow_GetRenderStats().
+ *
+ * @param mode The text rendering mode.
+ */
+void Gooey_SetTextRenderMode(GooeyTextRenderMode mode);
+
+/** Defined where Gooey_SetTextRenderMode() exists, for code that also builds against older versions. */
+#define GOOEY_HAS_TEXT_RENDER_MODE 1
+
+/**
+ * @brief Measures a string as it would be drawn at @p font_size.
+ *
+ * Results are cached by content and size, so measuring the same labels
+ * every frame costs a hash lookup. Needs a window to have been created.
+ *
+ * @param text The UTF-8 string to measure.
+ * @param font_size Font size in pixels, as passed to the drawing functions.
+ * @param metrics Receives the extent, zeroed when nothing can be measured.
+ */
+void Gooey_MeasureText(const char *text, float font_size, GooeyTextMetrics *metrics);
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,6 +18,18 @@
  */
 #define ENABLE_DEBUG_OVERLAY 1
 
+/**
+ * Redraw only the parts of a window that changed since the last frame
+ * Set to 0 to repaint whole windows, e.g. to rule it out while debugging
+ */
+#define ENABLE_DAMAGE_TRACKING 1
+
+/*
+ * Record what simple widgets draw and replay it while they are unchanged
+ * Set to 0 to lay out and draw every widget on every frame
+ */
+#define ENABLE_DISPLAY_LISTS 1
+
 /*******************************************************************************
  *                             APPLICATION LAYOUT                              *
  ******************************************************************************/
@@ -29,9 +41,144 @@
  *                          SYSTEM RESOURCE LIMITS                             *
  ******************************************************************************/
 
-/** Maximum number of timer objects that can be created */
+/** Maximum number of timer objects the Vulkan backend can create, the GLPS one has no limit */
 #define MAX_TIMERS 100
 
+/**
+ * Longest the idle main loop sleeps before polling input, in milliseconds,
+ * when the display server connection cannot be waited on directly.
+ */
+#define EVENT_LOOP_INPUT_POLL_MS 8
+
+/**
+ * Poll interval the loop backs off to while no input arrives, in
+ * milliseconds. Bounds the delay of the first input after a quiet spell.
+ */
+#define EVENT_LOOP_IDLE_POLL_MS 64
+
+/**
+ * Longest the idle main loop sleeps at all, in milliseconds. Catches input a
+ * toolkit queued without the connection becoming readable.
+ */
+#define EVENT_LOOP_MAX_WAIT_MS 100
+
+/**
+ * Frame interval of windows drawn on their own threads (GOOEY_INIT_THREADED),
+ * in milliseconds. Their frames are all presented from the main thread, so
+ * presentation does not wait for the display's refresh there, which would
+ * hold every window back behind the one being presented; each window's
+ * thread instead keeps it to at most one frame per interval. Windows may
+ * tear as a result. Set to 0 to present in step with the display.
+ */
+#define THREADED_FRAME_INTERVAL_MS 16
+
+/**
+ * Glyph atlas budget, in 512x512 pages (256 KB of VRAM each).
+ * Least recently used pages are evicted once all of them are full.
+ */
+#define GLYPH_ATLAS_MAX_PAGES 4
+
+/**
+ * Number of measured strings kept by the text metrics cache (32 bytes each).
+ * Older entries are replaced once it is full.
+ */
+#define TEXT_METRICS_CACHE_ENTRIES 1024
+
+/**
+ * Glyphs the software backend keeps rasterized, per codepoint and pixel size.
+ * A glyph drawn again takes the slot of the one it replaces.
+ */
+#define SOFT_GLYPH_CACHE_ENTRIES 512
+
+/**
+ * VRAM widget layers may hold, in megabytes (4 bytes per pixel).
+ * Layers not drawn in the current frame are evicted, least recently used first,
+ * when a new one does not fit. Widgets that still do not fit are drawn directly.
+ */
+#define LAYER_CACHE_BUDGET_MB 64
+
+/**
+ * VRAM image textures nobody draws anymore may keep, in megabytes. Every
+ * widget showing the same file or embedded image shares one texture; once
+ * unused it stays resident for the next one until this budget is exceeded,
+ * then the least recently used are deleted.
+ */
+#define TEXTURE_CACHE_BUDGET_MB 128
+
+/**
+ * Image widgets decode their files on worker threads and show a placeholder
+ * until the texture is ready. Set to 0 to load them on first draw instead.
+ */
+#define ENABLE_ASYNC_IMAGE_LOADING 1
+
+/** Number of image decoding threads, started on the first asynchronous load */
+#define IMAGE_DECODE_WORKERS 2
+
+/**
+ * Decoded image bytes uploaded to the GPU per pass of the main loop, in
+ * kilobytes. Bounds the stall a burst of finished images adds to one frame;
+ * a single image bigger than the budget still goes up on its own pass.
+ */
+#define IMAGE_UPLOAD_BUDGET_KB 8192
+
+/**
+ * Image widgets shrink pictures with at least this many times more pixels
+ * than they display before uploading them, so a photo shown as a thumbnail
+ * costs a thumbnail's worth of GPU memory. 0 keeps every image full size.
+ */
+#define IMAGE_DOWNSCALE_MIN_RATIO 4
+
+/**
+ * Display pixels per layout unit that downscaled images are sized for. The
+ * window system gives no content scale, set it above 1 on high DPI screens
+ * so that images are not shrunk below their on-screen resolution.
+ */
+#define IMAGE_DOWNSCALE_DPI_SCALE 1.0f
+
+/**
+ * Parsed SVG files kept in memory. Image widgets rasterize SVGs at the size
+ * they are displayed at (times IMAGE_DOWNSCALE_DPI_SCALE), and again when
+ * they are resized; a kept file is rasterized without being parsed again.
+ */
+#define SVG_CACHE_ENTRIES 64
+
+/**
+ * Keep decoded images in a cache directory from one launch to the next, so
+ * that startup maps them instead of decoding PNG, JPEG and SVG files again.
+ * The directory is $GOOEY_IMAGE_CACHE_DIR, or else gooey/images in the
+ * user's cache directory; set the variable to an empty string to disable
+ * the cache at run time.
+ */
+#define ENABLE_DISK_IMAGE_CACHE 1
+
+/**
+ * Size the image cache directory may grow to, in megabytes. Entries are
+ * decoded pixels with their mipmaps, the least recently used go first.
+ */
+#define DISK_IMAGE_CACHE_MB 256
+
+/**
+ * Pixel buffers each streamed image (GooeyImage_UpdatePixels()) rotates
+ * through. With 2 the GPU reads one frame while the next one is written;
+ * raise it to 3 when uploads of large frames still stall the render.
+ */
+#define IMAGE_STREAM_BUFFERS 2
+
+/**
+ * Tiles each image viewer keeps, resident or loading. Tiles out of view are
+ * dropped least recently used first once they are all taken; the window has
+ * to be covered by fewer than this many (256 pixel tiles: 64 cover 1920x1080
+ * with room for the coarser ones drawn while the sharp ones load).
+ */
+#define IMAGE_VIEWER_MAX_TILES 256
+
+/**
+ * Tiles an image viewer has queued for decoding at once. Requests for tiles
+ * that leave the view are cancelled, a small queue keeps a fast pan from
+ * decoding tiles nobody sees anymore.
+ */
+#define IMAGE_VIEWER_MAX_PENDING 16
+
 /** Maximum number of widgets per window */
 #define MAX_WIDGETS 100
 
@@ -90,6 +237,9 @@
 /** Image widget - Display static and animated images (GIF support) */
 #define ENABLE_IMAGE 1
 
+/** Image viewer widget - Pan and zoom through tiled images of any size */
+#define ENABLE_IMAGE_VIEWER 1
+
 /** Label widget - Text display */
 #define ENABLE_LABEL 1
 
@@ -54,6 +54,62 @@ void GooeyImage_SetImage(GooeyImage *image, const char *image_path);
  */
 void GooeyImage_Damage(GooeyImage *image);
 
+/**
+ * @brief Sets a function called once the image's file has been loaded.
+ *
+ * Images are decoded in the background and drawn as a placeholder until
+ * they are ready; the callback runs on the UI thread when the texture
+ * arrives, or when loading failed. It runs again after every
+ * GooeyImage_SetImage().
+ *
+ * @param image The image widget to watch.
+ * @param callback Called with loaded set to false when the file could not be read or decoded.
+ * @param user_data User data passed to the callback.
+ */
+void GooeyImage_SetLoadCallback(GooeyImage *image, void (*callback)(GooeyImage *image, bool loaded, void *user_data),
+                                void *user_data);
+
+/**
+ * @brief Sets whether large files are shrunk to the widget's size when loaded.
+ *
+ * On by default: a picture with many more pixels than the widget shows is
+ * downscaled before it reaches the GPU, and loaded again at a higher
+ * resolution if the widget grows. An SVG is rasterized at the widget's size
+ * instead of its own, and again whenever the widget is resized. Turn it off
+ * for images that are zoomed or read back at full resolution, SVGs are then
+ * rasterized at their intrinsic size. The image is reloaded when it changes.
+ *
+ * @param image The image widget to update.
+ * @param downscale false to always keep the full resolution.
+ */
+void GooeyImage_SetDownscale(GooeyImage *image, bool downscale);
+
+/**
+ * @brief Shows raw pixels, such as a video or camera frame, in place of the image's file.
+ *
+ * The pixels are copied and the call returns at once; the frame is uploaded
+ * when the window next draws, into a texture reused from frame to frame.
+ * Meant to be called from one producer thread, or from the UI thread. A
+ * frame pushed before the previous one was displayed replaces it: the
+ * image always shows the newest frame and the older one counts as
+ * dropped, see GooeyImage_GetDroppedFrames().
+ *
+ * Stop pushing frames before the image is destroyed.
+ *
+ * @param image The image widget to update.
+ * @param rgba Pixels, 4 bytes each in R, G, B, A order, top row first.
+ * @param stride Bytes from one row to the next, 0 when the rows are tightly packed.
+ * @param width Width of the frame in pixels.
+ * @param height Height of the frame in pixels.
+ * @return false when the arguments are invalid or the frame could not be copied.
+ */
+bool GooeyImage_UpdatePixels(GooeyImage *image, const unsigned char *rgba, int stride, int width, int height);
+
+/**
+ * @brief Number of frames passed to GooeyImage_UpdatePixels() that were replaced before being displayed.
+ */
+uint64_t GooeyImage_GetDroppedFrames(const GooeyImage *image);
+
 #endif // ENABLE_IMAGE
 
 #ifdef __cplusplus
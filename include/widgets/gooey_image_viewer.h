@@ -0,0 +1,79 @@
+/**
+ * @file gooey_image_viewer.h
+ * @brief Pan and zoom viewer for tiled images of any size.
+ *
+ * The image is read from a pyramid of tiles on disk: level 0 holds the full
+ * resolution image cut into square tiles, every next level the image at half
+ * the size of the previous one, down to the level that fits in a single
+ * tile. Only the tiles covering the view at the current zoom are decoded and
+ * uploaded, the work per frame does not depend on the size of the image.
+ *
+ * @author Yassine Ahmed Ali
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef GOOEY_IMAGE_VIEWER_H
+#define GOOEY_IMAGE_VIEWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "common/gooey_common.h"
+
+#if (ENABLE_IMAGE_VIEWER)
+
+/**
+ * @brief Creates an image viewer showing the whole image.
+ *
+ * Tiles are read from the files @p tile_path names once formatted with the
+ * level, column and row, in that order: "tiles/%d/%d_%d.jpg" reads the top
+ * left tile of the full resolution level from "tiles/0/0_0.jpg". Tiles are
+ * @p tile_size pixels square, except along the right and bottom edges, and
+ * do not overlap. Levels are numbered from the full resolution one, Deep
+ * Zoom pyramids number them the other way around.
+ *
+ * Dragging pans the image, scrolling zooms around the pointer.
+ *
+ * @param tile_path Pattern of the tile files, with exactly three %d.
+ * @param image_width Width of the full resolution image.
+ * @param image_height Height of the full resolution image.
+ * @param tile_size Side of the tiles in pixels.
+ * @param x The x-coordinate of the viewer's position.
+ * @param y The y-coordinate of the viewer's position.
+ * @param width The width of the viewer.
+ * @param height The height of the viewer.
+ * @return A pointer to the newly created GooeyImageViewer, NULL when the pattern or sizes are invalid.
+ */
+GooeyImageViewer *GooeyImageViewer_Create(const char *tile_path, int image_width, int image_height, int tile_size,
+                                          int x, int y, int width, int height);
+
+/**
+ * @brief Moves the view.
+ *
+ * @param viewer The image viewer to update.
+ * @param center_x Full resolution x-coordinate shown at the center of the viewer.
+ * @param center_y Full resolution y-coordinate shown at the center of the viewer.
+ * @param zoom Screen pixels per full resolution pixel, 1 shows the image at its real size.
+ */
+void GooeyImageViewer_SetView(GooeyImageViewer *viewer, double center_x, double center_y, double zoom);
+
+/**
+ * @brief Reads the current view, see GooeyImageViewer_SetView().
+ */
+void GooeyImageViewer_GetView(const GooeyImageViewer *viewer, double *center_x, double *center_y, double *zoom);
+
+/**
+ * @brief Zooms out until the whole image fits the viewer, and centers it.
+ *
+ * @param viewer The image viewer to update.
+ */
+void GooeyImageViewer_FitToView(GooeyImageViewer *viewer);
+
+#endif // ENABLE_IMAGE_VIEWER
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GOOEY_IMAGE_VIEWER_H
@@ -110,6 +110,36 @@ extern "C"
         void (*MakeWindowTransparent)(GooeyWindow *win, int blur_radius, float opacity);
 
         void (*RenderBatch)(int window_id);
+        void (*GetRenderStats)(int window_id, GooeyRenderStats *stats);                                                 /**< Fills renderer counters, optional. */
+        void (*SetTextRenderMode)(GooeyTextRenderMode mode);                                                            /**< Selects bitmap or SDF glyphs, optional. */
+        void (*MeasureText)(const char *text, int length, float font_size, GooeyTextMetrics *metrics);                 /**< Measures text at a font size, cached, optional. */
+        void (*BeginDisplayList)(int window_id);                                                                        /**< Starts recording what a widget draws, optional. */
+        GooeyDisplayList *(*EndDisplayList)(int window_id, GooeyDisplayList *list);                                     /**< Stores the recording in list, allocated when NULL. */
+        bool (*ReplayDisplayList)(int window_id, const GooeyDisplayList *list);                                         /**< Draws a recording again, false when it went stale. */
+        void (*DestroyDisplayList)(GooeyDisplayList *list);                                                             /**< Frees a recording. */
+        bool (*BeginLayer)(int window_id, GooeyLayer **layer, int x, int y, int width, int height, uint64_t key);      /**< Composites a cached layer, true when its content has to be drawn. */
+        void (*EndLayer)(int window_id, GooeyLayer *layer);                                                             /**< Renders what was drawn since BeginLayer into the layer. */
+        void (*InvalidateLayer)(GooeyLayer *layer);                                                                     /**< Forces the content to be drawn again. */
+        void (*DestroyLayer)(GooeyLayer *layer);                                                                        /**< Frees a layer and its texture. */
+        unsigned int (*LoadImageAsync)(const char *image_path, int window_id, int width, int height,
+                                       void (*callback)(unsigned int texture_id, void *user_data), void *user_data); /**< Decodes off the render thread, downscaled to width x height when much larger (0 for full size), 0 when the image has to be loaded synchronously. */
+        void (*CancelImageLoad)(unsigned int request);                                                                  /**< Drops a pending load, its callback is not called. */
+        unsigned int (*LoadImageScaled)(const char *image_path, int width, int height);                                 /**< LoadGooeyImage, downscaled to width x height when much larger. */
+        unsigned int (*LoadImageTile)(const char *image_path);                                                          /**< LoadGooeyImage for one of many small images cut from a larger one, kept out of the disk cache. Optional. */
+        unsigned int (*LoadImageTileAsync)(const char *image_path, int window_id,
+                                           void (*callback)(unsigned int texture_id, void *user_data), void *user_data); /**< LoadImageAsync at full size, kept out of the disk cache like LoadImageTile. Optional. */
+        void (*DrawImageRegion)(unsigned int texture_id, float u0, float v0, float u1, float v1,
+                                int x, int y, int width, int height, int window_id);                            /**< DrawImage of the part between u0,v0 and u1,v1, from the top left, optional. */
+        unsigned int (*UpdateImagePixels)(unsigned int texture_id, const unsigned char *rgba, int width, int height,
+                                          int window_id);                                                       /**< Overwrites a texture it returned before with tightly packed RGBA, or creates one for any other texture_id; returns the texture to draw, freed by UnloadImage. Optional. */
+        void (*DrawArc)(int x_center, int y_center, int width, int height, float angle1, float angle2, float thickness,
+                        uint32_t color, int window_id);                                                         /**< Antialiased arc of the ellipse filling width x height, from angle1 to angle2 degrees (0 on the left, growing clockwise); a ring thickness pixels wide, or the filled pie when 0. Optional. */
+        void (*DrawPolyline)(const float *points, size_t count, float width, uint32_t color, GooeyLineJoin join,
+                             int window_id);                                                            /**< Antialiased line width pixels wide through count points, x then y, submitted with a single draw. Optional. */
+        int (*InitHeadless)(int project_branch);                                                        /**< Init without a display, windows render offscreen; nonzero when that is impossible. Optional. */
+        void (*InjectEvent)(int window_id, const GooeyEvent *event);                                    /**< Delivers input as the window system would and handles it right away, once Run started. Optional. */
+        bool (*ReadPixels)(int window_id, unsigned char *rgba, int width, int height);                  /**< Copies width x height RGBA pixels from the top left of the window, false when unsupported. Optional. */
+        void (*SetThreadedRendering)(bool enabled);                                                     /**< Runs each window on its own thread from Run on, GL calls stay on the thread calling Run. Optional. */
     } GooeyBackend;
 
     /**
@@ -125,6 +155,11 @@ extern "C"
     extern GooeyBackend glps_backend;
     extern GooeyBackend glps_vk_backend;
 
+    /**
+     * @brief The software backend for Gooey, drawing on the CPU.
+     */
+    extern GooeyBackend soft_backend;
+
     /**
      * @brief The TFT backend for Gooey.
      */
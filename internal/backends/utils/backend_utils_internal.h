@@ -92,7 +92,7 @@ static const char *rectangle_vertex_shader =
     "uniform bool isRounded;\n"
     "uniform bool isHollow;\n"
     "uniform float borderWidth;\n"
-    "uniform int shapeType; // 0=rectangle, 1=line, 2=arc\n"
+    "uniform int shapeType; // 0=rectangle, 1=line, 2=arc, 3=stroke\n"
     "\n"
     "float roundedBoxSDF(vec2 centerPos, vec2 size, float radius) {\n"
     "    vec2 q = abs(centerPos) - size + radius;\n"
@@ -142,39 +142,126 @@ static const char *rectangle_vertex_shader =
     "        // Lines are drawn using GL_LINES primitive\n"
     "    }\n"
     "    else if (shapeType == 2) { // Arc\n"
-    "        // Arcs are handled by triangle fan\n"
+    "        // Arcs are drawn by the quad program\n"
+    "    }\n"
+    "    else if (shapeType == 3) { // Stroke\n"
+    "        // x is the distance across the line, y its half width, both in pixels\n"
+    "        float coverage = clamp(TexCoord.y + 0.5 - abs(TexCoord.x), 0.0, 1.0);\n"
+    "        if (coverage <= 0.0) discard;\n"
+    "        baseColor.a *= coverage;\n"
     "    }\n"
     "\n"
     "    fragment = baseColor;\n"
     "}\n";
-static const char *text_vertex_shader_source =
-#if GLES_ON 
+/*
+ * Instanced quad pipeline: one instance per rectangle, rounded rectangle,
+ * border, arc or glyph. Geometry is expanded from gl_VertexID (4-vertex strip)
+ * and every shape parameter travels as a per-instance attribute, so any
+ * number of differently shaped quads can share a single draw call.
+ */
+static const char *quad_vertex_shader_source =
+#if GLES_ON
     "#version 300 es\n"
-#else 
+#else
    "#version 400 core\n"
 #endif
-    "precision mediump float;\n"
-    "layout(location = 0) in vec4 vertex;\n"
-    "out vec2 TexCoords;\n"
-    "uniform mat4 projection;\n"
+    "precision highp float;\n"
+    "layout(location = 0) in vec4 rect;  // x, y, width, height in pixels\n"
+    "layout(location = 1) in vec4 color;\n"
+    "layout(location = 2) in vec4 shape; // corner radius, border width (0 = filled), kind (0 = shape, 1 = glyph, 2 = SDF glyph, 3 = arc), atlas page\n"
+    "layout(location = 3) in vec4 uv;    // atlas rectangle, top left then bottom right\n"
+    "uniform vec2 viewport;\n"
+    "out vec4 vColor;\n"
+    "out vec2 vLocal;\n"
+    "out vec2 vUv;\n"
+    "flat out vec2 vHalfSize;\n"
+    "flat out vec4 vShape;\n"
     "void main() {\n"
-    "    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);\n"
-    "    TexCoords = vec2(vertex.z, 1.0-vertex.w);\n"
+    "    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n"
+    "    vec2 ndc = (rect.xy + corner * rect.zw) / viewport * 2.0 - 1.0;\n"
+    "    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+    "    vHalfSize = abs(rect.zw) * 0.5;\n"
+    "    vLocal = (corner - 0.5) * abs(rect.zw);\n"
+    "    vUv = mix(uv.xy, uv.zw, corner);\n"
+    "    vColor = color;\n"
+    "    vShape = shape;\n"
     "}\n";
-static const char *text_fragment_shader_source =
-#if GLES_ON 
+
+static const char *quad_fragment_shader_source =
+#if GLES_ON
     "#version 300 es\n"
-#else 
+#else
    "#version 400 core\n"
 #endif
-    "precision mediump float;\n"
-    "in vec2 TexCoords;\n"
-    "out vec4 color;\n"
-    "uniform sampler2D text;\n"
-    "uniform vec3 textColor;\n"
+    "precision highp float;\n"
+    "precision mediump sampler2DArray;\n"
+    "in vec4 vColor;\n"
+    "in vec2 vLocal;\n"
+    "in vec2 vUv;\n"
+    "flat in vec2 vHalfSize;\n"
+    "flat in vec4 vShape;\n"
+    "uniform sampler2DArray atlas;\n"
+    "out vec4 fragment;\n"
+    "\n"
+    "float roundedBoxSDF(vec2 p, vec2 halfSize, float radius) {\n"
+    "    radius = min(radius, min(halfSize.x, halfSize.y));\n"
+    "    vec2 q = abs(p) - halfSize + radius;\n"
+    "    return min(max(q.x, q.y), 0.0) + length(max(q, 0.0)) - radius;\n"
+    "}\n"
+    "\n"
+    "// Exact for circles, first order for ellipses: good to a pixel around the edge.\n"
+    "float ellipseSDF(vec2 p, vec2 radii) {\n"
+    "    float k1 = length(p / radii);\n"
+    "    float k2 = length(p / (radii * radii));\n"
+    "    return k2 > 0.0 ? k1 * (k1 - 1.0) / k2 : -min(radii.x, radii.y);\n"
+    "}\n"
+    "\n"
+    "// Arc quads have a pixel of margin around the ellipse for its antialiased edge.\n"
+    "// Angles start on the left and grow clockwise, the way FillArc has always drawn them.\n"
+    "float arcSDF(vec2 p, vec2 halfSize, vec4 shape) {\n"
+    "    vec2 radii = max(halfSize - 1.0, vec2(0.5));\n"
+    "    float distance = ellipseSDF(p, radii);\n"
+    "    vec2 inner = radii - vec2(shape.w);\n"
+    "    if (shape.w > 0.0 && inner.x > 0.0 && inner.y > 0.0)\n"
+    "        distance = max(distance, -ellipseSDF(p, inner));\n"
+    "    if (shape.y < 6.2831) {\n"
+    "        float along = mod(atan(-p.y, -p.x) - shape.x, 6.2831853);\n"
+    "        float away = along <= shape.y ? -min(along, shape.y - along) : min(along - shape.y, 6.2831853 - along);\n"
+    "        distance = max(distance, length(p) * sin(clamp(away, -1.5707963, 1.5707963)));\n"
+    "    }\n"
+    "    return distance;\n"
+    "}\n"
+    "\n"
     "void main() {\n"
-    "   float alpha = texture(text, TexCoords).r;\n"
-    "   color = vec4(textColor, alpha);\n"
+    "    if (vShape.z > 2.5) {\n"
+    "        float coverage = clamp(0.5 - arcSDF(vLocal, vHalfSize, vShape), 0.0, 1.0);\n"
+    "        if (coverage <= 0.0) discard;\n"
+    "        fragment = vec4(vColor.rgb, vColor.a * coverage);\n"
+    "        return;\n"
+    "    }\n"
+    "    if (vShape.z > 1.5) {\n"
+    "        float field = texture(atlas, vec3(vUv, vShape.w)).r;\n"
+    "        float width = max(fwidth(field), 1e-4) * 0.7;\n"
+    "        float alpha = smoothstep(0.5 - width, 0.5 + width, field);\n"
+    "        if (alpha <= 0.0) discard;\n"
+    "        fragment = vec4(vColor.rgb, vColor.a * alpha);\n"
+    "        return;\n"
+    "    }\n"
+    "    if (vShape.z > 0.5) {\n"
+    "        fragment = vec4(vColor.rgb, vColor.a * texture(atlas, vec3(vUv, vShape.w)).r);\n"
+    "        return;\n"
+    "    }\n"
+    "    float radius = vShape.x;\n"
+    "    float distance = roundedBoxSDF(vLocal, vHalfSize, radius);\n"
+    "    if (vShape.y > 0.0) {\n"
+    "        float border = max(vShape.y, 1.0);\n"
+    "        vec2 innerHalf = vHalfSize - vec2(border);\n"
+    "        if (innerHalf.x > 0.0 && innerHalf.y > 0.0)\n"
+    "            distance = max(distance, -roundedBoxSDF(vLocal, innerHalf, max(radius - border, 0.0)));\n"
+    "    }\n"
+    "    float coverage = clamp(0.5 - distance, 0.0, 1.0);\n"
+    "    if (coverage <= 0.0) discard;\n"
+    "    fragment = vec4(vColor.rgb, vColor.a * coverage);\n"
     "}\n";
 
 void check_shader_link(GLuint program);
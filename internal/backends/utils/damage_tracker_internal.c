@@ -0,0 +1,234 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/damage_tracker_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void damage_tracker_init(DamageTracker *tracker)
+{
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->invalid = true;
+}
+
+void damage_tracker_destroy(DamageTracker *tracker)
+{
+    free(tracker->current);
+    free(tracker->previous);
+    memset(tracker, 0, sizeof(*tracker));
+}
+
+void damage_tracker_invalidate(DamageTracker *tracker)
+{
+    tracker->invalid = true;
+}
+
+void damage_tracker_add(DamageTracker *tracker, uint64_t hash, float x0, float y0, float x1, float y1)
+{
+    if (tracker->overflowed)
+        return;
+
+    if (tracker->current_count == tracker->current_capacity)
+    {
+        size_t capacity = tracker->current_capacity ? tracker->current_capacity * 2 : 256;
+        DamagePrimitive *grown = realloc(tracker->current, capacity * sizeof(DamagePrimitive));
+        if (!grown)
+        {
+            LOG_ERROR("Failed to grow damage tracker to %zu primitives", capacity);
+            tracker->overflowed = true;
+            return;
+        }
+        tracker->current = grown;
+        tracker->current_capacity = capacity;
+    }
+
+    DamagePrimitive *primitive = &tracker->current[tracker->current_count++];
+    primitive->hash = hash;
+    primitive->bounds.x = (int)floorf(fminf(x0, x1)) - DAMAGE_PADDING;
+    primitive->bounds.y = (int)floorf(fminf(y0, y1)) - DAMAGE_PADDING;
+    primitive->bounds.width = (int)ceilf(fabsf(x1 - x0)) + 2 * DAMAGE_PADDING + 1;
+    primitive->bounds.height = (int)ceilf(fabsf(y1 - y0)) + 2 * DAMAGE_PADDING + 1;
+}
+
+static int damage_compare_primitives(const void *a, const void *b)
+{
+    const uint64_t ha = ((const DamagePrimitive *)a)->hash;
+    const uint64_t hb = ((const DamagePrimitive *)b)->hash;
+    return (ha > hb) - (ha < hb);
+}
+
+static bool damage_rect_overlaps(const DamageRect *a, const DamageRect *b)
+{
+    return a->x <= b->x + b->width && b->x <= a->x + a->width &&
+           a->y <= b->y + b->height && b->y <= a->y + a->height;
+}
+
+static DamageRect damage_rect_union(const DamageRect *a, const DamageRect *b)
+{
+    const int x0 = a->x < b->x ? a->x : b->x;
+    const int y0 = a->y < b->y ? a->y : b->y;
+    const int x1 = a->x + a->width > b->x + b->width ? a->x + a->width : b->x + b->width;
+    const int y1 = a->y + a->height > b->y + b->height ? a->y + a->height : b->y + b->height;
+    return (DamageRect){x0, y0, x1 - x0, y1 - y0};
+}
+
+static long damage_rect_area(const DamageRect *rect)
+{
+    return (long)rect->width * rect->height;
+}
+
+static void damage_region_add(DamageRegion *region, DamageRect rect, int width, int height)
+{
+    if (region->full)
+        return;
+
+    // Clip to the window, damage outside of it is never visible.
+    if (rect.x < 0)
+    {
+        rect.width += rect.x;
+        rect.x = 0;
+    }
+    if (rect.y < 0)
+    {
+        rect.height += rect.y;
+        rect.y = 0;
+    }
+    if (rect.x + rect.width > width)
+        rect.width = width - rect.x;
+    if (rect.y + rect.height > height)
+        rect.height = height - rect.y;
+    if (rect.width <= 0 || rect.height <= 0)
+        return;
+
+    // Fold every rectangle the new one touches into it, overlapping scissors would draw twice.
+    for (int i = 0; i < region->count;)
+    {
+        if (damage_rect_overlaps(&rect, &region->rects[i]))
+        {
+            rect = damage_rect_union(&rect, &region->rects[i]);
+            region->rects[i] = region->rects[--region->count];
+            i = 0;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    if (region->count < DAMAGE_MAX_RECTS)
+    {
+        region->rects[region->count++] = rect;
+        return;
+    }
+
+    // Out of rectangles: grow the one that gains the least area.
+    int best = 0;
+    long best_growth = -1;
+    for (int i = 0; i < region->count; ++i)
+    {
+        const DamageRect merged = damage_rect_union(&rect, &region->rects[i]);
+        const long growth = damage_rect_area(&merged) - damage_rect_area(&region->rects[i]);
+        if (best_growth < 0 || growth < best_growth)
+        {
+            best = i;
+            best_growth = growth;
+        }
+    }
+    region->rects[best] = damage_rect_union(&rect, &region->rects[best]);
+}
+
+static void damage_region_merge(DamageRegion *dst, const DamageRegion *src, int width, int height)
+{
+    if (src->full)
+    {
+        dst->full = true;
+        return;
+    }
+    for (int i = 0; i < src->count; ++i)
+        damage_region_add(dst, src->rects[i], width, height);
+}
+
+static void damage_region_settle(DamageRegion *region, int width, int height)
+{
+    // Past three quarters of the window a single unscissored pass is cheaper than several scissored ones.
+    if (!region->full && damage_region_area(region, width, height) * 4 > (size_t)width * height * 3)
+        region->full = true;
+    if (region->full)
+        region->count = 0;
+}
+
+bool damage_tracker_end_frame(DamageTracker *tracker, int width, int height, int buffer_age, DamageRegion *repaint)
+{
+    DamageRegion frame = {0};
+    frame.full = tracker->invalid || tracker->overflowed || width != tracker->width || height != tracker->height;
+
+    qsort(tracker->current, tracker->current_count, sizeof(DamagePrimitive), damage_compare_primitives);
+
+    // Both lists are sorted: walk them together, whatever is only in one of them changed.
+    size_t i = 0, j = 0;
+    while (!frame.full && (i < tracker->current_count || j < tracker->previous_count))
+    {
+        if (j == tracker->previous_count ||
+            (i < tracker->current_count && tracker->current[i].hash < tracker->previous[j].hash))
+        {
+            damage_region_add(&frame, tracker->current[i++].bounds, width, height);
+        }
+        else if (i == tracker->current_count || tracker->previous[j].hash < tracker->current[i].hash)
+        {
+            damage_region_add(&frame, tracker->previous[j++].bounds, width, height);
+        }
+        else
+        {
+            ++i;
+            ++j;
+        }
+    }
+    damage_region_settle(&frame, width, height);
+
+    // The frame just diffed becomes the reference, its storage is reused for the next one.
+    DamagePrimitive *swap = tracker->previous;
+    size_t swap_capacity = tracker->previous_capacity;
+    tracker->previous = tracker->current;
+    tracker->previous_capacity = tracker->current_capacity;
+    tracker->previous_count = tracker->current_count;
+    tracker->current = swap;
+    tracker->current_capacity = swap_capacity;
+    tracker->current_count = 0;
+    tracker->width = width;
+    tracker->height = height;
+
+    // A truncated list would miss whatever disappears next frame, so that one is repainted in full too.
+    tracker->invalid = tracker->overflowed;
+    tracker->overflowed = false;
+
+    if (!frame.full && frame.count == 0)
+        return false;
+
+    // The back buffer misses the damage of every frame presented since it was last drawn into.
+    *repaint = frame;
+    if (buffer_age <= 0 || buffer_age - 1 > DAMAGE_HISTORY)
+        repaint->full = true;
+    for (int age = 0; age < buffer_age - 1 && !repaint->full; ++age)
+        damage_region_merge(repaint, &tracker->history[age], width, height);
+    damage_region_settle(repaint, width, height);
+
+    memmove(&tracker->history[1], &tracker->history[0], (DAMAGE_HISTORY - 1) * sizeof(DamageRegion));
+    tracker->history[0] = frame;
+    return true;
+}
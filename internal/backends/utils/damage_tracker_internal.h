@@ -0,0 +1,127 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file damage_tracker_internal.h
+ * @brief Finds the parts of a window that changed between two frames.
+ *
+ * Every primitive of a frame is reported as a content hash and its screen
+ * bounds. At the end of the frame the hashes are matched against the
+ * previous frame's: primitives that appeared or disappeared damage their
+ * bounds, everything that matched is already on screen. Widgets do not have
+ * to report what they changed, a hover that recolours one button damages
+ * that button only.
+ *
+ * The damage of the last few frames is remembered so a back buffer that is
+ * several frames old (EGL buffer age) can be brought up to date.
+ */
+
+#ifndef DAMAGE_TRACKER_INTERNAL_H
+#define DAMAGE_TRACKER_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Rectangles a region keeps before neighbours are merged into their bounding box. */
+#define DAMAGE_MAX_RECTS 4
+
+/** Past frames remembered, back buffers older than this are repainted in full. */
+#define DAMAGE_HISTORY 3
+
+/** Pixels added around every primitive, covers anti-aliased edges and line width. */
+#define DAMAGE_PADDING 2
+
+typedef struct
+{
+    int x, y, width, height; /**< Window pixels, origin at the top left. */
+} DamageRect;
+
+typedef struct
+{
+    DamageRect rects[DAMAGE_MAX_RECTS];
+    int count;
+    bool full; /**< The whole window, rects are meaningless. */
+} DamageRegion;
+
+typedef struct
+{
+    uint64_t hash;
+    DamageRect bounds;
+} DamagePrimitive;
+
+typedef struct
+{
+    DamagePrimitive *current;
+    size_t current_count;
+    size_t current_capacity;
+    DamagePrimitive *previous; /**< Sorted by hash. */
+    size_t previous_count;
+    size_t previous_capacity;
+    DamageRegion history[DAMAGE_HISTORY]; /**< [0] is the damage of the last presented frame. */
+    int width, height;
+    bool invalid;    /**< Next frame is damaged in full. */
+    bool overflowed; /**< Primitives were dropped from the frame being built, its list cannot be diffed against. */
+} DamageTracker;
+
+void damage_tracker_init(DamageTracker *tracker);
+void damage_tracker_destroy(DamageTracker *tracker);
+
+/**
+ * @brief Damages the whole window on the next frame, for changes hashes cannot see.
+ */
+void damage_tracker_invalidate(DamageTracker *tracker);
+
+/**
+ * @brief Reports one primitive of the frame being built, bounds in window pixels.
+ */
+void damage_tracker_add(DamageTracker *tracker, uint64_t hash, float x0, float y0, float x1, float y1);
+
+/**
+ * @brief Diffs the frame against the previous one and starts the next.
+ *
+ * @param buffer_age Frames since the back buffer was last drawn into, 0 when unknown.
+ * @param repaint Receives what has to be cleared and redrawn in the back buffer.
+ * @return false when nothing changed at all, the frame does not need presenting.
+ */
+bool damage_tracker_end_frame(DamageTracker *tracker, int width, int height, int buffer_age, DamageRegion *repaint);
+
+static inline size_t damage_region_area(const DamageRegion *region, int width, int height)
+{
+    if (region->full)
+        return (size_t)width * height;
+
+    size_t area = 0;
+    for (int i = 0; i < region->count; ++i)
+        area += (size_t)region->rects[i].width * region->rects[i].height;
+    return area;
+}
+
+static inline uint64_t damage_hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+#define DAMAGE_HASH_SEED 0xcbf29ce484222325ULL
+
+#endif // DAMAGE_TRACKER_INTERNAL_H
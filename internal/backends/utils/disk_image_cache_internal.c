@@ -0,0 +1,485 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/disk_image_cache_internal.h"
+#include "backends/utils/damage_tracker_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#include <sys/utime.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#define DISK_IMAGE_MAGIC "GIMG"
+#define DISK_IMAGE_VERSION 2
+#define DISK_IMAGE_SUFFIX ".gimg"
+
+/**
+ * Start of every entry, followed by the source path and, from data_offset,
+ * the pixels of every mip level one after the other.
+ */
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    int64_t mtime, size;
+    int32_t key_width, key_height;
+    int32_t width, height, channels, levels;
+    uint32_t path_length;
+    uint32_t reserved;
+    uint64_t data_offset;
+    uint64_t data_size;
+} DiskImageHeader;
+
+static atomic_uint disk_image_temp_counter;
+
+static bool disk_image_make_dirs(char *dir)
+{
+    // Creates every missing parent, one separator at a time.
+    for (char *c = dir + 1;; ++c)
+    {
+        const bool end = *c == '\0';
+        if (!end && *c != '/' && *c != '\\')
+            continue;
+        const char saved = *c;
+        *c = '\0';
+#ifdef _WIN32
+        const int failed = _mkdir(dir) != 0 && errno != EEXIST;
+#else
+        const int failed = mkdir(dir, 0755) != 0 && errno != EEXIST;
+#endif
+        *c = saved;
+        if (failed && end)
+            return false;
+        if (end)
+            return true;
+    }
+}
+
+static bool disk_image_default_dir(char *dir, size_t size)
+{
+    const char *env = getenv("GOOEY_IMAGE_CACHE_DIR");
+    if (env)
+        return snprintf(dir, size, "%s", env) < (int)size;
+
+#ifdef _WIN32
+    const char *base = getenv("LOCALAPPDATA");
+    return base && snprintf(dir, size, "%s\\gooey\\images", base) < (int)size;
+#else
+    const char *base = getenv("XDG_CACHE_HOME");
+    if (base && *base)
+        return snprintf(dir, size, "%s/gooey/images", base) < (int)size;
+    base = getenv("HOME");
+    return base && snprintf(dir, size, "%s/.cache/gooey/images", base) < (int)size;
+#endif
+}
+
+bool disk_image_cache_key(const char *path, DiskImageKey *key)
+{
+    key->width = key->height = 0;
+    return image_file_identity(path, key->path, &key->mtime, &key->size);
+}
+
+/**
+ * Entries are named after the hash of what they hold, minus the modification
+ * time and size: a new version of a file takes the place of the old one.
+ */
+static bool disk_image_entry_path(const DiskImageCache *cache, const DiskImageKey *key, char *path, size_t size)
+{
+    uint64_t hash = damage_hash_bytes(DAMAGE_HASH_SEED, key->path, strlen(key->path));
+    hash = damage_hash_bytes(hash, &key->width, sizeof(key->width));
+    hash = damage_hash_bytes(hash, &key->height, sizeof(key->height));
+    return snprintf(path, size, "%s/%016llx" DISK_IMAGE_SUFFIX, cache->dir, (unsigned long long)hash) < (int)size;
+}
+
+static size_t disk_image_level_size(int width, int height, int channels, int level)
+{
+    const int w = width >> level;
+    const int h = height >> level;
+    return (size_t)(w > 0 ? w : 1) * (h > 0 ? h : 1) * channels;
+}
+
+static size_t disk_image_chain_size(int width, int height, int channels, int levels)
+{
+    size_t size = 0;
+    for (int level = 0; level < levels; ++level)
+        size += disk_image_level_size(width, height, channels, level);
+    return size;
+}
+
+static void *disk_image_map(const char *path, size_t *size)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+    LARGE_INTEGER length;
+    void *mapping = NULL;
+    if (GetFileSizeEx(file, &length) && length.QuadPart > 0)
+    {
+        HANDLE section = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (section)
+        {
+            mapping = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(section);
+        }
+        *size = (size_t)length.QuadPart;
+    }
+    CloseHandle(file);
+    return mapping;
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat info;
+    void *mapping = NULL;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+            mapping = NULL;
+        *size = (size_t)info.st_size;
+    }
+    close(fd);
+    return mapping;
+#endif
+}
+
+void disk_image_cache_unmap(void *mapping, size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(mapping);
+#else
+    munmap(mapping, size);
+#endif
+}
+
+static bool disk_image_header_matches(const DiskImageHeader *header, size_t file_size, const DiskImageKey *key)
+{
+    const size_t path_length = strlen(key->path);
+    if (memcmp(header->magic, DISK_IMAGE_MAGIC, 4) != 0 || header->version != DISK_IMAGE_VERSION ||
+        header->mtime != key->mtime || header->size != key->size || header->key_width != key->width ||
+        header->key_height != key->height || header->path_length != path_length)
+        return false;
+    if (header->width <= 0 || header->height <= 0 || header->channels < 1 || header->channels > 4 ||
+        header->levels < 1 || header->levels > 32)
+        return false;
+    if (header->data_offset < sizeof(DiskImageHeader) + path_length || header->data_offset > file_size ||
+        header->data_size > file_size - header->data_offset)
+        return false;
+    if (header->data_size != disk_image_chain_size(header->width, header->height, header->channels, header->levels))
+        return false;
+    return memcmp((const char *)(header + 1), key->path, path_length) == 0;
+}
+
+bool disk_image_cache_load(DiskImageCache *cache, const DiskImageKey *key, DecodedImage *image)
+{
+    memset(image, 0, sizeof(*image));
+    char path[DISK_IMAGE_CACHE_PATH_MAX + 32];
+    if (!cache->enabled || !disk_image_entry_path(cache, key, path, sizeof(path)))
+        return false;
+
+    size_t size = 0;
+    unsigned char *mapping = disk_image_map(path, &size);
+    if (!mapping)
+        return false;
+
+    const DiskImageHeader *header = (const DiskImageHeader *)mapping;
+    if (size < sizeof(DiskImageHeader) || !disk_image_header_matches(header, size, key))
+    {
+        disk_image_cache_unmap(mapping, size);
+        return false;
+    }
+
+    image->pixels = mapping + header->data_offset;
+    image->width = header->width;
+    image->height = header->height;
+    image->channels = header->channels;
+    image->levels = header->levels;
+    image->mapping = mapping;
+    image->mapping_size = size;
+
+    // Recently used entries are the last to be evicted.
+    utime(path, NULL);
+    return true;
+}
+
+/**
+ * Averages 2x2 blocks of @p source into @p target. Level sizes round down, an odd last column or row is dropped.
+ */
+static void disk_image_halve(const unsigned char *source, int width, int height, int channels, unsigned char *target)
+{
+    const int target_width = width > 1 ? width / 2 : 1;
+    const int target_height = height > 1 ? height / 2 : 1;
+    const size_t stride = (size_t)width * channels;
+
+    for (int y = 0; y < target_height; ++y)
+    {
+        const unsigned char *row0 = source + (size_t)(2 * y) * stride;
+        const unsigned char *row1 = 2 * y + 1 < height ? row0 + stride : row0;
+        unsigned char *out = target + (size_t)y * target_width * channels;
+        for (int x = 0; x < target_width; ++x)
+        {
+            const int x0 = 2 * x * channels;
+            const int x1 = 2 * x + 1 < width ? x0 + channels : x0;
+            for (int c = 0; c < channels; ++c)
+                out[x * channels + c] = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+        }
+    }
+}
+
+static bool disk_image_write_all(FILE *file, const void *data, size_t size)
+{
+    return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+typedef struct
+{
+    char name[64];
+    int64_t mtime;
+    uint64_t size;
+} DiskImageEntry;
+
+static int disk_image_compare_age(const void *a, const void *b)
+{
+    const int64_t left = ((const DiskImageEntry *)a)->mtime;
+    const int64_t right = ((const DiskImageEntry *)b)->mtime;
+    return left < right ? -1 : left > right;
+}
+
+static bool disk_image_is_entry(const char *name)
+{
+    const size_t length = strlen(name);
+    const size_t suffix = sizeof(DISK_IMAGE_SUFFIX) - 1;
+    return length > suffix && length < sizeof(((DiskImageEntry *)0)->name) &&
+           strcmp(name + length - suffix, DISK_IMAGE_SUFFIX) == 0;
+}
+
+static bool disk_image_push_entry(DiskImageEntry **entries, size_t *count, size_t *capacity, const char *name,
+                                  int64_t mtime, uint64_t size)
+{
+    if (*count == *capacity)
+    {
+        const size_t grown = *capacity ? *capacity * 2 : 64;
+        DiskImageEntry *resized = realloc(*entries, grown * sizeof(DiskImageEntry));
+        if (!resized)
+            return false;
+        *entries = resized;
+        *capacity = grown;
+    }
+    DiskImageEntry *entry = &(*entries)[(*count)++];
+    snprintf(entry->name, sizeof(entry->name), "%s", name);
+    entry->mtime = mtime;
+    entry->size = size;
+    return true;
+}
+
+/**
+ * Deletes the entries touched longest ago until the directory fits the budget,
+ * with an eighth of it to spare so that the next stores do not scan again.
+ *
+ * @return What the entries left weigh.
+ */
+static uint64_t disk_image_cache_trim(const DiskImageCache *cache)
+{
+    DiskImageEntry *entries = NULL;
+    size_t count = 0, capacity = 0;
+    uint64_t total = 0;
+
+#ifdef _WIN32
+    char pattern[DISK_IMAGE_CACHE_PATH_MAX + 16];
+    snprintf(pattern, sizeof(pattern), "%s\\*" DISK_IMAGE_SUFFIX, cache->dir);
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA(pattern, &found);
+    if (search == INVALID_HANDLE_VALUE)
+        return 0;
+    do
+    {
+        const uint64_t size = ((uint64_t)found.nFileSizeHigh << 32) | found.nFileSizeLow;
+        const int64_t mtime = ((int64_t)found.ftLastWriteTime.dwHighDateTime << 32) | found.ftLastWriteTime.dwLowDateTime;
+        if (disk_image_is_entry(found.cFileName) &&
+            disk_image_push_entry(&entries, &count, &capacity, found.cFileName, mtime, size))
+            total += size;
+    } while (FindNextFileA(search, &found));
+    FindClose(search);
+#else
+    DIR *dir = opendir(cache->dir);
+    if (!dir)
+        return 0;
+    char path[DISK_IMAGE_CACHE_PATH_MAX + 80];
+    for (struct dirent *item; (item = readdir(dir));)
+    {
+        if (!disk_image_is_entry(item->d_name))
+            continue;
+        struct stat info;
+        snprintf(path, sizeof(path), "%s/%s", cache->dir, item->d_name);
+        if (stat(path, &info) == 0 &&
+            disk_image_push_entry(&entries, &count, &capacity, item->d_name, (int64_t)info.st_mtime, (uint64_t)info.st_size))
+            total += (uint64_t)info.st_size;
+    }
+    closedir(dir);
+#endif
+
+    if (total > cache->budget)
+    {
+        const uint64_t target = cache->budget - cache->budget / 8;
+        qsort(entries, count, sizeof(DiskImageEntry), disk_image_compare_age);
+        char victim[DISK_IMAGE_CACHE_PATH_MAX + 80];
+        for (size_t i = 0; i < count && total > target; ++i)
+        {
+            snprintf(victim, sizeof(victim), "%s/%s", cache->dir, entries[i].name);
+            // Maps of it stay valid, another thread may be uploading from it.
+            if (remove(victim) == 0)
+                total -= entries[i].size;
+        }
+    }
+    free(entries);
+    return total;
+}
+
+void disk_image_cache_init(DiskImageCache *cache, const char *dir, size_t budget)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->budget = budget;
+
+    if (dir ? snprintf(cache->dir, sizeof(cache->dir), "%s", dir) >= (int)sizeof(cache->dir)
+            : !disk_image_default_dir(cache->dir, sizeof(cache->dir)))
+        return;
+    if (cache->dir[0] == '\0')
+        return;
+
+    if (!disk_image_make_dirs(cache->dir))
+    {
+        LOG_WARNING("Image cache disabled, could not create %s", cache->dir);
+        return;
+    }
+    cache->enabled = true;
+    atomic_store(&cache->bytes, disk_image_cache_trim(cache));
+    LOG_INFO("Image cache in %s", cache->dir);
+}
+
+void disk_image_cache_store(DiskImageCache *cache, const DiskImageKey *key, const DecodedImage *image)
+{
+    char path[DISK_IMAGE_CACHE_PATH_MAX + 32];
+    if (!cache->enabled || image->mapping || !disk_image_entry_path(cache, key, path, sizeof(path)))
+        return;
+
+    // As many levels as glGenerateMipmap makes, down to 1x1.
+    int levels = 1;
+    while ((image->width >> levels) > 0 || (image->height >> levels) > 0)
+        levels++;
+    const size_t data_size = disk_image_chain_size(image->width, image->height, image->channels, levels);
+    if (data_size > cache->budget)
+        return;
+
+    unsigned char *chain = malloc(data_size);
+    if (!chain)
+    {
+        LOG_ERROR("Failed to allocate memory for the mip chain of %s", key->path);
+        return;
+    }
+    const size_t base_size = disk_image_level_size(image->width, image->height, image->channels, 0);
+    memcpy(chain, image->pixels, base_size);
+    unsigned char *level_pixels = chain;
+    for (int level = 1; level < levels; ++level)
+    {
+        const int w = image->width >> (level - 1);
+        const int h = image->height >> (level - 1);
+        unsigned char *next = level_pixels + disk_image_level_size(image->width, image->height, image->channels, level - 1);
+        disk_image_halve(level_pixels, w > 0 ? w : 1, h > 0 ? h : 1, image->channels, next);
+        level_pixels = next;
+    }
+
+    const size_t path_length = strlen(key->path);
+    DiskImageHeader header = {
+        .magic = {DISK_IMAGE_MAGIC[0], DISK_IMAGE_MAGIC[1], DISK_IMAGE_MAGIC[2], DISK_IMAGE_MAGIC[3]},
+        .version = DISK_IMAGE_VERSION,
+        .mtime = key->mtime,
+        .size = key->size,
+        .key_width = key->width,
+        .key_height = key->height,
+        .width = image->width,
+        .height = image->height,
+        .channels = image->channels,
+        .levels = levels,
+        .path_length = (uint32_t)path_length,
+        // Pixels start on a page so that the upload reads whole pages of them.
+        .data_offset = (sizeof(DiskImageHeader) + path_length + 4095) & ~(uint64_t)4095,
+        .data_size = data_size};
+
+    // Written aside then renamed over the entry, a load never sees half a file.
+    char temp[DISK_IMAGE_CACHE_PATH_MAX + 64];
+#ifdef _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = (int)getpid();
+#endif
+    snprintf(temp, sizeof(temp), "%s.%d.%u.tmp", path, pid, atomic_fetch_add(&disk_image_temp_counter, 1));
+    FILE *file = fopen(temp, "wb");
+    if (!file)
+    {
+        free(chain);
+        return;
+    }
+
+    static const char padding[4096];
+    bool written = disk_image_write_all(file, &header, sizeof(header)) &&
+                   disk_image_write_all(file, key->path, path_length) &&
+                   disk_image_write_all(file, padding, header.data_offset - sizeof(header) - path_length) &&
+                   disk_image_write_all(file, chain, data_size);
+    written = fclose(file) == 0 && written;
+    free(chain);
+
+    // A new version of the source replaces its old entry, whose size no longer counts.
+    struct stat replaced;
+    const uint64_t replaced_size = stat(path, &replaced) == 0 ? (uint64_t)replaced.st_size : 0;
+#ifdef _WIN32
+    written = written && MoveFileExA(temp, path, MOVEFILE_REPLACE_EXISTING);
+#else
+    written = written && rename(temp, path) == 0;
+#endif
+    if (!written)
+    {
+        LOG_WARNING("Failed to write image cache entry for %s", key->path);
+        remove(temp);
+        return;
+    }
+
+    const uint64_t added = header.data_offset + data_size;
+    const uint64_t bytes = atomic_fetch_add(&cache->bytes, added - replaced_size) + added - replaced_size;
+    if (bytes <= cache->budget || atomic_exchange(&cache->trimming, true))
+        return;
+    // The scan also picks up what other processes sharing the directory wrote.
+    atomic_store(&cache->bytes, disk_image_cache_trim(cache));
+    atomic_store(&cache->trimming, false);
+}
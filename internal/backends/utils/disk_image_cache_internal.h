@@ -0,0 +1,102 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file disk_image_cache_internal.h
+ * @brief Decoded images kept on disk from one launch to the next.
+ *
+ * Each entry is one file holding a decoded image and its mip chain, ready to
+ * be uploaded as is: loading it maps the file instead of reading and decoding
+ * the source. Entries are keyed by the canonical path of the source and the
+ * size it was downscaled to, and remember the source's modification time and
+ * size: a source replaced on disk misses and its entry is written again.
+ *
+ * Every load touches its entry. Once the directory holds more than the budget,
+ * the entries touched longest ago are deleted: the directory is only scanned
+ * at init and when a store takes the running total past the budget. Safe from
+ * any thread.
+ */
+
+#ifndef DISK_IMAGE_CACHE_INTERNAL_H
+#define DISK_IMAGE_CACHE_INTERNAL_H
+
+#include "backends/utils/image_decoder_internal.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DISK_IMAGE_CACHE_PATH_MAX IMAGE_FILE_PATH_MAX
+
+/**
+ * @brief What identifies a cached image.
+ */
+typedef struct
+{
+    char path[DISK_IMAGE_CACHE_PATH_MAX]; /**< Canonical path of the source. */
+    int64_t mtime;
+    int64_t size;
+    int width, height; /**< Size the image was downscaled to, 0 for the full image. */
+} DiskImageKey;
+
+struct DiskImageCache
+{
+    char dir[DISK_IMAGE_CACHE_PATH_MAX];
+    size_t budget;
+    bool enabled;            /**< false when no directory could be set up, loads then miss and stores do nothing. */
+    _Atomic uint64_t bytes;  /**< What the entries weigh, counted by the last scan and kept up by stores since. */
+    atomic_bool trimming;    /**< A store is scanning the directory, others leave it the work. */
+};
+
+/**
+ * @brief Sets the cache up in @p dir, created when missing.
+ *
+ * @param dir Directory, NULL for the GOOEY_IMAGE_CACHE_DIR environment
+ *            variable or else the user's cache directory. An empty
+ *            string disables the cache.
+ * @param budget Bytes the directory may hold.
+ */
+void disk_image_cache_init(DiskImageCache *cache, const char *dir, size_t budget);
+
+/**
+ * @brief Resolves @p path and reads what identifies its content, for the full size image.
+ *
+ * @return false when the file does not exist.
+ */
+bool disk_image_cache_key(const char *path, DiskImageKey *key);
+
+/**
+ * @brief Maps the entry of @p key into @p image.
+ *
+ * The image's pixels are followed by its mip chain, see DecodedImage::levels,
+ * and stay mapped until decoded_image_free().
+ *
+ * @return false on a miss.
+ */
+bool disk_image_cache_load(DiskImageCache *cache, const DiskImageKey *key, DecodedImage *image);
+
+/**
+ * @brief Writes @p image and its mip chain as the entry of @p key, then trims the cache when it went over its budget.
+ */
+void disk_image_cache_store(DiskImageCache *cache, const DiskImageKey *key, const DecodedImage *image);
+
+/**
+ * @brief Unmaps the pixels of a loaded entry, called by decoded_image_free().
+ */
+void disk_image_cache_unmap(void *mapping, size_t size);
+
+#endif // DISK_IMAGE_CACHE_INTERNAL_H
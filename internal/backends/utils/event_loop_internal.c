@@ -0,0 +1,295 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include "backends/utils/event_loop_internal.h"
+#include "common/gooey_common.h"
+#include "logger/pico_logger_internal.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+uint64_t event_loop_now_ms(void)
+{
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+/**
+ * Interval between two checks for input the connection cannot announce:
+ * the poll interval without a connection, the cap with one.
+ */
+static int64_t event_loop_poll_interval(const EventLoop *loop)
+{
+    return loop->polls_input ? loop->poll_ms : EVENT_LOOP_MAX_WAIT_MS;
+}
+
+/**
+ * Longest the loop may sleep: until the deadline, but never past the next
+ * check for input.
+ */
+static int64_t event_loop_clamp_timeout(const EventLoop *loop, int64_t timeout_ms)
+{
+    const uint64_t now = event_loop_now_ms();
+    const int64_t cap = loop->next_poll_ms > now ? (int64_t)(loop->next_poll_ms - now) : 0;
+    if (timeout_ms < 0 || timeout_ms > cap)
+        return cap;
+    return timeout_ms;
+}
+
+/**
+ * Whether a check for input is due, schedules the next one. Each check that
+ * finds nothing doubles the poll interval, see event_loop_note_input().
+ */
+static bool event_loop_poll_due(EventLoop *loop)
+{
+    const uint64_t now = event_loop_now_ms();
+    if (now < loop->next_poll_ms)
+        return false;
+
+    loop->next_poll_ms = now + (uint64_t)event_loop_poll_interval(loop);
+    if (loop->polls_input && loop->poll_ms < EVENT_LOOP_IDLE_POLL_MS)
+    {
+        loop->poll_ms *= 2;
+        if (loop->poll_ms > EVENT_LOOP_IDLE_POLL_MS)
+            loop->poll_ms = EVENT_LOOP_IDLE_POLL_MS;
+    }
+    return true;
+}
+
+void event_loop_note_input(EventLoop *loop)
+{
+    if (!loop->polls_input || loop->poll_ms == EVENT_LOOP_INPUT_POLL_MS)
+        return;
+    loop->poll_ms = EVENT_LOOP_INPUT_POLL_MS;
+    loop->next_poll_ms = event_loop_now_ms() + EVENT_LOOP_INPUT_POLL_MS;
+}
+
+#ifdef _WIN32
+
+bool event_loop_init(EventLoop *loop)
+{
+    memset(loop, 0, sizeof(*loop));
+    loop->display_fd = -1;
+    loop->poll_ms = EVENT_LOOP_INPUT_POLL_MS;
+    loop->wake_event = CreateEventA(NULL, FALSE, FALSE, NULL);
+    atomic_init(&loop->wake_pending, false);
+    return loop->wake_event != NULL;
+}
+
+void event_loop_destroy(EventLoop *loop)
+{
+    if (loop->wake_event)
+        CloseHandle((HANDLE)loop->wake_event);
+    loop->wake_event = NULL;
+}
+
+void event_loop_attach_display(EventLoop *loop)
+{
+    // Window messages wake MsgWaitForMultipleObjects directly, there is no descriptor to find.
+    loop->display_fd = 0;
+}
+
+void event_loop_wake(EventLoop *loop)
+{
+    if (atomic_exchange(&loop->wake_pending, true))
+        return;
+    loop->stats.wakeups++;
+    if (loop->wake_event)
+        SetEvent((HANDLE)loop->wake_event);
+}
+
+bool event_loop_wait(EventLoop *loop, int64_t timeout_ms)
+{
+    if (atomic_exchange(&loop->wake_pending, false))
+        return event_loop_poll_due(loop);
+
+    loop->stats.waits++;
+    HANDLE handles[1] = {(HANDLE)loop->wake_event};
+    const DWORD count = loop->wake_event ? 1 : 0;
+    const DWORD result = MsgWaitForMultipleObjects(count, handles, FALSE,
+                                                   (DWORD)event_loop_clamp_timeout(loop, timeout_ms), QS_ALLINPUT);
+    atomic_store(&loop->wake_pending, false);
+
+    return event_loop_poll_due(loop) || result == WAIT_OBJECT_0 + count;
+}
+
+#else
+
+bool event_loop_init(EventLoop *loop)
+{
+    memset(loop, 0, sizeof(*loop));
+    loop->display_fd = -1;
+    loop->poll_ms = EVENT_LOOP_INPUT_POLL_MS;
+    atomic_init(&loop->wake_pending, false);
+    if (pipe2(loop->wake_fds, O_NONBLOCK | O_CLOEXEC) != 0)
+    {
+        LOG_ERROR("Failed to create the event loop wakeup pipe: %s", strerror(errno));
+        loop->wake_fds[0] = loop->wake_fds[1] = -1;
+        return false;
+    }
+    return true;
+}
+
+void event_loop_destroy(EventLoop *loop)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        if (loop->wake_fds[i] >= 0)
+            close(loop->wake_fds[i]);
+        loop->wake_fds[i] = -1;
+    }
+    loop->display_fd = -1;
+}
+
+/**
+ * Whether a unix socket address is the one of the X11 server or of the Wayland compositor.
+ */
+static bool event_loop_is_display_address(const struct sockaddr_un *address, socklen_t length)
+{
+    if (length <= (socklen_t)offsetof(struct sockaddr_un, sun_path) + 1)
+        return false;
+
+    // Abstract sockets start with a NUL, X11 listens on "@/tmp/.X11-unix/X0" next to the path one.
+    char path[sizeof(address->sun_path) + 1] = {0};
+    const size_t path_length = length - offsetof(struct sockaddr_un, sun_path);
+    memcpy(path, address->sun_path, path_length < sizeof(address->sun_path) ? path_length : sizeof(address->sun_path));
+    const char *name = path[0] ? path : path + 1;
+
+    if (strstr(name, "/.X11-unix/X"))
+        return true;
+
+    const char *wayland = getenv("WAYLAND_DISPLAY");
+    if (!wayland || !*wayland)
+        wayland = "wayland-0";
+    const char *base = strrchr(name, '/');
+    return strcmp(base ? base + 1 : name, wayland[0] == '/' ? strrchr(wayland, '/') + 1 : wayland) == 0;
+}
+
+void event_loop_attach_display(EventLoop *loop)
+{
+    loop->display_fd = -1;
+    loop->polls_input = false;
+
+    DIR *fds = opendir("/proc/self/fd");
+    if (!fds)
+        return;
+
+    const int own = dirfd(fds);
+    for (struct dirent *entry; (entry = readdir(fds));)
+    {
+        char *end;
+        const long fd = strtol(entry->d_name, &end, 10);
+        if (*end || end == entry->d_name || fd == own || fd == loop->wake_fds[0] || fd == loop->wake_fds[1])
+            continue;
+
+        struct stat info;
+        if (fstat((int)fd, &info) != 0 || !S_ISSOCK(info.st_mode))
+            continue;
+
+        struct sockaddr_un address;
+        socklen_t length = sizeof(address);
+        if (getpeername((int)fd, (struct sockaddr *)&address, &length) == 0 && address.sun_family == AF_UNIX &&
+            event_loop_is_display_address(&address, length))
+        {
+            loop->display_fd = (int)fd;
+            break;
+        }
+    }
+    closedir(fds);
+
+    if (loop->display_fd < 0)
+    {
+        LOG_WARNING("Display connection not found, polling input every %d to %d ms", EVENT_LOOP_INPUT_POLL_MS,
+                    EVENT_LOOP_IDLE_POLL_MS);
+        loop->polls_input = true;
+        loop->poll_ms = EVENT_LOOP_INPUT_POLL_MS;
+        loop->next_poll_ms = event_loop_now_ms() + EVENT_LOOP_INPUT_POLL_MS;
+    }
+}
+
+void event_loop_wake(EventLoop *loop)
+{
+    if (atomic_exchange(&loop->wake_pending, true))
+        return;
+    loop->stats.wakeups++;
+
+    // A full pipe already holds a wakeup, the failed write loses nothing.
+    const char byte = 1;
+    if (loop->wake_fds[1] >= 0 && write(loop->wake_fds[1], &byte, 1) < 0 && errno != EAGAIN)
+        LOG_ERROR("Failed to wake the event loop: %s", strerror(errno));
+}
+
+bool event_loop_wait(EventLoop *loop, int64_t timeout_ms)
+{
+    if (atomic_exchange(&loop->wake_pending, false))
+    {
+        char drain[64];
+        while (loop->wake_fds[0] >= 0 && read(loop->wake_fds[0], drain, sizeof(drain)) > 0)
+            ;
+        return event_loop_poll_due(loop);
+    }
+
+    struct pollfd fds[2];
+    nfds_t count = 0;
+    if (loop->wake_fds[0] >= 0)
+        fds[count++] = (struct pollfd){.fd = loop->wake_fds[0], .events = POLLIN};
+    if (loop->display_fd >= 0)
+        fds[count++] = (struct pollfd){.fd = loop->display_fd, .events = POLLIN};
+
+    loop->stats.waits++;
+    if (poll(fds, count, (int)event_loop_clamp_timeout(loop, timeout_ms)) < 0 && errno != EINTR)
+        LOG_ERROR("Event loop poll failed: %s", strerror(errno));
+
+    bool input = false;
+    for (nfds_t i = 0; i < count; ++i)
+    {
+        if (fds[i].fd == loop->wake_fds[0] && (fds[i].revents & POLLIN))
+        {
+            char drain[64];
+            while (read(loop->wake_fds[0], drain, sizeof(drain)) > 0)
+                ;
+        }
+        else if (fds[i].fd == loop->display_fd && fds[i].revents)
+        {
+            input = true;
+        }
+    }
+    atomic_store(&loop->wake_pending, false);
+
+    return event_loop_poll_due(loop) || input;
+}
+
+#endif
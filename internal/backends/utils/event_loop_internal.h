@@ -0,0 +1,99 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file event_loop_internal.h
+ * @brief Puts the main loop to sleep until there is something to do.
+ *
+ * The loop waits on three sources at once: input on the display server
+ * connection, the nearest timer deadline (passed as a timeout), and a
+ * wakeup any thread can post. On Windows the thread's message queue takes
+ * the place of the connection.
+ *
+ * GLPS does not hand out its connection, so on Linux it is found among the
+ * process's sockets by the address of the X11 or Wayland server. When it
+ * cannot be found, input is polled instead: every EVENT_LOOP_INPUT_POLL_MS
+ * while it keeps arriving, backing off to EVENT_LOOP_IDLE_POLL_MS once it
+ * stops. Either way no wait lasts longer than EVENT_LOOP_MAX_WAIT_MS:
+ * events a toolkit already read off the socket into its own queue do not
+ * make the connection readable again.
+ */
+
+#ifndef EVENT_LOOP_INTERNAL_H
+#define EVENT_LOOP_INTERNAL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    size_t waits;   /**< Times the loop went to sleep. */
+    size_t wakeups; /**< Wakeups posted from any thread. */
+} EventLoopStats;
+
+typedef struct
+{
+#ifdef _WIN32
+    void *wake_event; /**< Auto-reset event, a HANDLE. */
+#else
+    int wake_fds[2]; /**< Self-pipe, read end first, -1 when it could not be created. */
+#endif
+    int display_fd;   /**< Display server connection, -1 when unknown. */
+    bool polls_input; /**< A display is attached but its connection was not found. */
+    int poll_ms;      /**< Current input poll interval, grows while no input arrives. */
+    uint64_t next_poll_ms; /**< When a wait next reports that input may be waiting, see event_loop_wait(). */
+    atomic_bool wake_pending; /**< Coalesces wakeups posted before the loop drains the pipe. */
+    EventLoopStats stats;
+} EventLoop;
+
+bool event_loop_init(EventLoop *loop);
+void event_loop_destroy(EventLoop *loop);
+
+/**
+ * @brief Looks up the display server connection, call it once windows exist.
+ */
+void event_loop_attach_display(EventLoop *loop);
+
+/**
+ * @brief Makes a current or next event_loop_wait() return, safe from any thread.
+ */
+void event_loop_wake(EventLoop *loop);
+
+/**
+ * @brief Sleeps until input, a wakeup, or @p timeout_ms elapsed.
+ *
+ * @param timeout_ms Milliseconds until the nearest timer deadline, negative when no timer is armed.
+ * @return Whether input may be waiting: the connection is readable, or a
+ *         poll interval (EVENT_LOOP_MAX_WAIT_MS when the connection is
+ *         known) went by since the last time it said so. Otherwise the wait
+ *         ended on a wakeup or a timer deadline and no window got input.
+ */
+bool event_loop_wait(EventLoop *loop, int64_t timeout_ms);
+
+/**
+ * @brief Tells a polling loop that input arrived, it polls at its fastest again.
+ */
+void event_loop_note_input(EventLoop *loop);
+
+/**
+ * @brief Monotonic clock in milliseconds, the one timer deadlines are kept in.
+ */
+uint64_t event_loop_now_ms(void);
+
+#endif // EVENT_LOOP_INTERNAL_H
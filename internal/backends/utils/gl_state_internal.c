@@ -0,0 +1,389 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "gl_state_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+
+/** Object names are never this, it marks a binding nobody knows. */
+#define GL_STATE_UNKNOWN 0xFFFFFFFFu
+
+static _Thread_local GlState *current;
+static GlState *states;
+static pthread_mutex_t states_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void gl_state_init(GlState *state)
+{
+    memset(state, 0, sizeof(*state));
+    gl_state_invalidate(state);
+
+    pthread_mutex_lock(&states_lock);
+    state->next = states;
+    states = state;
+    pthread_mutex_unlock(&states_lock);
+}
+
+void gl_state_destroy(GlState *state)
+{
+    pthread_mutex_lock(&states_lock);
+    for (GlState **link = &states; *link; link = &(*link)->next)
+    {
+        if (*link == state)
+        {
+            *link = state->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&states_lock);
+
+    if (current == state)
+        current = NULL;
+    state->next = NULL;
+}
+
+void gl_state_invalidate(GlState *state)
+{
+    state->program = GL_STATE_UNKNOWN;
+    state->vertex_array = GL_STATE_UNKNOWN;
+    state->array_buffer = GL_STATE_UNKNOWN;
+    state->pixel_unpack_buffer = GL_STATE_UNKNOWN;
+    state->framebuffer = GL_STATE_UNKNOWN;
+    state->active_texture = GL_STATE_UNKNOWN;
+    for (int unit = 0; unit < GL_STATE_TEXTURE_UNITS; ++unit)
+        state->textures[unit][0] = state->textures[unit][1] = GL_STATE_UNKNOWN;
+    state->blend = -1;
+    state->scissor = -1;
+    state->blend_src = state->blend_dst = GL_STATE_UNKNOWN;
+    for (int i = 0; i < 4; ++i)
+    {
+        state->viewport[i] = -1;
+        state->scissor_box[i] = -1;
+        state->clear_color[i] = NAN;
+    }
+    state->unpack_alignment = -1;
+    state->unpack_row_length = -1;
+}
+
+bool gl_state_make_current(GlState *state)
+{
+    if (state && state == current)
+    {
+        state->stats.skipped++;
+        return true;
+    }
+
+    current = state;
+    if (state)
+        state->stats.issued++;
+    return false;
+}
+
+GlState *gl_state_current(void)
+{
+    return current;
+}
+
+void gl_state_count(size_t issued, size_t skipped)
+{
+    if (!current)
+        return;
+    current->stats.issued += issued;
+    current->stats.skipped += skipped;
+}
+
+/**
+ * Records @p value in @p slot, true when the call setting it has to be issued.
+ */
+static bool gl_state_update(GLuint *slot, GLuint value)
+{
+    if (!current)
+        return true;
+    if (*slot == value)
+    {
+        current->stats.skipped++;
+        return false;
+    }
+    *slot = value;
+    current->stats.issued++;
+    return true;
+}
+
+void gl_state_use_program(GLuint program)
+{
+    if (gl_state_update(current ? &current->program : NULL, program))
+        glUseProgram(program);
+}
+
+void gl_state_bind_vertex_array(GLuint vertex_array)
+{
+    if (gl_state_update(current ? &current->vertex_array : NULL, vertex_array))
+        glBindVertexArray(vertex_array);
+}
+
+void gl_state_bind_buffer(GLenum target, GLuint buffer)
+{
+    GLuint *slot = NULL;
+    if (current && target == GL_ARRAY_BUFFER)
+        slot = &current->array_buffer;
+    else if (current && target == GL_PIXEL_UNPACK_BUFFER)
+        slot = &current->pixel_unpack_buffer;
+
+    if (!slot)
+    {
+        gl_state_count(1, 0);
+        glBindBuffer(target, buffer);
+    }
+    else if (gl_state_update(slot, buffer))
+    {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void gl_state_bind_framebuffer(GLuint framebuffer)
+{
+    if (gl_state_update(current ? &current->framebuffer : NULL, framebuffer))
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+GLuint gl_state_framebuffer(void)
+{
+    if (current && current->framebuffer != GL_STATE_UNKNOWN)
+        return current->framebuffer;
+
+    GLint framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    if (current)
+        current->framebuffer = (GLuint)framebuffer;
+    return (GLuint)framebuffer;
+}
+
+void gl_state_active_texture(GLenum unit)
+{
+    if (gl_state_update(current ? &current->active_texture : NULL, unit))
+        glActiveTexture(unit);
+}
+
+void gl_state_bind_texture(GLenum target, GLuint texture)
+{
+    GLuint *slot = NULL;
+    if (current && current->active_texture != GL_STATE_UNKNOWN)
+    {
+        const GLenum unit = current->active_texture - GL_TEXTURE0;
+        if (unit < GL_STATE_TEXTURE_UNITS && target == GL_TEXTURE_2D)
+            slot = &current->textures[unit][0];
+        else if (unit < GL_STATE_TEXTURE_UNITS && target == GL_TEXTURE_2D_ARRAY)
+            slot = &current->textures[unit][1];
+    }
+
+    if (!slot)
+    {
+        gl_state_count(1, 0);
+        glBindTexture(target, texture);
+    }
+    else if (gl_state_update(slot, texture))
+    {
+        glBindTexture(target, texture);
+    }
+}
+
+void gl_state_enable(GLenum capability, bool enabled)
+{
+    int *slot = NULL;
+    if (current && capability == GL_BLEND)
+        slot = &current->blend;
+    else if (current && capability == GL_SCISSOR_TEST)
+        slot = &current->scissor;
+
+    if (slot && *slot == (int)enabled)
+    {
+        current->stats.skipped++;
+        return;
+    }
+    if (slot)
+        *slot = enabled;
+    gl_state_count(1, 0);
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void gl_state_blend_func(GLenum src, GLenum dst)
+{
+    if (current && current->blend_src == src && current->blend_dst == dst)
+    {
+        current->stats.skipped++;
+        return;
+    }
+    if (current)
+    {
+        current->blend_src = src;
+        current->blend_dst = dst;
+    }
+    gl_state_count(1, 0);
+    glBlendFunc(src, dst);
+}
+
+static bool gl_state_update_box(GLint *box, GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (!current)
+        return true;
+    if (box[0] == x && box[1] == y && box[2] == width && box[3] == height)
+    {
+        current->stats.skipped++;
+        return false;
+    }
+    box[0] = x;
+    box[1] = y;
+    box[2] = width;
+    box[3] = height;
+    current->stats.issued++;
+    return true;
+}
+
+void gl_state_viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (gl_state_update_box(current ? current->viewport : NULL, x, y, width, height))
+        glViewport(x, y, width, height);
+}
+
+void gl_state_scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (gl_state_update_box(current ? current->scissor_box : NULL, x, y, width, height))
+        glScissor(x, y, width, height);
+}
+
+void gl_state_clear_color(float r, float g, float b, float a)
+{
+    if (current)
+    {
+        float *color = current->clear_color;
+        // Unknown components are NaN and never compare equal.
+        if (color[0] == r && color[1] == g && color[2] == b && color[3] == a)
+        {
+            current->stats.skipped++;
+            return;
+        }
+        color[0] = r;
+        color[1] = g;
+        color[2] = b;
+        color[3] = a;
+    }
+    gl_state_count(1, 0);
+    glClearColor(r, g, b, a);
+}
+
+void gl_state_pixel_store(GLenum parameter, GLint value)
+{
+    GLint *slot = NULL;
+    if (current && parameter == GL_UNPACK_ALIGNMENT)
+        slot = &current->unpack_alignment;
+    else if (current && parameter == GL_UNPACK_ROW_LENGTH)
+        slot = &current->unpack_row_length;
+
+    if (slot && *slot == value)
+    {
+        current->stats.skipped++;
+        return;
+    }
+    if (slot)
+        *slot = value;
+    gl_state_count(1, 0);
+    glPixelStorei(parameter, value);
+}
+
+/**
+ * Forgets @p name wherever @p slot_of finds it bound, in every context: a
+ * name deleted in one is free for the next object created in any.
+ */
+static void gl_state_forget(GLsizei count, const GLuint *names, GLuint *(*slot_of)(GlState *, int index))
+{
+    pthread_mutex_lock(&states_lock);
+    for (GlState *state = states; state; state = state->next)
+    {
+        GLuint *slot;
+        for (int index = 0; (slot = slot_of(state, index)); ++index)
+        {
+            for (GLsizei i = 0; i < count; ++i)
+            {
+                if (names[i] != 0 && *slot == names[i])
+                    *slot = GL_STATE_UNKNOWN;
+            }
+        }
+    }
+    pthread_mutex_unlock(&states_lock);
+}
+
+static GLuint *gl_state_texture_slot(GlState *state, int index)
+{
+    return index < GL_STATE_TEXTURE_UNITS * 2 ? &state->textures[index / 2][index % 2] : NULL;
+}
+
+static GLuint *gl_state_buffer_slot(GlState *state, int index)
+{
+    return index == 0 ? &state->array_buffer : index == 1 ? &state->pixel_unpack_buffer : NULL;
+}
+
+static GLuint *gl_state_vertex_array_slot(GlState *state, int index)
+{
+    return index == 0 ? &state->vertex_array : NULL;
+}
+
+static GLuint *gl_state_framebuffer_slot(GlState *state, int index)
+{
+    return index == 0 ? &state->framebuffer : NULL;
+}
+
+static GLuint *gl_state_program_slot(GlState *state, int index)
+{
+    return index == 0 ? &state->program : NULL;
+}
+
+void gl_state_delete_textures(GLsizei count, const GLuint *textures)
+{
+    gl_state_forget(count, textures, gl_state_texture_slot);
+    glDeleteTextures(count, textures);
+}
+
+void gl_state_delete_buffers(GLsizei count, const GLuint *buffers)
+{
+    gl_state_forget(count, buffers, gl_state_buffer_slot);
+    glDeleteBuffers(count, buffers);
+}
+
+void gl_state_delete_vertex_arrays(GLsizei count, const GLuint *vertex_arrays)
+{
+    gl_state_forget(count, vertex_arrays, gl_state_vertex_array_slot);
+    glDeleteVertexArrays(count, vertex_arrays);
+}
+
+void gl_state_delete_framebuffers(GLsizei count, const GLuint *framebuffers)
+{
+    gl_state_forget(count, framebuffers, gl_state_framebuffer_slot);
+    glDeleteFramebuffers(count, framebuffers);
+}
+
+void gl_state_delete_program(GLuint program)
+{
+    // A program in use stays installed after its deletion, until another one is.
+    gl_state_forget(1, &program, gl_state_program_slot);
+    glDeleteProgram(program);
+}
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file gl_state_internal.h
+ * @brief Shadow of the GL state, to skip calls that would change nothing.
+ *
+ * Every context has a GlState holding what was last set in it: the program,
+ * vertex array, buffer, framebuffer and texture bindings, blending, scissor,
+ * viewport, clear color and pixel store parameters. The gl_state_* calls
+ * stand in for their GL counterparts and act on the state made current with
+ * gl_state_make_current(), which, like GL's own, is per thread. Values start
+ * out unknown, so the first call always reaches the driver.
+ *
+ * State changed behind the tracker's back would make it skip calls that are
+ * needed: every bind in the backend goes through here, and objects are
+ * deleted with gl_state_delete_*, which forget them in every context.
+ */
+
+#ifndef GL_STATE_INTERNAL_H
+#define GL_STATE_INTERNAL_H
+
+#include "backends/utils/backend_utils_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Texture units whose bindings are tracked, binds to higher units are always issued. */
+#define GL_STATE_TEXTURE_UNITS 4
+
+/**
+ * @brief Calls that reached the driver and calls dropped, since the state was initialized.
+ */
+typedef struct
+{
+    size_t issued;
+    size_t skipped;
+} GlStateStats;
+
+typedef struct GlState GlState;
+
+struct GlState
+{
+    GLuint program;
+    GLuint vertex_array;
+    GLuint array_buffer;
+    GLuint pixel_unpack_buffer;
+    GLuint framebuffer;
+    GLenum active_texture;
+    GLuint textures[GL_STATE_TEXTURE_UNITS][2]; /**< GL_TEXTURE_2D and GL_TEXTURE_2D_ARRAY per unit. */
+    int blend;   /**< -1 while unknown. */
+    int scissor; /**< -1 while unknown. */
+    GLenum blend_src, blend_dst;
+    GLint viewport[4];
+    GLint scissor_box[4];
+    float clear_color[4]; /**< NaN while unknown. */
+    GLint unpack_alignment;
+    GLint unpack_row_length;
+    GlStateStats stats;
+    GlState *next; /**< Every state initialized, for deletions to reach. */
+};
+
+/**
+ * @brief Starts tracking a context, with every value unknown.
+ */
+void gl_state_init(GlState *state);
+
+/**
+ * @brief Stops tracking a context, it may no longer be current.
+ */
+void gl_state_destroy(GlState *state);
+
+/**
+ * @brief Forgets every value, after the context was changed by code that does not go through the tracker.
+ */
+void gl_state_invalidate(GlState *state);
+
+/**
+ * @brief Makes @p state the one the calling thread's gl_state_* calls act on.
+ *
+ * @return false when it was not current yet and the context itself has to be made current.
+ */
+bool gl_state_make_current(GlState *state);
+
+/**
+ * @brief The calling thread's current state, NULL when none is.
+ */
+GlState *gl_state_current(void);
+
+/**
+ * @brief Counts calls the caller issued or dropped itself, like uniforms it caches.
+ */
+void gl_state_count(size_t issued, size_t skipped);
+
+void gl_state_use_program(GLuint program);
+void gl_state_bind_vertex_array(GLuint vertex_array);
+void gl_state_bind_buffer(GLenum target, GLuint buffer);
+void gl_state_bind_framebuffer(GLuint framebuffer);
+void gl_state_active_texture(GLenum unit);
+void gl_state_bind_texture(GLenum target, GLuint texture);
+void gl_state_enable(GLenum capability, bool enabled);
+void gl_state_blend_func(GLenum src, GLenum dst);
+void gl_state_viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void gl_state_scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void gl_state_clear_color(float r, float g, float b, float a);
+void gl_state_pixel_store(GLenum parameter, GLint value);
+
+/**
+ * @brief The framebuffer bound in the current context, queried when it is not known.
+ */
+GLuint gl_state_framebuffer(void);
+
+void gl_state_delete_textures(GLsizei count, const GLuint *textures);
+void gl_state_delete_buffers(GLsizei count, const GLuint *buffers);
+void gl_state_delete_vertex_arrays(GLsizei count, const GLuint *vertex_arrays);
+void gl_state_delete_framebuffers(GLsizei count, const GLuint *framebuffers);
+void gl_state_delete_program(GLuint program);
+
+#endif
+#endif // GL_STATE_INTERNAL_H
@@ -0,0 +1,309 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "glyph_atlas_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/gl_state_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <string.h>
+
+#define GLYPH_ATLAS_INITIAL_SLOTS 256
+
+static size_t glyph_atlas_hash(uint32_t codepoint, size_t capacity)
+{
+    return (size_t)(codepoint * 2654435761u) & (capacity - 1);
+}
+
+static AtlasGlyph *glyph_atlas_find_slot(AtlasGlyph *slots, size_t capacity, uint32_t codepoint)
+{
+    size_t index = glyph_atlas_hash(codepoint, capacity);
+    while (slots[index].used && slots[index].codepoint != codepoint)
+        index = (index + 1) & (capacity - 1);
+    return &slots[index];
+}
+
+static bool glyph_atlas_rehash(GlyphAtlas *atlas, size_t capacity)
+{
+    AtlasGlyph *slots = calloc(capacity, sizeof(AtlasGlyph));
+    if (!slots)
+    {
+        LOG_ERROR("Failed to grow glyph cache to %zu slots", capacity);
+        return false;
+    }
+
+    for (size_t i = 0; i < atlas->slot_capacity; ++i)
+    {
+        if (atlas->slots[i].used)
+            *glyph_atlas_find_slot(slots, capacity, atlas->slots[i].codepoint) = atlas->slots[i];
+    }
+
+    free(atlas->slots);
+    atlas->slots = slots;
+    atlas->slot_capacity = capacity;
+    return true;
+}
+
+bool glyph_atlas_init(GlyphAtlas *atlas, GlyphAtlasMode mode, FT_Face face, int pixel_height, int max_pages)
+{
+    memset(atlas, 0, sizeof(*atlas));
+#if !GLYPH_ATLAS_HAS_SDF
+    if (mode == GLYPH_ATLAS_SDF)
+    {
+        LOG_ERROR("FreeType %d.%d cannot render signed distance fields", FREETYPE_MAJOR, FREETYPE_MINOR);
+        return false;
+    }
+#endif
+    atlas->mode = mode;
+    atlas->face = face;
+    atlas->pixel_height = pixel_height;
+    atlas->max_pages = max_pages > 0 ? max_pages : 1;
+
+    atlas->pages = calloc(atlas->max_pages, sizeof(GlyphAtlasPage));
+    atlas->slots = calloc(GLYPH_ATLAS_INITIAL_SLOTS, sizeof(AtlasGlyph));
+    if (!atlas->pages || !atlas->slots)
+    {
+        LOG_ERROR("Failed to allocate glyph cache");
+        glyph_atlas_destroy(atlas);
+        return false;
+    }
+    atlas->slot_capacity = GLYPH_ATLAS_INITIAL_SLOTS;
+
+    for (int i = 0; i < atlas->max_pages; ++i)
+    {
+        atlas->pages[i].pen_x = GLYPH_ATLAS_PADDING;
+        atlas->pages[i].pen_y = GLYPH_ATLAS_PADDING;
+    }
+
+    // Pages are sampled as layers of one texture, so a single binding serves every glyph.
+    glGenTextures(1, &atlas->texture);
+    gl_state_bind_texture(GL_TEXTURE_2D_ARRAY, atlas->texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE, atlas->max_pages, 0,
+                 GL_RED, GL_UNSIGNED_BYTE, NULL);
+
+    return true;
+}
+
+void glyph_atlas_destroy(GlyphAtlas *atlas)
+{
+    if (atlas->texture != 0)
+        gl_state_delete_textures(1, &atlas->texture);
+    free(atlas->pages);
+    free(atlas->slots);
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+void glyph_atlas_begin_frame(GlyphAtlas *atlas)
+{
+    atlas->frame++;
+    atlas->keep_since = atlas->frame;
+}
+
+static void glyph_atlas_clear_page(GlyphAtlas *atlas, int page)
+{
+    unsigned char *zeros = calloc(GLYPH_ATLAS_SIZE * GLYPH_ATLAS_SIZE, 1);
+    if (!zeros)
+        return;
+
+    gl_state_bind_texture(GL_TEXTURE_2D_ARRAY, atlas->texture);
+    gl_state_pixel_store(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, page, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE, 1,
+                    GL_RED, GL_UNSIGNED_BYTE, zeros);
+    free(zeros);
+}
+
+static void glyph_atlas_evict_page(GlyphAtlas *atlas, int page)
+{
+    for (size_t i = 0; i < atlas->slot_capacity; ++i)
+    {
+        if (atlas->slots[i].used && atlas->slots[i].page == page)
+        {
+            atlas->slots[i].used = false;
+            atlas->glyph_count--;
+            atlas->stats.evictions++;
+        }
+    }
+    // Linear probing cannot leave holes in a probe chain, rebuild the table around the freed slots.
+    glyph_atlas_rehash(atlas, atlas->slot_capacity);
+
+    GlyphAtlasPage *p = &atlas->pages[page];
+    p->pen_x = GLYPH_ATLAS_PADDING;
+    p->pen_y = GLYPH_ATLAS_PADDING;
+    p->row_height = 0;
+    p->glyph_count = 0;
+    glyph_atlas_clear_page(atlas, page);
+}
+
+static bool glyph_atlas_page_place(GlyphAtlasPage *page, int width, int height, int *x, int *y)
+{
+    int pen_x = page->pen_x;
+    int pen_y = page->pen_y;
+    int row_height = page->row_height;
+
+    if (pen_x + width + GLYPH_ATLAS_PADDING > GLYPH_ATLAS_SIZE)
+    {
+        pen_x = GLYPH_ATLAS_PADDING;
+        pen_y += row_height + GLYPH_ATLAS_PADDING;
+        row_height = 0;
+    }
+    if (pen_y + height + GLYPH_ATLAS_PADDING > GLYPH_ATLAS_SIZE)
+        return false;
+
+    *x = pen_x;
+    *y = pen_y;
+    page->pen_x = pen_x + width + GLYPH_ATLAS_PADDING;
+    page->pen_y = pen_y;
+    page->row_height = height > row_height ? height : row_height;
+    page->glyph_count++;
+    return true;
+}
+
+static int glyph_atlas_allocate(GlyphAtlas *atlas, int width, int height, int *x, int *y)
+{
+    for (int i = 0; i < atlas->page_count; ++i)
+    {
+        if (glyph_atlas_page_place(&atlas->pages[i], width, height, x, y))
+            return i;
+    }
+
+    if (atlas->page_count < atlas->max_pages)
+    {
+        // Layers start undefined, clear them so padding really is empty.
+        int page = atlas->page_count++;
+        glyph_atlas_clear_page(atlas, page);
+        return glyph_atlas_page_place(&atlas->pages[page], width, height, x, y) ? page : -1;
+    }
+
+    int victim = -1;
+    for (int i = 0; i < atlas->page_count; ++i)
+    {
+        // Glyphs of pages used by a frame in progress may already sit in a batch, they must not move.
+        if (atlas->pages[i].last_used >= atlas->keep_since)
+            continue;
+        if (victim < 0 || atlas->pages[i].last_used < atlas->pages[victim].last_used)
+            victim = i;
+    }
+    if (victim < 0)
+        return -1;
+
+    glyph_atlas_evict_page(atlas, victim);
+    return glyph_atlas_page_place(&atlas->pages[victim], width, height, x, y) ? victim : -1;
+}
+
+static bool glyph_atlas_rasterize(GlyphAtlas *atlas, uint32_t codepoint)
+{
+#if GLYPH_ATLAS_HAS_SDF
+    if (atlas->mode == GLYPH_ATLAS_SDF)
+    {
+        // Hinting snaps outlines to the raster grid, which is meaningless once the field gets scaled.
+        return FT_Load_Char(atlas->face, codepoint, FT_LOAD_DEFAULT | FT_LOAD_NO_HINTING) == 0 &&
+               FT_Render_Glyph(atlas->face->glyph, FT_RENDER_MODE_SDF) == 0;
+    }
+#endif
+    return FT_Load_Char(atlas->face, codepoint, FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL) == 0;
+}
+
+bool glyph_atlas_contains(GlyphAtlas *atlas, uint32_t codepoint)
+{
+    return atlas->slots && glyph_atlas_find_slot(atlas->slots, atlas->slot_capacity, codepoint)->used;
+}
+
+const AtlasGlyph *glyph_atlas_lookup(GlyphAtlas *atlas, uint32_t codepoint)
+{
+    if (!atlas->slots)
+        return NULL;
+
+    AtlasGlyph *slot = glyph_atlas_find_slot(atlas->slots, atlas->slot_capacity, codepoint);
+    if (slot->used)
+    {
+        atlas->stats.hits++;
+        if (slot->page >= 0)
+            atlas->pages[slot->page].last_used = atlas->frame;
+        return slot;
+    }
+
+    atlas->stats.misses++;
+    if (!atlas->face)
+        return NULL;
+
+    FT_Set_Pixel_Sizes(atlas->face, 0, atlas->pixel_height);
+    if (!glyph_atlas_rasterize(atlas, codepoint))
+    {
+        LOG_ERROR("Failed to load glyph U+%04X", codepoint);
+        return NULL;
+    }
+
+    const FT_GlyphSlot ft_glyph = atlas->face->glyph;
+    const FT_Bitmap *bmp = &ft_glyph->bitmap;
+    const int width = (int)bmp->width;
+    const int height = (int)bmp->rows;
+    if (width + 2 * GLYPH_ATLAS_PADDING > GLYPH_ATLAS_SIZE || height + 2 * GLYPH_ATLAS_PADDING > GLYPH_ATLAS_SIZE)
+    {
+        LOG_ERROR("Glyph U+%04X does not fit an atlas page", codepoint);
+        return NULL;
+    }
+
+    // Blank glyphs such as spaces only carry metrics, they take no room in any page.
+    int x = 0, y = 0;
+    int page = -1;
+    if (width > 0 && height > 0)
+    {
+        page = glyph_atlas_allocate(atlas, width, height, &x, &y);
+        if (page < 0)
+        {
+            LOG_ERROR("Glyph cache is full for this frame, dropping U+%04X", codepoint);
+            return NULL;
+        }
+
+        gl_state_bind_texture(GL_TEXTURE_2D_ARRAY, atlas->texture);
+        gl_state_pixel_store(GL_UNPACK_ALIGNMENT, 1);
+        gl_state_pixel_store(GL_UNPACK_ROW_LENGTH, bmp->pitch);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, page, width, height, 1,
+                        GL_RED, GL_UNSIGNED_BYTE, bmp->buffer);
+        gl_state_pixel_store(GL_UNPACK_ROW_LENGTH, 0);
+        atlas->pages[page].last_used = atlas->frame;
+    }
+
+    if ((atlas->glyph_count + 1) * 2 > atlas->slot_capacity)
+    {
+        if (!glyph_atlas_rehash(atlas, atlas->slot_capacity * 2))
+            return NULL;
+    }
+    // Eviction and growth rebuild the table, so the slot is looked up again.
+    slot = glyph_atlas_find_slot(atlas->slots, atlas->slot_capacity, codepoint);
+
+    slot->codepoint = codepoint;
+    slot->used = true;
+    slot->width = width;
+    slot->height = height;
+    slot->bearingX = ft_glyph->bitmap_left;
+    slot->bearingY = ft_glyph->bitmap_top;
+    slot->advance = (int)(ft_glyph->advance.x >> 6);
+    slot->page = page;
+    slot->uv[0] = (float)x / GLYPH_ATLAS_SIZE;
+    slot->uv[1] = (float)y / GLYPH_ATLAS_SIZE;
+    slot->uv[2] = (float)(x + width) / GLYPH_ATLAS_SIZE;
+    slot->uv[3] = (float)(y + height) / GLYPH_ATLAS_SIZE;
+    atlas->glyph_count++;
+
+    return slot;
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file glyph_atlas_internal.h
+ * @brief On-demand glyph cache backed by a paged single-channel texture array.
+ *
+ * Glyphs are rasterized through FreeType the first time a code point is
+ * looked up and packed left to right on shelves into one layer (page) of
+ * the atlas. When every page is full, the least recently used page not
+ * touched since keep_since is cleared and its glyphs evicted.
+ *
+ * In GLYPH_ATLAS_SDF mode pages hold signed distance fields instead of
+ * coverage, so a single rasterization stays sharp at any scale.
+ */
+
+#ifndef GLYPH_ATLAS_INTERNAL_H
+#define GLYPH_ATLAS_INTERNAL_H
+
+#include "backends/utils/backend_utils_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/utf8_internal.h"
+#include <stdint.h>
+
+/** Width and height of an atlas page, in texels. */
+#define GLYPH_ATLAS_SIZE 512
+
+/** Empty texels kept around every glyph so linear filtering never bleeds into a neighbour. */
+#define GLYPH_ATLAS_PADDING 1
+
+/** Code point drawn for malformed UTF-8. */
+#define GLYPH_ATLAS_REPLACEMENT_CHAR UTF8_REPLACEMENT_CHAR
+
+/** FT_RENDER_MODE_SDF appeared in FreeType 2.11. */
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 11)
+#define GLYPH_ATLAS_HAS_SDF 1
+#else
+#define GLYPH_ATLAS_HAS_SDF 0
+#endif
+
+typedef enum
+{
+    GLYPH_ATLAS_BITMAP, /**< Anti-aliased coverage, meant to be drawn near its raster size. */
+    GLYPH_ATLAS_SDF     /**< Signed distance, 0.5 on the outline and larger inside. */
+} GlyphAtlasMode;
+
+typedef struct
+{
+    uint32_t codepoint;
+    bool used;     /**< Slot holds a glyph. */
+    int width, height;
+    int bearingX, bearingY;
+    int advance;
+    int page;      /**< Atlas layer the bitmap lives in, -1 for blank glyphs. */
+    float uv[4];   /**< u0, v0 (top left), u1, v1 (bottom right). */
+} AtlasGlyph;
+
+typedef struct
+{
+    int pen_x, pen_y, row_height;
+    uint64_t last_used; /**< Frame the page was last sampled in. */
+    size_t glyph_count;
+} GlyphAtlasPage;
+
+typedef struct
+{
+    size_t hits;
+    size_t misses;
+    size_t evictions; /**< Glyphs dropped to make room, not pages. */
+} GlyphAtlasStats;
+
+typedef struct
+{
+    GLuint texture; /**< GL_TEXTURE_2D_ARRAY with max_pages layers. */
+    GlyphAtlasMode mode;
+    FT_Face face;
+    int pixel_height; /**< Size the glyphs are rasterized at. */
+    GlyphAtlasPage *pages;
+    int page_count; /**< Pages holding at least one glyph since creation. */
+    int max_pages;
+    AtlasGlyph *slots; /**< Open-addressing table keyed by code point. */
+    size_t slot_capacity;
+    size_t glyph_count;
+    uint64_t frame;
+    uint64_t keep_since; /**< Pages used in this frame or a later one may be sampled by a batch not drawn yet. */
+    GlyphAtlasStats stats;
+} GlyphAtlas;
+
+/**
+ * @brief Allocates the atlas texture, a GL context must be current.
+ *
+ * @param face Face glyphs are rasterized from, owned by the caller.
+ * @param max_pages Page budget, each page costs GLYPH_ATLAS_SIZE^2 bytes of VRAM.
+ * @return false on allocation failure, or for GLYPH_ATLAS_SDF when FreeType lacks SDF rendering.
+ */
+bool glyph_atlas_init(GlyphAtlas *atlas, GlyphAtlasMode mode, FT_Face face, int pixel_height, int max_pages);
+
+static inline size_t glyph_atlas_bytes(const GlyphAtlas *atlas)
+{
+    return atlas->texture ? (size_t)atlas->max_pages * GLYPH_ATLAS_SIZE * GLYPH_ATLAS_SIZE : 0;
+}
+void glyph_atlas_destroy(GlyphAtlas *atlas);
+
+/**
+ * @brief Marks the start of a frame, pages used from now on are kept until the next one.
+ *
+ * A caller drawing several frames at once moves keep_since back to the
+ * oldest of them afterwards.
+ */
+void glyph_atlas_begin_frame(GlyphAtlas *atlas);
+
+/**
+ * @brief Keeps @p page resident this frame, for glyph quads drawn without a lookup.
+ */
+static inline void glyph_atlas_touch_page(GlyphAtlas *atlas, int page)
+{
+    if (page >= 0 && page < atlas->page_count)
+        atlas->pages[page].last_used = atlas->frame;
+}
+
+/**
+ * @brief Returns the cached glyph for @p codepoint, rasterizing it on a miss.
+ *
+ * The pointer stays valid until the next lookup.
+ *
+ * @return The glyph, or NULL if it could not be rasterized or placed.
+ */
+const AtlasGlyph *glyph_atlas_lookup(GlyphAtlas *atlas, uint32_t codepoint);
+
+/**
+ * @brief Whether @p codepoint is cached, without rasterizing or uploading anything.
+ */
+bool glyph_atlas_contains(GlyphAtlas *atlas, uint32_t codepoint);
+
+/**
+ * @brief Decodes one UTF-8 sequence and advances @p text past it, see utf8_decode().
+ */
+static inline uint32_t glyph_atlas_decode_utf8(const char **text, size_t remaining)
+{
+    return utf8_decode(text, remaining);
+}
+
+#endif
+#endif // GLYPH_ATLAS_INTERNAL_H
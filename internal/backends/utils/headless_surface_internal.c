@@ -0,0 +1,394 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include "backends/utils/headless_surface_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/gl_state_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <string.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<EGL/egl.h>)
+#define HEADLESS_SURFACE_EGL 1
+#endif
+#endif
+
+#ifdef HEADLESS_SURFACE_EGL
+#include <EGL/egl.h>
+#include <dlfcn.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#ifndef EGL_CONTEXT_MAJOR_VERSION
+#define EGL_CONTEXT_MAJOR_VERSION 0x3098
+#define EGL_CONTEXT_MINOR_VERSION 0x30FB
+#define EGL_CONTEXT_OPENGL_PROFILE_MASK 0x30FD
+#define EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT 0x00000001
+#endif
+#ifndef EGL_OPENGL_ES3_BIT
+#define EGL_OPENGL_ES3_BIT 0x00000040
+#endif
+
+typedef EGLDisplay (*GetDisplayProc)(EGLNativeDisplayType display_id);
+typedef EGLDisplay (*GetPlatformDisplayProc)(EGLenum platform, void *native_display, const EGLint *attrib_list);
+typedef EGLBoolean (*InitializeProc)(EGLDisplay dpy, EGLint *major, EGLint *minor);
+typedef EGLBoolean (*TerminateProc)(EGLDisplay dpy);
+typedef const char *(*QueryStringProc)(EGLDisplay dpy, EGLint name);
+typedef EGLBoolean (*BindApiProc)(EGLenum api);
+typedef EGLBoolean (*ChooseConfigProc)(EGLDisplay dpy, const EGLint *attrib_list, EGLConfig *configs,
+                                       EGLint config_size, EGLint *num_config);
+typedef EGLContext (*CreateContextProc)(EGLDisplay dpy, EGLConfig config, EGLContext share_context,
+                                        const EGLint *attrib_list);
+typedef EGLBoolean (*DestroyContextProc)(EGLDisplay dpy, EGLContext ctx);
+typedef EGLSurface (*CreatePbufferSurfaceProc)(EGLDisplay dpy, EGLConfig config, const EGLint *attrib_list);
+typedef EGLBoolean (*DestroySurfaceProc)(EGLDisplay dpy, EGLSurface surface);
+typedef EGLBoolean (*MakeCurrentProc)(EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx);
+typedef void *(*GetProcAddressProc)(const char *procname);
+
+static struct
+{
+    TerminateProc terminate;
+    DestroyContextProc destroy_context;
+    DestroySurfaceProc destroy_surface;
+    MakeCurrentProc make_current;
+    GetProcAddressProc get_proc_address;
+    void *gl_library;
+} egl;
+
+static bool headless_surface_has_extension(const char *extensions, const char *name)
+{
+    const size_t length = strlen(name);
+    for (const char *p = extensions; p && (p = strstr(p, name)); p += length)
+    {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * GL entry points: exported by the GL library for the core ones, from EGL for the rest.
+ */
+static void *headless_surface_proc_address(const char *name)
+{
+    void *proc = egl.gl_library ? dlsym(egl.gl_library, name) : NULL;
+    return proc ? proc : egl.get_proc_address(name);
+}
+
+/**
+ * The display with no window system behind it when Mesa has one, the default display otherwise.
+ */
+static EGLDisplay headless_surface_open_display(void *library, QueryStringProc query_string)
+{
+    const char *client_extensions = query_string(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    GetPlatformDisplayProc get_platform_display = (GetPlatformDisplayProc)dlsym(library, "eglGetPlatformDisplay");
+    if (!get_platform_display)
+        get_platform_display = (GetPlatformDisplayProc)egl.get_proc_address("eglGetPlatformDisplayEXT");
+    if (get_platform_display && headless_surface_has_extension(client_extensions, "EGL_MESA_platform_surfaceless"))
+    {
+        EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (display != EGL_NO_DISPLAY)
+            return display;
+    }
+
+    GetDisplayProc get_display = (GetDisplayProc)dlsym(library, "eglGetDisplay");
+    return get_display ? get_display(EGL_DEFAULT_DISPLAY) : EGL_NO_DISPLAY;
+}
+
+bool headless_surface_init(HeadlessSurface *surface)
+{
+    memset(surface, 0, sizeof(*surface));
+    surface->egl_library = dlopen("libEGL.so.1", RTLD_NOW | RTLD_GLOBAL);
+    if (!surface->egl_library)
+    {
+        LOG_ERROR("Headless rendering needs libEGL: %s", dlerror());
+        return false;
+    }
+
+    void *library = surface->egl_library;
+    InitializeProc initialize = (InitializeProc)dlsym(library, "eglInitialize");
+    QueryStringProc query_string = (QueryStringProc)dlsym(library, "eglQueryString");
+    BindApiProc bind_api = (BindApiProc)dlsym(library, "eglBindAPI");
+    ChooseConfigProc choose_config = (ChooseConfigProc)dlsym(library, "eglChooseConfig");
+    CreateContextProc create_context = (CreateContextProc)dlsym(library, "eglCreateContext");
+    CreatePbufferSurfaceProc create_pbuffer = (CreatePbufferSurfaceProc)dlsym(library, "eglCreatePbufferSurface");
+    egl.terminate = (TerminateProc)dlsym(library, "eglTerminate");
+    egl.destroy_context = (DestroyContextProc)dlsym(library, "eglDestroyContext");
+    egl.destroy_surface = (DestroySurfaceProc)dlsym(library, "eglDestroySurface");
+    egl.make_current = (MakeCurrentProc)dlsym(library, "eglMakeCurrent");
+    egl.get_proc_address = (GetProcAddressProc)dlsym(library, "eglGetProcAddress");
+    if (!initialize || !query_string || !bind_api || !choose_config || !create_context || !create_pbuffer ||
+        !egl.terminate || !egl.destroy_context || !egl.destroy_surface || !egl.make_current || !egl.get_proc_address)
+    {
+        LOG_ERROR("libEGL lacks EGL 1.4 entry points");
+        headless_surface_destroy(surface);
+        return false;
+    }
+
+    EGLDisplay display = headless_surface_open_display(library, query_string);
+    if (display == EGL_NO_DISPLAY || !initialize(display, NULL, NULL))
+    {
+        LOG_ERROR("Failed to open an EGL display");
+        headless_surface_destroy(surface);
+        return false;
+    }
+    surface->display = display;
+
+#if GLES_ON
+    const EGLint renderable = EGL_OPENGL_ES3_BIT;
+    const EGLint context_attributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_NONE};
+    const EGLenum api = EGL_OPENGL_ES_API;
+    const char *gl_names[] = {"libGLESv2.so.2", NULL};
+#else
+    const EGLint renderable = EGL_OPENGL_BIT;
+    const EGLint context_attributes[] = {EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 0,
+                                         EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                         EGL_NONE};
+    const EGLenum api = EGL_OPENGL_API;
+    const char *gl_names[] = {"libOpenGL.so.0", "libGL.so.1", NULL};
+#endif
+
+    // Windows are framebuffers of their own, the config only has to be renderable.
+    const EGLint config_attributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                        EGL_RENDERABLE_TYPE, renderable,
+                                        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+                                        EGL_NONE};
+    EGLConfig config;
+    EGLint config_count = 0;
+    if (!bind_api(api) || !choose_config(display, config_attributes, &config, 1, &config_count) || config_count < 1)
+    {
+        LOG_ERROR("No EGL config can render offscreen");
+        headless_surface_destroy(surface);
+        return false;
+    }
+
+    surface->context = create_context(display, config, EGL_NO_CONTEXT, context_attributes);
+    if (surface->context == EGL_NO_CONTEXT)
+    {
+        surface->context = NULL;
+        LOG_ERROR("Failed to create an EGL context");
+        headless_surface_destroy(surface);
+        return false;
+    }
+
+    EGLSurface draw = EGL_NO_SURFACE;
+    if (!headless_surface_has_extension(query_string(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        const EGLint pbuffer_attributes[] = {EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE};
+        draw = create_pbuffer(display, config, pbuffer_attributes);
+        if (draw == EGL_NO_SURFACE)
+        {
+            LOG_ERROR("Failed to create an EGL pbuffer");
+            headless_surface_destroy(surface);
+            return false;
+        }
+        surface->pbuffer = draw;
+    }
+    if (!egl.make_current(display, draw, draw, surface->context))
+    {
+        LOG_ERROR("Failed to make the EGL context current");
+        headless_surface_destroy(surface);
+        return false;
+    }
+
+    for (size_t i = 0; gl_names[i] && !surface->gl_library; ++i)
+        surface->gl_library = dlopen(gl_names[i], RTLD_NOW | RTLD_GLOBAL);
+    egl.gl_library = surface->gl_library;
+#if !GLES_ON
+    if (!gladLoadGLLoader((GLADloadproc)headless_surface_proc_address))
+    {
+        LOG_ERROR("Failed to load the GL entry points");
+        headless_surface_destroy(surface);
+        return false;
+    }
+#endif
+
+    LOG_INFO("Rendering headless with %s", (const char *)glGetString(GL_RENDERER));
+    return true;
+}
+
+void headless_surface_destroy(HeadlessSurface *surface)
+{
+    if (surface->display)
+    {
+        for (size_t i = 0; i < surface->target_count; ++i)
+            headless_surface_destroy_target(surface, i);
+        egl.make_current(surface->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (surface->pbuffer)
+            egl.destroy_surface(surface->display, surface->pbuffer);
+        if (surface->context)
+            egl.destroy_context(surface->display, surface->context);
+        egl.terminate(surface->display);
+    }
+    if (surface->gl_library)
+        dlclose(surface->gl_library);
+    if (surface->egl_library)
+        dlclose(surface->egl_library);
+    memset(surface, 0, sizeof(*surface));
+    memset(&egl, 0, sizeof(egl));
+}
+
+#else
+
+bool headless_surface_init(HeadlessSurface *surface)
+{
+    memset(surface, 0, sizeof(*surface));
+    LOG_ERROR("Headless rendering needs EGL, which this build has no headers for");
+    return false;
+}
+
+void headless_surface_destroy(HeadlessSurface *surface)
+{
+    memset(surface, 0, sizeof(*surface));
+}
+
+#endif
+
+static HeadlessTarget *headless_surface_target(HeadlessSurface *surface, size_t window_id)
+{
+    if (window_id >= surface->target_count || surface->targets[window_id].framebuffer == 0)
+        return NULL;
+    return &surface->targets[window_id];
+}
+
+int headless_surface_create_target(HeadlessSurface *surface, int width, int height)
+{
+    if (surface->target_count >= MAX_WINDOWS)
+    {
+        LOG_ERROR("Cannot create more than %d windows", MAX_WINDOWS);
+        return -1;
+    }
+
+    HeadlessTarget *target = &surface->targets[surface->target_count];
+    memset(target, 0, sizeof(*target));
+    target->width = width > 0 ? width : 1;
+    target->height = height > 0 ? height : 1;
+
+    glGenRenderbuffers(1, &target->color);
+    glBindRenderbuffer(GL_RENDERBUFFER, target->color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, target->width, target->height);
+    glGenRenderbuffers(1, &target->depth_stencil);
+    glBindRenderbuffer(GL_RENDERBUFFER, target->depth_stencil);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, target->width, target->height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &target->framebuffer);
+    gl_state_bind_framebuffer(target->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target->color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target->depth_stencil);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_ERROR("Headless window framebuffer is incomplete");
+        gl_state_bind_framebuffer(0);
+        gl_state_delete_framebuffers(1, &target->framebuffer);
+        glDeleteRenderbuffers(1, &target->color);
+        glDeleteRenderbuffers(1, &target->depth_stencil);
+        memset(target, 0, sizeof(*target));
+        return -1;
+    }
+
+    gl_state_viewport(0, 0, target->width, target->height);
+    gl_state_clear_color(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    return (int)surface->target_count++;
+}
+
+void headless_surface_destroy_target(HeadlessSurface *surface, size_t window_id)
+{
+    HeadlessTarget *target = headless_surface_target(surface, window_id);
+    if (!target)
+        return;
+
+    gl_state_bind_framebuffer(0);
+    gl_state_delete_framebuffers(1, &target->framebuffer);
+    glDeleteRenderbuffers(1, &target->color);
+    glDeleteRenderbuffers(1, &target->depth_stencil);
+    memset(target, 0, sizeof(*target));
+}
+
+void headless_surface_bind(HeadlessSurface *surface, size_t window_id)
+{
+    HeadlessTarget *target = headless_surface_target(surface, window_id);
+    if (target)
+        gl_state_bind_framebuffer(target->framebuffer);
+}
+
+void headless_surface_size(const HeadlessSurface *surface, size_t window_id, int *width, int *height)
+{
+    const bool exists = window_id < surface->target_count && surface->targets[window_id].framebuffer != 0;
+    *width = exists ? surface->targets[window_id].width : 0;
+    *height = exists ? surface->targets[window_id].height : 0;
+}
+
+void headless_surface_present(HeadlessSurface *surface, size_t window_id)
+{
+    HeadlessTarget *target = headless_surface_target(surface, window_id);
+    if (!target)
+        return;
+
+    // Nothing is shown, the frame only has to start executing like a swap would.
+    glFlush();
+    target->frames++;
+}
+
+double headless_surface_frame_rate(HeadlessSurface *surface, size_t window_id, int64_t now_ms)
+{
+    HeadlessTarget *target = headless_surface_target(surface, window_id);
+    if (!target)
+        return 0.0;
+
+    if (target->measured_at_ms != 0 && now_ms > target->measured_at_ms)
+        target->frame_rate = (double)target->frames * 1000.0 / (double)(now_ms - target->measured_at_ms);
+    target->frames = 0;
+    target->measured_at_ms = now_ms;
+    return target->frame_rate;
+}
+
+bool headless_surface_read_pixels(HeadlessSurface *surface, size_t window_id, unsigned char *rgba, int width,
+                                  int height)
+{
+    HeadlessTarget *target = headless_surface_target(surface, window_id);
+    if (!target || !rgba || width <= 0 || height <= 0)
+        return false;
+
+    const int read_width = width < target->width ? width : target->width;
+    const int read_height = height < target->height ? height : target->height;
+    gl_state_bind_framebuffer(target->framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ROW_LENGTH, width);
+    // GL rows go up from the bottom: the top of the window is read, then flipped.
+    glReadPixels(0, target->height - read_height, read_width, read_height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+    const size_t stride = (size_t)width * 4;
+    for (int top = 0, bottom = read_height - 1; top < bottom; ++top, --bottom)
+    {
+        unsigned char *a = rgba + (size_t)top * stride;
+        unsigned char *b = rgba + (size_t)bottom * stride;
+        for (size_t i = 0; i < (size_t)read_width * 4; ++i)
+        {
+            const unsigned char swap = a[i];
+            a[i] = b[i];
+            b[i] = swap;
+        }
+    }
+    return true;
+}
+
+#endif
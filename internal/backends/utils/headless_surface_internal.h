@@ -0,0 +1,113 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file headless_surface_internal.h
+ * @brief Offscreen windows for running without a display.
+ *
+ * One EGL context, surfaceless when the driver allows it and on a tiny
+ * pbuffer otherwise, renders every window into a framebuffer of its own.
+ * With Mesa's llvmpipe this needs neither a display server nor a GPU, which
+ * is what benchmarks and CI run on. EGL and GL are loaded at runtime, a
+ * build without them only fails once headless rendering is asked for.
+ *
+ * Everything here belongs to the thread the context was made current on.
+ */
+
+#ifndef HEADLESS_SURFACE_INTERNAL_H
+#define HEADLESS_SURFACE_INTERNAL_H
+
+#include "backends/utils/backend_utils_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief What a window renders into.
+ */
+typedef struct
+{
+    GLuint framebuffer; /**< 0 when the window does not exist. */
+    GLuint color;
+    GLuint depth_stencil;
+    int width, height;
+    uint64_t frames;        /**< Presented since the frame rate was last measured. */
+    int64_t measured_at_ms; /**< When the frame rate was last measured. */
+    double frame_rate;
+} HeadlessTarget;
+
+typedef struct
+{
+    void *egl_library;
+    void *gl_library;
+    void *display; /**< EGLDisplay, NULL until initialized. */
+    void *context;
+    void *pbuffer; /**< Only when the context cannot be current without a surface. */
+    HeadlessTarget targets[MAX_WINDOWS];
+    size_t target_count; /**< Windows created so far, ids are never reused. */
+} HeadlessSurface;
+
+/**
+ * @brief Loads EGL, creates the context and makes it current, then loads the GL entry points.
+ *
+ * @return false when no context could be created, @p surface then holds nothing.
+ */
+bool headless_surface_init(HeadlessSurface *surface);
+
+void headless_surface_destroy(HeadlessSurface *surface);
+
+/**
+ * @brief Creates a window @p width x @p height pixels.
+ *
+ * @return Its id, -1 when MAX_WINDOWS exist or the framebuffer is incomplete.
+ */
+int headless_surface_create_target(HeadlessSurface *surface, int width, int height);
+
+void headless_surface_destroy_target(HeadlessSurface *surface, size_t window_id);
+
+/**
+ * @brief Directs rendering to the window's framebuffer.
+ */
+void headless_surface_bind(HeadlessSurface *surface, size_t window_id);
+
+/**
+ * @brief Size of the window, 0 x 0 when it does not exist.
+ */
+void headless_surface_size(const HeadlessSurface *surface, size_t window_id, int *width, int *height);
+
+/**
+ * @brief Ends the window's frame: submits its commands and counts it.
+ */
+void headless_surface_present(HeadlessSurface *surface, size_t window_id);
+
+/**
+ * @brief Frames presented per second, over the time since the previous call.
+ */
+double headless_surface_frame_rate(HeadlessSurface *surface, size_t window_id, int64_t now_ms);
+
+/**
+ * @brief Copies the window's pixels into @p rgba, @p width x @p height tightly packed rows from the top.
+ *
+ * Waits for rendering to finish. The requested size is clipped to the window's.
+ *
+ * @return false when the window does not exist.
+ */
+bool headless_surface_read_pixels(HeadlessSurface *surface, size_t window_id, unsigned char *rgba, int width,
+                                  int height);
+
+#endif
+#endif // HEADLESS_SURFACE_INTERNAL_H
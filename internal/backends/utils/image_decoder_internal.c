@@ -0,0 +1,445 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/image_decoder_internal.h"
+#include "backends/utils/disk_image_cache_internal.h"
+#include "backends/utils/image_resample_internal.h"
+#include "backends/utils/svg_cache_internal.h"
+#include "backends/utils/stb_image/stb_image.h"
+#include "logger/pico_logger_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+bool image_file_identity(const char *path, char *canonical, int64_t *mtime, int64_t *size)
+{
+#ifdef _WIN32
+    if (!_fullpath(canonical, path, IMAGE_FILE_PATH_MAX))
+        return false;
+#else
+    if (!realpath(path, canonical))
+        return false;
+#endif
+
+    struct stat info;
+    if (stat(canonical, &info) != 0)
+        return false;
+    *mtime = (int64_t)info.st_mtime;
+    *size = (int64_t)info.st_size;
+    return true;
+}
+
+static bool image_decoder_has_extension(const char *path, const char *extension)
+{
+    const char *ext = path ? strrchr(path, '.') : NULL;
+    return ext && strcasecmp(ext + 1, extension) == 0;
+}
+
+bool image_is_vector(const char *path)
+{
+    return image_decoder_has_extension(path, "svg");
+}
+
+bool image_decode_file(const char *path, DecodedImage *image)
+{
+    memset(image, 0, sizeof(*image));
+
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        LOG_ERROR("Image file not found or inaccessible: %s", path);
+        return false;
+    }
+    fclose(file);
+
+    bool decoded = false;
+    if (image_decoder_has_extension(path, "png") || image_decoder_has_extension(path, "jpg") ||
+        image_decoder_has_extension(path, "jpeg"))
+    {
+        // The thread local flag, workers decode concurrently with the render thread.
+        stbi_set_flip_vertically_on_load_thread(1);
+        image->pixels = stbi_load(path, &image->width, &image->height, &image->channels, 0);
+        image->stb_owned = true;
+        decoded = image->pixels != NULL;
+    }
+    else if (image_decoder_has_extension(path, "svg"))
+    {
+        decoded = svg_cache_rasterize(NULL, path, 0, 0, image);
+    }
+    else
+    {
+        LOG_ERROR("Unsupported image format: %s", path);
+    }
+
+    if (!decoded || image->width <= 0 || image->height <= 0 || image->channels < 1 || image->channels > 4)
+    {
+        LOG_ERROR("Failed to load image data: %s (%dx%d, %d channels)", path, image->width, image->height,
+                  image->channels);
+        decoded_image_free(image);
+        return false;
+    }
+    return true;
+}
+
+bool image_decode_memory(const unsigned char *data, size_t size, DecodedImage *image)
+{
+    memset(image, 0, sizeof(*image));
+    stbi_set_flip_vertically_on_load_thread(1);
+    image->pixels = stbi_load_from_memory(data, (int)size, &image->width, &image->height, &image->channels, 0);
+    image->stb_owned = true;
+    if (!image->pixels || image->channels < 1 || image->channels > 4)
+    {
+        decoded_image_free(image);
+        return false;
+    }
+    return true;
+}
+
+void decoded_image_free(DecodedImage *image)
+{
+    if (image->mapping)
+    {
+        disk_image_cache_unmap(image->mapping, image->mapping_size);
+        image->mapping = NULL;
+        image->mapping_size = 0;
+    }
+    else if (image->pixels)
+    {
+        if (image->stb_owned)
+            stbi_image_free(image->pixels);
+        else
+            free(image->pixels);
+    }
+    image->pixels = NULL;
+    image->levels = 0;
+}
+
+#ifdef _WIN32
+#define DECODER_LOCK(decoder) AcquireSRWLockExclusive(&(decoder)->lock)
+#define DECODER_UNLOCK(decoder) ReleaseSRWLockExclusive(&(decoder)->lock)
+#define DECODER_WAIT(decoder) SleepConditionVariableSRW(&(decoder)->wake, &(decoder)->lock, INFINITE, 0)
+#define DECODER_SIGNAL(decoder) WakeConditionVariable(&(decoder)->wake)
+#define DECODER_BROADCAST(decoder) WakeAllConditionVariable(&(decoder)->wake)
+#else
+#define DECODER_LOCK(decoder) pthread_mutex_lock(&(decoder)->lock)
+#define DECODER_UNLOCK(decoder) pthread_mutex_unlock(&(decoder)->lock)
+#define DECODER_WAIT(decoder) pthread_cond_wait(&(decoder)->wake, &(decoder)->lock)
+#define DECODER_SIGNAL(decoder) pthread_cond_signal(&(decoder)->wake)
+#define DECODER_BROADCAST(decoder) pthread_cond_broadcast(&(decoder)->wake)
+#endif
+
+static void image_decoder_append(ImageDecodeJob **head, ImageDecodeJob **tail, ImageDecodeJob *job)
+{
+    job->next = NULL;
+    if (*tail)
+        (*tail)->next = job;
+    else
+        *head = job;
+    *tail = job;
+}
+
+/**
+ * Unlinks the job with @p id from a list, @p tail may be NULL for lists that do not keep one.
+ */
+static ImageDecodeJob *image_decoder_unlink(ImageDecodeJob **head, ImageDecodeJob **tail, unsigned int id)
+{
+    ImageDecodeJob *previous = NULL;
+    for (ImageDecodeJob *job = *head; job; previous = job, job = job->next)
+    {
+        if (job->id != id)
+            continue;
+        if (previous)
+            previous->next = job->next;
+        else
+            *head = job->next;
+        if (tail && *tail == job)
+            *tail = previous;
+        job->next = NULL;
+        return job;
+    }
+    return NULL;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI image_decoder_worker(LPVOID data)
+#else
+static void *image_decoder_worker(void *data)
+#endif
+{
+    ImageDecoder *decoder = data;
+
+    DECODER_LOCK(decoder);
+    for (;;)
+    {
+        while (!decoder->queued && !decoder->stopping)
+            DECODER_WAIT(decoder);
+        if (decoder->stopping)
+            break;
+
+        ImageDecodeJob *job = decoder->queued;
+        decoder->queued = job->next;
+        if (!decoder->queued)
+            decoder->queued_tail = NULL;
+        job->next = decoder->running;
+        decoder->running = job;
+        DECODER_UNLOCK(decoder);
+
+        job->decoded = image_decoder_load(decoder, job->path, job->width, job->height, job->disk_cache, &job->image,
+                                           &job->downscaled);
+
+        DECODER_LOCK(decoder);
+        image_decoder_unlink(&decoder->running, NULL, job->id);
+        if (job->cancelled)
+        {
+            image_decoder_job_free(job);
+            continue;
+        }
+        image_decoder_append(&decoder->done, &decoder->done_tail, job);
+        if (decoder->notify)
+            decoder->notify(decoder->notify_data);
+    }
+    DECODER_UNLOCK(decoder);
+    return 0;
+}
+
+bool image_decoder_load(const ImageDecoder *decoder, const char *path, int width, int height, bool disk_cache,
+                        DecodedImage *image, bool *downscaled)
+{
+    const bool sized = width > 0 && height > 0;
+    DiskImageKey key;
+    const bool cached =
+        disk_cache && decoder->disk_cache && decoder->disk_cache->enabled && disk_image_cache_key(path, &key);
+    bool loaded = false;
+    if (cached && sized)
+    {
+        key.width = width;
+        key.height = height;
+        *downscaled = true;
+        if (disk_image_cache_load(decoder->disk_cache, &key, image))
+            return true;
+    }
+    // A full size raster would be scaled on the GPU, vector images are rasterized again instead.
+    if (cached && !(sized && image_is_vector(path)))
+    {
+        key.width = key.height = 0;
+        loaded = disk_image_cache_load(decoder->disk_cache, &key, image);
+    }
+
+    if (image_is_vector(path) && !loaded)
+    {
+        // Rasterized at the requested size, never scaled from another raster.
+        if (!svg_cache_rasterize(decoder->svg_cache, path, width, height, image))
+            return false;
+        *downscaled = sized;
+    }
+    else
+    {
+        if (!loaded && !image_decode_file(path, image))
+            return false;
+        *downscaled = image_downscale(image, width, height, decoder->downscale_min_ratio);
+    }
+
+    // The full image is only written once, a downscaled copy once per size.
+    if (cached && (*downscaled || !loaded))
+    {
+        key.width = *downscaled ? width : 0;
+        key.height = *downscaled ? height : 0;
+        disk_image_cache_store(decoder->disk_cache, &key, image);
+    }
+    return true;
+}
+
+void image_decoder_init(ImageDecoder *decoder, int max_workers, void (*notify)(void *data), void *notify_data)
+{
+    memset(decoder, 0, sizeof(*decoder));
+#ifdef _WIN32
+    InitializeSRWLock(&decoder->lock);
+    InitializeConditionVariable(&decoder->wake);
+#else
+    pthread_mutex_init(&decoder->lock, NULL);
+    pthread_cond_init(&decoder->wake, NULL);
+#endif
+    decoder->max_workers = max_workers < 1 ? 1 : max_workers > IMAGE_DECODER_MAX_WORKERS ? IMAGE_DECODER_MAX_WORKERS : max_workers;
+    decoder->downscale_min_ratio = 4;
+    decoder->next_id = 1;
+    decoder->notify = notify;
+    decoder->notify_data = notify_data;
+}
+
+static void image_decoder_free_list(ImageDecodeJob *job)
+{
+    while (job)
+    {
+        ImageDecodeJob *next = job->next;
+        image_decoder_job_free(job);
+        job = next;
+    }
+}
+
+void image_decoder_destroy(ImageDecoder *decoder)
+{
+    DECODER_LOCK(decoder);
+    decoder->stopping = true;
+    DECODER_BROADCAST(decoder);
+    DECODER_UNLOCK(decoder);
+
+    // Workers finish the file they are on first, it ends up in done and is freed with the rest below.
+    for (int i = 0; i < decoder->worker_count; ++i)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(decoder->threads[i], INFINITE);
+        CloseHandle(decoder->threads[i]);
+#else
+        pthread_join(decoder->threads[i], NULL);
+#endif
+    }
+
+    image_decoder_free_list(decoder->queued);
+    image_decoder_free_list(decoder->running);
+    image_decoder_free_list(decoder->done);
+#ifndef _WIN32
+    pthread_mutex_destroy(&decoder->lock);
+    pthread_cond_destroy(&decoder->wake);
+#endif
+    decoder->queued = decoder->queued_tail = NULL;
+    decoder->running = NULL;
+    decoder->done = decoder->done_tail = NULL;
+    decoder->worker_count = 0;
+}
+
+/**
+ * Starts one more worker while there are fewer than queued jobs, called with the lock held.
+ */
+static void image_decoder_spawn(ImageDecoder *decoder)
+{
+    if (decoder->worker_count >= decoder->max_workers)
+        return;
+
+    size_t waiting = 0;
+    for (ImageDecodeJob *job = decoder->queued; job; job = job->next)
+        waiting++;
+    if (waiting <= (size_t)decoder->worker_count)
+        return;
+
+#ifdef _WIN32
+    HANDLE thread = CreateThread(NULL, 0, image_decoder_worker, decoder, 0, NULL);
+    if (!thread)
+#else
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, image_decoder_worker, decoder) != 0)
+#endif
+    {
+        LOG_ERROR("Failed to start an image decoding thread");
+        return;
+    }
+    decoder->threads[decoder->worker_count++] = thread;
+}
+
+unsigned int image_decoder_submit(ImageDecoder *decoder, const char *path, int window_id, int width, int height,
+                                  bool disk_cache, void (*callback)(unsigned int texture_id, void *user_data),
+                                  void *user_data)
+{
+    ImageDecodeJob *job = calloc(1, sizeof(ImageDecodeJob));
+    if (!job || !(job->path = strdup(path)))
+    {
+        LOG_ERROR("Failed to queue image for decoding: %s", path);
+        free(job);
+        return 0;
+    }
+    job->window_id = window_id;
+    job->width = width;
+    job->height = height;
+    job->disk_cache = disk_cache;
+    job->callback = callback;
+    job->user_data = user_data;
+
+    DECODER_LOCK(decoder);
+    job->id = decoder->next_id++;
+    if (decoder->next_id == 0)
+        decoder->next_id = 1;
+    image_decoder_append(&decoder->queued, &decoder->queued_tail, job);
+    image_decoder_spawn(decoder);
+    const bool has_worker = decoder->worker_count > 0;
+    if (!has_worker)
+        image_decoder_unlink(&decoder->queued, &decoder->queued_tail, job->id);
+    DECODER_SIGNAL(decoder);
+    DECODER_UNLOCK(decoder);
+
+    if (!has_worker)
+    {
+        image_decoder_job_free(job);
+        return 0;
+    }
+    return job->id;
+}
+
+void image_decoder_cancel(ImageDecoder *decoder, unsigned int id)
+{
+    if (id == 0)
+        return;
+
+    DECODER_LOCK(decoder);
+    ImageDecodeJob *job = image_decoder_unlink(&decoder->queued, &decoder->queued_tail, id);
+    if (!job)
+        job = image_decoder_unlink(&decoder->done, &decoder->done_tail, id);
+    if (!job)
+    {
+        for (ImageDecodeJob *running = decoder->running; running; running = running->next)
+        {
+            if (running->id == id)
+                running->cancelled = true;
+        }
+    }
+    DECODER_UNLOCK(decoder);
+
+    if (job)
+        image_decoder_job_free(job);
+}
+
+ImageDecodeJob *image_decoder_take(ImageDecoder *decoder)
+{
+    DECODER_LOCK(decoder);
+    ImageDecodeJob *job = decoder->done;
+    if (job)
+    {
+        decoder->done = job->next;
+        if (!decoder->done)
+            decoder->done_tail = NULL;
+        job->next = NULL;
+    }
+    DECODER_UNLOCK(decoder);
+    return job;
+}
+
+bool image_decoder_has_results(ImageDecoder *decoder)
+{
+    DECODER_LOCK(decoder);
+    const bool has_results = decoder->done != NULL;
+    DECODER_UNLOCK(decoder);
+    return has_results;
+}
+
+void image_decoder_job_free(ImageDecodeJob *job)
+{
+    if (!job)
+        return;
+    decoded_image_free(&job->image);
+    free(job->path);
+    free(job);
+}
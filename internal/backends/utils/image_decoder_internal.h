@@ -0,0 +1,179 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file image_decoder_internal.h
+ * @brief Image file decoding, inline or on a pool of worker threads.
+ *
+ * Workers only read and decode: the pixels they produce wait in a completion
+ * queue until the render thread takes them and uploads them, a few per pass
+ * of the main loop. Each finished job calls a notify function so the loop
+ * can be woken up to do so.
+ *
+ * The workers start with the first submitted job, applications without
+ * images never spawn them.
+ */
+
+#ifndef IMAGE_DECODER_INTERNAL_H
+#define IMAGE_DECODER_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define IMAGE_DECODER_MAX_WORKERS 8
+
+/** Room image_file_identity() needs for a canonical path. */
+#define IMAGE_FILE_PATH_MAX 4096
+
+typedef struct DiskImageCache DiskImageCache;
+typedef struct SvgCache SvgCache;
+
+/**
+ * @brief Pixels of a decoded image, rows bottom-up as GL textures want them.
+ */
+typedef struct
+{
+    unsigned char *pixels;
+    int width, height;
+    int channels;   /**< 1 to 4. */
+    int levels;     /**< Mip levels packed from pixels on, each half the size of the previous one. 0 or 1 for none. */
+    bool stb_owned; /**< Freed with stbi_image_free() rather than free(). */
+    void *mapping;  /**< Disk cache file the pixels are mapped from, NULL when allocated. */
+    size_t mapping_size;
+} DecodedImage;
+
+/**
+ * @brief Resolves @p path into @p canonical, IMAGE_FILE_PATH_MAX bytes, and reads the file's modification time and size.
+ *
+ * @return false when the file does not exist.
+ */
+bool image_file_identity(const char *path, char *canonical, int64_t *mtime, int64_t *size);
+
+/**
+ * @brief Whether @p path is a vector image, rasterized for the size it is shown at rather than decoded.
+ */
+bool image_is_vector(const char *path);
+
+/**
+ * @brief Decodes a PNG, JPEG or SVG file, safe from any thread. SVGs keep their intrinsic size.
+ */
+bool image_decode_file(const char *path, DecodedImage *image);
+
+/**
+ * @brief Decodes an encoded image held in memory, safe from any thread.
+ */
+bool image_decode_memory(const unsigned char *data, size_t size, DecodedImage *image);
+
+void decoded_image_free(DecodedImage *image);
+
+typedef struct ImageDecodeJob ImageDecodeJob;
+
+struct ImageDecodeJob
+{
+    ImageDecodeJob *next;
+    unsigned int id;
+    char *path;
+    DecodedImage image;
+    int width, height; /**< Size to downscale to when the image is much larger, or rasterize a vector image at; 0 to keep it whole. */
+    bool decoded;      /**< false when reading or decoding failed. */
+    bool downscaled;   /**< The image was made for width x height rather than kept whole. */
+    bool cancelled;    /**< Set while a worker holds the job, it is dropped when done. */
+    bool disk_cache;   /**< Looked up in and written to the disk cache. */
+    int window_id;     /**< Window whose context uploads the texture. */
+    void (*callback)(unsigned int texture_id, void *user_data);
+    void *user_data;
+};
+
+typedef struct
+{
+#ifdef _WIN32
+    HANDLE threads[IMAGE_DECODER_MAX_WORKERS];
+    SRWLOCK lock;
+    CONDITION_VARIABLE wake;
+#else
+    pthread_t threads[IMAGE_DECODER_MAX_WORKERS];
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+#endif
+    int worker_count;   /**< Workers running, 0 until the first job. */
+    int max_workers;
+    int downscale_min_ratio;   /**< See image_downscale(). */
+    DiskImageCache *disk_cache; /**< Where decoded files are kept across launches, NULL for nowhere. */
+    SvgCache *svg_cache;        /**< Parsed vector images, NULL to parse them on every load. */
+    bool stopping;
+    unsigned int next_id;
+    ImageDecodeJob *queued, *queued_tail; /**< Waiting for a worker, oldest first. */
+    ImageDecodeJob *running;              /**< Held by a worker. */
+    ImageDecodeJob *done, *done_tail;     /**< Decoded, waiting for the render thread. */
+    void (*notify)(void *data);           /**< Called from a worker when a job lands in done. */
+    void *notify_data;
+} ImageDecoder;
+
+void image_decoder_init(ImageDecoder *decoder, int max_workers, void (*notify)(void *data), void *notify_data);
+
+/**
+ * @brief Loads @p path as the workers do, safe from any thread.
+ *
+ * Takes the image from the disk cache when it holds it, or else decodes
+ * it, downscales it to @p width x @p height when it is much larger and
+ * stores the result in the disk cache. Vector images are rasterized at
+ * @p width x @p height instead, whatever their intrinsic size.
+ *
+ * @param disk_cache false to leave the disk cache alone, for files that are
+ *                   cheap to decode and many, such as image viewer tiles.
+ * @param downscaled Set to whether the image was made for the requested size rather than kept whole.
+ */
+bool image_decoder_load(const ImageDecoder *decoder, const char *path, int width, int height, bool disk_cache,
+                        DecodedImage *image, bool *downscaled);
+
+/**
+ * @brief Stops the workers and frees every job, callbacks are not called.
+ */
+void image_decoder_destroy(ImageDecoder *decoder);
+
+/**
+ * @brief Queues @p path for decoding, and downscaling to @p width x @p height when it is much larger.
+ *
+ * @param disk_cache See image_decoder_load().
+ * @return Request id for image_decoder_cancel(), 0 when the job could not be queued.
+ */
+unsigned int image_decoder_submit(ImageDecoder *decoder, const char *path, int window_id, int width, int height,
+                                  bool disk_cache, void (*callback)(unsigned int texture_id, void *user_data),
+                                  void *user_data);
+
+/**
+ * @brief Drops a request wherever it is, its callback will not be called.
+ */
+void image_decoder_cancel(ImageDecoder *decoder, unsigned int id);
+
+/**
+ * @brief Oldest finished job, NULL when none. The caller uploads it, calls its callback and frees it.
+ */
+ImageDecodeJob *image_decoder_take(ImageDecoder *decoder);
+
+bool image_decoder_has_results(ImageDecoder *decoder);
+
+void image_decoder_job_free(ImageDecodeJob *job);
+
+#endif // IMAGE_DECODER_INTERNAL_H
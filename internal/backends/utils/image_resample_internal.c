@@ -0,0 +1,204 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/image_resample_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMAGE_RESAMPLE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGE_RESAMPLE_NEON 1
+#endif
+
+/** Largest box per pass, 16 x 16 x 255 still fits the 16 bit accumulators. */
+#define IMAGE_RESAMPLE_MAX_BOX 16
+
+/**
+ * Adds a row of bytes to a row of 16 bit sums, the inner loop of the box filter.
+ */
+static void image_accumulate_row(uint16_t *sums, const unsigned char *row, size_t count)
+{
+    size_t i = 0;
+#if defined(IMAGE_RESAMPLE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128((const __m128i *)(row + i));
+        __m128i low = _mm_loadu_si128((const __m128i *)(sums + i));
+        __m128i high = _mm_loadu_si128((const __m128i *)(sums + i + 8));
+        low = _mm_add_epi16(low, _mm_unpacklo_epi8(bytes, zero));
+        high = _mm_add_epi16(high, _mm_unpackhi_epi8(bytes, zero));
+        _mm_storeu_si128((__m128i *)(sums + i), low);
+        _mm_storeu_si128((__m128i *)(sums + i + 8), high);
+    }
+#elif defined(IMAGE_RESAMPLE_NEON)
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8x16_t bytes = vld1q_u8(row + i);
+        vst1q_u16(sums + i, vaddw_u8(vld1q_u16(sums + i), vget_low_u8(bytes)));
+        vst1q_u16(sums + i + 8, vaddw_u8(vld1q_u16(sums + i + 8), vget_high_u8(bytes)));
+    }
+#endif
+    for (; i < count; ++i)
+        sums[i] += row[i];
+}
+
+static void image_replace_pixels(DecodedImage *image, unsigned char *pixels, int width, int height)
+{
+    decoded_image_free(image);
+    image->pixels = pixels;
+    image->width = width;
+    image->height = height;
+    image->stb_owned = false;
+}
+
+/**
+ * Averages every @p box_x x @p box_y block into one pixel, leftover columns and rows are dropped.
+ */
+static bool image_box_reduce(DecodedImage *image, int box_x, int box_y)
+{
+    const int channels = image->channels;
+    const int width = image->width / box_x;
+    const int height = image->height / box_y;
+    const size_t source_stride = (size_t)image->width * channels;
+    const size_t used = (size_t)width * box_x * channels;
+
+    unsigned char *pixels = malloc((size_t)width * height * channels);
+    uint16_t *sums = malloc(used * sizeof(uint16_t));
+    if (!pixels || !sums)
+    {
+        LOG_ERROR("Failed to allocate memory to downscale an image");
+        free(pixels);
+        free(sums);
+        return false;
+    }
+
+    // Division by the block area as a 16.16 multiply, exact to rounding for blocks of up to 256 pixels.
+    const uint32_t area = (uint32_t)(box_x * box_y);
+    const uint32_t inverse = (65536 + area / 2) / area;
+
+    for (int y = 0; y < height; ++y)
+    {
+        memset(sums, 0, used * sizeof(uint16_t));
+        for (int row = 0; row < box_y; ++row)
+            image_accumulate_row(sums, image->pixels + ((size_t)y * box_y + row) * source_stride, used);
+
+        unsigned char *out = pixels + (size_t)y * width * channels;
+        for (int x = 0; x < width; ++x)
+        {
+            const uint16_t *block = sums + (size_t)x * box_x * channels;
+            for (int c = 0; c < channels; ++c)
+            {
+                uint32_t sum = 0;
+                for (int i = 0; i < box_x; ++i)
+                    sum += block[i * channels + c];
+                out[x * channels + c] = (unsigned char)((sum * inverse + 32768) >> 16);
+            }
+        }
+    }
+
+    free(sums);
+    image_replace_pixels(image, pixels, width, height);
+    return true;
+}
+
+/**
+ * Resamples to exactly @p width x @p height, meant for the last step of under 2x.
+ */
+static bool image_bilinear(DecodedImage *image, int width, int height)
+{
+    const int channels = image->channels;
+    unsigned char *pixels = malloc((size_t)width * height * channels);
+    if (!pixels)
+    {
+        LOG_ERROR("Failed to allocate memory to downscale an image");
+        return false;
+    }
+
+    // Pixel centers map onto each other, positions are 16.16 fixed point.
+    const int64_t step_x = ((int64_t)image->width << 16) / width;
+    const int64_t step_y = ((int64_t)image->height << 16) / height;
+    const size_t stride = (size_t)image->width * channels;
+
+    for (int y = 0; y < height; ++y)
+    {
+        int64_t sy = ((int64_t)y * step_y + step_y / 2) - 32768;
+        if (sy < 0)
+            sy = 0;
+        const int y0 = (int)(sy >> 16);
+        const int y1 = y0 + 1 < image->height ? y0 + 1 : y0;
+        const uint32_t fy = (uint32_t)(sy & 0xFFFF) >> 8;
+        const unsigned char *row0 = image->pixels + (size_t)y0 * stride;
+        const unsigned char *row1 = image->pixels + (size_t)y1 * stride;
+        unsigned char *out = pixels + (size_t)y * width * channels;
+
+        for (int x = 0; x < width; ++x)
+        {
+            int64_t sx = ((int64_t)x * step_x + step_x / 2) - 32768;
+            if (sx < 0)
+                sx = 0;
+            const int x0 = (int)(sx >> 16);
+            const int x1 = x0 + 1 < image->width ? x0 + 1 : x0;
+            const uint32_t fx = (uint32_t)(sx & 0xFFFF) >> 8;
+
+            for (int c = 0; c < channels; ++c)
+            {
+                const uint32_t top = row0[x0 * channels + c] * (256 - fx) + row0[x1 * channels + c] * fx;
+                const uint32_t bottom = row1[x0 * channels + c] * (256 - fx) + row1[x1 * channels + c] * fx;
+                out[x * channels + c] = (unsigned char)((top * (256 - fy) + bottom * fy + 32768) >> 16);
+            }
+        }
+    }
+
+    image_replace_pixels(image, pixels, width, height);
+    return true;
+}
+
+static int image_box_factor(int source, int target)
+{
+    const int factor = source / target;
+    return factor < 1 ? 1 : factor > IMAGE_RESAMPLE_MAX_BOX ? IMAGE_RESAMPLE_MAX_BOX : factor;
+}
+
+bool image_downscale(DecodedImage *image, int width, int height, int min_ratio)
+{
+    if (!image->pixels || width <= 0 || height <= 0 || min_ratio <= 0)
+        return false;
+
+    if (width > image->width)
+        width = image->width;
+    if (height > image->height)
+        height = image->height;
+    if ((int64_t)image->width * image->height < (int64_t)width * height * min_ratio)
+        return false;
+
+    bool scaled = false;
+    while (image->width / width >= 2 || image->height / height >= 2)
+    {
+        if (!image_box_reduce(image, image_box_factor(image->width, width), image_box_factor(image->height, height)))
+            return scaled;
+        scaled = true;
+    }
+    if (image->width != width || image->height != height)
+        scaled |= image_bilinear(image, width, height);
+    return scaled;
+}
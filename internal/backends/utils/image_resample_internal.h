@@ -0,0 +1,42 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file image_resample_internal.h
+ * @brief Shrinks decoded images to the size they are displayed at.
+ *
+ * Large reductions are done by averaging whole blocks of pixels (a box
+ * filter, with SSE2 or NEON when available), at most 16x per pass; the
+ * last, less than 2x, step to the exact size is bilinear.
+ */
+
+#ifndef IMAGE_RESAMPLE_INTERNAL_H
+#define IMAGE_RESAMPLE_INTERNAL_H
+
+#include "backends/utils/image_decoder_internal.h"
+#include <stdbool.h>
+
+/**
+ * @brief Replaces the image by a @p width x @p height version when it has at least @p min_ratio times as many pixels.
+ *
+ * Never enlarges: a dimension already smaller than the target is kept. A @p min_ratio of 0 disables it.
+ *
+ * @return true when the image was downscaled.
+ */
+bool image_downscale(DecodedImage *image, int width, int height, int min_ratio);
+
+#endif // IMAGE_RESAMPLE_INTERNAL_H
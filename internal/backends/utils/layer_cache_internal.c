@@ -0,0 +1,213 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/layer_cache_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/gl_state_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+static size_t layer_bytes(int width, int height)
+{
+    return (size_t)width * height * 4;
+}
+
+void layer_cache_init(LayerCache *cache, size_t budget)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->budget = budget;
+    cache->generation = 1;
+}
+
+void layer_cache_destroy(LayerCache *cache)
+{
+    for (GooeyLayer *layer = cache->layers; layer; layer = layer->next)
+        layer_cache_release(layer);
+}
+
+GooeyLayer *layer_cache_create(LayerCache *cache, int window_id)
+{
+    GooeyLayer *layer = calloc(1, sizeof(GooeyLayer));
+    if (!layer)
+    {
+        LOG_ERROR("Failed to allocate layer");
+        return NULL;
+    }
+
+    layer->cache = cache;
+    layer->window_id = window_id;
+    layer->next = cache->layers;
+    if (cache->layers)
+        cache->layers->prev = layer;
+    cache->layers = layer;
+    return layer;
+}
+
+void layer_cache_destroy_layer(GooeyLayer *layer)
+{
+    if (!layer)
+        return;
+
+    LayerCache *cache = layer->cache;
+    layer_cache_release(layer);
+    if (layer->prev)
+        layer->prev->next = layer->next;
+    else
+        cache->layers = layer->next;
+    if (layer->next)
+        layer->next->prev = layer->prev;
+    free(layer);
+}
+
+bool layer_cache_is_valid(const GooeyLayer *layer, int x, int y, int width, int height, uint64_t key,
+                          int window_width, int window_height)
+{
+    return layer->texture != 0 && layer->generation == layer->cache->generation && layer->key == key &&
+           layer->x == x && layer->y == y && layer->width == width && layer->height == height &&
+           layer->window_width == window_width && layer->window_height == window_height;
+}
+
+void layer_cache_release(GooeyLayer *layer)
+{
+    if (layer->texture == 0)
+        return;
+
+    gl_state_delete_textures(1, &layer->texture);
+    layer->texture = 0;
+    layer->cache->bytes -= layer_bytes(layer->width, layer->height);
+}
+
+/**
+ * Least recently used layer holding a texture, layers composited by a frame in progress are never picked.
+ */
+static GooeyLayer *layer_cache_victim(LayerCache *cache, const GooeyLayer *keep)
+{
+    GooeyLayer *victim = NULL;
+    for (GooeyLayer *layer = cache->layers; layer; layer = layer->next)
+    {
+        if (layer == keep || layer->texture == 0 || layer->last_used >= cache->keep_since)
+            continue;
+        if (!victim || layer->last_used < victim->last_used)
+            victim = layer;
+    }
+    return victim;
+}
+
+bool layer_cache_reserve(GooeyLayer *layer, int width, int height)
+{
+    LayerCache *cache = layer->cache;
+    if (width <= 0 || height <= 0)
+        return false;
+    if (layer->texture != 0 && layer->width == width && layer->height == height)
+        return true;
+
+    layer_cache_release(layer);
+    const size_t needed = layer_bytes(width, height);
+    while (cache->bytes + needed > cache->budget)
+    {
+        GooeyLayer *victim = layer_cache_victim(cache, layer);
+        if (!victim)
+            return false;
+        layer_cache_release(victim);
+    }
+
+    glGenTextures(1, &layer->texture);
+    gl_state_bind_texture(GL_TEXTURE_2D, layer->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    layer->width = width;
+    layer->height = height;
+    cache->bytes += needed;
+    return true;
+}
+
+static bool layer_target_prepare(LayerTarget *target, const RenderBatch *window)
+{
+    if (!target->ready)
+    {
+        render_batch_init(&target->batch, window->width, window->height);
+        glGenFramebuffers(1, &target->framebuffer);
+        target->ready = true;
+    }
+    render_batch_set_viewport(&target->batch, window->width, window->height);
+    return target->framebuffer != 0;
+}
+
+bool layer_target_render(LayerTarget *target, RenderBatch *window, GooeyLayer *layer, RenderBatchProgram *program,
+                         QuadProgram *quad_program)
+{
+    // Until the texture holds the content the primitives stay in the window batch, failing draws them directly.
+    layer->generation = 0;
+    if (window->vertex_count < layer->mark.vertex || window->instance_count < layer->mark.instance ||
+        window->command_count < layer->mark.command)
+        return false; // Flushed in between, the content was drawn already.
+    if (!render_batch_end_list(window, &layer->mark, &target->content) || !layer_target_prepare(target, window))
+        return false;
+    if (!render_batch_append_list(&target->batch, &target->content))
+    {
+        render_batch_discard(&target->batch);
+        return false;
+    }
+
+    // Windows may render into a framebuffer of their own, headless, that has to be bound back.
+    const GLuint window_framebuffer = gl_state_framebuffer();
+    gl_state_bind_framebuffer(target->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer->texture, 0);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete)
+    {
+        // The viewport stays window sized and is shifted instead, vertices keep their window coordinates.
+        gl_state_viewport(-layer->x, -(window->height - layer->y - layer->height), window->width, window->height);
+        target->batch.needs_clear = true;
+        render_batch_flush(&target->batch, program, quad_program, NULL);
+    }
+    else
+    {
+        LOG_ERROR("Layer framebuffer is incomplete");
+        render_batch_discard(&target->batch);
+    }
+    gl_state_bind_framebuffer(window_framebuffer);
+    gl_state_viewport(0, 0, window->width, window->height);
+    if (!complete)
+        return false;
+
+    render_batch_truncate(window, &layer->mark);
+    layer->window_width = window->width;
+    layer->window_height = window->height;
+    layer->generation = layer->cache->generation;
+    layer->version++;
+    layer->cache->stats.renders++;
+    return true;
+}
+
+void layer_target_destroy(LayerTarget *target)
+{
+    if (target->ready)
+    {
+        render_batch_destroy(&target->batch);
+        gl_state_delete_framebuffers(1, &target->framebuffer);
+    }
+    render_batch_list_free(&target->content);
+    memset(target, 0, sizeof(*target));
+}
+
+#endif
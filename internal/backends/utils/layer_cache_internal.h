@@ -0,0 +1,130 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file layer_cache_internal.h
+ * @brief Offscreen textures holding the static content of expensive widgets.
+ *
+ * A layer covers one rectangle of a window. Its content is drawn through the
+ * window batch like anything else, lifted out of it and rendered into the
+ * layer texture; later frames composite that texture with a single quad
+ * until the widget's key changes or the layer is invalidated.
+ *
+ * Textures are shared between contexts, framebuffers and VAOs are not: every
+ * window renders its layers through its own LayerTarget.
+ *
+ * All layers together stay under a byte budget. Layers not used since
+ * keep_since are evicted least recently used first; when that is not
+ * enough the widget is drawn directly instead.
+ */
+
+#ifndef LAYER_CACHE_INTERNAL_H
+#define LAYER_CACHE_INTERNAL_H
+
+#include "backends/utils/render_batch_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+
+typedef struct LayerCache LayerCache;
+
+struct GooeyLayer
+{
+    LayerCache *cache;
+    GooeyLayer *prev, *next;
+    GLuint texture;             /**< 0 when the layer holds no content. */
+    int window_id;
+    int x, y, width, height;    /**< Window pixels the texture covers. */
+    int window_width;           /**< Window size the content was rendered at, shape vertices depend on it. */
+    int window_height;
+    uint64_t key;               /**< Widget state the content was drawn from. */
+    uint64_t generation;        /**< LayerCache::generation it was rendered in. */
+    uint64_t version;           /**< Bumped on every render, tells the damage tracker the pixels changed. */
+    uint64_t last_used;         /**< LayerCache::frame it was last composited in. */
+    RenderBatchMark mark;       /**< Where its content starts in the window batch while it is drawn. */
+};
+
+typedef struct
+{
+    size_t hits;
+    size_t renders;
+} LayerCacheStats;
+
+struct LayerCache
+{
+    GooeyLayer *layers; /**< Every live layer, with or without a texture. */
+    size_t bytes;
+    size_t budget;
+    uint64_t frame;      /**< Advanced by the backend once per window frame. */
+    uint64_t keep_since; /**< Oldest frame still being drawn, layers composited since are not evicted. */
+    uint64_t generation; /**< Bumped when cached pixels may no longer match, e.g. a font change. */
+    LayerCacheStats stats;
+};
+
+/**
+ * @brief Per-window objects layers are rendered with, created on first use.
+ */
+typedef struct
+{
+    RenderBatch batch;
+    GLuint framebuffer;
+    RenderBatchList content; /**< Scratch copy of the primitives being moved into a layer. */
+    bool ready;
+} LayerTarget;
+
+void layer_cache_init(LayerCache *cache, size_t budget);
+
+/**
+ * @brief Frees every layer texture, layers themselves stay owned by their widgets.
+ */
+void layer_cache_destroy(LayerCache *cache);
+
+GooeyLayer *layer_cache_create(LayerCache *cache, int window_id);
+void layer_cache_destroy_layer(GooeyLayer *layer);
+
+/**
+ * @brief Whether the layer can be composited as is for the given rectangle, key and window size.
+ */
+bool layer_cache_is_valid(const GooeyLayer *layer, int x, int y, int width, int height, uint64_t key,
+                          int window_width, int window_height);
+
+/**
+ * @brief Makes sure the layer has a texture of @p width x @p height, evicting older layers to fit the budget.
+ *
+ * @return false when it cannot fit, the content should then be drawn directly.
+ */
+bool layer_cache_reserve(GooeyLayer *layer, int width, int height);
+
+/**
+ * @brief Drops the layer's texture, it is drawn again next time it is used.
+ */
+void layer_cache_release(GooeyLayer *layer);
+
+/**
+ * @brief Renders the primitives @p window pushed since the layer's mark into its texture, and removes them from @p window.
+ *
+ * The window's context must be current. The texture is cleared with its clear color first, the
+ * window background: layers are opaque.
+ */
+bool layer_target_render(LayerTarget *target, RenderBatch *window, GooeyLayer *layer, RenderBatchProgram *program,
+                         QuadProgram *quad_program);
+
+/**
+ * @brief Frees the target's VAOs and framebuffer, its window's context must be current.
+ */
+void layer_target_destroy(LayerTarget *target);
+
+#endif
+#endif // LAYER_CACHE_INTERNAL_H
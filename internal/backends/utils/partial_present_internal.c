@@ -0,0 +1,155 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include "backends/utils/partial_present_internal.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<EGL/egl.h>) && __has_include(<EGL/eglext.h>)
+#define PARTIAL_PRESENT_EGL 1
+#endif
+#endif
+
+#ifdef PARTIAL_PRESENT_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <dlfcn.h>
+#include <string.h>
+
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
+typedef EGLDisplay (*GetCurrentDisplayProc)(void);
+typedef EGLSurface (*GetCurrentSurfaceProc)(EGLint readdraw);
+typedef EGLBoolean (*QuerySurfaceProc)(EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint *value);
+typedef const char *(*QueryStringProc)(EGLDisplay dpy, EGLint name);
+typedef EGLBoolean (*SetDamageRegionProc)(EGLDisplay dpy, EGLSurface surface, EGLint *rects, EGLint n_rects);
+typedef EGLBoolean (*SwapIntervalProc)(EGLDisplay dpy, EGLint interval);
+
+static struct
+{
+    bool probed;
+    bool buffer_age;
+    GetCurrentDisplayProc get_current_display;
+    GetCurrentSurfaceProc get_current_surface;
+    QuerySurfaceProc query_surface;
+    SetDamageRegionProc set_damage_region;
+    SwapIntervalProc swap_interval;
+} egl;
+
+static bool partial_present_has_extension(const char *extensions, const char *name)
+{
+    const size_t length = strlen(name);
+    for (const char *p = extensions; p && (p = strstr(p, name)); p += length)
+    {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+static void partial_present_probe(void)
+{
+    egl.probed = true;
+
+    // RTLD_DEFAULT only finds EGL if GLPS loaded it, which is exactly when its surfaces are EGL ones.
+    egl.get_current_display = (GetCurrentDisplayProc)dlsym(RTLD_DEFAULT, "eglGetCurrentDisplay");
+    egl.get_current_surface = (GetCurrentSurfaceProc)dlsym(RTLD_DEFAULT, "eglGetCurrentSurface");
+    egl.query_surface = (QuerySurfaceProc)dlsym(RTLD_DEFAULT, "eglQuerySurface");
+    QueryStringProc query_string = (QueryStringProc)dlsym(RTLD_DEFAULT, "eglQueryString");
+    void *(*get_proc_address)(const char *) = (void *(*)(const char *))dlsym(RTLD_DEFAULT, "eglGetProcAddress");
+    if (!egl.get_current_display || !egl.get_current_surface || !egl.query_surface || !query_string)
+        return;
+
+    EGLDisplay display = egl.get_current_display();
+    if (display == EGL_NO_DISPLAY)
+        return;
+    egl.swap_interval = (SwapIntervalProc)dlsym(RTLD_DEFAULT, "eglSwapInterval");
+
+    const char *extensions = query_string(display, EGL_EXTENSIONS);
+    egl.buffer_age = partial_present_has_extension(extensions, "EGL_EXT_buffer_age") ||
+                     partial_present_has_extension(extensions, "EGL_KHR_partial_update");
+    if (get_proc_address && partial_present_has_extension(extensions, "EGL_KHR_partial_update"))
+        egl.set_damage_region = (SetDamageRegionProc)get_proc_address("eglSetDamageRegionKHR");
+}
+
+int partial_present_buffer_age(void)
+{
+    if (!egl.probed)
+        partial_present_probe();
+    if (!egl.buffer_age)
+        return 0;
+
+    EGLDisplay display = egl.get_current_display();
+    EGLSurface surface = egl.get_current_surface(EGL_DRAW);
+    EGLint age = 0;
+    if (display == EGL_NO_DISPLAY || surface == EGL_NO_SURFACE ||
+        !egl.query_surface(display, surface, EGL_BUFFER_AGE_EXT, &age))
+        return 0;
+    return age;
+}
+
+void partial_present_set_damage(const DamageRegion *region, int surface_height)
+{
+    if (!egl.set_damage_region || region->full)
+        return;
+
+    // EGL rectangles are x, y, width, height with the origin at the bottom left.
+    EGLint rects[DAMAGE_MAX_RECTS * 4];
+    for (int i = 0; i < region->count; ++i)
+    {
+        const DamageRect *rect = &region->rects[i];
+        rects[i * 4 + 0] = rect->x;
+        rects[i * 4 + 1] = surface_height - (rect->y + rect->height);
+        rects[i * 4 + 2] = rect->width;
+        rects[i * 4 + 3] = rect->height;
+    }
+    egl.set_damage_region(egl.get_current_display(), egl.get_current_surface(EGL_DRAW), rects, region->count);
+}
+
+bool partial_present_set_swap_interval(int interval)
+{
+    if (!egl.probed)
+        partial_present_probe();
+    if (!egl.swap_interval)
+        return false;
+
+    EGLDisplay display = egl.get_current_display();
+    return display != EGL_NO_DISPLAY && egl.swap_interval(display, interval);
+}
+
+#else
+
+int partial_present_buffer_age(void)
+{
+    return 0;
+}
+
+void partial_present_set_damage(const DamageRegion *region, int surface_height)
+{
+    (void)region;
+    (void)surface_height;
+}
+
+bool partial_present_set_swap_interval(int interval)
+{
+    (void)interval;
+    return false;
+}
+
+#endif
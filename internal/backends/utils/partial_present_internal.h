@@ -0,0 +1,56 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file partial_present_internal.h
+ * @brief Back buffer age, damage hints and swap interval of the current EGL surface.
+ *
+ * GLPS owns the surfaces and the swap, so everything here works on whatever
+ * EGL surface is current. The entry points are looked up at runtime from
+ * the EGL library GLPS already loaded: with GLX, WGL, or an EGL without
+ * EGL_EXT_buffer_age, the age is reported as unknown and callers repaint
+ * whole windows.
+ */
+
+#ifndef PARTIAL_PRESENT_INTERNAL_H
+#define PARTIAL_PRESENT_INTERNAL_H
+
+#include "backends/utils/damage_tracker_internal.h"
+
+/**
+ * @brief Frames since the current surface's back buffer was last presented.
+ *
+ * @return 1 for the previous frame, 2 for the one before, 0 when its content is unknown.
+ */
+int partial_present_buffer_age(void);
+
+/**
+ * @brief Tells the driver only @p region of the back buffer is about to be drawn to.
+ *
+ * Uses EGL_KHR_partial_update when present, does nothing otherwise. Must be
+ * called after partial_present_buffer_age() and before any drawing in the frame.
+ */
+void partial_present_set_damage(const DamageRegion *region, int surface_height);
+
+/**
+ * @brief Sets how many display refreshes a swap of the current surface waits for, 0 for none.
+ *
+ * @return false when the interval could not be set, swaps then keep their default.
+ */
+bool partial_present_set_swap_interval(int interval);
+
+#endif // PARTIAL_PRESENT_INTERNAL_H
@@ -0,0 +1,211 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/polyline_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    float x, y;
+} PolylineVector;
+
+static bool polyline_reserve(Polyline *polyline, size_t more)
+{
+    if (polyline->count + more <= polyline->capacity)
+        return true;
+
+    size_t capacity = polyline->capacity ? polyline->capacity : 256;
+    while (capacity < polyline->count + more)
+        capacity *= 2;
+    PolylineVertex *vertices = realloc(polyline->vertices, capacity * sizeof(PolylineVertex));
+    if (!vertices)
+        return false;
+    polyline->vertices = vertices;
+    polyline->capacity = capacity;
+    return true;
+}
+
+static void polyline_emit(Polyline *polyline, float x, float y, float across)
+{
+    polyline->vertices[polyline->count++] = (PolylineVertex){x, y, across};
+}
+
+/**
+ * Triangles from @p center to its rim, @p extent away, turning @p sweep radians from @p angle.
+ */
+static bool polyline_fan(Polyline *polyline, PolylineVector center, float extent, float angle, float sweep)
+{
+    // Chords stay within a quarter pixel of the circle.
+    const float step = extent > 0.25f ? 2.0f * acosf(1.0f - 0.25f / extent) : (float)M_PI / 2.0f;
+    int segments = (int)ceilf(fabsf(sweep) / step);
+    segments = segments < 1 ? 1 : segments > 64 ? 64 : segments;
+    if (!polyline_reserve(polyline, (size_t)segments * 3))
+        return false;
+
+    float previous_x = center.x + cosf(angle) * extent;
+    float previous_y = center.y + sinf(angle) * extent;
+    for (int i = 1; i <= segments; ++i)
+    {
+        const float a = angle + sweep * (float)i / (float)segments;
+        const float x = center.x + cosf(a) * extent;
+        const float y = center.y + sinf(a) * extent;
+        polyline_emit(polyline, center.x, center.y, 0.0f);
+        polyline_emit(polyline, previous_x, previous_y, extent);
+        polyline_emit(polyline, x, y, extent);
+        previous_x = x;
+        previous_y = y;
+    }
+    return true;
+}
+
+static PolylineVector polyline_normal(PolylineVector from, PolylineVector to)
+{
+    const float dx = to.x - from.x, dy = to.y - from.y;
+    const float length = sqrtf(dx * dx + dy * dy);
+    return (PolylineVector){-dy / length, dx / length};
+}
+
+/**
+ * Fills the outer side of the corner at @p point between segments of normals @p in and @p out.
+ */
+static bool polyline_join(Polyline *polyline, PolylineVector point, PolylineVector in, PolylineVector out,
+                          float extent, GooeyLineJoin join)
+{
+    // Normals are the directions turned a quarter, their cross product is the direction's.
+    const float cross = in.x * out.y - in.y * out.x;
+    const float dot = in.x * out.x + in.y * out.y;
+    if (fabsf(cross) < 1e-6f && dot > 0.0f)
+        return true;
+
+    const float side = cross > 0.0f ? -1.0f : 1.0f;
+    const PolylineVector from = {in.x * side, in.y * side};
+    const PolylineVector to = {out.x * side, out.y * side};
+    if (join == GOOEY_LINE_JOIN_ROUND)
+    {
+        const float angle = atan2f(from.y, from.x);
+        float sweep = atan2f(to.y, to.x) - angle;
+        if (sweep > (float)M_PI)
+            sweep -= 2.0f * (float)M_PI;
+        else if (sweep < -(float)M_PI)
+            sweep += 2.0f * (float)M_PI;
+        return polyline_fan(polyline, point, extent, angle, sweep);
+    }
+
+    if (!polyline_reserve(polyline, 3))
+        return false;
+    polyline_emit(polyline, point.x, point.y, 0.0f);
+    polyline_emit(polyline, point.x + from.x * extent, point.y + from.y * extent, extent);
+    polyline_emit(polyline, point.x + to.x * extent, point.y + to.y * extent, extent);
+    return true;
+}
+
+/**
+ * Offset of the left edge where two segments meet, when they can share it as a miter.
+ */
+static bool polyline_miter(PolylineVector in, PolylineVector out, float extent, PolylineVector *offset)
+{
+    const float x = in.x + out.x, y = in.y + out.y;
+    const float length = sqrtf(x * x + y * y);
+    if (length < 1e-6f)
+        return false;
+
+    // Cosine of half the corner: the miter is extent / cosine long.
+    const float cosine = (x * in.x + y * in.y) / length;
+    if (cosine < 1.0f / POLYLINE_MITER_LIMIT)
+        return false;
+    offset->x = x / length * extent / cosine;
+    offset->y = y / length * extent / cosine;
+    return true;
+}
+
+bool polyline_build(Polyline *polyline, const float *points, size_t count, float width, GooeyLineJoin join)
+{
+    polyline->count = 0;
+    const float extent = fmaxf(width, 1.0f) * 0.5f + 1.0f;
+
+    // Index of the first point different from the first.
+    size_t current;
+    for (current = 1; current < count; ++current)
+    {
+        if (points[current * 2] != points[0] || points[current * 2 + 1] != points[1])
+            break;
+    }
+    if (count < 2 || current >= count)
+        return true;
+
+    PolylineVector start = {points[0], points[1]};
+    PolylineVector normal = polyline_normal(start, (PolylineVector){points[current * 2], points[current * 2 + 1]});
+    PolylineVector start_offset = {normal.x * extent, normal.y * extent};
+    if (join == GOOEY_LINE_JOIN_ROUND &&
+        !polyline_fan(polyline, start, extent, atan2f(normal.y, normal.x), (float)M_PI))
+        goto out_of_memory;
+
+    while (current < count)
+    {
+        const PolylineVector end = {points[current * 2], points[current * 2 + 1]};
+        size_t next = current + 1;
+        while (next < count && points[next * 2] == end.x && points[next * 2 + 1] == end.y)
+            next++;
+
+        PolylineVector end_offset = {normal.x * extent, normal.y * extent};
+        PolylineVector next_normal = normal, next_offset = end_offset;
+        bool mitered = false;
+        if (next < count)
+        {
+            next_normal = polyline_normal(end, (PolylineVector){points[next * 2], points[next * 2 + 1]});
+            next_offset = (PolylineVector){next_normal.x * extent, next_normal.y * extent};
+            mitered = join == GOOEY_LINE_JOIN_MITER && polyline_miter(normal, next_normal, extent, &end_offset);
+            if (mitered)
+                next_offset = end_offset;
+        }
+
+        if (!polyline_reserve(polyline, 6))
+            goto out_of_memory;
+        polyline_emit(polyline, start.x + start_offset.x, start.y + start_offset.y, extent);
+        polyline_emit(polyline, start.x - start_offset.x, start.y - start_offset.y, -extent);
+        polyline_emit(polyline, end.x + end_offset.x, end.y + end_offset.y, extent);
+        polyline_emit(polyline, end.x + end_offset.x, end.y + end_offset.y, extent);
+        polyline_emit(polyline, start.x - start_offset.x, start.y - start_offset.y, -extent);
+        polyline_emit(polyline, end.x - end_offset.x, end.y - end_offset.y, -extent);
+
+        if (next < count && !mitered && !polyline_join(polyline, end, normal, next_normal, extent, join))
+            goto out_of_memory;
+        if (next >= count && join == GOOEY_LINE_JOIN_ROUND &&
+            !polyline_fan(polyline, end, extent, atan2f(-normal.y, -normal.x), (float)M_PI))
+            goto out_of_memory;
+
+        start = end;
+        start_offset = next_offset;
+        normal = next_normal;
+        current = next;
+    }
+    return true;
+
+out_of_memory:
+    LOG_ERROR("Failed to allocate memory for polyline vertices");
+    polyline->count = 0;
+    return false;
+}
+
+void polyline_destroy(Polyline *polyline)
+{
+    free(polyline->vertices);
+    memset(polyline, 0, sizeof(*polyline));
+}
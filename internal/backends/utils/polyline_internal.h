@@ -0,0 +1,68 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file polyline_internal.h
+ * @brief Thick antialiased polylines expanded into triangles on the CPU.
+ *
+ * Every segment becomes a quad one pixel wider on each side than the line,
+ * joins and round caps fill the gaps between them. Each vertex carries its
+ * signed distance across the line in pixels: the shader turns it into
+ * coverage, fading the extra pixel out into an antialiased edge.
+ *
+ * Triangles rather than a strip, so that consecutive polylines share one
+ * draw call in the render batch.
+ */
+
+#ifndef POLYLINE_INTERNAL_H
+#define POLYLINE_INTERNAL_H
+
+#include "common/gooey_common.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/** A miter longer than this many half widths is beveled instead. */
+#define POLYLINE_MITER_LIMIT 4.0f
+
+typedef struct
+{
+    float x, y;   /**< Pixels. */
+    float across; /**< Signed distance from the center of the line, in pixels. */
+} PolylineVertex;
+
+/**
+ * @brief Triangles of the last polyline built, reused from one to the next.
+ */
+typedef struct
+{
+    PolylineVertex *vertices;
+    size_t count;
+    size_t capacity;
+} Polyline;
+
+/**
+ * @brief Expands @p count points, x then y, into triangles for a line @p width pixels wide.
+ *
+ * Repeated points are skipped. Lines thinner than a pixel are drawn one pixel wide.
+ *
+ * @return false when out of memory, @p polyline then holds nothing.
+ */
+bool polyline_build(Polyline *polyline, const float *points, size_t count, float width, GooeyLineJoin join);
+
+void polyline_destroy(Polyline *polyline);
+
+#endif // POLYLINE_INTERNAL_H
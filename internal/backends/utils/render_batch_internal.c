@@ -0,0 +1,645 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "render_batch_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/gl_state_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <math.h>
+#include <string.h>
+
+static bool render_batch_state_equal(const RenderBatchState *a, const RenderBatchState *b)
+{
+    return a->mode == b->mode &&
+           a->texture == b->texture &&
+           a->shape_type == b->shape_type &&
+           a->use_texture == b->use_texture &&
+           a->is_rounded == b->is_rounded &&
+           a->is_hollow == b->is_hollow &&
+           a->size[0] == b->size[0] &&
+           a->size[1] == b->size[1] &&
+           a->radius == b->radius &&
+           a->border_width == b->border_width;
+}
+
+void render_batch_program_init(RenderBatchProgram *program, GLuint gl_program)
+{
+    program->program = gl_program;
+    program->use_texture = glGetUniformLocation(gl_program, "useTexture");
+    program->tex = glGetUniformLocation(gl_program, "tex");
+    program->size = glGetUniformLocation(gl_program, "size");
+    program->radius = glGetUniformLocation(gl_program, "radius");
+    program->border_width = glGetUniformLocation(gl_program, "borderWidth");
+    program->is_rounded = glGetUniformLocation(gl_program, "isRounded");
+    program->is_hollow = glGetUniformLocation(gl_program, "isHollow");
+    program->shape_type = glGetUniformLocation(gl_program, "shapeType");
+    program->has_current = false;
+
+    gl_state_use_program(gl_program);
+    glUniform1i(program->tex, RENDER_BATCH_TEXTURE_UNIT);
+}
+
+void render_batch_quad_program_init(QuadProgram *program, GLuint gl_program)
+{
+    program->program = gl_program;
+    program->viewport = glGetUniformLocation(gl_program, "viewport");
+    program->atlas = glGetUniformLocation(gl_program, "atlas");
+    program->has_viewport = false;
+
+    gl_state_use_program(gl_program);
+    glUniform1i(program->atlas, RENDER_BATCH_TEXTURE_UNIT);
+}
+
+static void render_batch_stream_init(RenderBatchStream *stream, size_t capacity, size_t stride)
+{
+    stream->capacity = capacity;
+    stream->offset = 0;
+    stream->stride = stride;
+    glGenBuffers(1, &stream->vbo);
+    gl_state_bind_buffer(GL_ARRAY_BUFFER, stream->vbo);
+    glBufferData(GL_ARRAY_BUFFER, capacity * stride, NULL, GL_STREAM_DRAW);
+}
+
+void render_batch_init(RenderBatch *batch, int width, int height)
+{
+    memset(batch, 0, sizeof(*batch));
+    render_batch_set_viewport(batch, width, height);
+
+    render_batch_stream_init(&batch->vertex_stream, RENDER_BATCH_INITIAL_VERTICES, sizeof(Vertex));
+    glGenVertexArrays(1, &batch->vao);
+    gl_state_bind_vertex_array(batch->vao);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, pos));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, col));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoord));
+
+    // Instance attributes are pointed at the right offset on every flush, only the layout lives in the VAO.
+    render_batch_stream_init(&batch->instance_stream, RENDER_BATCH_INITIAL_INSTANCES, sizeof(QuadInstance));
+    glGenVertexArrays(1, &batch->quad_vao);
+    gl_state_bind_vertex_array(batch->quad_vao);
+    for (GLuint attribute = 0; attribute < 4; ++attribute)
+    {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+
+    gl_state_bind_vertex_array(0);
+}
+
+void render_batch_destroy(RenderBatch *batch)
+{
+    if (batch->vao != 0)
+        gl_state_delete_vertex_arrays(1, &batch->vao);
+    if (batch->quad_vao != 0)
+        gl_state_delete_vertex_arrays(1, &batch->quad_vao);
+    if (batch->vertex_stream.vbo != 0)
+        gl_state_delete_buffers(1, &batch->vertex_stream.vbo);
+    if (batch->instance_stream.vbo != 0)
+        gl_state_delete_buffers(1, &batch->instance_stream.vbo);
+
+    free(batch->vertices);
+    free(batch->instances);
+    free(batch->commands);
+    free(batch->shapes);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void render_batch_set_viewport(RenderBatch *batch, int width, int height)
+{
+    batch->width = width > 0 ? width : 1;
+    batch->height = height > 0 ? height : 1;
+}
+
+static bool render_batch_grow(void **data, size_t *capacity, size_t needed, size_t initial, size_t element_size)
+{
+    if (needed <= *capacity)
+        return true;
+
+    size_t new_capacity = *capacity ? *capacity * 2 : initial;
+    while (new_capacity < needed)
+        new_capacity *= 2;
+
+    void *grown = realloc(*data, new_capacity * element_size);
+    if (!grown)
+    {
+        LOG_ERROR("Failed to grow render batch to %zu elements", new_capacity);
+        return false;
+    }
+    *data = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+/**
+ * Last command if new primitives may still be merged into it.
+ */
+static RenderBatchCommand *render_batch_open_command(RenderBatch *batch)
+{
+    if (batch->command_count == 0 || batch->command_count <= batch->merge_floor)
+        return NULL;
+    return &batch->commands[batch->command_count - 1];
+}
+
+static bool render_batch_can_merge_shape(const RenderBatchCommand *last, const RenderBatchState *state)
+{
+    return last->pipeline == RENDER_PIPELINE_SHAPE &&
+           (state->mode == GL_TRIANGLES || state->mode == GL_LINES) &&
+           render_batch_state_equal(&last->state, state);
+}
+
+static bool render_batch_can_merge_quad(const RenderBatchCommand *last, GLuint texture)
+{
+    // Untextured quads never sample, so they can join a run whatever texture it binds.
+    return last->pipeline == RENDER_PIPELINE_QUAD &&
+           (texture == 0 || last->state.texture == 0 || last->state.texture == texture);
+}
+
+static bool render_batch_reserve_command(RenderBatch *batch)
+{
+    return render_batch_grow((void **)&batch->commands, &batch->command_capacity, batch->command_count + 1,
+                             64, sizeof(RenderBatchCommand));
+}
+
+Vertex *render_batch_push(RenderBatch *batch, const RenderBatchState *state, size_t count)
+{
+    if (!render_batch_grow((void **)&batch->vertices, &batch->vertex_capacity, batch->vertex_count + count,
+                           RENDER_BATCH_INITIAL_VERTICES, sizeof(Vertex)) ||
+        !render_batch_grow((void **)&batch->shapes, &batch->shape_capacity, batch->shape_count + 1,
+                           64, sizeof(RenderBatchPrimitive)) ||
+        !render_batch_reserve_command(batch))
+        return NULL;
+
+    RenderBatchCommand *last = render_batch_open_command(batch);
+    bool can_merge = last && render_batch_can_merge_shape(last, state);
+
+    if (can_merge)
+    {
+        last->count += (GLsizei)count;
+    }
+    else
+    {
+        RenderBatchCommand *command = &batch->commands[batch->command_count++];
+        command->pipeline = RENDER_PIPELINE_SHAPE;
+        command->state = *state;
+        command->first = (GLint)batch->vertex_count;
+        command->count = (GLsizei)count;
+    }
+
+    RenderBatchPrimitive *shape = &batch->shapes[batch->shape_count++];
+    shape->command = batch->command_count - 1;
+    shape->first = (GLint)batch->vertex_count;
+    shape->count = (GLsizei)count;
+
+    Vertex *vertices = &batch->vertices[batch->vertex_count];
+    memset(vertices, 0, count * sizeof(Vertex));
+    batch->vertex_count += count;
+    batch->primitives++;
+    return vertices;
+}
+
+QuadInstance *render_batch_push_quad(RenderBatch *batch, GLuint texture)
+{
+    if (!render_batch_grow((void **)&batch->instances, &batch->instance_capacity, batch->instance_count + 1,
+                           RENDER_BATCH_INITIAL_INSTANCES, sizeof(QuadInstance)) ||
+        !render_batch_reserve_command(batch))
+        return NULL;
+
+    RenderBatchCommand *last = render_batch_open_command(batch);
+    if (last && render_batch_can_merge_quad(last, texture))
+    {
+        if (texture != 0)
+            last->state.texture = texture;
+        last->count++;
+    }
+    else
+    {
+        RenderBatchCommand *command = &batch->commands[batch->command_count++];
+        memset(command, 0, sizeof(*command));
+        command->pipeline = RENDER_PIPELINE_QUAD;
+        command->state.texture = texture;
+        command->first = (GLint)batch->instance_count;
+        command->count = 1;
+    }
+
+    QuadInstance *instance = &batch->instances[batch->instance_count++];
+    memset(instance, 0, sizeof(*instance));
+    batch->primitives++;
+    return instance;
+}
+
+static void render_batch_apply_state(RenderBatchProgram *program, const RenderBatchState *state)
+{
+    const RenderBatchState *current = program->has_current ? &program->current : NULL;
+    size_t issued = 0;
+
+    if (!current || current->use_texture != state->use_texture)
+    {
+        glUniform1i(program->use_texture, state->use_texture);
+        issued++;
+    }
+    if (!current || current->size[0] != state->size[0] || current->size[1] != state->size[1])
+    {
+        glUniform2f(program->size, state->size[0], state->size[1]);
+        issued++;
+    }
+    if (!current || current->radius != state->radius)
+    {
+        glUniform1f(program->radius, state->radius);
+        issued++;
+    }
+    if (!current || current->border_width != state->border_width)
+    {
+        glUniform1f(program->border_width, state->border_width);
+        issued++;
+    }
+    if (!current || current->is_rounded != state->is_rounded)
+    {
+        glUniform1i(program->is_rounded, state->is_rounded);
+        issued++;
+    }
+    if (!current || current->is_hollow != state->is_hollow)
+    {
+        glUniform1i(program->is_hollow, state->is_hollow);
+        issued++;
+    }
+    if (!current || current->shape_type != state->shape_type)
+    {
+        glUniform1i(program->shape_type, state->shape_type);
+        issued++;
+    }
+    gl_state_count(issued, RENDER_BATCH_UNIFORMS - issued);
+
+    program->current = *state;
+    program->has_current = true;
+}
+
+static size_t render_batch_stream_upload(RenderBatchStream *stream, const void *data, size_t count)
+{
+    const size_t bytes = count * stream->stride;
+
+    gl_state_bind_buffer(GL_ARRAY_BUFFER, stream->vbo);
+
+    if (count > stream->capacity)
+    {
+        while (stream->capacity < count)
+            stream->capacity *= 2;
+        glBufferData(GL_ARRAY_BUFFER, stream->capacity * stream->stride, NULL, GL_STREAM_DRAW);
+        stream->offset = 0;
+    }
+    else if (stream->offset + count > stream->capacity)
+    {
+        // Orphan the storage: the driver hands us fresh memory while frames in flight keep the old one.
+        glBufferData(GL_ARRAY_BUFFER, stream->capacity * stream->stride, NULL, GL_STREAM_DRAW);
+        stream->offset = 0;
+    }
+
+    const size_t base = stream->offset;
+    void *dst = glMapBufferRange(GL_ARRAY_BUFFER, base * stream->stride, bytes,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (dst)
+    {
+        memcpy(dst, data, bytes);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    else
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, base * stream->stride, bytes, data);
+    }
+
+    stream->offset += count;
+    return base;
+}
+
+static void render_batch_point_instances(RenderBatch *batch, size_t first)
+{
+    const GLsizei stride = sizeof(QuadInstance);
+    const size_t base = first * sizeof(QuadInstance);
+
+    // GLES3 has no base instance, so the attributes themselves are moved to the run's first instance.
+    gl_state_bind_buffer(GL_ARRAY_BUFFER, batch->instance_stream.vbo);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void *)(base + offsetof(QuadInstance, rect)));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void *)(base + offsetof(QuadInstance, color)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void *)(base + offsetof(QuadInstance, shape)));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void *)(base + offsetof(QuadInstance, uv)));
+}
+
+static void render_batch_draw_commands(RenderBatch *batch, RenderBatchProgram *program, QuadProgram *quad_program,
+                                       size_t vertex_base, size_t instance_base)
+{
+    // Bindings are left as they are at the end, the state tracker skips them on the next flush.
+    bool has_active = false;
+    RenderPipeline active = RENDER_PIPELINE_SHAPE;
+    for (size_t i = 0; i < batch->command_count; ++i)
+    {
+        const RenderBatchCommand *command = &batch->commands[i];
+
+        if (!has_active || active != command->pipeline)
+        {
+            if (command->pipeline == RENDER_PIPELINE_QUAD)
+            {
+                gl_state_use_program(quad_program->program);
+                gl_state_bind_vertex_array(batch->quad_vao);
+            }
+            else
+            {
+                gl_state_use_program(program->program);
+                gl_state_bind_vertex_array(batch->vao);
+            }
+            active = command->pipeline;
+            has_active = true;
+        }
+
+        if (command->pipeline == RENDER_PIPELINE_QUAD)
+        {
+            if (command->state.texture != 0)
+            {
+                gl_state_active_texture(GL_TEXTURE0 + RENDER_BATCH_TEXTURE_UNIT);
+                gl_state_bind_texture(GL_TEXTURE_2D_ARRAY, command->state.texture);
+            }
+            render_batch_point_instances(batch, instance_base + command->first);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, command->count);
+            batch->draw_calls++;
+            continue;
+        }
+
+        render_batch_apply_state(program, &command->state);
+        if (command->state.use_texture)
+        {
+            gl_state_active_texture(GL_TEXTURE0 + RENDER_BATCH_TEXTURE_UNIT);
+            gl_state_bind_texture(GL_TEXTURE_2D, command->state.texture);
+        }
+        glDrawArrays(command->state.mode, (GLint)vertex_base + command->first, command->count);
+        batch->draw_calls++;
+    }
+}
+
+/**
+ * Uploads the quad program's viewport, unless it already holds that size.
+ */
+static void render_batch_quad_viewport(QuadProgram *program, int width, int height)
+{
+    if (program->has_viewport && program->viewport_size[0] == width && program->viewport_size[1] == height)
+    {
+        gl_state_count(0, 1);
+        return;
+    }
+
+    glUniform2f(program->viewport, (float)width, (float)height);
+    program->viewport_size[0] = width;
+    program->viewport_size[1] = height;
+    program->has_viewport = true;
+    gl_state_count(1, 0);
+}
+
+void render_batch_flush(RenderBatch *batch, RenderBatchProgram *program, QuadProgram *quad_program,
+                        const DamageRegion *region)
+{
+    batch->draw_calls = 0;
+    if (batch->command_count == 0 && !batch->needs_clear)
+    {
+        render_batch_discard(batch);
+        return;
+    }
+
+    size_t vertex_base = 0;
+    size_t instance_base = 0;
+    if (batch->vertex_count > 0)
+        vertex_base = render_batch_stream_upload(&batch->vertex_stream, batch->vertices, batch->vertex_count);
+    if (batch->instance_count > 0)
+    {
+        instance_base = render_batch_stream_upload(&batch->instance_stream, batch->instances, batch->instance_count);
+        gl_state_use_program(quad_program->program);
+        render_batch_quad_viewport(quad_program, batch->width, batch->height);
+    }
+
+    // A partial region draws everything once per rectangle, the scissor discards what falls outside.
+    const bool partial = region && !region->full;
+    const int passes = partial ? region->count : 1;
+    gl_state_enable(GL_SCISSOR_TEST, partial);
+    for (int i = 0; i < passes; ++i)
+    {
+        if (partial)
+        {
+            const DamageRect *rect = &region->rects[i];
+            gl_state_scissor(rect->x, batch->height - (rect->y + rect->height), rect->width, rect->height);
+        }
+        if (batch->needs_clear)
+            glClear(GL_COLOR_BUFFER_BIT);
+        render_batch_draw_commands(batch, program, quad_program, vertex_base, instance_base);
+    }
+    // Clears elsewhere, like a headless window's first one, must reach every pixel.
+    gl_state_enable(GL_SCISSOR_TEST, false);
+
+    render_batch_discard(batch);
+}
+
+void render_batch_report_damage(const RenderBatch *batch, DamageTracker *tracker)
+{
+    for (size_t i = 0; i < batch->shape_count; ++i)
+    {
+        const RenderBatchPrimitive *shape = &batch->shapes[i];
+        const RenderBatchState *state = &batch->commands[shape->command].state;
+
+        // Field by field: padding inside the state is not guaranteed to be zeroed.
+        uint64_t hash = DAMAGE_HASH_SEED;
+        hash = damage_hash_bytes(hash, &state->mode, sizeof(state->mode));
+        hash = damage_hash_bytes(hash, &state->texture, sizeof(state->texture));
+        hash = damage_hash_bytes(hash, &state->shape_type, sizeof(state->shape_type));
+        hash = damage_hash_bytes(hash, &state->use_texture, sizeof(state->use_texture));
+        hash = damage_hash_bytes(hash, &state->is_rounded, sizeof(state->is_rounded));
+        hash = damage_hash_bytes(hash, &state->is_hollow, sizeof(state->is_hollow));
+        hash = damage_hash_bytes(hash, state->size, sizeof(state->size));
+        hash = damage_hash_bytes(hash, &state->radius, sizeof(state->radius));
+        hash = damage_hash_bytes(hash, &state->border_width, sizeof(state->border_width));
+
+        const Vertex *vertices = &batch->vertices[shape->first];
+        hash = damage_hash_bytes(hash, vertices, shape->count * sizeof(Vertex));
+
+        float min_x = vertices[0].pos[0], max_x = min_x;
+        float min_y = vertices[0].pos[1], max_y = min_y;
+        for (GLsizei v = 1; v < shape->count; ++v)
+        {
+            min_x = fminf(min_x, vertices[v].pos[0]);
+            max_x = fmaxf(max_x, vertices[v].pos[0]);
+            min_y = fminf(min_y, vertices[v].pos[1]);
+            max_y = fmaxf(max_y, vertices[v].pos[1]);
+        }
+
+        // Back from normalized device coordinates, y points down in window pixels.
+        damage_tracker_add(tracker, hash,
+                           (min_x + 1.0f) * 0.5f * batch->width, (1.0f - max_y) * 0.5f * batch->height,
+                           (max_x + 1.0f) * 0.5f * batch->width, (1.0f - min_y) * 0.5f * batch->height);
+    }
+
+    for (size_t i = 0; i < batch->instance_count; ++i)
+    {
+        const QuadInstance *instance = &batch->instances[i];
+        damage_tracker_add(tracker, damage_hash_bytes(DAMAGE_HASH_SEED, instance, sizeof(*instance)),
+                           instance->rect[0], instance->rect[1],
+                           instance->rect[0] + instance->rect[2], instance->rect[1] + instance->rect[3]);
+    }
+}
+
+void render_batch_begin_list(RenderBatch *batch, RenderBatchMark *mark)
+{
+    mark->vertex = batch->vertex_count;
+    mark->instance = batch->instance_count;
+    mark->command = batch->command_count;
+    mark->shape = batch->shape_count;
+    batch->merge_floor = batch->command_count;
+}
+
+static bool render_batch_copy_range(void **dst, const void *src, size_t count, size_t element_size)
+{
+    free(*dst);
+    *dst = NULL;
+    if (count == 0)
+        return true;
+
+    *dst = malloc(count * element_size);
+    if (!*dst)
+        return false;
+    memcpy(*dst, src, count * element_size);
+    return true;
+}
+
+bool render_batch_end_list(RenderBatch *batch, const RenderBatchMark *mark, RenderBatchList *list)
+{
+    // Later primitives may merge into the recorded commands again, the list has its own copy.
+    batch->merge_floor = 0;
+
+    list->vertex_count = batch->vertex_count - mark->vertex;
+    list->instance_count = batch->instance_count - mark->instance;
+    list->command_count = batch->command_count - mark->command;
+    list->shape_count = batch->shape_count - mark->shape;
+
+    bool copied = render_batch_copy_range((void **)&list->vertices, batch->vertices + mark->vertex,
+                                          list->vertex_count, sizeof(Vertex));
+    copied &= render_batch_copy_range((void **)&list->instances, batch->instances + mark->instance,
+                                      list->instance_count, sizeof(QuadInstance));
+    copied &= render_batch_copy_range((void **)&list->commands, batch->commands + mark->command,
+                                      list->command_count, sizeof(RenderBatchCommand));
+    copied &= render_batch_copy_range((void **)&list->shapes, batch->shapes + mark->shape,
+                                      list->shape_count, sizeof(RenderBatchPrimitive));
+    if (!copied)
+    {
+        LOG_ERROR("Failed to record display list");
+        render_batch_list_free(list);
+        return false;
+    }
+
+    for (size_t i = 0; i < list->command_count; ++i)
+    {
+        RenderBatchCommand *command = &list->commands[i];
+        command->first -= (GLint)(command->pipeline == RENDER_PIPELINE_QUAD ? mark->instance : mark->vertex);
+    }
+    for (size_t i = 0; i < list->shape_count; ++i)
+    {
+        list->shapes[i].command -= mark->command;
+        list->shapes[i].first -= (GLint)mark->vertex;
+    }
+    return true;
+}
+
+bool render_batch_append_list(RenderBatch *batch, const RenderBatchList *list)
+{
+    if (!render_batch_grow((void **)&batch->vertices, &batch->vertex_capacity, batch->vertex_count + list->vertex_count,
+                           RENDER_BATCH_INITIAL_VERTICES, sizeof(Vertex)) ||
+        !render_batch_grow((void **)&batch->instances, &batch->instance_capacity,
+                           batch->instance_count + list->instance_count, RENDER_BATCH_INITIAL_INSTANCES,
+                           sizeof(QuadInstance)) ||
+        !render_batch_grow((void **)&batch->commands, &batch->command_capacity,
+                           batch->command_count + list->command_count, 64, sizeof(RenderBatchCommand)) ||
+        !render_batch_grow((void **)&batch->shapes, &batch->shape_capacity, batch->shape_count + list->shape_count,
+                           64, sizeof(RenderBatchPrimitive)))
+        return false;
+
+    const size_t vertex_base = batch->vertex_count;
+    const size_t instance_base = batch->instance_count;
+    // Index in the batch every list command ended up in, merged or not.
+    size_t command_base = batch->command_count;
+
+    for (size_t i = 0; i < list->command_count; ++i)
+    {
+        const RenderBatchCommand *command = &list->commands[i];
+        RenderBatchCommand *last = i == 0 ? render_batch_open_command(batch) : NULL;
+        const bool merge = last && (command->pipeline == RENDER_PIPELINE_QUAD
+                                        ? render_batch_can_merge_quad(last, command->state.texture)
+                                        : render_batch_can_merge_shape(last, &command->state));
+        if (merge)
+        {
+            if (command->state.texture != 0)
+                last->state.texture = command->state.texture;
+            last->count += command->count;
+            command_base--;
+            continue;
+        }
+
+        RenderBatchCommand *appended = &batch->commands[batch->command_count++];
+        *appended = *command;
+        appended->first += (GLint)(command->pipeline == RENDER_PIPELINE_QUAD ? instance_base : vertex_base);
+    }
+
+    for (size_t i = 0; i < list->shape_count; ++i)
+    {
+        RenderBatchPrimitive *shape = &batch->shapes[batch->shape_count++];
+        *shape = list->shapes[i];
+        shape->command += command_base;
+        shape->first += (GLint)vertex_base;
+    }
+
+    memcpy(batch->vertices + vertex_base, list->vertices, list->vertex_count * sizeof(Vertex));
+    memcpy(batch->instances + instance_base, list->instances, list->instance_count * sizeof(QuadInstance));
+    batch->vertex_count += list->vertex_count;
+    batch->instance_count += list->instance_count;
+    batch->primitives += list->shape_count + list->instance_count;
+    return true;
+}
+
+void render_batch_list_free(RenderBatchList *list)
+{
+    free(list->vertices);
+    free(list->instances);
+    free(list->commands);
+    free(list->shapes);
+    memset(list, 0, sizeof(*list));
+}
+
+void render_batch_truncate(RenderBatch *batch, const RenderBatchMark *mark)
+{
+    // Nothing merged across the mark since it was taken, so the counts alone cut the batch back.
+    batch->merge_floor = 0;
+    batch->vertex_count = mark->vertex;
+    batch->instance_count = mark->instance;
+    batch->command_count = mark->command;
+    batch->shape_count = mark->shape;
+}
+
+void render_batch_discard(RenderBatch *batch)
+{
+    batch->merge_floor = 0;
+    batch->needs_clear = false;
+    batch->shape_count = 0;
+    batch->vertex_count = 0;
+    batch->instance_count = 0;
+    batch->command_count = 0;
+    batch->primitives = 0;
+}
+
+#endif
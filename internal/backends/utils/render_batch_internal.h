@@ -0,0 +1,284 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file render_batch_internal.h
+ * @brief Per-window vertex stream used to batch GL primitives.
+ *
+ * Primitives are appended on the CPU together with the shape-shader state
+ * they need. Consecutive primitives sharing the same state are merged into a
+ * single draw command; the whole stream is uploaded and submitted in one go
+ * when the batch is flushed (on render, or when the caller needs the GL
+ * state to be up to date).
+ *
+ * Rectangles, rounded rectangles, borders and glyphs take the instanced
+ * quad pipeline instead: one QuadInstance each, all of them drawn by a
+ * single instanced call until another pipeline or texture is interleaved.
+ */
+
+#ifndef RENDER_BATCH_INTERNAL_H
+#define RENDER_BATCH_INTERNAL_H
+
+#include "backends/utils/backend_utils_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/damage_tracker_internal.h"
+
+/** Number of vertices a stream buffer is created with, it grows on demand. */
+#define RENDER_BATCH_INITIAL_VERTICES 4096
+
+/** Number of quad instances a stream buffer is created with, it grows on demand. */
+#define RENDER_BATCH_INITIAL_INSTANCES 1024
+
+/** Uniforms of the shape program set from a RenderBatchState. */
+#define RENDER_BATCH_UNIFORMS 7
+
+/** Texture unit the shape program samples images from, and the quad program its atlas. */
+#define RENDER_BATCH_TEXTURE_UNIT 1
+
+typedef enum
+{
+    RENDER_PIPELINE_SHAPE, /**< Vertex stream drawn with the legacy shape program. */
+    RENDER_PIPELINE_QUAD   /**< Instanced SDF quads. */
+} RenderPipeline;
+
+/**
+ * @brief One instance of the quad pipeline, everything in pixels.
+ */
+typedef struct
+{
+    float rect[4];  /**< x, y, width, height. */
+    float color[4]; /**< rgba. */
+    float shape[4]; /**< corner radius, border width (0 fills the quad), kind, atlas page; arcs: start, sweep, kind, thickness. */
+    float uv[4];    /**< Texture rectangle sampled by glyphs: u0, v0, u1, v1. */
+} QuadInstance;
+
+/** Values of QuadInstance::shape[2]. */
+#define QUAD_KIND_SHAPE 0.0f
+#define QUAD_KIND_GLYPH 1.0f
+#define QUAD_KIND_SDF_GLYPH 2.0f
+#define QUAD_KIND_ARC 3.0f
+
+/**
+ * @brief Shape-shader state a run of vertices is drawn with.
+ *
+ * Two primitives end up in the same draw call only if their states compare
+ * equal, so fields the shader ignores for a given shape must be left zeroed.
+ */
+typedef struct
+{
+    GLenum mode;
+    GLuint texture;
+    int shape_type;
+    bool use_texture;
+    bool is_rounded;
+    bool is_hollow;
+    float size[2];
+    float radius;
+    float border_width;
+} RenderBatchState;
+
+typedef struct
+{
+    RenderPipeline pipeline;
+    RenderBatchState state; /**< Quads only use texture, shapes use all of it. */
+    GLint first;            /**< First vertex, or first instance for quads. */
+    GLsizei count;
+} RenderBatchCommand;
+
+/**
+ * @brief Shape program with its uniform locations resolved once at link time.
+ */
+typedef struct
+{
+    GLuint program;
+    GLint use_texture;
+    GLint tex;
+    GLint size;
+    GLint radius;
+    GLint border_width;
+    GLint is_rounded;
+    GLint is_hollow;
+    GLint shape_type;
+    RenderBatchState current; /**< Uniform values last uploaded. */
+    bool has_current;
+} RenderBatchProgram;
+
+typedef struct
+{
+    GLuint program;
+    GLint viewport;
+    GLint atlas;
+    int viewport_size[2]; /**< Viewport uniform last uploaded. */
+    bool has_viewport;
+} QuadProgram;
+
+/**
+ * @brief GL buffer written as a ring, orphaned whenever it wraps.
+ */
+typedef struct
+{
+    GLuint vbo;
+    size_t capacity; /**< In elements. */
+    size_t offset;   /**< Next free element. */
+    size_t stride;
+} RenderBatchStream;
+
+/**
+ * @brief One render_batch_push() call, kept so damage can be reported per primitive after runs merge.
+ */
+typedef struct
+{
+    size_t command;
+    GLint first;
+    GLsizei count;
+} RenderBatchPrimitive;
+
+typedef struct
+{
+    Vertex *vertices;
+    size_t vertex_count;
+    size_t vertex_capacity;
+    QuadInstance *instances;
+    size_t instance_count;
+    size_t instance_capacity;
+    RenderBatchCommand *commands;
+    size_t command_count;
+    size_t command_capacity;
+    RenderBatchPrimitive *shapes;
+    size_t shape_count;
+    size_t shape_capacity;
+    RenderBatchStream vertex_stream;
+    RenderBatchStream instance_stream;
+    GLuint vao;
+    GLuint quad_vao;
+    int width;
+    int height;
+    size_t draw_calls;   /**< Draw calls issued by the last flush. */
+    size_t primitives;   /**< Primitives appended since the last flush. */
+    size_t merge_floor;  /**< Commands below this index are closed, new primitives never merge into them. */
+    bool needs_clear;    /**< The next flush clears what it draws into first. */
+} RenderBatch;
+
+/**
+ * @brief Primitives lifted out of a batch so they can be appended again in later frames.
+ *
+ * Command and primitive offsets are relative to the list, shape vertices
+ * stay in normalized device coordinates of the viewport they were recorded at.
+ */
+typedef struct
+{
+    Vertex *vertices;
+    size_t vertex_count;
+    QuadInstance *instances;
+    size_t instance_count;
+    RenderBatchCommand *commands;
+    size_t command_count;
+    RenderBatchPrimitive *shapes;
+    size_t shape_count;
+} RenderBatchList;
+
+/**
+ * @brief Position in a batch a recording starts from.
+ */
+typedef struct
+{
+    size_t vertex;
+    size_t instance;
+    size_t command;
+    size_t shape;
+} RenderBatchMark;
+
+void render_batch_program_init(RenderBatchProgram *program, GLuint gl_program);
+void render_batch_quad_program_init(QuadProgram *program, GLuint gl_program);
+
+/**
+ * @brief Creates the stream buffer and VAO, the window's context must be current.
+ */
+void render_batch_init(RenderBatch *batch, int width, int height);
+void render_batch_destroy(RenderBatch *batch);
+void render_batch_set_viewport(RenderBatch *batch, int width, int height);
+
+/**
+ * @brief Reserves @p count vertices drawn with @p state.
+ *
+ * @return Pointer the caller fills with exactly @p count vertices, or NULL on allocation failure.
+ */
+Vertex *render_batch_push(RenderBatch *batch, const RenderBatchState *state, size_t count);
+
+/**
+ * @brief Reserves one quad instance, zeroed, for the caller to fill.
+ *
+ * @param texture GL_TEXTURE_2D_ARRAY the instance samples, 0 when it samples none.
+ * @return The instance, or NULL on allocation failure.
+ */
+QuadInstance *render_batch_push_quad(RenderBatch *batch, GLuint texture);
+
+/**
+ * @brief Uploads pending vertices and instances and issues one draw per state change.
+ *
+ * With a partial @p region the batch is drawn once per rectangle, scissored
+ * to it, so pixels outside of the region are neither cleared nor touched.
+ * The window's context must be current.
+ *
+ * @param region Rectangles to draw into, NULL or full for the whole window.
+ */
+void render_batch_flush(RenderBatch *batch, RenderBatchProgram *program, QuadProgram *quad_program,
+                        const DamageRegion *region);
+
+/**
+ * @brief Reports every pending primitive to @p tracker, call it before flushing.
+ */
+void render_batch_report_damage(const RenderBatch *batch, DamageTracker *tracker);
+
+/**
+ * @brief Starts recording, primitives pushed from now on do not merge into earlier commands.
+ */
+void render_batch_begin_list(RenderBatch *batch, RenderBatchMark *mark);
+
+/**
+ * @brief Copies everything pushed since @p mark into @p list, replacing its previous content.
+ *
+ * The primitives stay in the batch and are drawn this frame as usual.
+ *
+ * @return false on allocation failure, @p list is then left empty.
+ */
+bool render_batch_end_list(RenderBatch *batch, const RenderBatchMark *mark, RenderBatchList *list);
+
+/**
+ * @brief Appends a recorded list, merging its first command into the batch's last one when they are compatible.
+ */
+bool render_batch_append_list(RenderBatch *batch, const RenderBatchList *list);
+void render_batch_list_free(RenderBatchList *list);
+
+/**
+ * @brief Drops everything pushed since @p mark, the mark must come from render_batch_begin_list().
+ */
+void render_batch_truncate(RenderBatch *batch, const RenderBatchMark *mark);
+
+/**
+ * @brief Drops pending vertices without drawing them.
+ */
+void render_batch_discard(RenderBatch *batch);
+
+static inline void render_batch_to_ndc(const RenderBatch *batch, float x, float y, float *ndc_x, float *ndc_y)
+{
+    *ndc_x = (2.0f * x / batch->width) - 1.0f;
+    *ndc_y = 1.0f - (2.0f * y / batch->height);
+}
+
+#endif
+#endif // RENDER_BATCH_INTERNAL_H
@@ -0,0 +1,360 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "render_workers_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static _Thread_local bool on_worker;
+
+bool render_workers_on_worker(void)
+{
+    return on_worker;
+}
+
+/**
+ * Takes the oldest call, with the lock held. The caller runs it without the lock.
+ */
+static RenderWorkerCall *render_workers_next_call(RenderWorkers *workers)
+{
+    RenderWorkerCall *call = workers->calls;
+    if (call)
+    {
+        workers->calls = call->next;
+        if (!workers->calls)
+            workers->calls_tail = NULL;
+    }
+    return call;
+}
+
+/**
+ * Runs @p call on the main thread, the lock is dropped meanwhile and held again on return.
+ */
+static void render_workers_run_call(RenderWorkers *workers, RenderWorkerCall *call)
+{
+    pthread_mutex_unlock(&workers->lock);
+    pthread_mutex_lock(&workers->state_lock);
+    call->run(call->args);
+    pthread_mutex_unlock(&workers->state_lock);
+    pthread_mutex_lock(&workers->lock);
+
+    // The caller returns as soon as it sees this, call is gone after the broadcast.
+    call->done = true;
+    pthread_cond_broadcast(&workers->changed);
+}
+
+/**
+ * Waits on changed until @p time_ms at the latest, with the lock held.
+ */
+static void render_workers_wait_until(RenderWorkers *workers, uint64_t time_ms)
+{
+    // changed measures time on the monotonic clock, as event_loop_now_ms() does.
+    struct timespec deadline = {.tv_sec = (time_t)(time_ms / 1000), .tv_nsec = (long)(time_ms % 1000) * 1000000};
+    pthread_cond_timedwait(&workers->changed, &workers->lock, &deadline);
+}
+
+static void *render_workers_thread(void *data)
+{
+    RenderWorker *worker = data;
+    RenderWorkers *workers = worker->owner;
+    on_worker = true;
+
+    pthread_mutex_lock(&workers->lock);
+    for (;;)
+    {
+        while (!worker->stopping && (workers->paused || (!worker->pass_pending && worker->input_count == 0)))
+            pthread_cond_wait(&workers->changed, &workers->lock);
+        if (worker->stopping)
+            break;
+        if (event_loop_now_ms() < worker->not_before_ms)
+        {
+            render_workers_wait_until(workers, worker->not_before_ms);
+            continue;
+        }
+
+        // Input arriving from here on is handled by the next pass.
+        RenderWorkerInput *inputs = worker->inputs;
+        const size_t count = worker->input_count;
+        const size_t capacity = worker->input_capacity;
+        worker->inputs = worker->taken;
+        worker->input_capacity = worker->taken_capacity;
+        worker->input_count = 0;
+        worker->taken = inputs;
+        worker->taken_capacity = capacity;
+        worker->pass_pending = false;
+        workers->busy++;
+        pthread_mutex_unlock(&workers->lock);
+
+        if (count == 0)
+            workers->pass(worker->window_id, NULL, workers->data);
+        for (size_t i = 0; i < count; ++i)
+            workers->pass(worker->window_id, &inputs[i], workers->data);
+
+        pthread_mutex_lock(&workers->lock);
+        workers->busy--;
+        pthread_cond_broadcast(&workers->changed);
+    }
+    worker->exited = true;
+    workers->alive--;
+    pthread_cond_broadcast(&workers->changed);
+    pthread_mutex_unlock(&workers->lock);
+    return NULL;
+}
+
+bool render_workers_init(RenderWorkers *workers, size_t capacity,
+                         void (*pass)(size_t window_id, const RenderWorkerInput *input, void *data), void *data,
+                         EventLoop *loop)
+{
+    memset(workers, 0, sizeof(*workers));
+    workers->workers = calloc(capacity, sizeof(RenderWorker));
+    if (!workers->workers)
+    {
+        LOG_ERROR("Failed to allocate window workers");
+        return false;
+    }
+    pthread_mutex_init(&workers->lock, NULL);
+    pthread_condattr_t condition_attributes;
+    pthread_condattr_init(&condition_attributes);
+    pthread_condattr_setclock(&condition_attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&workers->changed, &condition_attributes);
+    pthread_condattr_destroy(&condition_attributes);
+    // Recursive: drawing a cached layer draws an image, both take it.
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&workers->state_lock, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    workers->capacity = capacity;
+    workers->pass = pass;
+    workers->data = data;
+    workers->loop = loop;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        workers->workers[i].owner = workers;
+        workers->workers[i].window_id = i;
+    }
+    return true;
+}
+
+void render_workers_destroy(RenderWorkers *workers)
+{
+    if (!workers->workers)
+        return;
+
+    pthread_mutex_lock(&workers->lock);
+    for (size_t i = 0; i < workers->capacity; ++i)
+        workers->workers[i].stopping = true;
+    workers->paused = false;
+    pthread_cond_broadcast(&workers->changed);
+
+    // A worker may be waiting on a call, it can only finish its pass once that ran.
+    while (workers->alive > 0)
+    {
+        RenderWorkerCall *call = render_workers_next_call(workers);
+        if (call)
+            render_workers_run_call(workers, call);
+        else
+            pthread_cond_wait(&workers->changed, &workers->lock);
+    }
+    pthread_mutex_unlock(&workers->lock);
+
+    for (size_t i = 0; i < workers->capacity; ++i)
+    {
+        RenderWorker *worker = &workers->workers[i];
+        if (worker->started)
+            pthread_join(worker->thread, NULL);
+        free(worker->inputs);
+        free(worker->taken);
+    }
+    free(workers->workers);
+    workers->workers = NULL;
+    workers->capacity = 0;
+    pthread_cond_destroy(&workers->changed);
+    pthread_mutex_destroy(&workers->lock);
+    pthread_mutex_destroy(&workers->state_lock);
+}
+
+bool render_workers_start(RenderWorkers *workers, size_t window_id)
+{
+    if (window_id >= workers->capacity)
+        return false;
+
+    RenderWorker *worker = &workers->workers[window_id];
+    pthread_mutex_lock(&workers->lock);
+    if (worker->started && !worker->exited)
+    {
+        // Asked to stop and not there yet: a window reusing the id keeps the thread.
+        worker->stopping = false;
+        pthread_mutex_unlock(&workers->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&workers->lock);
+
+    if (worker->started)
+        pthread_join(worker->thread, NULL);
+
+    pthread_mutex_lock(&workers->lock);
+    worker->started = false;
+    worker->stopping = false;
+    worker->exited = false;
+    worker->input_count = 0;
+    worker->pass_pending = true;
+    worker->not_before_ms = 0;
+    if (pthread_create(&worker->thread, NULL, render_workers_thread, worker) != 0)
+    {
+        pthread_mutex_unlock(&workers->lock);
+        LOG_ERROR("Failed to start the thread of window %zu", window_id);
+        return false;
+    }
+    worker->started = true;
+    workers->alive++;
+    pthread_mutex_unlock(&workers->lock);
+    return true;
+}
+
+void render_workers_stop(RenderWorkers *workers, size_t window_id)
+{
+    if (window_id >= workers->capacity)
+        return;
+
+    pthread_mutex_lock(&workers->lock);
+    workers->workers[window_id].stopping = true;
+    pthread_cond_broadcast(&workers->changed);
+    pthread_mutex_unlock(&workers->lock);
+}
+
+void render_workers_defer(RenderWorkers *workers, size_t window_id, uint64_t time_ms)
+{
+    if (window_id >= workers->capacity)
+        return;
+
+    pthread_mutex_lock(&workers->lock);
+    workers->workers[window_id].not_before_ms = time_ms;
+    pthread_mutex_unlock(&workers->lock);
+}
+
+void render_workers_post(RenderWorkers *workers, size_t window_id, const RenderWorkerInput *input)
+{
+    if (window_id >= workers->capacity)
+        return;
+
+    RenderWorker *worker = &workers->workers[window_id];
+    pthread_mutex_lock(&workers->lock);
+    worker->pass_pending = true;
+    if (input)
+    {
+        RenderWorkerInput *last = worker->input_count ? &worker->inputs[worker->input_count - 1] : NULL;
+        if (last && last->event.type == GOOEY_EVENT_MOUSE_MOVE && input->event.type == GOOEY_EVENT_MOUSE_MOVE)
+        {
+            *last = *input;
+        }
+        else if (last && last->event.type == GOOEY_EVENT_REDRAWREQ && input->event.type == GOOEY_EVENT_REDRAWREQ)
+        {
+            // Already asked for, one frame shows both.
+        }
+        else
+        {
+            if (worker->input_count == worker->input_capacity)
+            {
+                const size_t capacity = worker->input_capacity ? worker->input_capacity * 2 : 16;
+                RenderWorkerInput *inputs = realloc(worker->inputs, capacity * sizeof(RenderWorkerInput));
+                if (inputs)
+                {
+                    worker->inputs = inputs;
+                    worker->input_capacity = capacity;
+                }
+            }
+            if (worker->input_count < worker->input_capacity)
+                worker->inputs[worker->input_count++] = *input;
+            else
+                LOG_ERROR("Failed to queue input for window %zu", window_id);
+        }
+    }
+    pthread_cond_broadcast(&workers->changed);
+    pthread_mutex_unlock(&workers->lock);
+}
+
+void render_workers_call(RenderWorkers *workers, void (*run)(void *args), void *args)
+{
+    if (!on_worker)
+    {
+        run(args);
+        return;
+    }
+
+    RenderWorkerCall call = {.run = run, .args = args};
+    pthread_mutex_lock(&workers->lock);
+    if (workers->calls_tail)
+        workers->calls_tail->next = &call;
+    else
+        workers->calls = &call;
+    workers->calls_tail = &call;
+    pthread_cond_broadcast(&workers->changed);
+    pthread_mutex_unlock(&workers->lock);
+
+    // The main thread may be asleep in the event loop rather than waiting on changed.
+    event_loop_wake(workers->loop);
+
+    pthread_mutex_lock(&workers->lock);
+    while (!call.done)
+        pthread_cond_wait(&workers->changed, &workers->lock);
+    pthread_mutex_unlock(&workers->lock);
+}
+
+void render_workers_service(RenderWorkers *workers)
+{
+    pthread_mutex_lock(&workers->lock);
+    RenderWorkerCall *call;
+    while ((call = render_workers_next_call(workers)))
+        render_workers_run_call(workers, call);
+    pthread_mutex_unlock(&workers->lock);
+}
+
+void render_workers_pause(RenderWorkers *workers)
+{
+    pthread_mutex_lock(&workers->lock);
+    workers->paused = true;
+    while (workers->busy > 0)
+    {
+        RenderWorkerCall *call = render_workers_next_call(workers);
+        if (call)
+            render_workers_run_call(workers, call);
+        else
+            pthread_cond_wait(&workers->changed, &workers->lock);
+    }
+    pthread_mutex_unlock(&workers->lock);
+}
+
+void render_workers_resume(RenderWorkers *workers)
+{
+    pthread_mutex_lock(&workers->lock);
+    workers->paused = false;
+    pthread_cond_broadcast(&workers->changed);
+    pthread_mutex_unlock(&workers->lock);
+}
+
+void render_workers_lock_state(RenderWorkers *workers)
+{
+    pthread_mutex_lock(&workers->state_lock);
+}
+
+void render_workers_unlock_state(RenderWorkers *workers)
+{
+    pthread_mutex_unlock(&workers->state_lock);
+}
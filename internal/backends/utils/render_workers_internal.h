@@ -0,0 +1,253 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file render_workers_internal.h
+ * @brief One thread per window handling its input and building its frames.
+ *
+ * Each window gets a worker with its own queue of input: the window system
+ * callbacks and redraw requests post to it from any thread, and the worker
+ * runs a pass of the window for each input, or a single one for a bare
+ * tick. Windows are thus paced independently, a slow window only delays
+ * its own frames.
+ *
+ * GL contexts stay on the thread that created them, the one calling
+ * render_workers_service(). Whatever a worker cannot do itself it hands to
+ * that thread with render_workers_call(), and waits for it: clearing and
+ * presenting frames, texture uploads, window system calls. Every submission
+ * is so serialized on one thread while the draw lists are built in parallel.
+ *
+ * Backend state shared between windows is guarded by the state lock: workers
+ * take it around what they read or change of it, and calls handed to the
+ * main thread run with it held.
+ */
+
+#ifndef RENDER_WORKERS_INTERNAL_H
+#define RENDER_WORKERS_INTERNAL_H
+
+#include "common/gooey_common.h"
+#include "backends/utils/event_loop_internal.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Input waiting for a window's worker.
+ */
+typedef struct
+{
+    GooeyEvent event;
+    int width, height; /**< New size of the window, for GOOEY_EVENT_RESIZE. */
+} RenderWorkerInput;
+
+typedef struct RenderWorkerCall RenderWorkerCall;
+
+struct RenderWorkerCall
+{
+    RenderWorkerCall *next;
+    void (*run)(void *args);
+    void *args;
+    bool done;
+};
+
+typedef struct RenderWorkers RenderWorkers;
+
+typedef struct
+{
+    RenderWorkers *owner;
+    size_t window_id;
+    pthread_t thread;
+    bool started;  /**< thread was created and is not joined yet. */
+    bool stopping; /**< Asked to exit once its current pass is done. */
+    bool exited;
+    bool pass_pending; /**< A tick arrived, the window gets a pass even without input. */
+    uint64_t not_before_ms; /**< No pass starts earlier, see render_workers_defer(). */
+    RenderWorkerInput *inputs;
+    size_t input_count;
+    size_t input_capacity;
+    RenderWorkerInput *taken; /**< Inputs being handled, swapped with inputs so neither is reallocated per pass. */
+    size_t taken_capacity;
+} RenderWorker;
+
+struct RenderWorkers
+{
+    pthread_mutex_t lock; /**< Guards the queues, the calls and the pause. */
+    pthread_cond_t changed;
+    pthread_mutex_t state_lock; /**< Recursive. */
+    RenderWorker *workers; /**< Indexed by window id. */
+    size_t capacity;
+    RenderWorkerCall *calls, *calls_tail; /**< Waiting for the main thread, oldest first. */
+    size_t busy;   /**< Workers in the middle of a pass. */
+    size_t alive;  /**< Workers started and not exited. */
+    bool paused;   /**< No pass starts until render_workers_resume(). */
+    void (*pass)(size_t window_id, const RenderWorkerInput *input, void *data); /**< input is NULL for a tick. */
+    void *data;
+    EventLoop *loop; /**< Woken when a call is queued. */
+};
+
+/**
+ * @brief Sets up room for @p capacity windows, no thread starts yet.
+ *
+ * @param pass Handles one input of a window, or runs a bare pass, on its worker.
+ * @param loop Event loop the main thread sleeps in.
+ */
+bool render_workers_init(RenderWorkers *workers, size_t capacity,
+                         void (*pass)(size_t window_id, const RenderWorkerInput *input, void *data), void *data,
+                         EventLoop *loop);
+
+/**
+ * @brief Stops and joins every worker, running the calls they make until then. Main thread only.
+ */
+void render_workers_destroy(RenderWorkers *workers);
+
+/**
+ * @brief Starts the worker of @p window_id, nothing happens when it runs already.
+ */
+bool render_workers_start(RenderWorkers *workers, size_t window_id);
+
+/**
+ * @brief Makes the worker of @p window_id exit after its current pass, it is joined by render_workers_destroy().
+ */
+void render_workers_stop(RenderWorkers *workers, size_t window_id);
+
+/**
+ * @brief Queues @p input for the window, or a tick when NULL, safe from any thread.
+ *
+ * Consecutive pointer moves are merged, only the last position is handled,
+ * and so are consecutive redraw requests.
+ */
+void render_workers_post(RenderWorkers *workers, size_t window_id, const RenderWorkerInput *input);
+
+/**
+ * @brief Holds the next pass of @p window_id back until @p time_ms, an event_loop_now_ms() time.
+ *
+ * Input keeps queueing meanwhile and is handled by that pass. The pause
+ * does not wait for a pass held back, none is in progress.
+ */
+void render_workers_defer(RenderWorkers *workers, size_t window_id, uint64_t time_ms);
+
+/**
+ * @brief Whether the calling thread is a window's worker.
+ */
+bool render_workers_on_worker(void);
+
+/**
+ * @brief Runs @p run on the main thread with the state lock held, and returns once it did.
+ *
+ * Called from the main thread it runs right away. A worker must not hold
+ * the state lock when calling it.
+ */
+void render_workers_call(RenderWorkers *workers, void (*run)(void *args), void *args);
+
+// Applies m to each (type, name) pair, separated by sep(); up to 8 pairs.
+#define RENDER_WORKERS_EACH(m, sep, ...)                                                                            \
+    RENDER_WORKERS_EACH_N(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1)(m, sep, __VA_ARGS__)
+#define RENDER_WORKERS_EACH_N(_1, _2, _3, _4, _5, _6, _7, _8, n, ...) RENDER_WORKERS_EACH_##n
+#define RENDER_WORKERS_EACH_1(m, sep, a) m a
+#define RENDER_WORKERS_EACH_2(m, sep, a, ...) m a sep() RENDER_WORKERS_EACH_1(m, sep, __VA_ARGS__)
+#define RENDER_WORKERS_EACH_3(m, sep, a, ...) m a sep() RENDER_WORKERS_EACH_2(m, sep, __VA_ARGS__)
+#define RENDER_WORKERS_EACH_4(m, sep, a, ...) m a sep() RENDER_WORKERS_EACH_3(m, sep, __VA_ARGS__)
+#define RENDER_WORKERS_EACH_5(m, sep, a, ...) m a sep() RENDER_WORKERS_EACH_4(m, sep, __VA_ARGS__)
+#define RENDER_WORKERS_EACH_6(m, sep, a, ...) m a sep() RENDER_WORKERS_EACH_5(m, sep, __VA_ARGS__)
+#define RENDER_WORKERS_EACH_7(m, sep, a, ...) m a sep() RENDER_WORKERS_EACH_6(m, sep, __VA_ARGS__)
+#define RENDER_WORKERS_EACH_8(m, sep, a, ...) m a sep() RENDER_WORKERS_EACH_7(m, sep, __VA_ARGS__)
+#define RENDER_WORKERS_COMMA() ,
+#define RENDER_WORKERS_SEMICOLON() ;
+#define RENDER_WORKERS_PARAM(type, name) __typeof__(type) name
+#define RENDER_WORKERS_NAME(type, name) name
+#define RENDER_WORKERS_ARG(type, name) call->name
+
+/**
+ * @brief Defines name##_on_main_thread(), which hands a call of @p name to
+ * the main thread with render_workers_call() and returns its result.
+ *
+ * Placed before the definition of @p name, whose parameters follow as
+ * (type, name) pairs. The function then starts with
+ *
+ *     if (render_workers_on_worker())
+ *         return name_on_main_thread(its arguments);
+ *
+ * and runs again on the main thread, where render_workers_on_worker() is false.
+ */
+#define RENDER_WORKERS_FORWARD(workers, type, name, ...)                                                            \
+    type name(RENDER_WORKERS_EACH(RENDER_WORKERS_PARAM, RENDER_WORKERS_COMMA, __VA_ARGS__));                        \
+    typedef struct                                                                                                  \
+    {                                                                                                               \
+        RENDER_WORKERS_EACH(RENDER_WORKERS_PARAM, RENDER_WORKERS_SEMICOLON, __VA_ARGS__);                           \
+        type result;                                                                                                \
+    } name##_call;                                                                                                  \
+    static void name##_task(void *args)                                                                             \
+    {                                                                                                               \
+        name##_call *call = args;                                                                                   \
+        call->result = name(RENDER_WORKERS_EACH(RENDER_WORKERS_ARG, RENDER_WORKERS_COMMA, __VA_ARGS__));            \
+    }                                                                                                               \
+    static type name##_on_main_thread(RENDER_WORKERS_EACH(RENDER_WORKERS_PARAM, RENDER_WORKERS_COMMA, __VA_ARGS__)) \
+    {                                                                                                               \
+        name##_call call = {RENDER_WORKERS_EACH(RENDER_WORKERS_NAME, RENDER_WORKERS_COMMA, __VA_ARGS__), 0};        \
+        render_workers_call(workers, name##_task, &call);                                                           \
+        return call.result;                                                                                         \
+    }
+
+/**
+ * @brief RENDER_WORKERS_FORWARD() for a function returning nothing, started with
+ *
+ *     if (render_workers_on_worker())
+ *     {
+ *         name_on_main_thread(its arguments);
+ *         return;
+ *     }
+ */
+#define RENDER_WORKERS_FORWARD_VOID(workers, name, ...)                                                             \
+    void name(RENDER_WORKERS_EACH(RENDER_WORKERS_PARAM, RENDER_WORKERS_COMMA, __VA_ARGS__));                        \
+    typedef struct                                                                                                  \
+    {                                                                                                               \
+        RENDER_WORKERS_EACH(RENDER_WORKERS_PARAM, RENDER_WORKERS_SEMICOLON, __VA_ARGS__);                           \
+    } name##_call;                                                                                                  \
+    static void name##_task(void *args)                                                                             \
+    {                                                                                                               \
+        name##_call *call = args;                                                                                   \
+        name(RENDER_WORKERS_EACH(RENDER_WORKERS_ARG, RENDER_WORKERS_COMMA, __VA_ARGS__));                           \
+    }                                                                                                               \
+    static void name##_on_main_thread(RENDER_WORKERS_EACH(RENDER_WORKERS_PARAM, RENDER_WORKERS_COMMA, __VA_ARGS__)) \
+    {                                                                                                               \
+        name##_call call = {RENDER_WORKERS_EACH(RENDER_WORKERS_NAME, RENDER_WORKERS_COMMA, __VA_ARGS__)};           \
+        render_workers_call(workers, name##_task, &call);                                                           \
+    }
+
+/**
+ * @brief Runs the calls workers are waiting on. Main thread only.
+ */
+void render_workers_service(RenderWorkers *workers);
+
+/**
+ * @brief Waits for every pass in progress to end, and holds new ones back.
+ *
+ * Calls made by the passes still running are served meanwhile. Until
+ * render_workers_resume() the main thread owns every window, as it does
+ * without workers.
+ */
+void render_workers_pause(RenderWorkers *workers);
+void render_workers_resume(RenderWorkers *workers);
+
+/**
+ * @brief Guards backend state shared between windows, only workers need it.
+ */
+void render_workers_lock_state(RenderWorkers *workers);
+void render_workers_unlock_state(RenderWorkers *workers);
+
+#endif // RENDER_WORKERS_INTERNAL_H
@@ -0,0 +1,373 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/soft_output_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+#endif
+
+#define SOFT_OUTPUT_DEFAULT_DEVICE "/dev/fb0"
+#define SOFT_OUTPUT_SHM_DIR "/dev/shm/"
+
+/**
+ * Maps the framebuffer device at output->path.
+ *
+ * @param quiet Says nothing when the device does not open, for the default one.
+ */
+static bool soft_output_open_fbdev(SoftOutput *output, bool quiet)
+{
+#ifdef __linux__
+    const int fd = open(output->path, O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (!quiet)
+            LOG_ERROR("Failed to open %s", output->path);
+        return false;
+    }
+
+    struct fb_var_screeninfo var;
+    struct fb_fix_screeninfo fix;
+    if (ioctl(fd, FBIOGET_VSCREENINFO, &var) != 0 || ioctl(fd, FBIOGET_FSCREENINFO, &fix) != 0)
+    {
+        LOG_ERROR("%s is not a framebuffer device", output->path);
+        close(fd);
+        return false;
+    }
+    if (var.bits_per_pixel != 16 && var.bits_per_pixel != 32)
+    {
+        LOG_ERROR("%s has %u bits per pixel, only 16 and 32 are supported", output->path, var.bits_per_pixel);
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, fix.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        LOG_ERROR("Failed to map %s", output->path);
+        close(fd);
+        return false;
+    }
+
+    output->row565 = var.bits_per_pixel == 16 ? (uint16_t *)malloc(var.xres * sizeof(uint16_t)) : NULL;
+    if (var.bits_per_pixel == 16 && !output->row565)
+    {
+        munmap(map, fix.smem_len);
+        close(fd);
+        return false;
+    }
+
+    output->fb_fd = fd;
+    output->fb_map = (unsigned char *)map;
+    output->fb_size = fix.smem_len;
+    output->fb_pixels = output->fb_map + (size_t)var.yoffset * fix.line_length + var.xoffset * (var.bits_per_pixel / 8);
+    output->fb_width = (int)var.xres;
+    output->fb_height = (int)var.yres;
+    output->fb_line_length = (int)fix.line_length;
+    output->fb_bits_per_pixel = (int)var.bits_per_pixel;
+    output->fb_red_offset = (int)var.red.offset;
+    output->fb_green_offset = (int)var.green.offset;
+    output->fb_blue_offset = (int)var.blue.offset;
+    LOG_INFO("Drawing to %s, %dx%d at %d bits per pixel", output->path, output->fb_width, output->fb_height,
+             output->fb_bits_per_pixel);
+    return true;
+#else
+    if (!quiet)
+        LOG_ERROR("Framebuffer devices are only supported on Linux");
+    return false;
+#endif
+}
+
+bool soft_output_open(SoftOutput *output, const char *spec)
+{
+    memset(output, 0, sizeof(*output));
+    output->fb_fd = -1;
+
+    if (!spec)
+        spec = getenv("GOOEY_SOFT_OUTPUT");
+    if (!spec || !*spec)
+    {
+        // Nothing asked for: the screen when the board has one, memory otherwise.
+        strncpy(output->path, SOFT_OUTPUT_DEFAULT_DEVICE, sizeof(output->path) - 1);
+        output->kind = soft_output_open_fbdev(output, true) ? SOFT_OUTPUT_FBDEV : SOFT_OUTPUT_NONE;
+        return true;
+    }
+    if (strcmp(spec, "none") == 0)
+        return true;
+
+    static const struct
+    {
+        const char *prefix;
+        SoftOutputKind kind;
+        SoftShmFormat format;
+    } kinds[] = {
+        {"fb:", SOFT_OUTPUT_FBDEV, SOFT_SHM_RGBA8888},
+        {"file:", SOFT_OUTPUT_FILE, SOFT_SHM_RGBA8888},
+        {"shm:", SOFT_OUTPUT_SHM, SOFT_SHM_RGBA8888},
+        {"shm565:", SOFT_OUTPUT_SHM, SOFT_SHM_RGB565},
+    };
+
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); ++i)
+    {
+        const size_t length = strlen(kinds[i].prefix);
+        if (strncmp(spec, kinds[i].prefix, length) != 0)
+            continue;
+
+        const char *path = spec + length;
+        if (!*path || strlen(path) >= sizeof(output->path) ||
+            (kinds[i].kind == SOFT_OUTPUT_SHM && strchr(path, '/')))
+        {
+            LOG_ERROR("Invalid software output \"%s\"", spec);
+            return false;
+        }
+        strcpy(output->path, path);
+        output->kind = kinds[i].kind;
+        output->shm_format = kinds[i].format;
+        if (output->kind == SOFT_OUTPUT_FBDEV && !soft_output_open_fbdev(output, false))
+        {
+            output->kind = SOFT_OUTPUT_NONE;
+            return false;
+        }
+        return true;
+    }
+
+    LOG_ERROR("Unknown software output \"%s\", expected fb:, file:, shm:, shm565: or none", spec);
+    return false;
+}
+
+void soft_output_close(SoftOutput *output)
+{
+#ifdef __linux__
+    if (output->fb_map)
+        munmap(output->fb_map, output->fb_size);
+    if (output->fb_fd >= 0)
+        close(output->fb_fd);
+#endif
+    free(output->row565);
+    memset(output, 0, sizeof(*output));
+    output->fb_fd = -1;
+}
+
+void soft_output_window_init(SoftOutputWindow *window, int x, int y)
+{
+    memset(window, 0, sizeof(*window));
+    window->x = x;
+    window->y = y;
+    window->shm_fd = -1;
+}
+
+/**
+ * Path a window's frames go to: "%d" replaced by the frame number for files,
+ * and the window id appended before the extension past the first window.
+ */
+static bool soft_output_window_path(const SoftOutput *output, int window_id, uint64_t frame, char *path,
+                                    size_t size)
+{
+    char name[SOFT_OUTPUT_PATH_MAX + 32];
+    const char *pattern = output->path;
+    const char *number = output->kind == SOFT_OUTPUT_FILE ? strstr(pattern, "%d") : NULL;
+    if (number)
+        snprintf(name, sizeof(name), "%.*s%llu%s", (int)(number - pattern), pattern, (unsigned long long)frame,
+                 number + 2);
+    else
+        snprintf(name, sizeof(name), "%s", pattern);
+
+    if (window_id > 0)
+    {
+        const char *slash = strrchr(name, '/');
+        const char *dot = strrchr(name, '.');
+        const size_t stem = dot && (!slash || dot > slash) ? (size_t)(dot - name) : strlen(name);
+        char suffixed[sizeof(name) + 16];
+        snprintf(suffixed, sizeof(suffixed), "%.*s-%d%s", (int)stem, name, window_id, name + stem);
+        strcpy(name, suffixed);
+    }
+
+    const int written = output->kind == SOFT_OUTPUT_SHM ? snprintf(path, size, SOFT_OUTPUT_SHM_DIR "%s", name)
+                                                        : snprintf(path, size, "%s", name);
+    return written > 0 && (size_t)written < size;
+}
+
+static void soft_output_present_fbdev(SoftOutput *output, const SoftOutputWindow *window, const SoftFramebuffer *fb)
+{
+    const int first_row = window->y < 0 ? -window->y : 0;
+    const int first_column = window->x < 0 ? -window->x : 0;
+    const int end_row = fb->height < output->fb_height - window->y ? fb->height : output->fb_height - window->y;
+    const int end_column = fb->width < output->fb_width - window->x ? fb->width : output->fb_width - window->x;
+    if (first_row >= end_row || first_column >= end_column)
+        return;
+
+    const int count = end_column - first_column;
+    const int bytes_per_pixel = output->fb_bits_per_pixel / 8;
+    for (int row = first_row; row < end_row; ++row)
+    {
+        const uint32_t *src = fb->pixels + (size_t)row * fb->width + first_column;
+        unsigned char *dst = output->fb_pixels + (size_t)(window->y + row) * output->fb_line_length +
+                             (size_t)(window->x + first_column) * bytes_per_pixel;
+        if (output->fb_bits_per_pixel == 16)
+        {
+            soft_raster_to_rgb565(src, output->row565, (size_t)count);
+            memcpy(dst, output->row565, (size_t)count * sizeof(uint16_t));
+            continue;
+        }
+
+        // Channels wherever the device puts them, usually B, G, R, X.
+        uint32_t *dst32 = (uint32_t *)dst;
+        for (int i = 0; i < count; ++i)
+        {
+            uint8_t p[4];
+            memcpy(p, &src[i], sizeof(p));
+            dst32[i] = (uint32_t)p[0] << output->fb_red_offset | (uint32_t)p[1] << output->fb_green_offset |
+                       (uint32_t)p[2] << output->fb_blue_offset;
+        }
+    }
+}
+
+/**
+ * Writes the frame as a binary PPM next to the target, then renames it over
+ * the target so that a viewer never reads half a frame.
+ */
+static void soft_output_present_file(const SoftOutput *output, const SoftOutputWindow *window, int window_id,
+                                     const SoftFramebuffer *fb)
+{
+    char path[SOFT_OUTPUT_PATH_MAX + 64];
+    char temporary[sizeof(path) + 8];
+    if (!soft_output_window_path(output, window_id, window->frames, path, sizeof(path)))
+        return;
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+
+    unsigned char *row = (unsigned char *)malloc((size_t)fb->width * 3);
+    FILE *file = row ? fopen(temporary, "wb") : NULL;
+    if (!file)
+    {
+        LOG_ERROR("Failed to write %s", temporary);
+        free(row);
+        return;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", fb->width, fb->height);
+    for (int y = 0; y < fb->height; ++y)
+    {
+        const unsigned char *src = (const unsigned char *)(fb->pixels + (size_t)y * fb->width);
+        for (int x = 0; x < fb->width; ++x)
+            memcpy(row + x * 3, src + x * 4, 3);
+        fwrite(row, 3, (size_t)fb->width, file);
+    }
+    free(row);
+
+    if (fclose(file) != 0 || rename(temporary, path) != 0)
+    {
+        LOG_ERROR("Failed to write %s", path);
+        remove(temporary);
+    }
+}
+
+static void soft_output_unmap_shm(SoftOutputWindow *window)
+{
+    if (window->shm_map)
+        munmap(window->shm_map, window->shm_size);
+    if (window->shm_fd >= 0)
+        close(window->shm_fd);
+    window->shm_map = NULL;
+    window->shm_size = 0;
+    window->shm_fd = -1;
+}
+
+static void soft_output_present_shm(const SoftOutput *output, SoftOutputWindow *window, int window_id,
+                                    const SoftFramebuffer *fb)
+{
+    const size_t bytes_per_pixel = output->shm_format == SOFT_SHM_RGB565 ? 2 : 4;
+    const size_t stride = (size_t)fb->width * bytes_per_pixel;
+    const size_t size = sizeof(SoftShmHeader) + stride * fb->height;
+
+    // Sized for the window, resizing it maps the file again.
+    if (window->shm_size != size)
+    {
+        soft_output_unmap_shm(window);
+
+        char path[SOFT_OUTPUT_PATH_MAX + 64];
+        if (!soft_output_window_path(output, window_id, 0, path, sizeof(path)))
+            return;
+        const int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        void *map = MAP_FAILED;
+        if (fd >= 0 && ftruncate(fd, (off_t)size) == 0)
+            map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            LOG_ERROR("Failed to map %s", path);
+            if (fd >= 0)
+                close(fd);
+            return;
+        }
+        window->shm_fd = fd;
+        window->shm_map = map;
+        window->shm_size = size;
+    }
+
+    SoftShmHeader *header = (SoftShmHeader *)window->shm_map;
+    unsigned char *pixels = (unsigned char *)window->shm_map + sizeof(SoftShmHeader);
+    memcpy(header->magic, SOFT_SHM_MAGIC, sizeof(header->magic));
+    header->width = (uint32_t)fb->width;
+    header->height = (uint32_t)fb->height;
+    header->stride = (uint32_t)stride;
+    header->format = output->shm_format;
+    if (output->shm_format == SOFT_SHM_RGB565)
+        soft_raster_to_rgb565(fb->pixels, (uint16_t *)pixels, (size_t)fb->width * fb->height);
+    else
+        memcpy(pixels, fb->pixels, stride * fb->height);
+    __atomic_store_n(&header->frame, window->frames, __ATOMIC_RELEASE);
+}
+
+void soft_output_window_release(SoftOutput *output, SoftOutputWindow *window, int window_id)
+{
+    if (!window->shm_map)
+        return;
+
+    soft_output_unmap_shm(window);
+    char path[SOFT_OUTPUT_PATH_MAX + 64];
+    if (soft_output_window_path(output, window_id, 0, path, sizeof(path)))
+        unlink(path);
+}
+
+void soft_output_present(SoftOutput *output, SoftOutputWindow *window, int window_id, const SoftFramebuffer *fb)
+{
+    if (!fb->pixels)
+        return;
+
+    window->frames++;
+    switch (output->kind)
+    {
+    case SOFT_OUTPUT_FBDEV:
+        soft_output_present_fbdev(output, window, fb);
+        break;
+    case SOFT_OUTPUT_FILE:
+        soft_output_present_file(output, window, window_id, fb);
+        break;
+    case SOFT_OUTPUT_SHM:
+        soft_output_present_shm(output, window, window_id, fb);
+        break;
+    default:
+        break;
+    }
+}
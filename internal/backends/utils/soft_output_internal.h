@@ -0,0 +1,127 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file soft_output_internal.h
+ * @brief Where the software backend shows its frames.
+ *
+ * GOOEY_SOFT_OUTPUT picks one of:
+ *  - fb:/dev/fb0      the Linux framebuffer device, windows composited at their position;
+ *  - file:frame.ppm   a PPM image rewritten every frame, "%d" in the path numbers them instead;
+ *  - shm:name         /dev/shm/name, a SoftShmHeader followed by the pixels, for another process to show;
+ *  - shm565:name      the same with RGB565 pixels;
+ *  - none             frames stay in memory, for GooeyWindow_ReadPixels().
+ * Unset, /dev/fb0 is used when it can be opened and nothing otherwise.
+ *
+ * Windows other than the first get their id appended to file and shared
+ * memory names, "-1" before the extension and so on.
+ */
+
+#ifndef SOFT_OUTPUT_INTERNAL_H
+#define SOFT_OUTPUT_INTERNAL_H
+
+#include "backends/utils/soft_raster_internal.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SOFT_OUTPUT_PATH_MAX 256
+
+/** First bytes of a shared memory frame. */
+#define SOFT_SHM_MAGIC "GSHM"
+
+typedef enum
+{
+    SOFT_OUTPUT_NONE,
+    SOFT_OUTPUT_FBDEV,
+    SOFT_OUTPUT_FILE,
+    SOFT_OUTPUT_SHM
+} SoftOutputKind;
+
+typedef enum
+{
+    SOFT_SHM_RGBA8888, /**< 4 bytes a pixel, R, G, B, A in memory order. */
+    SOFT_SHM_RGB565    /**< 2 bytes a pixel, native endian. */
+} SoftShmFormat;
+
+/**
+ * @brief Header of a shared memory frame, the pixels follow it.
+ *
+ * frame is written last, once the pixels are complete: a reader copies
+ * the pixels and checks that frame did not change meanwhile.
+ */
+typedef struct
+{
+    char magic[4];
+    uint32_t width, height;
+    uint32_t stride; /**< Bytes from one row to the next. */
+    uint32_t format; /**< SoftShmFormat. */
+    uint32_t reserved;
+    uint64_t frame; /**< Frames presented so far. */
+} SoftShmHeader;
+
+/**
+ * @brief Per window state of an output.
+ */
+typedef struct
+{
+    int x, y; /**< Where the window sits on the framebuffer device. */
+    uint64_t frames;
+    int shm_fd; /**< -1 when not mapped. */
+    void *shm_map;
+    size_t shm_size;
+} SoftOutputWindow;
+
+typedef struct
+{
+    SoftOutputKind kind;
+    char path[SOFT_OUTPUT_PATH_MAX]; /**< Device, file or shared memory name. */
+    SoftShmFormat shm_format;
+    int fb_fd;
+    unsigned char *fb_map;
+    unsigned char *fb_pixels; /**< Top left of the visible area in fb_map. */
+    size_t fb_size;
+    int fb_width, fb_height;
+    int fb_line_length;
+    int fb_bits_per_pixel;
+    int fb_red_offset, fb_green_offset, fb_blue_offset;
+    uint16_t *row565; /**< One converted row, for 16 bit devices. */
+} SoftOutput;
+
+/**
+ * @brief Opens the output described by @p spec, see the file comment.
+ *
+ * @param spec NULL for the GOOEY_SOFT_OUTPUT environment variable.
+ * @return false when it cannot be opened, @p output then shows nothing.
+ */
+bool soft_output_open(SoftOutput *output, const char *spec);
+
+void soft_output_close(SoftOutput *output);
+
+void soft_output_window_init(SoftOutputWindow *window, int x, int y);
+
+/**
+ * @brief Releases what @p window holds, unlinking its shared memory.
+ */
+void soft_output_window_release(SoftOutput *output, SoftOutputWindow *window, int window_id);
+
+/**
+ * @brief Shows the frame of window @p window_id.
+ */
+void soft_output_present(SoftOutput *output, SoftOutputWindow *window, int window_id, const SoftFramebuffer *fb);
+
+#endif // SOFT_OUTPUT_INTERNAL_H
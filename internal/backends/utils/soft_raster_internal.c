@@ -0,0 +1,818 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/soft_raster_internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFT_RASTER_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SOFT_RASTER_NEON 1
+#endif
+
+#define SOFT_RASTER_TWO_PI 6.2831853f
+
+static int64_t soft_raster_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void soft_raster_account(SoftFramebuffer *fb, GooeyRasterPrimitive primitive, uint64_t pixels,
+                                int64_t started)
+{
+    fb->stats.pixels[primitive] += pixels;
+    fb->stats.nanoseconds[primitive] += (uint64_t)(soft_raster_now_ns() - started);
+}
+
+static inline int soft_raster_min(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+static inline int soft_raster_max(int a, int b)
+{
+    return a > b ? a : b;
+}
+
+/**
+ * s * a + d * (255 - a), divided by 255 and rounded exactly. The SIMD
+ * kernels compute the same, pixels do not depend on the instruction set.
+ */
+static inline uint8_t blend_channel(uint32_t s, uint32_t d, uint32_t a)
+{
+    const uint32_t t = s * a + d * (255 - a) + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+static inline uint32_t blend_pixel(uint32_t src, uint32_t dst, uint32_t alpha)
+{
+    uint8_t s[4], d[4];
+    memcpy(s, &src, sizeof(s));
+    memcpy(d, &dst, sizeof(d));
+    for (int c = 0; c < 4; ++c)
+        d[c] = blend_channel(s[c], d[c], alpha);
+    memcpy(&dst, d, sizeof(dst));
+    return dst;
+}
+
+#if SOFT_RASTER_SSE2
+/** blend_channel() on eight 16 bit lanes. */
+static inline __m128i sse2_blend(__m128i s, __m128i d, __m128i a)
+{
+    const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    const __m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, inverse)),
+                                    _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+#elif SOFT_RASTER_NEON
+/** blend_channel() on eight lanes, vraddhn adds the rounding bias. */
+static inline uint8x8_t neon_blend(uint8x8_t s, uint8x8_t d, uint8x8_t a)
+{
+    const uint16x8_t t = vmlal_u8(vmull_u8(s, a), d, vmvn_u8(a));
+    return vraddhn_u16(t, vrshrq_n_u16(t, 8));
+}
+#endif
+
+/**
+ * Writes @p pixel over @p count pixels.
+ */
+static void span_fill(uint32_t *dst, uint32_t pixel, int count)
+{
+    int i = 0;
+#if SOFT_RASTER_SSE2
+    const __m128i value = _mm_set1_epi32((int)pixel);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i *)(dst + i), value);
+#elif SOFT_RASTER_NEON
+    const uint32x4_t value = vdupq_n_u32(pixel);
+    for (; i + 4 <= count; i += 4)
+        vst1q_u32(dst + i, value);
+#endif
+    for (; i < count; ++i)
+        dst[i] = pixel;
+}
+
+/**
+ * Blends @p pixel over @p count pixels, each weighted by its coverage.
+ */
+static void span_blend_mask(uint32_t *dst, uint32_t pixel, const uint8_t *coverage, int count)
+{
+    int i = 0;
+#if SOFT_RASTER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i solid = _mm_set1_epi32((int)pixel);
+    const __m128i src = _mm_unpacklo_epi8(solid, zero);
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32_t weights;
+        memcpy(&weights, coverage + i, sizeof(weights));
+        // Glyphs and edges are mostly empty or solid, neither needs the multiply.
+        if (weights == 0)
+            continue;
+        if (weights == 0xFFFFFFFFu)
+        {
+            _mm_storeu_si128((__m128i *)(dst + i), solid);
+            continue;
+        }
+
+        __m128i weight = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)weights), zero);
+        weight = _mm_unpacklo_epi16(weight, weight);
+        const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        const __m128i low = sse2_blend(src, _mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(weight, weight));
+        const __m128i high = sse2_blend(src, _mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(weight, weight));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(low, high));
+    }
+#elif SOFT_RASTER_NEON
+    uint8_t s[4];
+    memcpy(s, &pixel, sizeof(s));
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint8x8_t weight = vld1_u8(coverage + i);
+        uint8x8x4_t d = vld4_u8((const uint8_t *)(dst + i));
+        for (int c = 0; c < 4; ++c)
+            d.val[c] = neon_blend(vdup_n_u8(s[c]), d.val[c], weight);
+        vst4_u8((uint8_t *)(dst + i), d);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        if (coverage[i] == 255)
+            dst[i] = pixel;
+        else if (coverage[i] != 0)
+            dst[i] = blend_pixel(pixel, dst[i], coverage[i]);
+    }
+}
+
+/**
+ * Blends @p count source pixels over the destination by their alpha, leaving it opaque.
+ */
+static void span_over(uint32_t *dst, const uint32_t *src, int count)
+{
+    int i = 0;
+#if SOFT_RASTER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i opaque = _mm_set1_epi32((int)0xFF000000u);
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        const int alpha = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, opaque), opaque));
+        if (alpha == 0xFFFF)
+        {
+            _mm_storeu_si128((__m128i *)(dst + i), s);
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, opaque), zero)) == 0xFFFF)
+            continue;
+
+        const __m128i s_low = _mm_unpacklo_epi8(s, zero);
+        const __m128i s_high = _mm_unpackhi_epi8(s, zero);
+        const __m128i a_low = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_low, 0xFF), 0xFF);
+        const __m128i a_high = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_high, 0xFF), 0xFF);
+        const __m128i solid = _mm_or_si128(s, opaque);
+        const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        const __m128i low = sse2_blend(_mm_unpacklo_epi8(solid, zero), _mm_unpacklo_epi8(d, zero), a_low);
+        const __m128i high = sse2_blend(_mm_unpackhi_epi8(solid, zero), _mm_unpackhi_epi8(d, zero), a_high);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(low, high));
+    }
+#elif SOFT_RASTER_NEON
+    const uint8x8_t opaque = vdup_n_u8(255);
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint8x8x4_t s = vld4_u8((const uint8_t *)(src + i));
+        uint8x8x4_t d = vld4_u8((const uint8_t *)(dst + i));
+        for (int c = 0; c < 3; ++c)
+            d.val[c] = neon_blend(s.val[c], d.val[c], s.val[3]);
+        d.val[3] = neon_blend(opaque, d.val[3], s.val[3]);
+        vst4_u8((uint8_t *)(dst + i), d);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        uint8_t s[4];
+        memcpy(s, &src[i], sizeof(s));
+        const uint8_t alpha = s[3];
+        s[3] = 255;
+        uint32_t solid;
+        memcpy(&solid, s, sizeof(solid));
+        if (alpha == 255)
+            dst[i] = solid;
+        else if (alpha != 0)
+            dst[i] = blend_pixel(solid, dst[i], alpha);
+    }
+}
+
+/**
+ * Coverage of a pixel whose center is @p distance from the edge, negative inside, as the shaders compute it.
+ */
+static inline uint8_t coverage_of(float distance)
+{
+    const float coverage = 0.5f - distance;
+    if (coverage <= 0.0f)
+        return 0;
+    if (coverage >= 1.0f)
+        return 255;
+    return (uint8_t)(coverage * 255.0f + 0.5f);
+}
+
+/**
+ * Columns whose pixel centers lie within @p extent of @p center, lo > hi when none do.
+ */
+static void column_range(float center, float extent, int *lo, int *hi)
+{
+    *lo = (int)ceilf(center - extent - 0.5f);
+    *hi = (int)floorf(center + extent - 0.5f);
+}
+
+bool soft_raster_resize(SoftFramebuffer *fb, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return false;
+    if (fb->pixels && width == fb->width && height == fb->height)
+        return true;
+
+    uint32_t *pixels = (uint32_t *)calloc((size_t)width * height, sizeof(uint32_t));
+    uint8_t *coverage = (uint8_t *)malloc((size_t)width);
+    uint32_t *scanline = (uint32_t *)malloc((size_t)width * sizeof(uint32_t));
+    int32_t *columns = (int32_t *)malloc((size_t)width * 2 * sizeof(int32_t));
+    if (!pixels || !coverage || !scanline || !columns)
+    {
+        free(pixels);
+        free(coverage);
+        free(scanline);
+        free(columns);
+        return false;
+    }
+
+    if (fb->pixels)
+    {
+        const int rows = soft_raster_min(height, fb->height);
+        const int columns_kept = soft_raster_min(width, fb->width);
+        for (int row = 0; row < rows; ++row)
+            memcpy(pixels + (size_t)row * width, fb->pixels + (size_t)row * fb->width,
+                   (size_t)columns_kept * sizeof(uint32_t));
+    }
+
+    free(fb->pixels);
+    free(fb->coverage);
+    free(fb->scanline);
+    free(fb->columns);
+    fb->pixels = pixels;
+    fb->coverage = coverage;
+    fb->scanline = scanline;
+    fb->columns = columns;
+    fb->width = width;
+    fb->height = height;
+    return true;
+}
+
+void soft_raster_destroy(SoftFramebuffer *fb)
+{
+    free(fb->pixels);
+    free(fb->coverage);
+    free(fb->scanline);
+    free(fb->columns);
+    memset(fb, 0, sizeof(*fb));
+}
+
+uint32_t soft_raster_pack(uint32_t color)
+{
+    const uint8_t bytes[4] = {(uint8_t)(color >> 16), (uint8_t)(color >> 8), (uint8_t)color, 255};
+    uint32_t pixel;
+    memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+void soft_raster_clear(SoftFramebuffer *fb, uint32_t color)
+{
+    if (!fb->pixels)
+        return;
+
+    const int64_t started = soft_raster_now_ns();
+    const size_t count = (size_t)fb->width * fb->height;
+    span_fill(fb->pixels, soft_raster_pack(color), (int)count);
+    soft_raster_account(fb, GOOEY_RASTER_RECT, count, started);
+}
+
+typedef struct
+{
+    float cx, cy;
+    float half_width, half_height;
+    float radius;
+    float border; /**< 0 when filled, otherwise at least a pixel. */
+} SoftRoundedBox;
+
+/** roundedBoxSDF() of the quad shader, @p px and @p py from the center. */
+static float rounded_box_distance(float px, float py, float half_width, float half_height, float radius)
+{
+    radius = fminf(radius, fminf(half_width, half_height));
+    const float qx = fabsf(px) - half_width + radius;
+    const float qy = fabsf(py) - half_height + radius;
+    const float ox = fmaxf(qx, 0.0f), oy = fmaxf(qy, 0.0f);
+    return fminf(fmaxf(qx, qy), 0.0f) + sqrtf(ox * ox + oy * oy) - radius;
+}
+
+static float rect_distance(const SoftRoundedBox *box, float px, float py)
+{
+    float distance = rounded_box_distance(px, py, box->half_width, box->half_height, box->radius);
+    if (box->border > 0.0f)
+    {
+        const float inner_width = box->half_width - box->border;
+        const float inner_height = box->half_height - box->border;
+        if (inner_width > 0.0f && inner_height > 0.0f)
+            distance = fmaxf(distance, -rounded_box_distance(px, py, inner_width, inner_height,
+                                                             fmaxf(box->radius - box->border, 0.0f)));
+    }
+    return distance;
+}
+
+/**
+ * Half width, at @p dy from the center, of a rounded box grown by @p grow
+ * pixels, or shrunk when negative: the pixels whose distance is below @p grow.
+ *
+ * @return false when the row misses it.
+ */
+static bool rounded_box_extent(float half_width, float half_height, float radius, float grow, float dy,
+                               float *extent)
+{
+    radius = fminf(radius, fminf(half_width, half_height));
+    half_width += grow;
+    half_height += grow;
+    radius = fmaxf(radius + grow, 0.0f);
+    dy = fabsf(dy);
+    if (half_width <= 0.0f || dy > half_height)
+        return false;
+
+    const float qy = dy - (half_height - radius);
+    *extent = qy > 0.0f ? half_width - radius + sqrtf(fmaxf(radius * radius - qy * qy, 0.0f)) : half_width;
+    return true;
+}
+
+static bool in_columns(int column, int lo, int hi)
+{
+    return column >= lo && column <= hi;
+}
+
+/**
+ * Draws one row of a rectangle between columns @p first and @p last.
+ *
+ * The row splits where the shape grown by half a pixel, shrunk by half a
+ * pixel, and its hole grown and shrunk the same, begin and end. Between
+ * those columns a run is either fully covered, fully in the hole, or has
+ * to be computed pixel by pixel.
+ *
+ * @return Pixels written.
+ */
+static uint64_t rect_row(SoftFramebuffer *fb, const SoftRoundedBox *box, int row, int first, int last,
+                         uint32_t pixel)
+{
+    const float dy = (float)row + 0.5f - box->cy;
+    float extent;
+    if (!rounded_box_extent(box->half_width, box->half_height, box->radius, 0.5f, dy, &extent))
+        return 0;
+
+    int lo, hi;
+    column_range(box->cx, extent, &lo, &hi);
+    lo = soft_raster_max(lo, first);
+    hi = soft_raster_min(hi, last);
+    if (lo > hi)
+        return 0;
+
+    int full_lo = 1, full_hi = 0, hole_lo = 1, hole_hi = 0, empty_lo = 1, empty_hi = 0;
+    if (rounded_box_extent(box->half_width, box->half_height, box->radius, -0.5f, dy, &extent))
+        column_range(box->cx, extent, &full_lo, &full_hi);
+    const float inner_width = box->half_width - box->border;
+    const float inner_height = box->half_height - box->border;
+    if (box->border > 0.0f && inner_width > 0.0f && inner_height > 0.0f)
+    {
+        const float inner_radius = fmaxf(box->radius - box->border, 0.0f);
+        if (rounded_box_extent(inner_width, inner_height, inner_radius, 0.5f, dy, &extent))
+            column_range(box->cx, extent, &hole_lo, &hole_hi);
+        if (rounded_box_extent(inner_width, inner_height, inner_radius, -0.5f, dy, &extent))
+            column_range(box->cx, extent, &empty_lo, &empty_hi);
+    }
+
+    int breaks[8] = {lo, hi + 1, full_lo, full_hi + 1, hole_lo, hole_hi + 1, empty_lo, empty_hi + 1};
+    for (int i = 1; i < 8; ++i)
+    {
+        for (int j = i; j > 0 && breaks[j - 1] > breaks[j]; --j)
+        {
+            const int swap = breaks[j];
+            breaks[j] = breaks[j - 1];
+            breaks[j - 1] = swap;
+        }
+    }
+
+    uint32_t *dst = fb->pixels + (size_t)row * fb->width;
+    uint64_t written = 0;
+    for (int i = 0; i < 7; ++i)
+    {
+        const int start = soft_raster_max(breaks[i], lo);
+        const int end = soft_raster_min(breaks[i + 1], hi + 1);
+        if (start >= end || in_columns(start, empty_lo, empty_hi))
+            continue;
+
+        if (in_columns(start, full_lo, full_hi) && !in_columns(start, hole_lo, hole_hi))
+        {
+            span_fill(dst + start, pixel, end - start);
+        }
+        else
+        {
+            for (int column = start; column < end; ++column)
+                fb->coverage[column - start] = coverage_of(rect_distance(box, (float)column + 0.5f - box->cx, dy));
+            span_blend_mask(dst + start, pixel, fb->coverage, end - start);
+        }
+        written += (uint64_t)(end - start);
+    }
+    return written;
+}
+
+void soft_raster_rect(SoftFramebuffer *fb, float x, float y, float width, float height, float radius, float border,
+                      uint32_t color)
+{
+    if (!fb->pixels || width <= 0.0f || height <= 0.0f)
+        return;
+
+    const int64_t started = soft_raster_now_ns();
+    const SoftRoundedBox box = {
+        .cx = x + width * 0.5f,
+        .cy = y + height * 0.5f,
+        .half_width = width * 0.5f,
+        .half_height = height * 0.5f,
+        .radius = fmaxf(radius, 0.0f),
+        .border = border > 0.0f ? fmaxf(border, 1.0f) : 0.0f,
+    };
+    const uint32_t pixel = soft_raster_pack(color);
+
+    // Only pixels whose center is inside the rectangle, as the GPU rasterizes the quad.
+    const int first_row = soft_raster_max((int)ceilf(y - 0.5f), 0);
+    const int last_row = soft_raster_min((int)ceilf(y + height - 0.5f) - 1, fb->height - 1);
+    const int first_column = soft_raster_max((int)ceilf(x - 0.5f), 0);
+    const int last_column = soft_raster_min((int)ceilf(x + width - 0.5f) - 1, fb->width - 1);
+
+    uint64_t written = 0;
+    for (int row = first_row; row <= last_row; ++row)
+        written += rect_row(fb, &box, row, first_column, last_column, pixel);
+    soft_raster_account(fb, box.radius > 0.0f ? GOOEY_RASTER_ROUNDED_RECT : GOOEY_RASTER_RECT, written, started);
+}
+
+static float segment_distance(float px, float py, const float *a, const float *b)
+{
+    const float dx = b[0] - a[0], dy = b[1] - a[1];
+    const float length_squared = dx * dx + dy * dy;
+    float t = length_squared > 0.0f ? ((px - a[0]) * dx + (py - a[1]) * dy) / length_squared : 0.0f;
+    t = fminf(fmaxf(t, 0.0f), 1.0f);
+    const float ex = px - (a[0] + t * dx), ey = py - (a[1] + t * dy);
+    return sqrtf(ex * ex + ey * ey);
+}
+
+/**
+ * Horizontal span of the pixels of row @p py within @p reach of the segment, false when there are none.
+ */
+static bool segment_row_span(const float *a, const float *b, float py, float reach, float *x_min, float *x_max)
+{
+    float t0 = 0.0f, t1 = 1.0f;
+    const float dy = b[1] - a[1];
+    if (fabsf(dy) < 1e-6f)
+    {
+        if (fabsf(py - a[1]) > reach)
+            return false;
+    }
+    else
+    {
+        t0 = (py - reach - a[1]) / dy;
+        t1 = (py + reach - a[1]) / dy;
+        if (t0 > t1)
+        {
+            const float swap = t0;
+            t0 = t1;
+            t1 = swap;
+        }
+        t0 = fmaxf(t0, 0.0f);
+        t1 = fminf(t1, 1.0f);
+        if (t0 > t1)
+            return false;
+    }
+
+    const float xa = a[0] + t0 * (b[0] - a[0]);
+    const float xb = a[0] + t1 * (b[0] - a[0]);
+    *x_min = fminf(xa, xb) - reach;
+    *x_max = fmaxf(xa, xb) + reach;
+    return true;
+}
+
+/**
+ * Draws the capsules around consecutive segments. A pixel partly covered by
+ * two neighbouring segments is left to the closer one, so that corners are
+ * not blended twice.
+ *
+ * @return Pixels written.
+ */
+static uint64_t draw_segments(SoftFramebuffer *fb, const float *points, size_t count, float half_width,
+                              uint32_t pixel)
+{
+    const float reach = half_width + 0.5f;
+    uint64_t written = 0;
+    for (size_t segment = 0; segment + 1 < count; ++segment)
+    {
+        const float *a = points + segment * 2;
+        const float *b = a + 2;
+        const float *previous = segment > 0 ? a - 2 : NULL;
+        const float *next = segment + 2 < count ? b + 2 : NULL;
+
+        const int first_row = soft_raster_max((int)floorf(fminf(a[1], b[1]) - reach), 0);
+        const int last_row = soft_raster_min((int)ceilf(fmaxf(a[1], b[1]) + reach), fb->height - 1);
+        for (int row = first_row; row <= last_row; ++row)
+        {
+            const float py = (float)row + 0.5f;
+            float x_min, x_max;
+            if (!segment_row_span(a, b, py, reach, &x_min, &x_max))
+                continue;
+
+            int lo, hi;
+            column_range((x_min + x_max) * 0.5f, (x_max - x_min) * 0.5f, &lo, &hi);
+            lo = soft_raster_max(lo, 0);
+            hi = soft_raster_min(hi, fb->width - 1);
+            if (lo > hi)
+                continue;
+
+            for (int column = lo; column <= hi; ++column)
+            {
+                const float px = (float)column + 0.5f;
+                const float distance = segment_distance(px, py, a, b) - half_width;
+                if (distance > -0.5f && ((previous && segment_distance(px, py, previous, a) - half_width < distance) ||
+                                         (next && segment_distance(px, py, b, next) - half_width <= distance)))
+                {
+                    fb->coverage[column - lo] = 0;
+                    continue;
+                }
+                fb->coverage[column - lo] = coverage_of(distance);
+            }
+            span_blend_mask(fb->pixels + (size_t)row * fb->width + lo, pixel, fb->coverage, hi - lo + 1);
+            written += (uint64_t)(hi - lo + 1);
+        }
+    }
+    return written;
+}
+
+void soft_raster_line(SoftFramebuffer *fb, float x1, float y1, float x2, float y2, float width, uint32_t color)
+{
+    if (!fb->pixels)
+        return;
+
+    const int64_t started = soft_raster_now_ns();
+    const float points[4] = {x1, y1, x2, y2};
+    const uint64_t written = draw_segments(fb, points, 2, fmaxf(width, 1.0f) * 0.5f, soft_raster_pack(color));
+    soft_raster_account(fb, GOOEY_RASTER_LINE, written, started);
+}
+
+void soft_raster_polyline(SoftFramebuffer *fb, const float *points, size_t count, float width, uint32_t color)
+{
+    if (!fb->pixels || !points || count < 2)
+        return;
+
+    const int64_t started = soft_raster_now_ns();
+    const uint64_t written = draw_segments(fb, points, count, fmaxf(width, 1.0f) * 0.5f, soft_raster_pack(color));
+    soft_raster_account(fb, GOOEY_RASTER_LINE, written, started);
+}
+
+/** ellipseSDF() of the quad shader. */
+static float ellipse_distance(float px, float py, float rx, float ry)
+{
+    const float ax = px / rx, ay = py / ry;
+    const float bx = px / (rx * rx), by = py / (ry * ry);
+    const float k1 = sqrtf(ax * ax + ay * ay);
+    const float k2 = sqrtf(bx * bx + by * by);
+    return k2 > 0.0f ? k1 * (k1 - 1.0f) / k2 : -fminf(rx, ry);
+}
+
+/** arcSDF() of the quad shader. */
+static float arc_distance(float px, float py, float rx, float ry, float start, float sweep, float thickness)
+{
+    float distance = ellipse_distance(px, py, rx, ry);
+    const float inner_x = rx - thickness, inner_y = ry - thickness;
+    if (thickness > 0.0f && inner_x > 0.0f && inner_y > 0.0f)
+        distance = fmaxf(distance, -ellipse_distance(px, py, inner_x, inner_y));
+    if (sweep < 6.2831f)
+    {
+        float along = fmodf(atan2f(-py, -px) - start, SOFT_RASTER_TWO_PI);
+        if (along < 0.0f)
+            along += SOFT_RASTER_TWO_PI;
+        float away = along <= sweep ? -fminf(along, sweep - along)
+                                    : fminf(along - sweep, SOFT_RASTER_TWO_PI - along);
+        away = fminf(fmaxf(away, -1.5707963f), 1.5707963f);
+        distance = fmaxf(distance, sqrtf(px * px + py * py) * sinf(away));
+    }
+    return distance;
+}
+
+void soft_raster_arc(SoftFramebuffer *fb, float cx, float cy, float rx, float ry, float start, float sweep,
+                     float thickness, uint32_t color)
+{
+    if (!fb->pixels || rx <= 0.0f || ry <= 0.0f)
+        return;
+
+    const int64_t started = soft_raster_now_ns();
+    const uint32_t pixel = soft_raster_pack(color);
+    rx = fmaxf(rx, 0.5f);
+    ry = fmaxf(ry, 0.5f);
+    start = fmodf(start, SOFT_RASTER_TWO_PI);
+    if (start < 0.0f)
+        start += SOFT_RASTER_TWO_PI;
+
+    // The quad the shader runs on has a pixel of margin, nothing reaches past it.
+    const int first_row = soft_raster_max((int)ceilf(cy - ry - 1.5f), 0);
+    const int last_row = soft_raster_min((int)floorf(cy + ry + 0.5f), fb->height - 1);
+    uint64_t written = 0;
+    for (int row = first_row; row <= last_row; ++row)
+    {
+        const float py = (float)row + 0.5f - cy;
+        // An ellipse grown by a pixel and a half holds every pixel the edge can touch.
+        const float across = py / (ry + 1.5f);
+        const float extent = fminf((rx + 1.5f) * sqrtf(fmaxf(1.0f - across * across, 0.0f)), rx + 1.0f);
+        int lo, hi;
+        column_range(cx, extent, &lo, &hi);
+        lo = soft_raster_max(lo, 0);
+        hi = soft_raster_min(hi, fb->width - 1);
+        if (lo > hi)
+            continue;
+
+        for (int column = lo; column <= hi; ++column)
+            fb->coverage[column - lo] =
+                coverage_of(arc_distance((float)column + 0.5f - cx, py, rx, ry, start, sweep, thickness));
+        span_blend_mask(fb->pixels + (size_t)row * fb->width + lo, pixel, fb->coverage, hi - lo + 1);
+        written += (uint64_t)(hi - lo + 1);
+    }
+    soft_raster_account(fb, GOOEY_RASTER_ARC, written, started);
+}
+
+/**
+ * Mixes two pixels, @p weight of 256 giving @p b. Two channels per multiply.
+ */
+static inline uint32_t lerp_pixel(uint32_t a, uint32_t b, uint32_t weight)
+{
+    const uint32_t keep = 256 - weight;
+    const uint32_t even = (((a & 0x00FF00FFu) * keep + (b & 0x00FF00FFu) * weight) >> 8) & 0x00FF00FFu;
+    const uint32_t odd = (((a >> 8) & 0x00FF00FFu) * keep + ((b >> 8) & 0x00FF00FFu) * weight) & 0xFF00FF00u;
+    return even | odd;
+}
+
+/**
+ * Texel a pixel center lands on and how far towards the next one, in 256ths, clamped to the edge like the GL sampler.
+ */
+static inline void texel_position(float position, int size, int32_t *texel, int32_t *weight)
+{
+    if (position <= 0.0f)
+    {
+        *texel = 0;
+        *weight = 0;
+        return;
+    }
+    if (position >= (float)(size - 1))
+    {
+        *texel = size - 1;
+        *weight = 0;
+        return;
+    }
+    *texel = (int32_t)position;
+    *weight = (int32_t)((position - (float)*texel) * 256.0f + 0.5f);
+}
+
+void soft_raster_image(SoftFramebuffer *fb, const SoftImage *image, float u0, float v0, float u1, float v1, int x,
+                       int y, int width, int height)
+{
+    if (!fb->pixels || !image || !image->pixels || width <= 0 || height <= 0)
+        return;
+
+    const int first_row = soft_raster_max(y, 0), end_row = soft_raster_min(y + height, fb->height);
+    const int first_column = soft_raster_max(x, 0), end_column = soft_raster_min(x + width, fb->width);
+    if (first_row >= end_row || first_column >= end_column)
+        return;
+
+    const int64_t started = soft_raster_now_ns();
+    const int count = end_column - first_column;
+
+    // Texels per pixel and where the region starts, in texels.
+    const float step_x = (u1 - u0) * (float)image->width / (float)width;
+    const float step_y = (v1 - v0) * (float)image->height / (float)height;
+    const float origin_x = u0 * (float)image->width;
+    const float origin_y = v0 * (float)image->height;
+
+    // Shown at its own size on whole texels, rows are blended straight from the image.
+    const int source_x = (int)origin_x + first_column - x;
+    const int source_y = (int)origin_y + first_row - y;
+    if (step_x == 1.0f && step_y == 1.0f && origin_x == floorf(origin_x) && origin_y == floorf(origin_y) &&
+        source_x >= 0 && source_y >= 0 && source_x + count <= image->width &&
+        source_y + (end_row - first_row) <= image->height)
+    {
+        for (int row = first_row; row < end_row; ++row)
+            span_over(fb->pixels + (size_t)row * fb->width + first_column,
+                      image->pixels + (size_t)(source_y + row - first_row) * image->width + source_x, count);
+        soft_raster_account(fb, GOOEY_RASTER_IMAGE, (uint64_t)count * (end_row - first_row), started);
+        return;
+    }
+
+    int32_t *columns = fb->columns;
+    for (int i = 0; i < count; ++i)
+        texel_position(origin_x + ((float)(first_column + i - x) + 0.5f) * step_x - 0.5f, image->width,
+                       &columns[i * 2], &columns[i * 2 + 1]);
+
+    for (int row = first_row; row < end_row; ++row)
+    {
+        int32_t texel_y, weight_y;
+        texel_position(origin_y + ((float)(row - y) + 0.5f) * step_y - 0.5f, image->height, &texel_y, &weight_y);
+        const uint32_t *top = image->pixels + (size_t)texel_y * image->width;
+        const uint32_t *bottom = image->pixels + (size_t)soft_raster_min(texel_y + 1, image->height - 1) * image->width;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const int32_t texel_x = columns[i * 2];
+            const int32_t next_x = soft_raster_min(texel_x + 1, image->width - 1);
+            const uint32_t weight_x = (uint32_t)columns[i * 2 + 1];
+            fb->scanline[i] = lerp_pixel(lerp_pixel(top[texel_x], top[next_x], weight_x),
+                                         lerp_pixel(bottom[texel_x], bottom[next_x], weight_x), (uint32_t)weight_y);
+        }
+        span_over(fb->pixels + (size_t)row * fb->width + first_column, fb->scanline, count);
+    }
+    soft_raster_account(fb, GOOEY_RASTER_IMAGE, (uint64_t)count * (end_row - first_row), started);
+}
+
+void soft_raster_glyph(SoftFramebuffer *fb, const uint8_t *mask, int pitch, int x, int y, int width, int height,
+                       uint32_t color)
+{
+    if (!fb->pixels || !mask || width <= 0 || height <= 0)
+        return;
+
+    const int first_row = soft_raster_max(y, 0), end_row = soft_raster_min(y + height, fb->height);
+    const int first_column = soft_raster_max(x, 0), end_column = soft_raster_min(x + width, fb->width);
+    if (first_row >= end_row || first_column >= end_column)
+        return;
+
+    const int64_t started = soft_raster_now_ns();
+    const uint32_t pixel = soft_raster_pack(color);
+    const int count = end_column - first_column;
+    for (int row = first_row; row < end_row; ++row)
+        span_blend_mask(fb->pixels + (size_t)row * fb->width + first_column, pixel,
+                        mask + (size_t)(row - y) * pitch + (first_column - x), count);
+    soft_raster_account(fb, GOOEY_RASTER_GLYPH, (uint64_t)count * (end_row - first_row), started);
+}
+
+#if SOFT_RASTER_SSE2
+static inline __m128i sse2_to_rgb565(__m128i pixels)
+{
+    const __m128i red = _mm_slli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xF8)), 8);
+    const __m128i green = _mm_and_si128(_mm_srli_epi32(pixels, 5), _mm_set1_epi32(0x7E0));
+    const __m128i blue = _mm_and_si128(_mm_srli_epi32(pixels, 19), _mm_set1_epi32(0x1F));
+    const __m128i packed = _mm_or_si128(_mm_or_si128(red, green), blue);
+    // Sign extended, so that the saturating pack keeps the 16 bits as they are.
+    return _mm_srai_epi32(_mm_slli_epi32(packed, 16), 16);
+}
+#endif
+
+void soft_raster_to_rgb565(const uint32_t *pixels, uint16_t *rgb565, size_t count)
+{
+    size_t i = 0;
+#if SOFT_RASTER_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i low = sse2_to_rgb565(_mm_loadu_si128((const __m128i *)(pixels + i)));
+        const __m128i high = sse2_to_rgb565(_mm_loadu_si128((const __m128i *)(pixels + i + 4)));
+        _mm_storeu_si128((__m128i *)(rgb565 + i), _mm_packs_epi32(low, high));
+    }
+#elif SOFT_RASTER_NEON
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint8x8x4_t p = vld4_u8((const uint8_t *)(pixels + i));
+        uint16x8_t packed = vshll_n_u8(p.val[0], 8);
+        packed = vsriq_n_u16(packed, vshll_n_u8(p.val[1], 8), 5);
+        packed = vsriq_n_u16(packed, vshll_n_u8(p.val[2], 8), 11);
+        vst1q_u16(rgb565 + i, packed);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        uint8_t p[4];
+        memcpy(p, &pixels[i], sizeof(p));
+        rgb565[i] = (uint16_t)(((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3));
+    }
+}
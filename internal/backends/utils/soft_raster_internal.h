@@ -0,0 +1,136 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file soft_raster_internal.h
+ * @brief Antialiased 2D rasterizer drawing into memory, for the software backend.
+ *
+ * Shapes are described by the same signed distance fields the GL shaders
+ * evaluate, so both backends draw the same coverage. Each row of a shape is
+ * split into runs: the inside of the shape is filled outright, only the
+ * pixels around its edge compute a distance. Runs are then written by span
+ * kernels in SSE2 or NEON when the target has them, plain C otherwise.
+ *
+ * Pixels are 4 bytes, R, G, B and A in memory order, top row first. The
+ * framebuffer stays opaque: every color is blended with alpha 255 and images
+ * only use theirs as the blend weight.
+ */
+
+#ifndef SOFT_RASTER_INTERNAL_H
+#define SOFT_RASTER_INTERNAL_H
+
+#include "common/gooey_common.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief What was drawn, per GooeyRasterPrimitive, since the framebuffer was created.
+ */
+typedef struct
+{
+    uint64_t pixels[GOOEY_RASTER_PRIMITIVE_COUNT];      /**< Pixels written, blended or not. */
+    uint64_t nanoseconds[GOOEY_RASTER_PRIMITIVE_COUNT]; /**< Time spent drawing them. */
+} SoftRasterStats;
+
+typedef struct
+{
+    uint32_t *pixels; /**< width x height, rows packed. */
+    int width, height;
+    uint8_t *coverage; /**< One row of edge coverage. */
+    uint32_t *scanline; /**< One row of sampled image pixels. */
+    int32_t *columns;   /**< Source column and weight of each pixel of an image row. */
+    SoftRasterStats stats;
+} SoftFramebuffer;
+
+/**
+ * @brief Tightly packed pixels in the framebuffer's format, top row first.
+ */
+typedef struct
+{
+    uint32_t *pixels;
+    int width, height;
+} SoftImage;
+
+/**
+ * @brief Allocates @p width x @p height pixels, keeping what fits of the previous content.
+ *
+ * @return false when out of memory, the framebuffer is then unchanged.
+ */
+bool soft_raster_resize(SoftFramebuffer *fb, int width, int height);
+
+void soft_raster_destroy(SoftFramebuffer *fb);
+
+/**
+ * @brief Packs a 0xRRGGBB color into an opaque pixel.
+ */
+uint32_t soft_raster_pack(uint32_t color);
+
+/**
+ * @brief Fills the whole framebuffer with a 0xRRGGBB color.
+ */
+void soft_raster_clear(SoftFramebuffer *fb, uint32_t color);
+
+/**
+ * @brief Rectangle, rounded when @p radius is above 0, filled when @p border is 0 and outlined that wide otherwise.
+ */
+void soft_raster_rect(SoftFramebuffer *fb, float x, float y, float width, float height, float radius, float border,
+                      uint32_t color);
+
+/**
+ * @brief Line between two points, @p width pixels wide with round ends.
+ */
+void soft_raster_line(SoftFramebuffer *fb, float x1, float y1, float x2, float y2, float width, uint32_t color);
+
+/**
+ * @brief Line through @p count points, x then y, @p width pixels wide.
+ *
+ * Corners are always round: each pixel around a corner is drawn once, by
+ * whichever of the two segments it is closest to.
+ */
+void soft_raster_polyline(SoftFramebuffer *fb, const float *points, size_t count, float width, uint32_t color);
+
+/**
+ * @brief Arc of the ellipse around @p cx, @p cy with radii @p rx and @p ry.
+ *
+ * @param start Where the arc starts in radians, 0 on the left and growing clockwise.
+ * @param sweep Radians it goes on for, a full ellipse from 2 pi on.
+ * @param thickness Width of the ring in pixels, 0 for the filled pie.
+ */
+void soft_raster_arc(SoftFramebuffer *fb, float cx, float cy, float rx, float ry, float start, float sweep,
+                     float thickness, uint32_t color);
+
+/**
+ * @brief Draws the part of @p image between @p u0, @p v0 and @p u1, @p v1, from the top left, into the rectangle.
+ *
+ * Filtered bilinearly, blended by the image's alpha.
+ */
+void soft_raster_image(SoftFramebuffer *fb, const SoftImage *image, float u0, float v0, float u1, float v1, int x,
+                       int y, int width, int height);
+
+/**
+ * @brief Blends @p color through an 8 bit coverage mask, @p pitch bytes per row, with its top left at @p x, @p y.
+ */
+void soft_raster_glyph(SoftFramebuffer *fb, const uint8_t *mask, int pitch, int x, int y, int width, int height,
+                       uint32_t color);
+
+/**
+ * @brief Converts @p count pixels to RGB565.
+ */
+void soft_raster_to_rgb565(const uint32_t *pixels, uint16_t *rgb565, size_t count);
+
+#endif // SOFT_RASTER_INTERNAL_H
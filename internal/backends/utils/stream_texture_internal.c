@@ -0,0 +1,111 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/stream_texture_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/gl_state_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <string.h>
+
+bool stream_texture_init(StreamTexture *stream)
+{
+    memset(stream, 0, sizeof(*stream));
+
+    glGenTextures(1, &stream->texture);
+    if (stream->texture == 0)
+        return false;
+    gl_state_bind_texture(GL_TEXTURE_2D, stream->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    glGenBuffers(IMAGE_STREAM_BUFFERS, stream->buffers);
+    return true;
+}
+
+/**
+ * Copies the frame into the next buffer and points the upload at it, false when the buffer could not be mapped.
+ */
+static bool stream_texture_upload_buffered(StreamTexture *stream, const unsigned char *rgba)
+{
+    const size_t row_size = (size_t)stream->width * 4;
+    const size_t size = row_size * stream->height;
+    if (stream->buffers[0] == 0)
+        return false;
+
+    gl_state_bind_buffer(GL_PIXEL_UNPACK_BUFFER, stream->buffers[stream->next]);
+    // Orphaned, a transfer still reading the previous contents keeps its own storage.
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_DRAW);
+    void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size,
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!mapped)
+    {
+        gl_state_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        LOG_WARNING("Could not map a pixel buffer, streamed images are uploaded directly");
+        gl_state_delete_buffers(IMAGE_STREAM_BUFFERS, stream->buffers);
+        memset(stream->buffers, 0, sizeof(stream->buffers));
+        return false;
+    }
+    // Frames come top row first, textures are stored bottom-up like decoded images.
+    for (int row = 0; row < stream->height; ++row)
+        memcpy((unsigned char *)mapped + row_size * row, rgba + row_size * (stream->height - 1 - row), row_size);
+    const bool unmapped = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+
+    if (unmapped)
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, stream->width, stream->height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    gl_state_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    stream->next = (stream->next + 1) % IMAGE_STREAM_BUFFERS;
+    // Contents lost while mapped, e.g. on a mode switch; the frame goes up directly instead.
+    return unmapped;
+}
+
+void stream_texture_update(StreamTexture *stream, const unsigned char *rgba, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return;
+
+    gl_state_bind_texture(GL_TEXTURE_2D, stream->texture);
+    gl_state_pixel_store(GL_UNPACK_ALIGNMENT, 4);
+    if (width != stream->width || height != stream->height)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        stream->width = width;
+        stream->height = height;
+    }
+
+    if (!stream_texture_upload_buffered(stream, rgba))
+    {
+        const size_t row_size = (size_t)width * 4;
+        for (int row = 0; row < height; ++row)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, height - 1 - row, width, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                            rgba + row_size * row);
+    }
+    stream->version++;
+}
+
+void stream_texture_destroy(StreamTexture *stream)
+{
+    if (stream->buffers[0] != 0)
+        gl_state_delete_buffers(IMAGE_STREAM_BUFFERS, stream->buffers);
+    if (stream->texture != 0)
+        gl_state_delete_textures(1, &stream->texture);
+    memset(stream, 0, sizeof(*stream));
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file stream_texture_internal.h
+ * @brief Textures whose pixels are replaced every frame, as video or camera images are.
+ *
+ * The texture is allocated once and overwritten in place. New pixels are
+ * copied into one of IMAGE_STREAM_BUFFERS pixel buffer objects, orphaned
+ * first, and the texture is filled from that buffer: the copy to the GPU
+ * runs asynchronously while the frame renders, and the next frame writes
+ * the next buffer instead of waiting for this one to be read.
+ */
+
+#ifndef STREAM_TEXTURE_INTERNAL_H
+#define STREAM_TEXTURE_INTERNAL_H
+
+#include "backends/utils/backend_utils_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+    GLuint texture;
+    GLuint buffers[IMAGE_STREAM_BUFFERS]; /**< Pixel unpack buffers used in turn, 0 when mapping them failed. */
+    int next;                             /**< Buffer the next frame is written to. */
+    int width, height;
+    uint64_t version;                     /**< Bumped on every update, tells the damage tracker the pixels changed. */
+} StreamTexture;
+
+/**
+ * @brief Creates the texture and its buffers, the context they go to must be current.
+ */
+bool stream_texture_init(StreamTexture *stream);
+
+/**
+ * @brief Replaces the texture's pixels with tightly packed RGBA, reallocating it when the size changed.
+ *
+ * @p rgba is top row first, it is stored bottom-up as every other texture is.
+ */
+void stream_texture_update(StreamTexture *stream, const unsigned char *rgba, int width, int height);
+
+void stream_texture_destroy(StreamTexture *stream);
+
+#endif
+#endif // STREAM_TEXTURE_INTERNAL_H
@@ -0,0 +1,250 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/svg_cache_internal.h"
+#include "backends/utils/nanosvg/nanosvg.h"
+#include "backends/utils/nanosvg/nanosvgrast.h"
+#include "logger/pico_logger_internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define SVG_CACHE_LOCK(cache) AcquireSRWLockExclusive(&(cache)->lock)
+#define SVG_CACHE_UNLOCK(cache) ReleaseSRWLockExclusive(&(cache)->lock)
+#else
+#define SVG_CACHE_LOCK(cache) pthread_mutex_lock(&(cache)->lock)
+#define SVG_CACHE_UNLOCK(cache) pthread_mutex_unlock(&(cache)->lock)
+#endif
+
+void svg_cache_init(SvgCache *cache, size_t capacity)
+{
+    memset(cache, 0, sizeof(*cache));
+#ifdef _WIN32
+    InitializeSRWLock(&cache->lock);
+#else
+    pthread_mutex_init(&cache->lock, NULL);
+#endif
+    cache->capacity = capacity;
+}
+
+static void svg_cache_unlink(SvgCache *cache, SvgCacheEntry *entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cache->head = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+    entry->prev = entry->next = NULL;
+    cache->count--;
+}
+
+static void svg_cache_push_front(SvgCache *cache, SvgCacheEntry *entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head)
+        cache->head->prev = entry;
+    else
+        cache->tail = entry;
+    cache->head = entry;
+    cache->count++;
+}
+
+static void svg_cache_free_entry(SvgCacheEntry *entry)
+{
+    nsvgDelete(entry->svg);
+    free(entry->path);
+    free(entry);
+}
+
+/**
+ * Frees released documents that changed on disk or no longer fit, called with the lock held.
+ */
+static void svg_cache_trim(SvgCache *cache)
+{
+    size_t over = cache->count > cache->capacity ? cache->count - cache->capacity : 0;
+    for (SvgCacheEntry *entry = cache->tail, *prev; entry; entry = prev)
+    {
+        prev = entry->prev;
+        if (entry->refs > 0 || (!entry->stale && over == 0))
+            continue;
+        if (!entry->stale)
+            over--;
+        svg_cache_unlink(cache, entry);
+        svg_cache_free_entry(entry);
+    }
+}
+
+void svg_cache_destroy(SvgCache *cache)
+{
+    while (cache->head)
+    {
+        SvgCacheEntry *entry = cache->head;
+        svg_cache_unlink(cache, entry);
+        svg_cache_free_entry(entry);
+    }
+#ifndef _WIN32
+    pthread_mutex_destroy(&cache->lock);
+#endif
+}
+
+/**
+ * The parsed document of @p path with one more reference, parsed now when the cache misses.
+ */
+static SvgCacheEntry *svg_cache_acquire(SvgCache *cache, const char *path)
+{
+    char canonical[IMAGE_FILE_PATH_MAX];
+    int64_t mtime, size;
+    if (!image_file_identity(path, canonical, &mtime, &size))
+    {
+        LOG_ERROR("Image file not found or inaccessible: %s", path);
+        return NULL;
+    }
+
+    SVG_CACHE_LOCK(cache);
+    for (SvgCacheEntry *entry = cache->head; entry; entry = entry->next)
+    {
+        if (entry->stale || strcmp(entry->path, canonical) != 0)
+            continue;
+        if (entry->mtime != mtime || entry->size != size)
+        {
+            entry->stale = true;
+            continue;
+        }
+        entry->refs++;
+        cache->hits++;
+        svg_cache_unlink(cache, entry);
+        svg_cache_push_front(cache, entry);
+        SVG_CACHE_UNLOCK(cache);
+        return entry;
+    }
+    SVG_CACHE_UNLOCK(cache);
+
+    // Parsed unlocked, two threads missing the same file both parse it and the later one is kept.
+    SvgCacheEntry *entry = calloc(1, sizeof(SvgCacheEntry));
+    if (!entry || !(entry->path = strdup(canonical)))
+    {
+        LOG_ERROR("Failed to allocate memory for SVG cache entry: %s", path);
+        free(entry);
+        return NULL;
+    }
+    entry->svg = nsvgParseFromFile(canonical, "px", 96);
+    if (!entry->svg)
+    {
+        LOG_ERROR("NanoSVG failed to parse SVG file: %s", path);
+        svg_cache_free_entry(entry);
+        return NULL;
+    }
+    entry->mtime = mtime;
+    entry->size = size;
+    entry->refs = 1;
+
+    SVG_CACHE_LOCK(cache);
+    cache->parses++;
+    svg_cache_push_front(cache, entry);
+    SVG_CACHE_UNLOCK(cache);
+    return entry;
+}
+
+static void svg_cache_release(SvgCache *cache, SvgCacheEntry *entry)
+{
+    SVG_CACHE_LOCK(cache);
+    entry->refs--;
+    svg_cache_trim(cache);
+    SVG_CACHE_UNLOCK(cache);
+}
+
+static bool svg_rasterize(const NSVGimage *svg, const char *path, int width, int height, DecodedImage *image)
+{
+    memset(image, 0, sizeof(*image));
+    if (svg->width <= 0.0f || svg->height <= 0.0f)
+    {
+        LOG_ERROR("SVG file has no size: %s", path);
+        return false;
+    }
+
+    float scale = 1.0f;
+    if (width > 0 && height > 0)
+        scale = fmaxf((float)width / svg->width, (float)height / svg->height);
+    const float largest = fmaxf(svg->width, svg->height) * scale;
+    if (largest > SVG_CACHE_MAX_RASTER)
+        scale *= SVG_CACHE_MAX_RASTER / largest;
+
+    image->width = (int)ceilf(svg->width * scale);
+    image->height = (int)ceilf(svg->height * scale);
+    image->channels = 4;
+    image->levels = 1;
+    if (image->width <= 0 || image->height <= 0)
+        return false;
+
+    const size_t stride = (size_t)image->width * 4;
+    image->pixels = calloc((size_t)image->height, stride);
+    NSVGrasterizer *rast = nsvgCreateRasterizer();
+    if (!image->pixels || !rast)
+    {
+        LOG_ERROR("Failed to allocate memory for SVG rasterization: %s", path);
+        nsvgDeleteRasterizer(rast);
+        decoded_image_free(image);
+        return false;
+    }
+    // The rasterizer only reads the document, threads share it.
+    nsvgRasterize(rast, (NSVGimage *)svg, 0, 0, scale, image->pixels, image->width, image->height, (int)stride);
+    nsvgDeleteRasterizer(rast);
+
+    // Rasterized top-down, textures take the first row as the bottom one.
+    unsigned char *row = malloc(stride);
+    if (row)
+    {
+        for (int y = 0; y < image->height / 2; ++y)
+        {
+            unsigned char *top = image->pixels + (size_t)y * stride;
+            unsigned char *bottom = image->pixels + (size_t)(image->height - 1 - y) * stride;
+            memcpy(row, top, stride);
+            memcpy(top, bottom, stride);
+            memcpy(bottom, row, stride);
+        }
+        free(row);
+    }
+    return true;
+}
+
+bool svg_cache_rasterize(SvgCache *cache, const char *path, int width, int height, DecodedImage *image)
+{
+    if (!cache)
+    {
+        NSVGimage *svg = nsvgParseFromFile(path, "px", 96);
+        if (!svg)
+        {
+            LOG_ERROR("NanoSVG failed to parse SVG file: %s", path);
+            return false;
+        }
+        const bool rasterized = svg_rasterize(svg, path, width, height, image);
+        nsvgDelete(svg);
+        return rasterized;
+    }
+
+    SvgCacheEntry *entry = svg_cache_acquire(cache, path);
+    if (!entry)
+        return false;
+    const bool rasterized = svg_rasterize(entry->svg, path, width, height, image);
+    svg_cache_release(cache, entry);
+    return rasterized;
+}
@@ -0,0 +1,88 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file svg_cache_internal.h
+ * @brief Parsed SVG documents kept in memory, rasterized at the size they are shown at.
+ *
+ * Vector images have no natural resolution: they are rasterized for the
+ * pixels they cover rather than at their intrinsic size and scaled on the
+ * GPU. A resized widget needs a new raster, so the parsed document is kept
+ * and the file is not read and parsed again.
+ *
+ * Documents are shared between threads rasterizing them concurrently. Past
+ * the capacity, the least recently used one not being rasterized is freed.
+ */
+
+#ifndef SVG_CACHE_INTERNAL_H
+#define SVG_CACHE_INTERNAL_H
+
+#include "backends/utils/image_decoder_internal.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Largest side of a raster, bigger requests are scaled down to it. */
+#define SVG_CACHE_MAX_RASTER 8192
+
+struct NSVGimage;
+
+typedef struct SvgCacheEntry SvgCacheEntry;
+
+struct SvgCacheEntry
+{
+    SvgCacheEntry *prev, *next; /**< Most recently used first. */
+    char *path;                 /**< Canonical. */
+    int64_t mtime, size;
+    struct NSVGimage *svg;
+    unsigned int refs;          /**< Rasterizations in progress, the entry stays until they end. */
+    bool stale;                 /**< Its file changed, it goes once released. */
+};
+
+struct SvgCache
+{
+#ifdef _WIN32
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+    SvgCacheEntry *head, *tail;
+    size_t count;
+    size_t capacity;
+    size_t parses; /**< Files parsed, against rasterizations served from memory. */
+    size_t hits;
+};
+
+void svg_cache_init(SvgCache *cache, size_t capacity);
+
+/**
+ * @brief Frees every document, nothing may be rasterizing.
+ */
+void svg_cache_destroy(SvgCache *cache);
+
+/**
+ * @brief Rasterizes @p path to cover @p width x @p height pixels, safe from any thread.
+ *
+ * The document keeps its aspect ratio and is scaled until neither side is
+ * smaller than requested, 0 x 0 keeps its intrinsic size. Rows are
+ * bottom-up, as DecodedImage holds them.
+ *
+ * @param cache Documents to reuse, NULL to parse the file and free it afterwards.
+ */
+bool svg_cache_rasterize(SvgCache *cache, const char *path, int width, int height, DecodedImage *image);
+
+#endif // SVG_CACHE_INTERNAL_H
@@ -0,0 +1,130 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/text_metrics_cache_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+bool text_metrics_cache_init(TextMetricsCache *cache, size_t capacity)
+{
+    memset(cache, 0, sizeof(*cache));
+
+    size_t set_count = 1;
+    while (set_count * TEXT_METRICS_CACHE_WAYS < capacity)
+        set_count <<= 1;
+
+    cache->entries = calloc(set_count * TEXT_METRICS_CACHE_WAYS, sizeof(TextMetricsEntry));
+    if (!cache->entries)
+        return false;
+
+    cache->set_count = set_count;
+    cache->generation = 1;
+    return true;
+}
+
+void text_metrics_cache_destroy(TextMetricsCache *cache)
+{
+    free(cache->entries);
+    memset(cache, 0, sizeof(*cache));
+}
+
+void text_metrics_cache_invalidate(TextMetricsCache *cache)
+{
+    if (!cache->entries)
+        return;
+
+    // Generation 0 marks empty slots, clear the table instead of wrapping onto it.
+    if (++cache->generation == 0)
+    {
+        memset(cache->entries, 0, cache->set_count * TEXT_METRICS_CACHE_WAYS * sizeof(TextMetricsEntry));
+        cache->generation = 1;
+    }
+}
+
+uint64_t text_metrics_cache_key(const char *text, int length, float font_size)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    for (int i = 0; i < length && text[i]; ++i)
+    {
+        hash ^= (unsigned char)text[i];
+        hash *= FNV_PRIME;
+    }
+
+    // The size goes in last so "ab" at 16px and "ab" at 18px land in different sets.
+    uint32_t size_bits;
+    memcpy(&size_bits, &font_size, sizeof(size_bits));
+    for (int i = 0; i < 4; ++i)
+    {
+        hash ^= (size_bits >> (i * 8)) & 0xFF;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static TextMetricsEntry *text_metrics_cache_set(TextMetricsCache *cache, uint64_t key)
+{
+    return &cache->entries[(key & (cache->set_count - 1)) * TEXT_METRICS_CACHE_WAYS];
+}
+
+const GooeyTextMetrics *text_metrics_cache_get(TextMetricsCache *cache, uint64_t key)
+{
+    if (!cache->entries)
+        return NULL;
+
+    TextMetricsEntry *set = text_metrics_cache_set(cache, key);
+    for (int way = 0; way < TEXT_METRICS_CACHE_WAYS; ++way)
+    {
+        if (set[way].generation == cache->generation && set[way].key == key)
+        {
+            set[way].last_used = ++cache->tick;
+            cache->stats.hits++;
+            return &set[way].metrics;
+        }
+    }
+
+    cache->stats.misses++;
+    return NULL;
+}
+
+void text_metrics_cache_put(TextMetricsCache *cache, uint64_t key, const GooeyTextMetrics *metrics)
+{
+    if (!cache->entries)
+        return;
+
+    TextMetricsEntry *set = text_metrics_cache_set(cache, key);
+    TextMetricsEntry *victim = &set[0];
+    for (int way = 0; way < TEXT_METRICS_CACHE_WAYS; ++way)
+    {
+        if (set[way].generation != cache->generation)
+        {
+            victim = &set[way];
+            break;
+        }
+        // Unsigned difference keeps the comparison right across tick wrap-around.
+        if (cache->tick - set[way].last_used > cache->tick - victim->last_used)
+            victim = &set[way];
+    }
+
+    victim->key = key;
+    victim->generation = cache->generation;
+    victim->last_used = ++cache->tick;
+    victim->metrics = *metrics;
+}
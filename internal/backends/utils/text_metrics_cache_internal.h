@@ -0,0 +1,83 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file text_metrics_cache_internal.h
+ * @brief Bounded cache of measured glyph runs, keyed by string hash and font size.
+ *
+ * Entries live in a fixed set-associative table: a key maps to one set of
+ * TEXT_METRICS_CACHE_WAYS entries and replaces the least recently used of
+ * them, so memory never grows past what init allocated. Invalidation is by
+ * generation: bumping it turns every entry stale without touching the table,
+ * which is what the backend does whenever glyph metrics may have changed.
+ */
+
+#ifndef TEXT_METRICS_CACHE_INTERNAL_H
+#define TEXT_METRICS_CACHE_INTERNAL_H
+
+#include "common/gooey_common.h"
+#include <stdint.h>
+
+/** Entries per set, a key can only live in its own set. */
+#define TEXT_METRICS_CACHE_WAYS 4
+
+typedef struct
+{
+    uint64_t key;
+    uint32_t generation; /**< 0 for a slot that never held an entry. */
+    uint32_t last_used;
+    GooeyTextMetrics metrics;
+} TextMetricsEntry;
+
+typedef struct
+{
+    size_t hits;
+    size_t misses;
+} TextMetricsCacheStats;
+
+typedef struct
+{
+    TextMetricsEntry *entries;
+    size_t set_count; /**< Power of two. */
+    uint32_t generation;
+    uint32_t tick;
+    TextMetricsCacheStats stats;
+} TextMetricsCache;
+
+/**
+ * @brief Allocates room for at least @p capacity entries, rounded up to whole sets.
+ */
+bool text_metrics_cache_init(TextMetricsCache *cache, size_t capacity);
+void text_metrics_cache_destroy(TextMetricsCache *cache);
+
+/**
+ * @brief Drops every entry, call it when the font or atlas metrics change.
+ */
+void text_metrics_cache_invalidate(TextMetricsCache *cache);
+
+/**
+ * @brief Hashes the first @p length bytes of @p text, stopping early at a NUL, together with @p font_size.
+ */
+uint64_t text_metrics_cache_key(const char *text, int length, float font_size);
+
+/**
+ * @return The cached metrics for @p key, or NULL on a miss.
+ */
+const GooeyTextMetrics *text_metrics_cache_get(TextMetricsCache *cache, uint64_t key);
+void text_metrics_cache_put(TextMetricsCache *cache, uint64_t key, const GooeyTextMetrics *metrics);
+
+#endif // TEXT_METRICS_CACHE_INTERNAL_H
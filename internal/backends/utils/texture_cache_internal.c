@@ -0,0 +1,239 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/texture_cache_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/image_decoder_internal.h"
+#include "backends/utils/gl_state_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+static size_t texture_cache_bytes(int width, int height)
+{
+    // RGBA8 texels plus a third for the mipmap chain.
+    return (size_t)width * height * 4 * 4 / 3;
+}
+
+void texture_cache_init(TextureCache *cache, size_t budget)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->budget = budget;
+}
+
+static void texture_cache_unlink(TextureCache *cache, TextureCacheEntry *entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cache->head = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+static void texture_cache_push_front(TextureCache *cache, TextureCacheEntry *entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head)
+        cache->head->prev = entry;
+    else
+        cache->tail = entry;
+    cache->head = entry;
+}
+
+static void texture_cache_delete(TextureCache *cache, TextureCacheEntry *entry)
+{
+    texture_cache_unlink(cache, entry);
+    gl_state_delete_textures(1, &entry->texture);
+    cache->bytes -= entry->bytes;
+    cache->count--;
+    cache->deletions++;
+    free(entry->path);
+    free(entry);
+}
+
+void texture_cache_destroy(TextureCache *cache)
+{
+    while (cache->head)
+        texture_cache_delete(cache, cache->head);
+}
+
+bool texture_cache_file_key(const char *path, TextureFileKey *key)
+{
+    key->width = key->height = 0;
+    key->exact = false;
+    return image_file_identity(path, key->path, &key->mtime, &key->size);
+}
+
+static bool texture_cache_same_file(const TextureCacheEntry *entry, const TextureFileKey *key)
+{
+    return entry->path && entry->mtime == key->mtime && entry->size == key->size && strcmp(entry->path, key->path) == 0;
+}
+
+/**
+ * The texture downscaled to the key's size, or else the full one unless the key is exact.
+ */
+static TextureCacheEntry *texture_cache_find_file(const TextureCache *cache, const TextureFileKey *key)
+{
+    TextureCacheEntry *full = NULL;
+    for (TextureCacheEntry *entry = cache->head; entry; entry = entry->next)
+    {
+        if (entry->stale || !texture_cache_same_file(entry, key))
+            continue;
+        if (entry->width == key->width && entry->height == key->height)
+            return entry;
+        if (entry->width == 0 && entry->height == 0 && !key->exact)
+            full = entry;
+    }
+    return full;
+}
+
+bool texture_cache_has_file(const TextureCache *cache, const TextureFileKey *key)
+{
+    return texture_cache_find_file(cache, key) != NULL;
+}
+
+static GLuint texture_cache_hit(TextureCache *cache, TextureCacheEntry *entry)
+{
+    if (!entry)
+    {
+        cache->stats.misses++;
+        return 0;
+    }
+
+    cache->stats.hits++;
+    entry->refs++;
+    texture_cache_unlink(cache, entry);
+    texture_cache_push_front(cache, entry);
+    return entry->texture;
+}
+
+GLuint texture_cache_acquire_file(TextureCache *cache, const TextureFileKey *key)
+{
+    return texture_cache_hit(cache, texture_cache_find_file(cache, key));
+}
+
+GLuint texture_cache_acquire_content(TextureCache *cache, uint64_t content_hash)
+{
+    TextureCacheEntry *found = NULL;
+    for (TextureCacheEntry *entry = cache->head; entry && !found; entry = entry->next)
+    {
+        if (!entry->path && entry->content_hash == content_hash)
+            found = entry;
+    }
+    return texture_cache_hit(cache, found);
+}
+
+/**
+ * Deletes unreferenced textures, least recently used first, until the cache fits its budget.
+ */
+static void texture_cache_trim(TextureCache *cache)
+{
+    for (TextureCacheEntry *entry = cache->tail; entry && cache->bytes > cache->budget;)
+    {
+        TextureCacheEntry *previous = entry->prev;
+        if (entry->refs == 0)
+        {
+            texture_cache_delete(cache, entry);
+            cache->stats.evictions++;
+        }
+        entry = previous;
+    }
+}
+
+static TextureCacheEntry *texture_cache_insert(TextureCache *cache, GLuint texture, int width, int height)
+{
+    TextureCacheEntry *entry = calloc(1, sizeof(TextureCacheEntry));
+    if (!entry)
+    {
+        LOG_ERROR("Failed to allocate texture cache entry");
+        return NULL;
+    }
+
+    entry->texture = texture;
+    entry->bytes = texture_cache_bytes(width, height);
+    entry->refs = 1;
+    texture_cache_push_front(cache, entry);
+    cache->bytes += entry->bytes;
+    cache->count++;
+    return entry;
+}
+
+bool texture_cache_insert_file(TextureCache *cache, const TextureFileKey *key, GLuint texture, int width, int height)
+{
+    char *path = strdup(key->path);
+    TextureCacheEntry *entry = path ? texture_cache_insert(cache, texture, width, height) : NULL;
+    if (!entry)
+    {
+        free(path);
+        return false;
+    }
+    entry->path = path;
+    entry->mtime = key->mtime;
+    entry->size = key->size;
+    entry->width = key->width;
+    entry->height = key->height;
+
+    // Older versions of the file stay valid for whoever still draws them, nobody gets them anymore.
+    for (TextureCacheEntry *other = entry->next; other;)
+    {
+        TextureCacheEntry *next = other->next;
+        if (other->path && strcmp(other->path, key->path) == 0 && !texture_cache_same_file(other, key))
+        {
+            other->stale = true;
+            if (other->refs == 0)
+                texture_cache_delete(cache, other);
+        }
+        other = next;
+    }
+
+    texture_cache_trim(cache);
+    return true;
+}
+
+bool texture_cache_insert_content(TextureCache *cache, uint64_t content_hash, GLuint texture, int width, int height)
+{
+    TextureCacheEntry *entry = texture_cache_insert(cache, texture, width, height);
+    if (!entry)
+        return false;
+    entry->content_hash = content_hash;
+    texture_cache_trim(cache);
+    return true;
+}
+
+bool texture_cache_release(TextureCache *cache, GLuint texture)
+{
+    for (TextureCacheEntry *entry = cache->head; entry; entry = entry->next)
+    {
+        if (entry->texture != texture)
+            continue;
+
+        if (entry->refs > 0)
+            entry->refs--;
+        if (entry->refs == 0 && entry->stale)
+            texture_cache_delete(cache, entry);
+        texture_cache_trim(cache);
+        return true;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file texture_cache_internal.h
+ * @brief Image textures shared by every widget that shows the same picture.
+ *
+ * Textures loaded from a file are keyed by its canonical path, along with
+ * its modification time and size so that a file replaced on disk is loaded
+ * again, and the size it was downscaled to. A full size texture of the file
+ * serves any size, it costs nothing more once resident. Textures decoded
+ * from memory are keyed by a hash of the encoded bytes.
+ *
+ * Every load takes a reference and every unload drops one. Textures nobody
+ * references stay resident, ready for the next load, until the cache holds
+ * more than its budget: they are then deleted least recently used first.
+ * Referenced textures are never evicted, the budget can be exceeded by them.
+ */
+
+#ifndef TEXTURE_CACHE_INTERNAL_H
+#define TEXTURE_CACHE_INTERNAL_H
+
+#include "backends/utils/backend_utils_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/image_decoder_internal.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TEXTURE_CACHE_PATH_MAX IMAGE_FILE_PATH_MAX
+
+/**
+ * @brief What identifies the content of an image file.
+ */
+typedef struct
+{
+    char path[TEXTURE_CACHE_PATH_MAX]; /**< Canonical, symbolic links and ".." resolved. */
+    int64_t mtime;
+    int64_t size;
+    int width, height; /**< Size the texture was downscaled to, 0 for the full image. */
+    bool exact;        /**< Only a texture made for this size will do, the full image is not a fallback. */
+} TextureFileKey;
+
+typedef struct TextureCacheEntry TextureCacheEntry;
+
+struct TextureCacheEntry
+{
+    TextureCacheEntry *prev, *next; /**< Most recently used first. */
+    char *path;                     /**< NULL for textures keyed by content. */
+    int64_t mtime, size;
+    int width, height; /**< TextureFileKey::width and height. */
+    uint64_t content_hash;
+    GLuint texture;
+    size_t bytes;
+    unsigned int refs;
+    bool stale; /**< Its file changed, it is deleted as soon as it is released. */
+};
+
+typedef struct
+{
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} TextureCacheStats;
+
+typedef struct
+{
+    TextureCacheEntry *head, *tail;
+    size_t count;
+    size_t bytes;
+    size_t budget;
+    size_t deletions; /**< Textures deleted so far, their names may come back for other images. */
+    TextureCacheStats stats;
+} TextureCache;
+
+void texture_cache_init(TextureCache *cache, size_t budget);
+
+/**
+ * @brief Deletes every texture, referenced or not. A context sharing them must be current.
+ */
+void texture_cache_destroy(TextureCache *cache);
+
+/**
+ * @brief Resolves @p path and reads what identifies its content, for the full size image.
+ *
+ * @return false when the file does not exist.
+ */
+bool texture_cache_file_key(const char *path, TextureFileKey *key);
+
+/**
+ * @brief Whether the file's texture is resident, without taking a reference.
+ */
+bool texture_cache_has_file(const TextureCache *cache, const TextureFileKey *key);
+
+/**
+ * @brief References the file's texture.
+ *
+ * @return The texture, 0 on a miss.
+ */
+GLuint texture_cache_acquire_file(TextureCache *cache, const TextureFileKey *key);
+GLuint texture_cache_acquire_content(TextureCache *cache, uint64_t content_hash);
+
+/**
+ * @brief Adds a freshly uploaded texture with one reference, older versions of the file go stale.
+ *
+ * @return false when it could not be tracked, the caller then owns the texture alone.
+ */
+bool texture_cache_insert_file(TextureCache *cache, const TextureFileKey *key, GLuint texture, int width, int height);
+bool texture_cache_insert_content(TextureCache *cache, uint64_t content_hash, GLuint texture, int width, int height);
+
+/**
+ * @brief Drops a reference to @p texture.
+ *
+ * @return false when the texture is not in the cache, the caller should delete it itself.
+ */
+bool texture_cache_release(TextureCache *cache, GLuint texture);
+
+#endif
+#endif // TEXTURE_CACHE_INTERNAL_H
@@ -0,0 +1,175 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backends/utils/timer_heap_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TIMER_HEAP_INITIAL_CAPACITY 64
+
+void timer_heap_init(TimerHeap *heap)
+{
+    memset(heap, 0, sizeof(*heap));
+}
+
+void timer_heap_destroy(TimerHeap *heap)
+{
+    for (size_t i = 0; i < heap->count; ++i)
+        heap->entries[i]->slot = TIMER_HEAP_DISARMED;
+    free(heap->entries);
+    memset(heap, 0, sizeof(*heap));
+}
+
+void timer_heap_timer_init(HeapTimer *timer)
+{
+    memset(timer, 0, sizeof(*timer));
+    timer->slot = TIMER_HEAP_DISARMED;
+}
+
+static void timer_heap_place(TimerHeap *heap, HeapTimer *timer, size_t slot)
+{
+    heap->entries[slot] = timer;
+    timer->slot = slot;
+}
+
+static void timer_heap_sift_up(TimerHeap *heap, size_t slot)
+{
+    HeapTimer *timer = heap->entries[slot];
+    while (slot > 0)
+    {
+        const size_t parent = (slot - 1) / 2;
+        if (heap->entries[parent]->deadline_ms <= timer->deadline_ms)
+            break;
+        timer_heap_place(heap, heap->entries[parent], slot);
+        slot = parent;
+    }
+    timer_heap_place(heap, timer, slot);
+}
+
+static void timer_heap_sift_down(TimerHeap *heap, size_t slot)
+{
+    HeapTimer *timer = heap->entries[slot];
+    for (;;)
+    {
+        size_t child = slot * 2 + 1;
+        if (child >= heap->count)
+            break;
+        if (child + 1 < heap->count && heap->entries[child + 1]->deadline_ms < heap->entries[child]->deadline_ms)
+            child++;
+        if (timer->deadline_ms <= heap->entries[child]->deadline_ms)
+            break;
+        timer_heap_place(heap, heap->entries[child], slot);
+        slot = child;
+    }
+    timer_heap_place(heap, timer, slot);
+}
+
+/**
+ * Moves an armed timer whose deadline changed to where it now belongs.
+ */
+static void timer_heap_fix(TimerHeap *heap, size_t slot)
+{
+    if (slot > 0 && heap->entries[(slot - 1) / 2]->deadline_ms > heap->entries[slot]->deadline_ms)
+        timer_heap_sift_up(heap, slot);
+    else
+        timer_heap_sift_down(heap, slot);
+}
+
+static bool timer_heap_grow(TimerHeap *heap)
+{
+    const size_t capacity = heap->capacity ? heap->capacity * 2 : TIMER_HEAP_INITIAL_CAPACITY;
+    HeapTimer **entries = realloc(heap->entries, capacity * sizeof(HeapTimer *));
+    if (!entries)
+    {
+        LOG_ERROR("Failed to grow the timer heap to %zu timers", capacity);
+        return false;
+    }
+    heap->entries = entries;
+    heap->capacity = capacity;
+    return true;
+}
+
+bool timer_heap_arm(TimerHeap *heap, HeapTimer *timer, uint64_t interval_ms, uint64_t now_ms)
+{
+    // A zero interval would fire on every pass of the loop without ever letting it sleep.
+    timer->interval_ms = interval_ms ? interval_ms : 1;
+    timer->deadline_ms = now_ms + timer->interval_ms;
+
+    if (timer->slot != TIMER_HEAP_DISARMED)
+    {
+        timer_heap_fix(heap, timer->slot);
+        return true;
+    }
+
+    if (heap->count == heap->capacity && !timer_heap_grow(heap))
+        return false;
+    heap->entries[heap->count] = timer;
+    timer_heap_sift_up(heap, heap->count++);
+    return true;
+}
+
+void timer_heap_cancel(TimerHeap *heap, HeapTimer *timer)
+{
+    const size_t slot = timer->slot;
+    if (slot == TIMER_HEAP_DISARMED)
+        return;
+
+    timer->slot = TIMER_HEAP_DISARMED;
+    HeapTimer *last = heap->entries[--heap->count];
+    if (last == timer)
+        return;
+    timer_heap_place(heap, last, slot);
+    timer_heap_fix(heap, slot);
+}
+
+int64_t timer_heap_timeout(const TimerHeap *heap, uint64_t now_ms)
+{
+    if (heap->count == 0)
+        return -1;
+    const uint64_t deadline = heap->entries[0]->deadline_ms;
+    return deadline <= now_ms ? 0 : (int64_t)(deadline - now_ms);
+}
+
+size_t timer_heap_run_expired(TimerHeap *heap, uint64_t now_ms)
+{
+    size_t fired = 0;
+    while (heap->count > 0 && heap->entries[0]->deadline_ms <= now_ms)
+    {
+        HeapTimer *timer = heap->entries[0];
+
+        // Rescheduled before the callback runs, so it is free to stop or destroy its own timer.
+        // A late timer skips the periods it missed rather than firing in a burst.
+        timer->deadline_ms += timer->interval_ms;
+        if (timer->deadline_ms <= now_ms)
+            timer->deadline_ms = now_ms + timer->interval_ms;
+        timer_heap_sift_down(heap, 0);
+
+        fired++;
+        heap->fired++;
+        if (timer->callback)
+            timer->callback(timer->user_data);
+    }
+    return fired;
+}
+
+void timer_heap_get_stats(const TimerHeap *heap, TimerHeapStats *stats)
+{
+    stats->armed = heap->count;
+    stats->fired = heap->fired;
+    stats->capacity = heap->capacity;
+}
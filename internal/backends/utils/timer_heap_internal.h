@@ -0,0 +1,101 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file timer_heap_internal.h
+ * @brief Periodic timers ordered by deadline in a binary min-heap.
+ *
+ * Arming and cancelling are O(log n): every timer remembers its slot in the
+ * heap, so it is sifted in place instead of searched for. The soonest
+ * deadline sits at the root, which is what the event loop sleeps until.
+ *
+ * Timers are owned by their creator; the heap only holds pointers to the
+ * armed ones and grows as needed. Deadlines are in event_loop_now_ms() time.
+ */
+
+#ifndef TIMER_HEAP_INTERNAL_H
+#define TIMER_HEAP_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TIMER_HEAP_DISARMED ((size_t)-1)
+
+typedef struct
+{
+    void (*callback)(void *user_data);
+    void *user_data;
+    uint64_t interval_ms;
+    uint64_t deadline_ms;
+    size_t slot; /**< Index in TimerHeap::entries, TIMER_HEAP_DISARMED when not armed. */
+} HeapTimer;
+
+typedef struct
+{
+    size_t armed;    /**< Timers currently waiting. */
+    size_t fired;    /**< Callbacks run since init. */
+    size_t capacity; /**< Slots allocated, grows and never shrinks. */
+} TimerHeapStats;
+
+typedef struct
+{
+    HeapTimer **entries;
+    size_t count;
+    size_t capacity;
+    size_t fired;
+} TimerHeap;
+
+void timer_heap_init(TimerHeap *heap);
+
+/**
+ * @brief Frees the heap's storage, the timers it held are left disarmed.
+ */
+void timer_heap_destroy(TimerHeap *heap);
+
+void timer_heap_timer_init(HeapTimer *timer);
+
+/**
+ * @brief (Re)arms @p timer to fire every @p interval_ms from @p now_ms on.
+ *
+ * @return false when the heap could not grow, the timer is then left disarmed.
+ */
+bool timer_heap_arm(TimerHeap *heap, HeapTimer *timer, uint64_t interval_ms, uint64_t now_ms);
+
+/**
+ * @brief Disarms @p timer, a no-op when it is not armed.
+ */
+void timer_heap_cancel(TimerHeap *heap, HeapTimer *timer);
+
+/**
+ * @brief Milliseconds until the soonest deadline, 0 when overdue, -1 when no timer is armed.
+ */
+int64_t timer_heap_timeout(const TimerHeap *heap, uint64_t now_ms);
+
+/**
+ * @brief Runs the callback of every timer due at @p now_ms and schedules its next period.
+ *
+ * Each timer fires at most once per call, however late it is. Callbacks may
+ * arm, cancel or free any timer, their own included.
+ *
+ * @return Number of callbacks run.
+ */
+size_t timer_heap_run_expired(TimerHeap *heap, uint64_t now_ms);
+
+void timer_heap_get_stats(const TimerHeap *heap, TimerHeapStats *stats);
+
+#endif // TIMER_HEAP_INTERNAL_H
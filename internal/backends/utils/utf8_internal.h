@@ -0,0 +1,93 @@
+/*
+ Copyright (c) 2025 Yassine Ahmed Ali
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file utf8_internal.h
+ * @brief UTF-8 decoding shared by every text renderer.
+ */
+
+#ifndef UTF8_INTERNAL_H
+#define UTF8_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Code point drawn for malformed UTF-8. */
+#define UTF8_REPLACEMENT_CHAR 0xFFFD
+
+/**
+ * @brief Decodes one UTF-8 sequence and advances @p text past it.
+ *
+ * Malformed sequences consume one byte and decode to UTF8_REPLACEMENT_CHAR.
+ * A sequence cut short by @p remaining decodes to it too and consumes the
+ * rest of the range, nothing past it is read.
+ *
+ * @param remaining Bytes left in the range, SIZE_MAX for a NUL-terminated string.
+ */
+static inline uint32_t utf8_decode(const char **text, size_t remaining)
+{
+    const unsigned char *s = (const unsigned char *)*text;
+    uint32_t codepoint;
+    size_t length;
+
+    if (s[0] < 0x80)
+    {
+        *text += 1;
+        return s[0];
+    }
+    else if ((s[0] & 0xE0) == 0xC0)
+    {
+        codepoint = s[0] & 0x1F;
+        length = 2;
+    }
+    else if ((s[0] & 0xF0) == 0xE0)
+    {
+        codepoint = s[0] & 0x0F;
+        length = 3;
+    }
+    else if ((s[0] & 0xF8) == 0xF0)
+    {
+        codepoint = s[0] & 0x07;
+        length = 4;
+    }
+    else
+    {
+        *text += 1;
+        return UTF8_REPLACEMENT_CHAR;
+    }
+
+    if (length > remaining)
+    {
+        *text += remaining;
+        return UTF8_REPLACEMENT_CHAR;
+    }
+
+    for (size_t i = 1; i < length; ++i)
+    {
+        if ((s[i] & 0xC0) != 0x80)
+        {
+            *text += 1;
+            return UTF8_REPLACEMENT_CHAR;
+        }
+        codepoint = (codepoint << 6) | (s[i] & 0x3F);
+    }
+
+    *text += length;
+    return codepoint;
+}
+
+#endif // UTF8_INTERNAL_H
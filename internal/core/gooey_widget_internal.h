@@ -1,7 +1,9 @@
 #ifndef GOOEY_WIDGET_INTERNAL_H
 #define GOOEY_WIDGET_INTERNAL_H
 
+#include "common/gooey_common.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,6 +35,72 @@ void GooeyWidget_MoveTo_Internal(void *widget, int x, int y);
  */
 void GooeyWidget_Resize_Internal(void *widget, int w, int h);
 
+/**
+ * @brief Appends the widget's last recording to the frame if the widget is unchanged.
+ *
+ * The widget is unchanged when its struct, the window theme and the
+ * backend state the recording depends on are the same as when it was made.
+ * Call at the top of the widget's draw, skip drawing when it returns true.
+ *
+ * @param win Window being drawn.
+ * @param widget Pointer to the widget, starting with its GooeyWidget core.
+ * @param size Size of the whole widget struct.
+ * @return true if the recording was replayed.
+ */
+bool GooeyWidget_Replay_Internal(GooeyWindow *win, void *widget, size_t size);
+
+/**
+ * @brief Starts recording what the widget draws, after a failed replay.
+ */
+void GooeyWidget_BeginRecord_Internal(GooeyWindow *win, void *widget);
+
+/**
+ * @brief Stores the recording started by GooeyWidget_BeginRecord_Internal().
+ *
+ * The widget is keyed after drawing, state the draw itself updates is part of it.
+ */
+void GooeyWidget_EndRecord_Internal(GooeyWindow *win, void *widget, size_t size);
+
+/**
+ * @brief Forces the widget to be drawn again instead of replayed.
+ *
+ * For state the widget only points to, e.g. a text buffer owned by the application.
+ */
+void GooeyWidget_Invalidate_Internal(void *widget);
+
+/**
+ * @brief Frees the widget's recording, call before freeing the widget.
+ */
+void GooeyWidget_ReleaseDisplayList_Internal(void *widget);
+
+/**
+ * @brief Enables or disables the widget's layer, see GooeyWidget_SetLayerCached().
+ */
+void GooeyWidget_SetLayerCached_Internal(void *widget, bool cached);
+
+/**
+ * @brief Composites the widget's cached layer, or prepares to draw its content.
+ *
+ * Everything drawn between this call and GooeyWidget_EndLayer_Internal()
+ * has to stay inside the rectangle and depend only on the widget's state,
+ * the theme and @p state. Widgets without a layer always draw.
+ *
+ * @param state Bytes the content depends on besides the widget's geometry and theme, hashed into the key.
+ * @return true if the content has to be drawn, false if the layer was composited instead.
+ */
+bool GooeyWidget_BeginLayer_Internal(GooeyWindow *win, void *widget, int x, int y, int width, int height,
+                                     const void *state, size_t state_size);
+
+/**
+ * @brief Moves what was drawn since GooeyWidget_BeginLayer_Internal() into the widget's layer.
+ */
+void GooeyWidget_EndLayer_Internal(GooeyWindow *win, void *widget);
+
+/**
+ * @brief Frees the widget's layer, call before freeing the widget.
+ */
+void GooeyWidget_ReleaseLayer_Internal(void *widget);
+
 #ifdef __cplusplus
 }
 #endif
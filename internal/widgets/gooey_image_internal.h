@@ -10,11 +10,45 @@
 #ifndef GOOEY_IMAGE_INTERNAL_H
 #define GOOEY_IMAGE_INTERNAL_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include "common/gooey_common.h"
 
 #if (ENABLE_IMAGE)
 
+/** Set in GooeyImageStream::ready while the frame it names has not been taken by the UI thread. */
+#define GOOEY_IMAGE_FRAME_FRESH 0x4
+
+/**
+ * @brief One frame pushed with GooeyImage_UpdatePixels(), tightly packed RGBA.
+ */
+typedef struct
+{
+    unsigned char *pixels;
+    size_t capacity;
+    int width, height;
+} GooeyImageFrame;
+
+/**
+ * @brief Triple buffer between the thread producing frames and the UI thread.
+ *
+ * Each frame belongs in turn to the producer, who fills it, to the mailbox
+ * and to the UI thread, who uploads it. Both sides swap the frame they hold
+ * with the one in the mailbox; neither ever waits. A frame still in the
+ * mailbox when the next one is pushed is dropped: the display always gets
+ * the newest frame and a fast producer never queues up latency.
+ */
+struct GooeyImageStream
+{
+    GooeyImageFrame frames[3];
+    int producer;                  /**< Frame being filled, only touched by the producer. */
+    int consumer;                  /**< Frame last uploaded, only touched by the UI thread. */
+    atomic_int ready;              /**< Frame in the mailbox, with GOOEY_IMAGE_FRAME_FRESH until it is taken. */
+    atomic_bool active;            /**< A frame was pushed, the file is no longer shown. */
+    atomic_uint_fast64_t dropped;  /**< Frames replaced before they were displayed. */
+    _Atomic(GooeyWindow *) window; /**< Window redrawn when a frame arrives, NULL until the image is first drawn. */
+};
+
 bool GooeyImage_HandleClick(GooeyWindow *win, int mouseX, int mouseY);
 
 /**
@@ -26,6 +60,27 @@ bool GooeyImage_HandleClick(GooeyWindow *win, int mouseX, int mouseY);
  */
 void GooeyImage_Draw(GooeyWindow* win);
 
+/**
+ * @brief Drops the image's pending asynchronous load, if any.
+ *
+ * Must be called before an image with a load in flight is freed.
+ *
+ * @param image The image whose load to cancel.
+ */
+void GooeyImage_CancelLoad_Internal(GooeyImage *image);
+
+/**
+ * @brief Allocates an empty stream for GooeyImage_UpdatePixels().
+ *
+ * @return NULL when out of memory.
+ */
+GooeyImageStream *GooeyImage_CreateStream_Internal(void);
+
+/**
+ * @brief Frees a stream and its frames, the producer must have stopped.
+ */
+void GooeyImage_DestroyStream_Internal(GooeyImageStream *stream);
+
 #endif // ENABLE_IMAGE
 
 #endif // GOOEY_IMAGE_INTERNAL_H
@@ -0,0 +1,56 @@
+/**
+ * @file gooey_image_viewer_internal.h
+ * @brief Internal image viewer functions for the Gooey GUI library.
+ * @author Yassine Ahmed Ali
+ * @copyright GNU General Public License v3.0
+ *
+ * This file contains the functions drawing image viewers, streaming their
+ * tiles and handling their input.
+ */
+
+#ifndef GOOEY_IMAGE_VIEWER_INTERNAL_H
+#define GOOEY_IMAGE_VIEWER_INTERNAL_H
+
+#include <stdbool.h>
+#include "common/gooey_common.h"
+
+#if (ENABLE_IMAGE_VIEWER)
+
+/**
+ * @brief Draws all image viewers in a Gooey window, loading the tiles they miss.
+ *
+ * @param win The Gooey window containing the image viewers to draw.
+ */
+void GooeyImageViewer_Draw(GooeyWindow *win);
+
+/**
+ * @brief Pans the viewer being dragged.
+ *
+ * @return true when a view moved.
+ */
+bool GooeyImageViewer_HandleDrag(GooeyWindow *win, void *event);
+
+/**
+ * @brief Zooms the viewer under the pointer.
+ *
+ * @return true when a view changed.
+ */
+bool GooeyImageViewer_HandleScroll(GooeyWindow *win, void *event);
+
+/**
+ * @brief Keeps the zoom between fitting half the viewer and 16x, and the center on the image.
+ */
+void GooeyImageViewer_ClampView_Internal(GooeyImageViewer *viewer);
+
+/**
+ * @brief Cancels the viewer's pending loads and releases its tiles.
+ *
+ * Must be called before a viewer is freed.
+ *
+ * @param viewer The image viewer to release.
+ */
+void GooeyImageViewer_Release_Internal(GooeyImageViewer *viewer);
+
+#endif // ENABLE_IMAGE_VIEWER
+
+#endif // GOOEY_IMAGE_VIEWER_INTERNAL_H
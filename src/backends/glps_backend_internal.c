@@ -7,123 +7,355 @@
 
 #include "backends/utils/backend_utils_internal.h"
 #if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/render_batch_internal.h"
+#include "backends/utils/glyph_atlas_internal.h"
+#include "backends/utils/text_metrics_cache_internal.h"
+#include "backends/utils/damage_tracker_internal.h"
+#include "backends/utils/partial_present_internal.h"
+#include "backends/utils/layer_cache_internal.h"
+#include "backends/utils/event_loop_internal.h"
+#include "backends/utils/timer_heap_internal.h"
+#include "backends/utils/image_decoder_internal.h"
+#include "backends/utils/disk_image_cache_internal.h"
+#include "backends/utils/stream_texture_internal.h"
+#include "backends/utils/svg_cache_internal.h"
+#include "backends/utils/polyline_internal.h"
+#include "backends/utils/headless_surface_internal.h"
+#include "backends/utils/texture_cache_internal.h"
+#include "backends/utils/gl_state_internal.h"
+#include "backends/utils/render_workers_internal.h"
 #include "backends/utils/stb_image/stb_image.h"
 #include "backends/fonts/roboto.h"
 #include "logger/pico_logger_internal.h"
 #include <time.h>
 #include <nfd.h>
+
+/**
+ * Per-window state of damage-region rendering, see damage_tracker_internal.h.
+ */
+typedef struct
+{
+    DamageTracker tracker;
+    size_t repainted_pixels; /**< Cleared and redrawn by the last frame, 0 when it was skipped. */
+} GlpsWindowDamage;
+
+typedef struct
+{
+    GlStateStats frame_start; /**< Counters of the window's context when its frame was cleared. */
+    GlStateStats last_frame;  /**< Calls its last frame issued and skipped. */
+} GlpsWindowCalls;
+
+/**
+ * What a window is recording, display lists and layers are recorded one at a time per window.
+ */
+typedef struct
+{
+    bool list;           /**< A display list is being recorded, from mark on. */
+    RenderBatchMark mark;
+    GooeyLayer *layer;   /**< Layer whose content is being drawn, layers do not nest. */
+} GlpsWindowRecording;
+
+/**
+ * A widget's recorded primitives, valid while nothing they depend on changed.
+ */
+struct GooeyDisplayList
+{
+    RenderBatchList commands;
+    uint64_t generation;     /**< ctx.display_list_generation it was recorded in, 0 when it cannot be replayed. */
+    const GlyphAtlas *atlas; /**< Atlas its glyph quads sample. */
+    int width, height;       /**< Viewport its vertices were converted to device coordinates with. */
+    uint32_t glyph_pages;    /**< Atlas pages its glyphs live in, one bit per page. */
+};
+
+/**
+ * Frame a window started drawing and has not presented yet. Its batch may
+ * sample atlas pages and layers used since, which must not be evicted.
+ */
+typedef struct
+{
+    bool in_flight;
+    uint64_t atlas, sdf_atlas, layers; /**< Frame counters when it was cleared. */
+} GlpsFramePin;
+
+/**
+ * How a window drawn on a worker is presented, see THREADED_FRAME_INTERVAL_MS.
+ */
 typedef struct
 {
-    GLuint textureID;
-    int width, height;
-    int bearingX, bearingY;
-    int advance;
-} Glyph;
+    bool swap_set_up;       /**< Its swap interval was set, when its first frame was presented. */
+    atomic_bool unsynced;   /**< Its swaps do not wait for the display, its worker paces it. */
+    uint64_t frame_ms;      /**< When the frame it presented last was due, only its worker uses it. */
+} GlpsWindowPacing;
+
 typedef struct
 {
-    GLuint *text_programs;
     GLuint shape_program;
-    GLuint text_vbo;
-    GLuint shape_vbo;
-    GLuint *text_vaos;
-    GLuint *shape_vaos;
-    mat4x4 projection;
-    GLuint text_fragment_shader;
+    GLuint quad_program;
+    RenderBatch *batches;
+    GlpsWindowDamage *damage;
+    GlState *gl_states; /**< One per window context, headless windows all share the first. */
+    GlpsWindowCalls *gl_calls;
+    size_t seen_glyph_evictions; /**< Evictions move glyphs under unchanged quads, they damage every window. */
+    size_t seen_texture_deletions;
+    uint64_t display_list_generation; /**< Bumped whenever recorded primitives may no longer draw the same. */
+    GlpsWindowRecording *recording;
+    LayerCache layers;
+    TextureCache textures;
+    LayerTarget *layer_targets; /**< One per window, framebuffers are not shared between contexts. */
+    RenderBatchProgram shape;
+    QuadProgram quad;
     glps_WindowManager *wm;
-    glps_timer **timers;
-    GLuint text_vertex_shader;
-    Character characters[128];
+    bool headless;           /**< Windows are offscreen framebuffers of surface, there is no wm. */
+    HeadlessSurface surface;
+    void (*frame_callback)(size_t window_id, void *data); /**< Handles a window's events and redraws it. */
+    void *frame_data;
+    atomic_bool pending_windows[MAX_WINDOWS]; /**< Windows with input or a redraw request not handled yet. */
+    atomic_bool ticking_windows[MAX_WINDOWS]; /**< Windows that get a frame on every pass of the loop, see glps_frame_done(). */
+    bool input_seen;             /**< The window system delivered input since the loop last looked. */
+    bool threaded;          /**< Windows run on their own threads from glps_run on, see render_workers_internal.h. */
+    RenderWorkers workers;  /**< Set up while glps_run runs threaded. */
+    GooeyMouseData queued_pointer[MAX_WINDOWS]; /**< Last pointer position queued for each window's worker. */
+    GlpsFramePin frame_pins[MAX_WINDOWS];
+    GlpsWindowPacing pacing[MAX_WINDOWS];
+    TimerHeap timers;
+    EventLoop loop;
+    ImageDecoder decoder;
+    DiskImageCache disk_images;
+    SvgCache svgs;
+    StreamTexture *streams; /**< Textures fed by UpdateImagePixels, not shared through the texture cache. */
+    size_t stream_count;
+    size_t stream_capacity;
+    Polyline polyline; /**< Triangles of the last polyline drawn, kept for their storage. */
     char font_path[256];
     size_t active_window_count;
-    size_t timer_count;
     bool inhibit_reset;
-    unsigned int selected_color;
     bool is_running;
+    FT_Library ft;
     FT_Face face;
-    Glyph glyph_cache[128]; // simple ASCII cache
+    GlyphAtlas atlas;
+    GlyphAtlas sdf_atlas; /**< Created the first time SDF text is requested. */
+    GooeyTextRenderMode text_mode;
+    TextMetricsCache text_metrics;
+    const GlyphAtlas *text_metrics_atlas; /**< Atlas the cached metrics were measured with. */
+    bool shared_ready; /**< Programs, glyphs and FreeType are created once, for the first window. */
 
 } GooeyBackendContext;
 
 static GooeyBackendContext ctx = {0};
 
+/** Color FillArc draws with, per thread since windows may be drawn at the same time. */
+static _Thread_local uint32_t selected_color;
+
+static void glps_damage_all_windows(void);
+static void glps_image_decoded(void *data);
+
 static bool validate_window_id(int window_id)
 {
     return (window_id >= 0 && window_id < MAX_WINDOWS);
 }
-void glps_generate_glyphs(int pixel_height)
+
+/**
+ * Guards state shared between windows while a worker uses it. The main
+ * thread owns it whenever no worker can: in the calls it runs for them, and
+ * while they are paused.
+ */
+static void glps_lock(void)
 {
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft))
-    {
-        LOG_ERROR("Could not initialize FreeType\n");
-        return;
-    }
+    if (render_workers_on_worker())
+        render_workers_lock_state(&ctx.workers);
+}
 
-    if (FT_New_Memory_Face(ft, roboto_ttf, roboto_ttf_len, 0, &ctx.face))
-    {
-        LOG_ERROR("Failed to load Roboto font\n");
-        FT_Done_FreeType(ft);
+static void glps_unlock(void)
+{
+    if (render_workers_on_worker())
+        render_workers_unlock_state(&ctx.workers);
+}
+
+/**
+ * Whether input and redraw requests go to the windows' workers rather than straight to the windows.
+ */
+static bool glps_workers_running(void)
+{
+    return ctx.threaded && ctx.workers.workers;
+}
+
+/**
+ * Gives a window a frame on the next pass of the loop, from any thread.
+ */
+static void glps_mark_pending(size_t window_id)
+{
+    atomic_store(&ctx.pending_windows[window_id], true);
+}
+
+/**
+ * Marks a window that got input. When the window system delivered it, the
+ * loop polls at its fastest again, and runs another pass in case the input
+ * is for a window it already updated.
+ */
+static void glps_input_arrived(size_t window_id)
+{
+    glps_mark_pending(window_id);
+    if (render_workers_on_worker())
         return;
-    }
+    ctx.input_seen = true;
+    event_loop_wake(&ctx.loop);
+}
 
-    FT_Set_Pixel_Sizes(ctx.face, 0, pixel_height);
+/**
+ * Whether a window has something to handle, without taking it.
+ */
+static bool glps_window_due(size_t window_id)
+{
+    return atomic_load(&ctx.pending_windows[window_id]) || atomic_load(&ctx.ticking_windows[window_id]);
+}
 
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+/**
+ * Takes what a window has to handle, whether it needs a frame now.
+ */
+static bool glps_take_due(size_t window_id)
+{
+    const bool pending = atomic_exchange(&ctx.pending_windows[window_id], false);
+    return pending || atomic_load(&ctx.ticking_windows[window_id]);
+}
 
-    for (unsigned char c = 0; c < 128; c++)
-    {
-        if (FT_Load_Char(ctx.face, c, FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL))
-        {
-            LOG_ERROR("Failed to load glyph '%c'\n", c);
-            continue;
-        }
+/**
+ * Called after a window's frame. Windows showing notifications get a frame
+ * on every pass, the notifications count their display time in frames.
+ */
+static void glps_frame_done(size_t window_id, void *data)
+{
+    GooeyWindow **windows = (GooeyWindow **)data;
+    const GooeyWindow *window = windows[window_id];
+    atomic_store(&ctx.ticking_windows[window_id],
+                 window && window->notification_manager && window->notification_manager->notification_count > 0);
+}
+
+/**
+ * Frame update callback of the window system, runs the frame callback for windows that have something to handle.
+ */
+static void glps_run_frame(size_t window_id, void *data)
+{
+    if (!glps_take_due(window_id))
+        return;
+    ctx.frame_callback(window_id, data);
+    glps_frame_done(window_id, data);
+}
+
+static GlState *glps_gl_state(size_t window_id)
+{
+    return &ctx.gl_states[ctx.headless ? 0 : window_id];
+}
 
-        FT_Bitmap *bmp = &ctx.face->glyph->bitmap;
+/**
+ * Makes the window's context current, or directs rendering to its framebuffer when headless.
+ */
+static void glps_make_current(size_t window_id)
+{
+    if (ctx.headless)
+        headless_surface_bind(&ctx.surface, window_id);
+    else if (!gl_state_make_current(glps_gl_state(window_id)))
+        glps_wm_set_window_ctx_curr(ctx.wm, window_id);
+}
 
-        GLuint tex;
-        glGenTextures(1, &tex);
-        glBindTexture(GL_TEXTURE_2D, tex);
+/**
+ * Forgets which context is current, after GLPS calls that may make another one current.
+ */
+static void glps_forget_current(void)
+{
+    if (!ctx.headless)
+        gl_state_make_current(NULL);
+}
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_RED);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+int glps_init_ft()
+{
+#if !GLES_ON
+    // Headless, the entry points came from EGL with the context.
+    if (!ctx.headless)
+        gladLoadGL();
+#endif
+    return 0;
+}
+void glps_generate_glyphs(int pixel_height)
+{
+    if (!ctx.face)
+        return;
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glyph_atlas_destroy(&ctx.atlas);
+    text_metrics_cache_invalidate(&ctx.text_metrics);
+    ctx.display_list_generation++;
+    ctx.layers.generation++;
+    if (!glyph_atlas_init(&ctx.atlas, GLYPH_ATLAS_BITMAP, ctx.face, pixel_height, GLYPH_ATLAS_MAX_PAGES))
+        return;
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, bmp->width, bmp->rows, 0,
-                     GL_RED, GL_UNSIGNED_BYTE, bmp->buffer);
+    // Everything else is rasterized on first use, printable ASCII is warmed up so the first frame does not stall.
+    for (uint32_t c = 32; c < 127; c++)
+        glyph_atlas_lookup(&ctx.atlas, c);
+    ctx.atlas.stats = (GlyphAtlasStats){0};
+}
 
-        ctx.glyph_cache[c] = (Glyph){
-            tex,
-            bmp->width,
-            bmp->rows,
-            ctx.face->glyph->bitmap_left,
-            ctx.face->glyph->bitmap_top,
-            (ctx.face->glyph->advance.x >> 6)};
+/**
+ * Atlas text is drawn and measured with. Falls back to the bitmap atlas when
+ * SDF is unavailable, so switching modes never loses text.
+ */
+static GlyphAtlas *glps_text_atlas(void)
+{
+    if (ctx.text_mode == GOOEY_TEXT_RENDER_SDF && ctx.shared_ready)
+    {
+        // Rasterized larger than the bitmap atlas: the field only loses detail below its own size.
+        // Workers cannot create it, text they draw goes through the main thread until it exists.
+        if (ctx.sdf_atlas.texture == 0 && ctx.face && !render_workers_on_worker() &&
+            !glyph_atlas_init(&ctx.sdf_atlas, GLYPH_ATLAS_SDF, ctx.face, 48, GLYPH_ATLAS_MAX_PAGES))
+        {
+            ctx.text_mode = GOOEY_TEXT_RENDER_BITMAP;
+        }
+        if (ctx.sdf_atlas.texture != 0)
+            return &ctx.sdf_atlas;
     }
+    return &ctx.atlas;
+}
 
-    FT_Done_Face(ctx.face);
-    FT_Done_FreeType(ft);
+void glps_set_text_render_mode(GooeyTextRenderMode mode)
+{
+    glps_lock();
+    if (mode != ctx.text_mode)
+        ctx.layers.generation++;
+    ctx.text_mode = mode;
+    glps_unlock();
 }
-void glps_setup_shared()
+
+/**
+ * Evictions move glyphs under quads that did not change: unchanged widgets
+ * have to be re-recorded and their pixels repainted.
+ */
+static void glps_sync_glyph_evictions(void)
 {
-    glGenBuffers(1, &ctx.text_vbo);
+    const size_t evictions = ctx.atlas.stats.evictions + ctx.sdf_atlas.stats.evictions;
+    if (evictions == ctx.seen_glyph_evictions)
+        return;
 
-    ctx.text_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(ctx.text_vertex_shader, 1, &text_vertex_shader_source, NULL);
-    glCompileShader(ctx.text_vertex_shader);
-    check_shader_compile(ctx.text_vertex_shader);
+    ctx.seen_glyph_evictions = evictions;
+    ctx.display_list_generation++;
+    glps_damage_all_windows();
+}
+void glps_setup_shared()
+{
+    // Every window context shares objects with the first one, only VAOs are per context.
+    if (ctx.shared_ready)
+        return;
 
-    ctx.text_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(ctx.text_fragment_shader, 1, &text_fragment_shader_source, NULL);
-    glCompileShader(ctx.text_fragment_shader);
-    check_shader_compile(ctx.text_fragment_shader);
+    glps_init_ft();
 
-    glGenBuffers(1, &ctx.shape_vbo);
+    if (FT_Init_FreeType(&ctx.ft))
+    {
+        LOG_ERROR("Could not initialize FreeType\n");
+        ctx.ft = NULL;
+    }
+    else if (FT_New_Memory_Face(ctx.ft, roboto_ttf, roboto_ttf_len, 0, &ctx.face))
+    {
+        LOG_ERROR("Failed to load Roboto font\n");
+        ctx.face = NULL;
+    }
+    glps_generate_glyphs(28);
 
     GLuint shape_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(shape_vertex_shader, 1, &rectangle_vertex_shader, NULL);
@@ -143,118 +375,167 @@ void glps_setup_shared()
 
     glDeleteShader(shape_vertex_shader);
     glDeleteShader(shape_fragment_shader);
-}
 
-void glps_setup_seperate_vao(int window_id)
-{
-    ctx.text_programs[window_id] = glCreateProgram();
-    glAttachShader(ctx.text_programs[window_id], ctx.text_vertex_shader);
-    glAttachShader(ctx.text_programs[window_id], ctx.text_fragment_shader);
-    glLinkProgram(ctx.text_programs[window_id]);
-    check_shader_link(ctx.text_programs[window_id]);
+    render_batch_program_init(&ctx.shape, ctx.shape_program);
 
-    GLuint text_vao;
-    glGenVertexArrays(1, &text_vao);
+    GLuint quad_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(quad_vertex_shader, 1, &quad_vertex_shader_source, NULL);
+    glCompileShader(quad_vertex_shader);
+    check_shader_compile(quad_vertex_shader);
 
-    glBindVertexArray(text_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, ctx.text_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    ctx.text_vaos[window_id] = text_vao;
-    glBindVertexArray(0);
+    GLuint quad_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(quad_fragment_shader, 1, &quad_fragment_shader_source, NULL);
+    glCompileShader(quad_fragment_shader);
+    check_shader_compile(quad_fragment_shader);
 
-    GLuint shape_vao;
-    glGenVertexArrays(1, &shape_vao);
-    glBindVertexArray(shape_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, ctx.shape_vbo);
+    ctx.quad_program = glCreateProgram();
+    glAttachShader(ctx.quad_program, quad_vertex_shader);
+    glAttachShader(ctx.quad_program, quad_fragment_shader);
+    glLinkProgram(ctx.quad_program);
+    check_shader_link(ctx.quad_program);
 
-    GLint position_attrib = glGetAttribLocation(ctx.shape_program, "pos");
-    glEnableVertexAttribArray(position_attrib);
-    glVertexAttribPointer(position_attrib, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, pos));
+    glDeleteShader(quad_vertex_shader);
+    glDeleteShader(quad_fragment_shader);
 
-    GLint col_attrib = glGetAttribLocation(ctx.shape_program, "col");
-    glEnableVertexAttribArray(col_attrib);
-    glVertexAttribPointer(col_attrib, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, col));
-    ctx.shape_vaos[window_id] = shape_vao;
+    render_batch_quad_program_init(&ctx.quad, ctx.quad_program);
+
+    ctx.shared_ready = true;
+}
+
+void glps_setup_seperate_vao(int window_id, int width, int height)
+{
+    render_batch_init(&ctx.batches[window_id], width, height);
+    damage_tracker_init(&ctx.damage[window_id].tracker);
 }
-void glps_set_projection(int window_id, int width, int height)
+
+/**
+ * Repaints every window in full on its next frame, for changes that do not
+ * show up in the primitives, like a texture whose name gets reused.
+ */
+static void glps_damage_all_windows(void)
 {
-    mat4x4 projection;
-    mat4x4_ortho(projection, 0.0f, width, height, 0.0f, -1.0f, 1.0f);
-    glUseProgram(ctx.text_programs[window_id]);
-    glUniformMatrix4fv(glGetUniformLocation(ctx.text_programs[window_id], "projection"), 1, GL_FALSE, (const GLfloat *)projection);
-    glBindVertexArray(ctx.text_vaos[window_id]);
-    glViewport(0, 0, width, height);
+    if (!ctx.damage)
+        return;
+
+    for (int i = 0; i < MAX_WINDOWS; ++i)
+        damage_tracker_invalidate(&ctx.damage[i].tracker);
 }
 void glps_set_viewport(size_t window_id, int width, int height)
 {
-    glps_wm_set_window_ctx_curr(ctx.wm, window_id);
-    glps_set_projection(window_id, width, height);
+    // A worker only tells the batch, glps_render applies the batch's size to the context.
+    if (!render_workers_on_worker())
+    {
+        glps_make_current(window_id);
+        gl_state_viewport(0, 0, width, height);
+    }
+    render_batch_set_viewport(&ctx.batches[window_id], width, height);
 }
-void glps_draw_rectangle(int x, int y, int width, int height,
-                         uint32_t color, float thickness,
-                         int window_id, bool isRounded, float cornerRadius, GooeyTFT_Sprite *sprite)
+
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_render_batch, (int, window_id))
+
+void glps_render_batch(int window_id)
 {
     if (!validate_window_id(window_id))
         return;
+    if (render_workers_on_worker())
+    {
+        glps_render_batch_on_main_thread(window_id);
+        return;
+    }
 
-    glps_wm_set_window_ctx_curr(ctx.wm, window_id);
+    RenderBatch *batch = &ctx.batches[window_id];
+    if (batch->command_count == 0)
+        return;
 
-    int win_width, win_height;
-    get_window_size(ctx.wm, window_id, &win_width, &win_height);
+    glps_make_current(window_id);
+    // Drawn outside of the frame being diffed, so that frame cannot be presented partially.
+    damage_tracker_invalidate(&ctx.damage[window_id].tracker);
+    render_batch_flush(batch, &ctx.shape, &ctx.quad, NULL);
+}
 
-    float ndc_x, ndc_y;
-    float ndc_width, ndc_height;
-    vec3 color_rgb;
+static void glps_push_quad(RenderBatch *batch, const RenderBatchState *state, float x, float y,
+                           float width, float height, const vec3 color, const float tex_coords[4])
+{
+    Vertex *vertices = render_batch_push(batch, state, 6);
+    if (!vertices)
+        return;
 
-    convert_coords_to_ndc(ctx.wm, window_id, &ndc_x, &ndc_y, x, y);
-    convert_dimension_to_ndc(ctx.wm, window_id, &ndc_width, &ndc_height, width, height);
-    convert_hex_to_rgb(&color_rgb, color);
+    float x0, y0, x1, y1;
+    render_batch_to_ndc(batch, x, y, &x0, &y0);
+    render_batch_to_ndc(batch, x + width, y + height, &x1, &y1);
 
-    Vertex vertices[6] = {
-        {{ndc_x, ndc_y}, {color_rgb[0], color_rgb[1], color_rgb[2]}, {0.0, 0.0}},
-        {{ndc_x + ndc_width, ndc_y}, {color_rgb[0], color_rgb[1], color_rgb[2]}, {1.0, 0.0}},
-        {{ndc_x, ndc_y + ndc_height}, {color_rgb[0], color_rgb[1], color_rgb[2]}, {0.0, 1.0}},
-        {{ndc_x + ndc_width, ndc_y}, {color_rgb[0], color_rgb[1], color_rgb[2]}, {1.0, 0.0}},
-        {{ndc_x + ndc_width, ndc_y + ndc_height}, {color_rgb[0], color_rgb[1], color_rgb[2]}, {1.0, 1.0}},
-        {{ndc_x, ndc_y + ndc_height}, {color_rgb[0], color_rgb[1], color_rgb[2]}, {0.0, 1.0}}};
+    const float corners[6][4] = {
+        {x0, y0, tex_coords[0], tex_coords[1]},
+        {x1, y0, tex_coords[2], tex_coords[1]},
+        {x0, y1, tex_coords[0], tex_coords[3]},
+        {x1, y0, tex_coords[2], tex_coords[1]},
+        {x1, y1, tex_coords[2], tex_coords[3]},
+        {x0, y1, tex_coords[0], tex_coords[3]}};
 
-    glUseProgram(ctx.shape_program);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "useTexture"), 0);
-    glUniform2f(glGetUniformLocation(ctx.shape_program, "size"), width, height);
-    glUniform1f(glGetUniformLocation(ctx.shape_program, "radius"), cornerRadius);
-    glUniform1f(glGetUniformLocation(ctx.shape_program, "borderWidth"), thickness);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "isRounded"), isRounded ? 1 : 0);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "isHollow"), 1);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "shapeType"), 0);
+    for (int i = 0; i < 6; i++)
+    {
+        vertices[i].pos[0] = corners[i][0];
+        vertices[i].pos[1] = corners[i][1];
+        vertices[i].col[0] = color[0];
+        vertices[i].col[1] = color[1];
+        vertices[i].col[2] = color[2];
+        vertices[i].texCoord[0] = corners[i][2];
+        vertices[i].texCoord[1] = corners[i][3];
+    }
+}
+static void glps_push_sdf_quad(RenderBatch *batch, int x, int y, int width, int height,
+                               uint32_t color, float radius, float border_width)
+{
+    QuadInstance *instance = render_batch_push_quad(batch, 0);
+    if (!instance)
+        return;
 
-    glBindBuffer(GL_ARRAY_BUFFER, ctx.shape_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+    vec3 color_rgb;
+    convert_hex_to_rgb(&color_rgb, color);
 
-    glBindVertexArray(ctx.shape_vaos[window_id]);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, pos));
+    instance->rect[0] = (float)x;
+    instance->rect[1] = (float)y;
+    instance->rect[2] = (float)width;
+    instance->rect[3] = (float)height;
+    instance->color[0] = color_rgb[0];
+    instance->color[1] = color_rgb[1];
+    instance->color[2] = color_rgb[2];
+    instance->color[3] = 1.0f;
+    instance->shape[0] = radius;
+    instance->shape[1] = border_width;
+}
 
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, col));
+void glps_draw_rectangle(int x, int y, int width, int height,
+                         uint32_t color, float thickness,
+                         int window_id, bool isRounded, float cornerRadius, GooeyTFT_Sprite *sprite)
+{
+    if (!validate_window_id(window_id))
+        return;
 
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoord));
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // A zero border would fill the quad, the shader clamps thinner borders to one pixel anyway.
+    glps_push_sdf_quad(&ctx.batches[window_id], x, y, width, height, color,
+                       isRounded ? cornerRadius : 0.0f, thickness > 0.0f ? thickness : 1.0f);
 }
 
 void glps_set_foreground(uint32_t color)
 {
-    ctx.selected_color = color;
+    selected_color = color;
 }
 
 void glps_window_dim(int *width, int *height, int window_id)
 {
-    get_window_size(ctx.wm, window_id, width, height);
+    // The size its last resize input set, the window system may already be ahead of it.
+    if (render_workers_on_worker() && validate_window_id(window_id))
+    {
+        *width = ctx.batches[window_id].width;
+        *height = ctx.batches[window_id].height;
+        return;
+    }
+
+    if (ctx.headless)
+        headless_surface_size(&ctx.surface, window_id, width, height);
+    else
+        get_window_size(ctx.wm, window_id, width, height);
 }
 
 void glps_draw_line(int x1, int y1, int x2, int y2, uint32_t color, int window_id, GooeyTFT_Sprite *sprite)
@@ -262,184 +543,187 @@ void glps_draw_line(int x1, int y1, int x2, int y2, uint32_t color, int window_i
     if (!validate_window_id(window_id))
         return;
 
-    glps_wm_set_window_ctx_curr(ctx.wm, window_id);
-    float ndc_x1, ndc_y1;
-    float ndc_x2, ndc_y2;
+    RenderBatch *batch = &ctx.batches[window_id];
     vec3 color_rgb;
-
-    convert_coords_to_ndc(ctx.wm, window_id, &ndc_x1, &ndc_y1, x1, y1);
-    convert_coords_to_ndc(ctx.wm, window_id, &ndc_x2, &ndc_y2, x2, y2);
     convert_hex_to_rgb(&color_rgb, color);
 
-    Vertex vertices[2];
+    // Lines ignore every other shape uniform, so all of them share one state and one draw.
+    const RenderBatchState state = {.mode = GL_LINES, .shape_type = 1};
+    Vertex *vertices = render_batch_push(batch, &state, 2);
+    if (!vertices)
+        return;
 
+    render_batch_to_ndc(batch, x1, y1, &vertices[0].pos[0], &vertices[0].pos[1]);
+    render_batch_to_ndc(batch, x2, y2, &vertices[1].pos[0], &vertices[1].pos[1]);
     for (int i = 0; i < 2; i++)
     {
         vertices[i].col[0] = color_rgb[0];
         vertices[i].col[1] = color_rgb[1];
         vertices[i].col[2] = color_rgb[2];
     }
-
-    vertices[0].pos[0] = ndc_x1;
-    vertices[0].pos[1] = ndc_y1;
-    vertices[1].pos[0] = ndc_x2;
-    vertices[1].pos[1] = ndc_y2;
-
-    glUseProgram(ctx.shape_program);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "useTexture"), 0);
-    glUniform1f(glGetUniformLocation(ctx.shape_program, "borderWidth"), 1.0f);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "isRounded"), 0);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "isHollow"), 1);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "shapeType"), 1);
-
-    glBindBuffer(GL_ARRAY_BUFFER, ctx.shape_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-
-    glBindVertexArray(ctx.shape_vaos[window_id]);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, pos));
-
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, col));
-
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoord));
-    glDrawArrays(GL_LINES, 0, 2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 
-void glps_fill_arc(int x_center, int y_center, int width, int height,
-                   int angle1, int angle2, int window_id, GooeyTFT_Sprite *sprite)
+void glps_draw_polyline(const float *points, size_t count, float width, uint32_t color, GooeyLineJoin join,
+                        int window_id)
 {
-    if (!validate_window_id(window_id))
+    if (!validate_window_id(window_id) || !points || count < 2)
         return;
 
-    glps_wm_set_window_ctx_curr(ctx.wm, window_id);
-    int win_width, win_height;
-    get_window_size(ctx.wm, window_id, &win_width, &win_height);
-    const int segments = 80;
-
-    float ndc_x_center, ndc_y_center;
-    convert_coords_to_ndc(ctx.wm, window_id, &ndc_x_center, &ndc_y_center, x_center, y_center);
+    // The triangles are built in storage every window shares.
+    glps_lock();
+    if (!polyline_build(&ctx.polyline, points, count, width, join) || ctx.polyline.count == 0)
+    {
+        glps_unlock();
+        return;
+    }
 
+    RenderBatch *batch = &ctx.batches[window_id];
     vec3 color_rgb;
-    convert_hex_to_rgb(&color_rgb, ctx.selected_color);
+    convert_hex_to_rgb(&color_rgb, color);
 
-    Vertex vertices[segments + 2];
+    // Every polyline shares one state, however many are drawn in a row they take one draw.
+    const RenderBatchState state = {.mode = GL_TRIANGLES, .shape_type = 3};
+    Vertex *vertices = render_batch_push(batch, &state, ctx.polyline.count);
+    if (!vertices)
+    {
+        glps_unlock();
+        return;
+    }
 
-    vertices[0].pos[0] = ndc_x_center;
-    vertices[0].pos[1] = ndc_y_center;
-    vertices[0].col[0] = color_rgb[0];
-    vertices[0].col[1] = color_rgb[1];
-    vertices[0].col[2] = color_rgb[2];
+    const float half_width = fmaxf(width, 1.0f) * 0.5f;
+    for (size_t i = 0; i < ctx.polyline.count; i++)
+    {
+        const PolylineVertex *vertex = &ctx.polyline.vertices[i];
+        render_batch_to_ndc(batch, vertex->x, vertex->y, &vertices[i].pos[0], &vertices[i].pos[1]);
+        vertices[i].col[0] = color_rgb[0];
+        vertices[i].col[1] = color_rgb[1];
+        vertices[i].col[2] = color_rgb[2];
+        vertices[i].texCoord[0] = vertex->across;
+        vertices[i].texCoord[1] = half_width;
+    }
+    glps_unlock();
+}
 
-    float angle1_rad = ((float)angle1) * M_PI / 180.0f;
-    float angle2_rad = (float)angle2 * M_PI / 180.0f;
-    float angle_range = angle2_rad - angle1_rad;
+/**
+ * Pushes the arc of the ellipse around x_center, y_center going from angle1 to
+ * angle2 degrees, as one quad with a pixel of margin for the antialiased edge.
+ * A thickness of 0 fills the pie, anything else leaves a ring that wide.
+ */
+static void glps_push_arc_quad(RenderBatch *batch, float x_center, float y_center, float radius_x, float radius_y,
+                               float angle1, float angle2, float thickness, uint32_t color)
+{
+    if (radius_x <= 0.0f || radius_y <= 0.0f)
+        return;
 
-    float aspect_ratio = (float)height / (float)width;
+    QuadInstance *instance = render_batch_push_quad(batch, 0);
+    if (!instance)
+        return;
 
-    for (int i = 0; i <= segments; ++i)
+    float start = angle1, sweep = angle2 - angle1;
+    if (sweep < 0.0f)
     {
-        float t = (float)i / segments;
-        float angle = angle1_rad + t * angle_range;
-
-        float x = ndc_x_center - (cos(angle) * 2.0 / win_width) * (width / 2.0);
-        float y = ndc_y_center + (sin(angle) * 2.0 / win_height) * (height / 2.0) * aspect_ratio;
-
-        vertices[i + 1].pos[0] = x;
-        vertices[i + 1].pos[1] = y;
-        vertices[i + 1].col[0] = color_rgb[0];
-        vertices[i + 1].col[1] = color_rgb[1];
-        vertices[i + 1].col[2] = color_rgb[2];
+        start = angle2;
+        sweep = -sweep;
     }
+    start = fmodf(start, 360.0f);
+    if (start < 0.0f)
+        start += 360.0f;
 
-    glUseProgram(ctx.shape_program);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "useTexture"), GL_FALSE);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "shapeType"), 2);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "isRounded"), GL_FALSE);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "isHollow"), GL_FALSE);
-
-    glBindBuffer(GL_ARRAY_BUFFER, ctx.shape_vbo);
-    glBufferData(GL_ARRAY_BUFFER, (segments + 2) * sizeof(Vertex), vertices, GL_DYNAMIC_DRAW);
-
-    glBindVertexArray(ctx.shape_vaos[window_id]);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, pos));
+    vec3 color_rgb;
+    convert_hex_to_rgb(&color_rgb, color);
 
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, col));
+    instance->rect[0] = x_center - radius_x - 1.0f;
+    instance->rect[1] = y_center - radius_y - 1.0f;
+    instance->rect[2] = radius_x * 2.0f + 2.0f;
+    instance->rect[3] = radius_y * 2.0f + 2.0f;
+    instance->color[0] = color_rgb[0];
+    instance->color[1] = color_rgb[1];
+    instance->color[2] = color_rgb[2];
+    instance->color[3] = 1.0f;
+    instance->shape[0] = start * (float)M_PI / 180.0f;
+    instance->shape[1] = fminf(sweep, 360.0f) * (float)M_PI / 180.0f;
+    instance->shape[2] = QUAD_KIND_ARC;
+    instance->shape[3] = thickness;
+}
 
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoord));
-    glDrawArrays(GL_TRIANGLE_FAN, 0, segments + 2);
+void glps_fill_arc(int x_center, int y_center, int width, int height,
+                   int angle1, int angle2, int window_id, GooeyTFT_Sprite *sprite)
+{
+    if (!validate_window_id(window_id) || width <= 0)
+        return;
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // The vertical radius has always been scaled by height / width, only circles come out as asked.
+    const float radius_y = (float)height * 0.5f * ((float)height / (float)width);
+    glps_push_arc_quad(&ctx.batches[window_id], (float)x_center, (float)y_center, (float)width * 0.5f, radius_y,
+                       (float)angle1, (float)angle2, 0.0f, selected_color);
 }
 
-void glps_draw_image(unsigned int texture_id, int x, int y, int width, int height, int window_id)
+void glps_draw_arc(int x_center, int y_center, int width, int height, float angle1, float angle2, float thickness,
+                   uint32_t color, int window_id)
 {
     if (!validate_window_id(window_id))
         return;
 
-    glps_wm_set_window_ctx_curr(ctx.wm, window_id);
-
-    float ndc_x, ndc_y, ndc_width, ndc_height;
-    convert_coords_to_ndc(ctx.wm, window_id, &ndc_x, &ndc_y, x, y);
-    convert_dimension_to_ndc(ctx.wm, window_id, &ndc_width, &ndc_height, width, height);
-
-    Vertex vertices[6] = {
-        {{ndc_x, ndc_y}, {1.0f, 1.0f, 1.0f}, {0.0f, 1.0f}},
-        {{ndc_x + ndc_width, ndc_y}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
-        {{ndc_x, ndc_y + ndc_height}, {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f}},
-        {{ndc_x + ndc_width, ndc_y}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
-        {{ndc_x + ndc_width, ndc_y + ndc_height}, {1.0f, 1.0f, 1.0f}, {1.0f, 0.0f}},
-        {{ndc_x, ndc_y + ndc_height}, {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f}}};
-
-    glBindBuffer(GL_ARRAY_BUFFER, ctx.shape_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-
-    glUseProgram(ctx.shape_program);
-
-    GLint isRoundedLocation = glGetUniformLocation(ctx.shape_program, "isRounded");
-    if (isRoundedLocation != -1)
-    {
-        glUniform1i(isRoundedLocation, GL_FALSE);
-    }
+    glps_push_arc_quad(&ctx.batches[window_id], (float)x_center, (float)y_center, (float)width * 0.5f,
+                       (float)height * 0.5f, angle1, angle2, thickness, color);
+}
 
-    GLint useTextureLocation = glGetUniformLocation(ctx.shape_program, "useTexture");
-    if (useTextureLocation == -1)
+static StreamTexture *glps_find_stream(unsigned int texture_id)
+{
+    for (size_t i = 0; i < ctx.stream_count; ++i)
     {
-        LOG_ERROR("Failed to find useTexture uniform location");
+        if (ctx.streams[i].texture == texture_id)
+            return &ctx.streams[i];
     }
-    glUniform1i(useTextureLocation, GL_TRUE);
+    return NULL;
+}
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+void glps_draw_image(unsigned int texture_id, int x, int y, int width, int height, int window_id)
+{
+    if (!validate_window_id(window_id))
+        return;
 
-    GLint textureSamplerLocation = glGetUniformLocation(ctx.shape_program, "tex");
-    if (textureSamplerLocation == -1)
+#if (ENABLE_DAMAGE_TRACKING)
+    // Streamed pixels change under the same texture name, only their version tells the frames apart.
+    glps_lock();
+    const StreamTexture *stream = glps_find_stream(texture_id);
+    if (stream)
     {
-        LOG_ERROR("Failed to find tex uniform location");
+        uint64_t hash = damage_hash_bytes(DAMAGE_HASH_SEED, &stream->texture, sizeof(stream->texture));
+        hash = damage_hash_bytes(hash, &stream->version, sizeof(stream->version));
+        damage_tracker_add(&ctx.damage[window_id].tracker, hash, (float)x, (float)y, (float)(x + width),
+                           (float)(y + height));
     }
-    glUniform1i(textureSamplerLocation, 1);
+    glps_unlock();
+#endif
 
-    glBindVertexArray(ctx.shape_vaos[window_id]);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, pos));
+    const RenderBatchState state = {
+        .mode = GL_TRIANGLES,
+        .texture = texture_id,
+        .shape_type = 0,
+        .use_texture = true};
 
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, col));
+    static const vec3 white = {1.0f, 1.0f, 1.0f};
+    static const float tex_coords[4] = {0.0f, 1.0f, 1.0f, 0.0f};
+    glps_push_quad(&ctx.batches[window_id], &state, x, y, width, height, white, tex_coords);
+}
+
+void glps_draw_image_region(unsigned int texture_id, float u0, float v0, float u1, float v1, int x, int y, int width,
+                            int height, int window_id)
+{
+    if (!validate_window_id(window_id))
+        return;
 
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoord));
+    const RenderBatchState state = {
+        .mode = GL_TRIANGLES,
+        .texture = texture_id,
+        .shape_type = 0,
+        .use_texture = true};
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glBindVertexArray(0);
+    // Texture rows are stored bottom-up, v counts from the top like the rest of the API.
+    static const vec3 white = {1.0f, 1.0f, 1.0f};
+    const float tex_coords[4] = {u0, 1.0f - v0, u1, 1.0f - v1};
+    glps_push_quad(&ctx.batches[window_id], &state, x, y, width, height, white, tex_coords);
 }
 
 void glps_fill_rectangle(int x, int y, int width, int height,
@@ -449,66 +733,8 @@ void glps_fill_rectangle(int x, int y, int width, int height,
     if (!validate_window_id(window_id))
         return;
 
-    glps_wm_set_window_ctx_curr(ctx.wm, window_id);
-    float ndc_x, ndc_y;
-    float ndc_width, ndc_height;
-    vec3 color_rgb;
-
-    convert_coords_to_ndc(ctx.wm, window_id, &ndc_x, &ndc_y, x, y);
-    convert_dimension_to_ndc(ctx.wm, window_id, &ndc_width, &ndc_height, width, height);
-    convert_hex_to_rgb(&color_rgb, color);
-
-    Vertex vertices[6];
-    vec2 texCoords[6] = {
-        {0.0f, 0.0f}, {1.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
-
-    for (int i = 0; i < 6; i++)
-    {
-        vertices[i].col[0] = color_rgb[0];
-        vertices[i].col[1] = color_rgb[1];
-        vertices[i].col[2] = color_rgb[2];
-        vertices[i].texCoord[0] = texCoords[i][0];
-        vertices[i].texCoord[1] = texCoords[i][1];
-    }
-
-    vertices[0].pos[0] = ndc_x;
-    vertices[0].pos[1] = ndc_y;
-    vertices[1].pos[0] = ndc_x + ndc_width;
-    vertices[1].pos[1] = ndc_y;
-    vertices[2].pos[0] = ndc_x;
-    vertices[2].pos[1] = ndc_y + ndc_height;
-
-    vertices[3].pos[0] = ndc_x + ndc_width;
-    vertices[3].pos[1] = ndc_y;
-    vertices[4].pos[0] = ndc_x + ndc_width;
-    vertices[4].pos[1] = ndc_y + ndc_height;
-    vertices[5].pos[0] = ndc_x;
-    vertices[5].pos[1] = ndc_y + ndc_height;
-
-    glBindBuffer(GL_ARRAY_BUFFER, ctx.shape_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-
-    glUseProgram(ctx.shape_program);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "useTexture"), 0);
-    glUniform2f(glGetUniformLocation(ctx.shape_program, "size"), width, height);
-    glUniform1f(glGetUniformLocation(ctx.shape_program, "radius"), cornerRadius);
-    glUniform1f(glGetUniformLocation(ctx.shape_program, "borderWidth"), 1.0f);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "isRounded"), isRounded ? 1 : 0);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "isHollow"), 0);
-    glUniform1i(glGetUniformLocation(ctx.shape_program, "shapeType"), 0);
-
-    glBindVertexArray(ctx.shape_vaos[window_id]);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, pos));
-
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, col));
-
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoord));
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    glps_push_sdf_quad(&ctx.batches[window_id], x, y, width, height, color,
+                       isRounded ? cornerRadius : 0.0f, 0.0f);
 }
 
 static void keyboard_callback(size_t window_id, bool state, const char *value, unsigned long keycode,
@@ -522,6 +748,7 @@ static void keyboard_callback(size_t window_id, bool state, const char *value, u
     LOG_INFO("%s", value);
     strncpy(event->key_press.value, value, sizeof(event->key_press.value));
     event->key_press.keycode = keycode;
+    glps_input_arrived(window_id);
 }
 
 static void mouse_scroll_callback(size_t window_id, GLPS_SCROLL_AXES axe,
@@ -534,9 +761,16 @@ static void mouse_scroll_callback(size_t window_id, GLPS_SCROLL_AXES axe,
     event->type = GOOEY_EVENT_MOUSE_SCROLL;
 
     if (axe == GLPS_SCROLL_H_AXIS)
+    {
         event->mouse_scroll.x = value;
+        event->mouse_scroll.y = 0;
+    }
     else
+    {
+        event->mouse_scroll.x = 0;
         event->mouse_scroll.y = value;
+    }
+    glps_input_arrived(window_id);
 }
 
 static void mouse_click_callback(size_t window_id, bool state, void *data)
@@ -547,12 +781,24 @@ static void mouse_click_callback(size_t window_id, bool state, void *data)
     event->type = state ? GOOEY_EVENT_CLICK_PRESS : GOOEY_EVENT_CLICK_RELEASE;
     event->click.x = event->mouse_move.x;
     event->click.y = event->mouse_move.y;
+    glps_input_arrived(window_id);
 }
 
 void glps_request_redraw(GooeyWindow *win)
 {
+    if (glps_workers_running())
+    {
+        // The window's own thread sets its event, it may be handling one right now.
+        const RenderWorkerInput input = {.event.type = GOOEY_EVENT_REDRAWREQ};
+        render_workers_post(&ctx.workers, win->creation_id, &input);
+        return;
+    }
+
     GooeyEvent *event = (GooeyEvent *)win->current_event;
     event->type = GOOEY_EVENT_REDRAWREQ;
+    glps_mark_pending(win->creation_id);
+    // May come from another thread while the loop sleeps.
+    event_loop_wake(&ctx.loop);
 }
 
 void glps_force_redraw()
@@ -566,6 +812,7 @@ static void mouse_move_callback(size_t window_id, double posX, double posY, void
     GooeyWindow *win = (GooeyWindow *)windows[window_id];
     event->mouse_move.x = posX;
     event->mouse_move.y = posY;
+    glps_input_arrived(window_id);
 }
 
 static void window_resize_callback(size_t window_id, int width, int height, void *data)
@@ -577,6 +824,7 @@ static void window_resize_callback(size_t window_id, int width, int height, void
     win->width = width;
     win->height = height;
     glps_set_viewport(window_id, width, height);
+    glps_input_arrived(window_id);
 }
 
 static void window_close_callback(size_t window_id, void *data)
@@ -585,324 +833,703 @@ static void window_close_callback(size_t window_id, void *data)
     GooeyEvent *event = (GooeyEvent *)windows[window_id]->current_event;
     GooeyWindow *win = (GooeyWindow *)windows[window_id];
     event->type = GOOEY_EVENT_WINDOW_CLOSE;
+    glps_input_arrived(window_id);
 }
 
-int glps_init_ft()
-{
-#if !GLES_ON
-    gladLoadGL();
-#endif
-    return 0;
-}
-int glps_init(int project_branch)
+/**
+ * Hands input to a window through the window system callbacks, so that widgets see exactly what real input produces.
+ */
+static void glps_apply_input(size_t window_id, const RenderWorkerInput *queued)
 {
-    NFD_Init();
-    set_logging_enabled(project_branch);
-    ctx.inhibit_reset = 0;
-    ctx.selected_color = 0x000000;
-    ctx.active_window_count = 0;
-    ctx.text_vaos = (GLuint *)calloc(MAX_WINDOWS, sizeof(GLuint));
-    ctx.shape_vaos = (GLuint *)calloc(MAX_WINDOWS, sizeof(GLuint));
-    ctx.text_programs = (GLuint *)calloc(MAX_WINDOWS, sizeof(GLuint));
-    ctx.wm = glps_wm_init();
-    ctx.timers = (glps_timer **)calloc(MAX_TIMERS, sizeof(glps_timer *));
-    ctx.timer_count = 0;
-    ctx.is_running = true;
-    return 0;
+    const GooeyEvent *input = &queued->event;
+    GooeyWindow **windows = (GooeyWindow **)ctx.frame_data;
+    GooeyEvent *event = (GooeyEvent *)windows[window_id]->current_event;
+    switch (input->type)
+    {
+    case GOOEY_EVENT_MOUSE_MOVE:
+        mouse_move_callback(window_id, input->mouse_move.x, input->mouse_move.y, ctx.frame_data);
+        break;
+    case GOOEY_EVENT_CLICK_PRESS:
+    case GOOEY_EVENT_CLICK_RELEASE:
+        // Clicks land where the pointer is, it moves there first.
+        mouse_move_callback(window_id, input->click.x, input->click.y, ctx.frame_data);
+        mouse_click_callback(window_id, input->type == GOOEY_EVENT_CLICK_PRESS, ctx.frame_data);
+        break;
+    case GOOEY_EVENT_KEY_PRESS:
+    case GOOEY_EVENT_KEY_RELEASE:
+        keyboard_callback(window_id, input->type == GOOEY_EVENT_KEY_PRESS, input->key_press.value,
+                          input->key_press.keycode, ctx.frame_data);
+        break;
+    case GOOEY_EVENT_MOUSE_SCROLL:
+        event->type = GOOEY_EVENT_MOUSE_SCROLL;
+        event->mouse_scroll = input->mouse_scroll;
+        break;
+    case GOOEY_EVENT_WINDOW_CLOSE:
+        window_close_callback(window_id, ctx.frame_data);
+        break;
+    case GOOEY_EVENT_REDRAWREQ:
+        event->type = GOOEY_EVENT_REDRAWREQ;
+        break;
+    case GOOEY_EVENT_RESIZE:
+        // Only the window system's resizes carry a size.
+        if (queued->width > 0 && queued->height > 0)
+        {
+            window_resize_callback(window_id, queued->width, queued->height, ctx.frame_data);
+            break;
+        }
+        *event = *input;
+        break;
+    default:
+        *event = *input;
+        break;
+    }
 }
 
-int glps_get_current_clicked_window(void)
-{
-    return -1;
-}
-void glps_draw_text(int x, int y, const char *text, uint32_t color, float font_size, int window_id)
+void glps_inject_event(int window_id, const GooeyEvent *input)
 {
-    if (!validate_window_id(window_id) || !text)
+    if (!validate_window_id(window_id) || !input)
         return;
+    if (!ctx.frame_callback)
+    {
+        LOG_WARNING("Events can only be injected once the window runs");
+        return;
+    }
 
-    glps_wm_set_window_ctx_curr(ctx.wm, window_id);
+    GooeyWindow **windows = (GooeyWindow **)ctx.frame_data;
+    if (!windows[window_id])
+        return;
 
-    int window_width, window_height;
-    glps_window_dim(&window_width, &window_height, window_id);
+    const RenderWorkerInput queued = {.event = *input};
+    if (glps_workers_running())
+    {
+        render_workers_post(&ctx.workers, window_id, &queued);
+        return;
+    }
 
-    vec3 color_rgb;
-    convert_hex_to_rgb(&color_rgb, color);
+    glps_apply_input(window_id, &queued);
+    glps_mark_pending(window_id);
+    glps_run_frame(window_id, ctx.frame_data);
+}
 
-    glUseProgram(ctx.text_programs[window_id]);
-    glUniform3f(glGetUniformLocation(ctx.text_programs[window_id], "textColor"),
-                color_rgb[0], color_rgb[1], color_rgb[2]);
+/*
+ * Window system callbacks of a threaded run: input is queued for the
+ * window's worker, which hands it to the window with glps_apply_input().
+ */
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(ctx.text_vaos[window_id]);
+static void glps_queue_input(size_t window_id, const RenderWorkerInput *input)
+{
+    ctx.input_seen = true;
+    render_workers_post(&ctx.workers, window_id, input);
+}
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+static void queue_keyboard_callback(size_t window_id, bool state, const char *value, unsigned long keycode,
+                                    void *data)
+{
+    RenderWorkerInput input = {.event.type = state ? GOOEY_EVENT_KEY_PRESS : GOOEY_EVENT_KEY_RELEASE};
+    strncpy(input.event.key_press.value, value, sizeof(input.event.key_press.value) - 1);
+    input.event.key_press.keycode = keycode;
+    glps_queue_input(window_id, &input);
+}
 
-    float cursor_x = (float)x;
-    float cursor_y = (float)y;
-    float scale = font_size / 28.0f;
-    float baseline_y = cursor_y;
+static void queue_mouse_scroll_callback(size_t window_id, GLPS_SCROLL_AXES axe,
+                                        GLPS_SCROLL_SOURCE source, double value,
+                                        int discrete, bool is_stopped, void *data)
+{
+    RenderWorkerInput input = {.event.type = GOOEY_EVENT_MOUSE_SCROLL};
+    if (axe == GLPS_SCROLL_H_AXIS)
+        input.event.mouse_scroll.x = value;
+    else
+        input.event.mouse_scroll.y = value;
+    glps_queue_input(window_id, &input);
+}
 
-    for (size_t i = 0; i < strlen(text); i++)
-    {
-        char c = text[i];
-        if (c == '\n')
-        {
-            cursor_x = (float)x;
-            baseline_y += font_size * 1.2f;
-            continue;
-        }
+static void queue_mouse_click_callback(size_t window_id, bool state, void *data)
+{
+    RenderWorkerInput input = {.event.type = state ? GOOEY_EVENT_CLICK_PRESS : GOOEY_EVENT_CLICK_RELEASE};
+    input.event.click = ctx.queued_pointer[window_id];
+    glps_queue_input(window_id, &input);
+}
 
-        Glyph ch = ctx.glyph_cache[(unsigned char)c];
-        if (ch.textureID == 0)
-            continue;
+static void queue_mouse_move_callback(size_t window_id, double posX, double posY, void *data)
+{
+    RenderWorkerInput input = {.event.type = GOOEY_EVENT_MOUSE_MOVE};
+    input.event.mouse_move.x = posX;
+    input.event.mouse_move.y = posY;
+    ctx.queued_pointer[window_id] = input.event.mouse_move;
+    glps_queue_input(window_id, &input);
+}
+
+static void queue_window_resize_callback(size_t window_id, int width, int height, void *data)
+{
+    const RenderWorkerInput input = {.event.type = GOOEY_EVENT_RESIZE, .width = width, .height = height};
+    glps_queue_input(window_id, &input);
+}
+
+static void queue_window_close_callback(size_t window_id, void *data)
+{
+    const RenderWorkerInput input = {.event.type = GOOEY_EVENT_WINDOW_CLOSE};
+    glps_queue_input(window_id, &input);
+}
 
-        float xpos = cursor_x + ch.bearingX * scale;
-        float ypos = baseline_y - ch.bearingY * scale;
+/**
+ * Frame update of a threaded run, the worker gives the window a pass.
+ */
+static void queue_pass_callback(size_t window_id, void *data)
+{
+    if (glps_take_due(window_id))
+        render_workers_post(&ctx.workers, window_id, NULL);
+}
 
-        float w = ch.width * scale;
-        float h = ch.height * scale;
+/**
+ * One pass of a window on its worker, handling @p input first when there is some.
+ */
+static void glps_worker_pass(size_t window_id, const RenderWorkerInput *input, void *data)
+{
+    GooeyWindow **windows = (GooeyWindow **)data;
+    if (!windows[window_id])
+        return;
 
-        float vertices[6][4] = {
-            {xpos, ypos + h, 0.0f, 0.0f},
-            {xpos, ypos, 0.0f, 1.0f},
-            {xpos + w, ypos, 1.0f, 1.0f},
-            {xpos, ypos + h, 0.0f, 0.0f},
-            {xpos + w, ypos, 1.0f, 1.0f},
-            {xpos + w, ypos + h, 1.0f, 0.0f}};
+    if (input)
+        glps_apply_input(window_id, input);
+    // This pass handles it, the loop need not schedule another.
+    atomic_store(&ctx.pending_windows[window_id], false);
+    ctx.frame_callback(window_id, data);
+    glps_frame_done(window_id, data);
+}
 
-        glBindTexture(GL_TEXTURE_2D, ch.textureID);
-        glBindBuffer(GL_ARRAY_BUFFER, ctx.text_vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+RENDER_WORKERS_FORWARD(&ctx.workers, bool, glps_read_pixels, (int, window_id), (unsigned char *, rgba), (int, width),
+                       (int, height))
 
-        cursor_x += ch.advance * scale;
+bool glps_read_pixels(int window_id, unsigned char *rgba, int width, int height)
+{
+    if (!ctx.headless)
+    {
+        LOG_WARNING("Pixels can only be read back from headless windows");
+        return false;
     }
+    if (render_workers_on_worker())
+        return glps_read_pixels_on_main_thread(window_id, rgba, width, height);
+    return validate_window_id(window_id) && headless_surface_read_pixels(&ctx.surface, window_id, rgba, width, height);
+}
 
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+static int glps_init_context(int project_branch, bool headless)
+{
+    set_logging_enabled(project_branch);
+    ctx.headless = headless;
+    if (headless && !headless_surface_init(&ctx.surface))
+    {
+        ctx.headless = false;
+        return -1;
+    }
+    if (!headless)
+        NFD_Init();
+    ctx.inhibit_reset = 0;
+    selected_color = 0x000000;
+    ctx.active_window_count = 0;
+    ctx.batches = (RenderBatch *)calloc(MAX_WINDOWS, sizeof(RenderBatch));
+    ctx.damage = (GlpsWindowDamage *)calloc(MAX_WINDOWS, sizeof(GlpsWindowDamage));
+    ctx.gl_states = (GlState *)calloc(MAX_WINDOWS, sizeof(GlState));
+    ctx.gl_calls = (GlpsWindowCalls *)calloc(MAX_WINDOWS, sizeof(GlpsWindowCalls));
+    if (headless)
+    {
+        // The one context stays current from here on.
+        gl_state_init(&ctx.gl_states[0]);
+        gl_state_make_current(&ctx.gl_states[0]);
+    }
+    ctx.display_list_generation = 1;
+    ctx.recording = (GlpsWindowRecording *)calloc(MAX_WINDOWS, sizeof(GlpsWindowRecording));
+    ctx.layer_targets = (LayerTarget *)calloc(MAX_WINDOWS, sizeof(LayerTarget));
+    layer_cache_init(&ctx.layers, (size_t)LAYER_CACHE_BUDGET_MB * 1024 * 1024);
+    texture_cache_init(&ctx.textures, (size_t)TEXTURE_CACHE_BUDGET_MB * 1024 * 1024);
+    if (!headless)
+        ctx.wm = glps_wm_init();
+    timer_heap_init(&ctx.timers);
+    event_loop_init(&ctx.loop);
+    image_decoder_init(&ctx.decoder, IMAGE_DECODE_WORKERS, glps_image_decoded, &ctx.loop);
+    ctx.decoder.downscale_min_ratio = IMAGE_DOWNSCALE_MIN_RATIO;
+    svg_cache_init(&ctx.svgs, SVG_CACHE_ENTRIES);
+    ctx.decoder.svg_cache = &ctx.svgs;
+#if (ENABLE_DISK_IMAGE_CACHE)
+    disk_image_cache_init(&ctx.disk_images, NULL, (size_t)DISK_IMAGE_CACHE_MB * 1024 * 1024);
+    if (ctx.disk_images.enabled)
+        ctx.decoder.disk_cache = &ctx.disk_images;
+#endif
+    ctx.is_running = true;
+    return 0;
 }
-void glps_unload_image(unsigned int texture_id)
+
+int glps_init(int project_branch)
 {
-    glDeleteTextures(1, &texture_id);
+    return glps_init_context(project_branch, false);
 }
 
-static int is_stb_supported_image_format(const char *path)
+int glps_init_headless(int project_branch)
 {
-    if (!path)
-        return 0;
+    return glps_init_context(project_branch, true);
+}
 
-    const char *ext = strrchr(path, '.');
-    if (!ext)
-        return 0;
+void glps_set_threaded_rendering(bool enabled)
+{
+    if (ctx.frame_callback)
+    {
+        LOG_WARNING("Threaded rendering is chosen before the windows run");
+        return;
+    }
+    ctx.threaded = enabled;
+}
+
+int glps_get_current_clicked_window(void)
+{
+    return -1;
+}
+/**
+ * Whether a worker can draw or measure @p text as is: the atlas exists and
+ * holds every glyph, nothing has to be rasterized and uploaded. Called with
+ * the lock held.
+ */
+static bool glps_text_resident(const char *text, int length)
+{
+    // An SDF atlas not created yet would be on the first lookup.
+    if (ctx.text_mode == GOOEY_TEXT_RENDER_SDF && ctx.sdf_atlas.texture == 0)
+        return false;
 
-    ext++;
+    GlyphAtlas *atlas = glps_text_atlas();
+    if (atlas->texture == 0)
+        return false;
 
-    if (strcasecmp(ext, "png") == 0 ||
-        strcasecmp(ext, "jpg") == 0 ||
-        strcasecmp(ext, "jpeg") == 0)
+    const char *p = text;
+    const char *end = length < 0 ? NULL : text + length;
+    while (*p && (!end || p < end))
     {
-        return 1;
+        if (!glyph_atlas_contains(atlas, glyph_atlas_decode_utf8(&p, end ? (size_t)(end - p) : SIZE_MAX)))
+            return false;
     }
+    return true;
+}
 
-    return 0;
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_draw_text, (int, x), (int, y), (const char *, text), (uint32_t, color),
+                            (float, font_size), (int, window_id))
+
+void glps_draw_text(int x, int y, const char *text, uint32_t color, float font_size, int window_id)
+{
+    if (!validate_window_id(window_id) || !text)
+        return;
+
+    glps_lock();
+    if (render_workers_on_worker() && !glps_text_resident(text, -1))
+    {
+        glps_unlock();
+        glps_draw_text_on_main_thread(x, y, text, color, font_size, window_id);
+        return;
+    }
+
+    GlyphAtlas *atlas = glps_text_atlas();
+    if (atlas->texture == 0)
+    {
+        glps_unlock();
+        return;
+    }
+    const float kind = atlas->mode == GLYPH_ATLAS_SDF ? QUAD_KIND_SDF_GLYPH : QUAD_KIND_GLYPH;
+
+    RenderBatch *batch = &ctx.batches[window_id];
+
+    vec3 color_rgb;
+    convert_hex_to_rgb(&color_rgb, color);
+
+    float cursor_x = (float)x;
+    float baseline_y = (float)y;
+    float scale = font_size / (float)atlas->pixel_height;
+
+    const char *p = text;
+    while (*p)
+    {
+        uint32_t codepoint = glyph_atlas_decode_utf8(&p, SIZE_MAX);
+        if (codepoint == '\n')
+        {
+            cursor_x = (float)x;
+            baseline_y += font_size * 1.2f;
+            continue;
+        }
+
+        const AtlasGlyph *ch = glyph_atlas_lookup(atlas, codepoint);
+        if (!ch)
+            continue;
+
+        if (ch->width > 0 && ch->height > 0)
+        {
+            QuadInstance *instance = render_batch_push_quad(batch, atlas->texture);
+            if (!instance)
+                break;
+
+            instance->rect[0] = cursor_x + ch->bearingX * scale;
+            instance->rect[1] = baseline_y - ch->bearingY * scale;
+            instance->rect[2] = ch->width * scale;
+            instance->rect[3] = ch->height * scale;
+            instance->color[0] = color_rgb[0];
+            instance->color[1] = color_rgb[1];
+            instance->color[2] = color_rgb[2];
+            instance->color[3] = 1.0f;
+            instance->shape[2] = kind;
+            instance->shape[3] = (float)ch->page;
+            memcpy(instance->uv, ch->uv, sizeof(instance->uv));
+        }
+
+        cursor_x += ch->advance * scale;
+    }
+    glps_unlock();
 }
-unsigned int glps_load_image(const char *image_path)
+/**
+ * Deleted textures may see their names come back for a different image,
+ * nothing drawn with them can be trusted.
+ */
+static void glps_sync_texture_deletions(void)
+{
+    if (ctx.textures.deletions == ctx.seen_texture_deletions)
+        return;
+
+    ctx.seen_texture_deletions = ctx.textures.deletions;
+    ctx.display_list_generation++;
+    glps_damage_all_windows();
+}
+
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_unload_image, (unsigned int, texture_id))
+
+void glps_unload_image(unsigned int texture_id)
 {
-    // First check if file exists and is accessible
-    FILE *file = fopen(image_path, "rb");
-    if (!file)
+    if (render_workers_on_worker())
     {
-        LOG_ERROR("Image file not found or inaccessible: %s", image_path);
-        return 0;
+        glps_unload_image_on_main_thread(texture_id);
+        return;
+    }
+
+    StreamTexture *stream = glps_find_stream(texture_id);
+    if (stream)
+    {
+        stream_texture_destroy(stream);
+        *stream = ctx.streams[--ctx.stream_count];
+        ctx.textures.deletions++;
+        glps_sync_texture_deletions();
+        return;
     }
-    fclose(file);
+
+    // Shared textures stay resident for the next user until the cache needs the room.
+    if (!texture_cache_release(&ctx.textures, texture_id))
+    {
+        gl_state_delete_textures(1, &texture_id);
+        ctx.textures.deletions++;
+    }
+    glps_sync_texture_deletions();
+}
+
+/**
+ * Creates a texture from decoded pixels, the context it goes to must be current.
+ */
+static unsigned int glps_upload_decoded_image(const DecodedImage *image)
+{
+    static const GLenum formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
 
     unsigned int texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    gl_state_bind_texture(GL_TEXTURE_2D, texture);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    unsigned char *data = NULL;
-    int img_width = 0, img_height = 0, nrChannels = 0;
-    int success = 0;
-
-    // Check file extension first
-    if (is_stb_supported_image_format(image_path))
+    // Rows of 1 to 3 channel images are not 4 byte aligned.
+    gl_state_pixel_store(GL_UNPACK_ALIGNMENT, 1);
+    const GLenum format = formats[image->channels - 1];
+    if (image->levels > 1)
     {
-        // Use stb_image for common formats (PNG, JPG, BMP, etc.)
-        stbi_set_flip_vertically_on_load(1);
-        data = stbi_load(image_path, &img_width, &img_height, &nrChannels, 0);
-        if (data)
+        // Straight from the disk cache, every level is already there.
+        const unsigned char *pixels = image->pixels;
+        for (int level = 0; level < image->levels; ++level)
         {
-            success = 1;
-            LOG_INFO("Loaded image with stb: %s (%dx%d, %d channels)",
-                     image_path, img_width, img_height, nrChannels);
+            const int width = image->width >> level > 0 ? image->width >> level : 1;
+            const int height = image->height >> level > 0 ? image->height >> level : 1;
+            glTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+            pixels += (size_t)width * height * image->channels;
         }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image->levels - 1);
     }
     else
     {
-        // Try NanoSVG for SVG files
-        const char *ext = strrchr(image_path, '.');
-        if (ext && (strcasecmp(ext, ".svg") == 0))
-        {
-            NSVGimage *image = nsvgParseFromFile(image_path, "px", 96);
-            if (image)
-            {
-                NSVGrasterizer *rast = nsvgCreateRasterizer();
-                img_width = (int)image->width;
-                img_height = (int)image->height;
-                nrChannels = 4;
-
-                // Allocate memory for RGBA data
-                size_t data_size = img_width * img_height * 4;
-                data = malloc(data_size);
-                if (data)
-                {
-                    memset(data, 0, data_size); // Initialize to transparent
-                    nsvgRasterize(rast, image, 0, 0, 1, data, img_width, img_height, img_width * 4);
-                    success = 1;
-                    LOG_INFO("Loaded SVG with NanoSVG: %s (%dx%d)",
-                             image_path, img_width, img_height);
-                }
-                else
-                {
-                    LOG_ERROR("Failed to allocate memory for SVG rasterization: %s", image_path);
-                }
-
-                nsvgDeleteRasterizer(rast);
-                nsvgDelete(image);
-            }
-            else
-            {
-                LOG_ERROR("NanoSVG failed to parse SVG file: %s", image_path);
-            }
-        }
-        else
-        {
-            LOG_ERROR("Unsupported image format: %s", image_path);
-        }
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image->width, image->height, 0, format, GL_UNSIGNED_BYTE, image->pixels);
+        glGenerateMipmap(GL_TEXTURE_2D);
     }
 
-    if (!success || !data)
+    return texture;
+}
+
+/**
+ * Uploads a decoded file and shares the texture through the cache, the caller holds one reference.
+ */
+static unsigned int glps_cache_decoded_file(const TextureFileKey *key, const DecodedImage *image)
+{
+    const unsigned int texture = glps_upload_decoded_image(image);
+    texture_cache_insert_file(&ctx.textures, key, texture, image->width, image->height);
+    glps_sync_texture_deletions();
+    return texture;
+}
+
+/**
+ * The key a load of @p width x @p height looks up, textures of any other size are only reused when full size.
+ */
+static bool glps_image_file_key(const char *image_path, int width, int height, TextureFileKey *key)
+{
+    if (!texture_cache_file_key(image_path, key))
+        return false;
+    if (width > 0 && height > 0)
     {
-        LOG_ERROR("Failed to load image data: %s", image_path);
-        glDeleteTextures(1, &texture);
+        key->width = width;
+        key->height = height;
+        key->exact = image_is_vector(image_path);
+    }
+    return true;
+}
 
-        // Clean up allocated data if any
-        if (data && !is_stb_supported_image_format(image_path))
-        {
-            free(data);
-        }
+/**
+ * Cache key of a decoded image: its own size once downscaled, the full image otherwise.
+ */
+static void glps_decoded_file_key(TextureFileKey *key, bool downscaled)
+{
+    if (!downscaled)
+        key->width = key->height = 0;
+}
+
+/**
+ * Loads a file into a texture shared through the cache, @p disk_cache as for image_decoder_load().
+ */
+static unsigned int glps_load_image_file(const char *image_path, int width, int height, bool disk_cache)
+{
+    TextureFileKey key;
+    if (!glps_image_file_key(image_path, width, height, &key))
+    {
+        LOG_ERROR("Image file not found or inaccessible: %s", image_path);
         return 0;
     }
 
-    // Validate image dimensions
-    if (img_width <= 0 || img_height <= 0)
+    unsigned int texture = texture_cache_acquire_file(&ctx.textures, &key);
+    if (texture != 0)
+        return texture;
+
+    DecodedImage image;
+    bool downscaled;
+    if (!image_decoder_load(&ctx.decoder, key.path, key.width, key.height, disk_cache, &image, &downscaled))
+        return 0;
+
+    glps_decoded_file_key(&key, downscaled);
+    texture = glps_cache_decoded_file(&key, &image);
+    LOG_INFO("Successfully loaded texture: %s (%dx%d, %d channels, ID: %u)", image_path, image.width, image.height,
+             image.channels, texture);
+    decoded_image_free(&image);
+    return texture;
+}
+
+RENDER_WORKERS_FORWARD(&ctx.workers, unsigned int, glps_load_image_scaled, (const char *, image_path), (int, width),
+                       (int, height))
+
+unsigned int glps_load_image_scaled(const char *image_path, int width, int height)
+{
+    if (render_workers_on_worker())
+        return glps_load_image_scaled_on_main_thread(image_path, width, height);
+    return glps_load_image_file(image_path, width, height, true);
+}
+
+RENDER_WORKERS_FORWARD(&ctx.workers, unsigned int, glps_load_image_tile, (const char *, image_path))
+
+unsigned int glps_load_image_tile(const char *image_path)
+{
+    if (render_workers_on_worker())
+        return glps_load_image_tile_on_main_thread(image_path);
+    return glps_load_image_file(image_path, 0, 0, false);
+}
+
+unsigned int glps_load_image(const char *image_path)
+{
+    return glps_load_image_scaled(image_path, 0, 0);
+}
+
+RENDER_WORKERS_FORWARD(&ctx.workers, unsigned int, glps_load_image_from_bin, (unsigned char *, data),
+                       (long unsigned, binary_len))
+
+unsigned int glps_load_image_from_bin(unsigned char *data, long unsigned binary_len)
+{
+    if (render_workers_on_worker())
+        return glps_load_image_from_bin_on_main_thread(data, binary_len);
+
+    const uint64_t hash = damage_hash_bytes(damage_hash_bytes(DAMAGE_HASH_SEED, &binary_len, sizeof(binary_len)),
+                                            data, binary_len);
+    unsigned int texture = texture_cache_acquire_content(&ctx.textures, hash);
+    if (texture != 0)
+        return texture;
+
+    DecodedImage image;
+    if (!image_decode_memory(data, binary_len, &image))
     {
-        LOG_ERROR("Invalid image dimensions: %s (%dx%d)", image_path, img_width, img_height);
-        glDeleteTextures(1, &texture);
-        if (is_stb_supported_image_format(image_path))
-        {
-            stbi_image_free(data);
-        }
-        else
-        {
-            free(data);
-        }
+        LOG_ERROR("Failed to load image");
         return 0;
     }
 
-    // Determine OpenGL format
-    GLenum format;
-    if (nrChannels == 1)
-        format = GL_RED;
-    else if (nrChannels == 2)
-        format = GL_RG;
-    else if (nrChannels == 3)
-        format = GL_RGB;
-    else if (nrChannels == 4)
-        format = GL_RGBA;
-    else
+    texture = glps_upload_decoded_image(&image);
+    texture_cache_insert_content(&ctx.textures, hash, texture, image.width, image.height);
+    glps_sync_texture_deletions();
+    decoded_image_free(&image);
+    return texture;
+}
+
+RENDER_WORKERS_FORWARD(&ctx.workers, unsigned int, glps_update_image_pixels, (unsigned int, texture_id),
+                       (const unsigned char *, rgba), (int, width), (int, height), (int, window_id))
+
+unsigned int glps_update_image_pixels(unsigned int texture_id, const unsigned char *rgba, int width, int height,
+                                      int window_id)
+{
+    if (!rgba || width <= 0 || height <= 0 || !validate_window_id(window_id))
+        return 0;
+    if (render_workers_on_worker())
+        return glps_update_image_pixels_on_main_thread(texture_id, rgba, width, height, window_id);
+
+    glps_make_current(window_id);
+    StreamTexture *stream = glps_find_stream(texture_id);
+    if (!stream)
     {
-        LOG_ERROR("Unsupported number of channels: %d for %s", nrChannels, image_path);
-        glDeleteTextures(1, &texture);
-        if (is_stb_supported_image_format(image_path))
+        if (ctx.stream_count == ctx.stream_capacity)
         {
-            stbi_image_free(data);
+            const size_t capacity = ctx.stream_capacity ? ctx.stream_capacity * 2 : 4;
+            StreamTexture *streams = realloc(ctx.streams, capacity * sizeof(StreamTexture));
+            if (!streams)
+            {
+                LOG_ERROR("Failed to allocate memory for streamed textures");
+                return 0;
+            }
+            ctx.streams = streams;
+            ctx.stream_capacity = capacity;
         }
-        else
+        stream = &ctx.streams[ctx.stream_count];
+        if (!stream_texture_init(stream))
         {
-            free(data);
+            LOG_ERROR("Failed to create a streamed texture");
+            return 0;
         }
-        return 0;
+        ctx.stream_count++;
     }
 
-    // Upload to GPU
-    glTexImage2D(GL_TEXTURE_2D, 0, format, img_width, img_height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    stream_texture_update(stream, rgba, width, height);
+    return stream->texture;
+}
 
-    // Clean up
-    if (is_stb_supported_image_format(image_path))
-    {
-        stbi_image_free(data);
-    }
-    else
+static void glps_image_decoded(void *data)
+{
+    event_loop_wake((EventLoop *)data);
+}
+
+/**
+ * Queues a file for the decoder, 0 when it is resident and loading it synchronously only takes a reference.
+ */
+static unsigned int glps_submit_image(const char *image_path, int window_id, int width, int height, bool disk_cache,
+                                      void (*callback)(unsigned int texture_id, void *user_data), void *user_data)
+{
+    if (!image_path || !validate_window_id(window_id))
+        return 0;
+
+    // Already resident, loading it synchronously only takes a reference.
+    TextureFileKey key;
+    if (glps_image_file_key(image_path, width, height, &key))
     {
-        free(data);
+        glps_lock();
+        const bool resident = texture_cache_has_file(&ctx.textures, &key);
+        glps_unlock();
+        if (resident)
+            return 0;
     }
+    return image_decoder_submit(&ctx.decoder, image_path, window_id, width, height, disk_cache, callback, user_data);
+}
 
-    LOG_INFO("Successfully loaded texture: %s (ID: %u)", image_path, texture);
-    return texture;
+unsigned int glps_load_image_async(const char *image_path, int window_id, int width, int height,
+                                   void (*callback)(unsigned int texture_id, void *user_data), void *user_data)
+{
+    return glps_submit_image(image_path, window_id, width, height, true, callback, user_data);
 }
 
-unsigned int glps_load_image_from_bin(unsigned char *data, long unsigned binary_len)
+unsigned int glps_load_image_tile_async(const char *image_path, int window_id,
+                                        void (*callback)(unsigned int texture_id, void *user_data), void *user_data)
 {
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    return glps_submit_image(image_path, window_id, 0, 0, false, callback, user_data);
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+void glps_cancel_image_load(unsigned int request)
+{
+    image_decoder_cancel(&ctx.decoder, request);
+}
+
+/**
+ * Uploads decoded images and hands them to their owners, IMAGE_UPLOAD_BUDGET_KB at a time.
+ */
+static void glps_upload_decoded_images(void)
+{
+    const size_t budget = (size_t)IMAGE_UPLOAD_BUDGET_KB * 1024;
+    size_t uploaded = 0;
 
-    stbi_set_flip_vertically_on_load(1);
-    int width, height, channels;
-    unsigned char *img_data = stbi_load_from_memory(data, binary_len, &width, &height, &channels, 0);
-    if (!img_data)
+    ImageDecodeJob *job;
+    while (uploaded < budget && (job = image_decoder_take(&ctx.decoder)))
     {
-        LOG_ERROR("Failed to load image");
-        glDeleteTextures(1, &texture);
-        return 0;
+        unsigned int texture = 0;
+        TextureFileKey key;
+        if (job->decoded && glps_image_file_key(job->path, job->width, job->height, &key))
+        {
+            // Another widget may have loaded the same file while this one was decoding.
+            texture = texture_cache_acquire_file(&ctx.textures, &key);
+            if (texture == 0)
+            {
+                glps_make_current(job->window_id);
+                glps_decoded_file_key(&key, job->downscaled);
+                texture = glps_cache_decoded_file(&key, &job->image);
+                uploaded += (size_t)job->image.width * job->image.height * job->image.channels;
+            }
+        }
+        if (job->callback)
+            job->callback(texture, job->user_data);
+        image_decoder_job_free(job);
     }
-
-    GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, img_data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    stbi_image_free(img_data);
-
-    return texture;
 }
 
+RENDER_WORKERS_FORWARD(&ctx.workers, GooeyWindow *, glps_create_window, (const char *, title), (int, x), (int, y),
+                       (int, width), (int, height))
+
 GooeyWindow *glps_create_window(const char *title, int x, int y, int width, int height)
 {
+    if (render_workers_on_worker())
+        return glps_create_window_on_main_thread(title, x, y, width, height);
+
     GooeyWindow *window = (GooeyWindow *)malloc(sizeof(GooeyWindow));
+    if (!window)
+        return NULL;
 
-    size_t window_id = glps_wm_window_create(ctx.wm, title, x, y, width, height);
+    size_t window_id;
+    if (ctx.headless)
+    {
+        const int target = headless_surface_create_target(&ctx.surface, width, height);
+        if (target < 0)
+        {
+            free(window);
+            return NULL;
+        }
+        window_id = (size_t)target;
+    }
+    else
+    {
+        window_id = glps_wm_window_create(ctx.wm, title, x, y, width, height);
+        // Created current, with nothing known about it yet.
+        gl_state_init(&ctx.gl_states[window_id]);
+        gl_state_make_current(&ctx.gl_states[window_id]);
+    }
     window->creation_id = window_id;
 
-    glps_init_ft();
-    glps_generate_glyphs(28);
-    if (window->creation_id == 0)
-        glps_setup_shared();
-
-    glps_setup_seperate_vao(window->creation_id);
+    glps_setup_shared();
+    glps_setup_seperate_vao(window->creation_id, width, height);
     ctx.active_window_count++;
+    glps_mark_pending(window_id);
 
     return window;
 }
@@ -911,8 +1538,17 @@ void glps_make_window_visible(int window_id, bool visibility)
 {
 }
 
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_set_window_resizable, (bool, value), (int, window_id))
+
 void glps_set_window_resizable(bool value, int window_id)
 {
+    if (ctx.headless)
+        return;
+    if (render_workers_on_worker())
+    {
+        glps_set_window_resizable_on_main_thread(value, window_id);
+        return;
+    }
     glps_wm_window_is_resizable(ctx.wm, value, window_id);
 }
 
@@ -924,166 +1560,370 @@ void glps_destroy_windows()
 {
 }
 
+/**
+ * Context state every frame is drawn with, a worker's is applied by glps_render.
+ */
+static void glps_apply_frame_state(const GooeyWindow *win)
+{
+    vec3 color;
+    convert_hex_to_rgb(&color, win->active_theme->base);
+    gl_state_clear_color(color[0], color[1], color[2], 1.0f);
+    gl_state_enable(GL_BLEND, true);
+    gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+/**
+ * Keeps what the oldest frame in flight uses, windows drawn on workers
+ * advance the shared frame counters while others are not presented yet.
+ * Called with the state lock held.
+ */
+static void glps_pin_frames(void)
+{
+    uint64_t atlas = ctx.atlas.frame;
+    uint64_t sdf_atlas = ctx.sdf_atlas.frame;
+    uint64_t layers = ctx.layers.frame;
+    for (size_t i = 0; i < MAX_WINDOWS; i++)
+    {
+        const GlpsFramePin *pin = &ctx.frame_pins[i];
+        if (!pin->in_flight)
+            continue;
+        // Counters may have restarted since, the SDF atlas is set up after its first frames.
+        if (pin->atlas < atlas)
+            atlas = pin->atlas;
+        if (pin->sdf_atlas < sdf_atlas)
+            sdf_atlas = pin->sdf_atlas;
+        if (pin->layers < layers)
+            layers = pin->layers;
+    }
+    ctx.atlas.keep_since = atlas;
+    ctx.sdf_atlas.keep_since = sdf_atlas;
+    ctx.layers.keep_since = layers;
+}
+
+static void glps_unpin_frame(size_t window_id)
+{
+    ctx.frame_pins[window_id].in_flight = false;
+    glps_pin_frames();
+}
+
 void glps_clear(GooeyWindow *win)
 {
     size_t window_id = win->creation_id;
+    RenderBatch *batch = &ctx.batches[window_id];
+    render_batch_discard(batch);
+
+    glps_lock();
+    ctx.gl_calls[window_id].frame_start = glps_gl_state(window_id)->stats;
+    ctx.layers.frame++;
+    glyph_atlas_begin_frame(&ctx.atlas);
+    glyph_atlas_begin_frame(&ctx.sdf_atlas);
+    ctx.frame_pins[window_id] = (GlpsFramePin){true, ctx.atlas.frame, ctx.sdf_atlas.frame, ctx.layers.frame};
+    glps_pin_frames();
+
+    // Clearing waits for the render, only then is it known which parts of the window changed.
+    batch->needs_clear = true;
+    if (!render_workers_on_worker())
+    {
+        glps_make_current(window_id);
+        glps_apply_frame_state(win);
+    }
 
-    glps_wm_set_window_ctx_curr(ctx.wm, window_id);
-    glClear(GL_COLOR_BUFFER_BIT);
-    vec3 color;
-    convert_hex_to_rgb(&color, win->active_theme->base);
-    glClearColor(color[0], color[1], color[2], 1.0f);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+#if (ENABLE_DAMAGE_TRACKING)
+    // The background is diffed like any primitive, a theme change repaints the whole window.
+    damage_tracker_add(&ctx.damage[window_id].tracker,
+                       damage_hash_bytes(DAMAGE_HASH_SEED, &win->active_theme->base, sizeof(win->active_theme->base)),
+                       0.0f, 0.0f, (float)batch->width, (float)batch->height);
+#endif
+    glps_unlock();
 }
 
 void glps_cleanup()
 {
     ctx.is_running = false;
 
-    for (int i = 0; i < 128; i++)
+    glyph_atlas_destroy(&ctx.atlas);
+    glyph_atlas_destroy(&ctx.sdf_atlas);
+    text_metrics_cache_destroy(&ctx.text_metrics);
+    ctx.text_metrics_atlas = NULL;
+    if (ctx.face)
     {
-        if (ctx.characters[i].textureID != 0)
-        {
-            glDeleteTextures(1, &ctx.characters[i].textureID);
-        }
+        FT_Done_Face(ctx.face);
+        ctx.face = NULL;
+    }
+    if (ctx.ft)
+    {
+        FT_Done_FreeType(ctx.ft);
+        ctx.ft = NULL;
     }
 
-    if (ctx.text_vaos)
+    if (ctx.batches)
     {
         for (size_t i = 0; i < ctx.active_window_count; i++)
         {
-            if (ctx.text_vaos[i] != 0)
-            {
-                glDeleteVertexArrays(1, &ctx.text_vaos[i]);
-            }
+            render_batch_destroy(&ctx.batches[i]);
         }
-        free(ctx.text_vaos);
-        ctx.text_vaos = NULL;
+        free(ctx.batches);
+        ctx.batches = NULL;
     }
-
-    if (ctx.shape_vaos)
+    if (ctx.damage)
+    {
+        for (size_t i = 0; i < MAX_WINDOWS; i++)
+            damage_tracker_destroy(&ctx.damage[i].tracker);
+        free(ctx.damage);
+        ctx.damage = NULL;
+    }
+    if (ctx.layer_targets)
     {
         for (size_t i = 0; i < ctx.active_window_count; i++)
-        {
-            if (ctx.shape_vaos[i] != 0)
-            {
-                glDeleteVertexArrays(1, &ctx.shape_vaos[i]);
-            }
-        }
-        free(ctx.shape_vaos);
-        ctx.shape_vaos = NULL;
+            layer_target_destroy(&ctx.layer_targets[i]);
+        free(ctx.layer_targets);
+        ctx.layer_targets = NULL;
     }
+    free(ctx.recording);
+    ctx.recording = NULL;
+    layer_cache_destroy(&ctx.layers);
+    texture_cache_destroy(&ctx.textures);
+    for (size_t i = 0; i < ctx.stream_count; ++i)
+        stream_texture_destroy(&ctx.streams[i]);
+    free(ctx.streams);
+    ctx.streams = NULL;
+    ctx.stream_count = ctx.stream_capacity = 0;
 
-    if (ctx.text_programs)
+    if (ctx.shape_program != 0)
     {
-        for (size_t i = 0; i < ctx.active_window_count; i++)
+        gl_state_delete_program(ctx.shape_program);
+        ctx.shape_program = 0;
+    }
+    if (ctx.quad_program != 0)
+    {
+        gl_state_delete_program(ctx.quad_program);
+        ctx.quad_program = 0;
+    }
+    ctx.shared_ready = false;
+
+    // Timers stay owned by their GooeyTimer, only the schedule goes.
+    timer_heap_destroy(&ctx.timers);
+    image_decoder_destroy(&ctx.decoder);
+    svg_cache_destroy(&ctx.svgs);
+    polyline_destroy(&ctx.polyline);
+    event_loop_destroy(&ctx.loop);
+
+    if (ctx.gl_states)
+    {
+        for (size_t i = 0; i < MAX_WINDOWS; i++)
+            gl_state_destroy(&ctx.gl_states[i]);
+        free(ctx.gl_states);
+        ctx.gl_states = NULL;
+    }
+    free(ctx.gl_calls);
+    ctx.gl_calls = NULL;
+
+    if (ctx.wm)
+    {
+        glps_wm_destroy(ctx.wm);
+        ctx.wm = NULL;
+    }
+
+    if (ctx.headless)
+    {
+        headless_surface_destroy(&ctx.surface);
+        ctx.headless = false;
+        return;
+    }
+    NFD_Quit();
+}
+
+void glps_update_background(GooeyWindow *win)
+{
+    if (!win || !win->active_theme || render_workers_on_worker())
+        return;
+    glps_make_current(win->creation_id);
+    glps_apply_frame_state(win);
+}
+
+/**
+ * Counts what the window's context issued and skipped since its frame was cleared.
+ */
+static void glps_end_frame_calls(int window_id)
+{
+    const GlStateStats *now = &glps_gl_state(window_id)->stats;
+    GlpsWindowCalls *calls = &ctx.gl_calls[window_id];
+    calls->last_frame.issued = now->issued - calls->frame_start.issued;
+    calls->last_frame.skipped = now->skipped - calls->frame_start.skipped;
+}
+
+/**
+ * Holds the window's next pass back until its next frame is due, once its swaps no longer wait for the display.
+ */
+static void glps_pace_frame(size_t window_id)
+{
+    GlpsWindowPacing *pacing = &ctx.pacing[window_id];
+    if (!atomic_load(&pacing->unsynced))
+        return;
+
+    // Frames keep their cadence. One a whole interval late starts it again rather than being caught up
+    // with, one drawn early, for input handled in the same pass, counts from now.
+    const uint64_t now = event_loop_now_ms();
+    pacing->frame_ms += THREADED_FRAME_INTERVAL_MS;
+    if (pacing->frame_ms + THREADED_FRAME_INTERVAL_MS <= now || pacing->frame_ms > now)
+        pacing->frame_ms = now;
+    render_workers_defer(&ctx.workers, window_id, pacing->frame_ms + THREADED_FRAME_INTERVAL_MS);
+}
+
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_render, (GooeyWindow *, win))
+
+void glps_render(GooeyWindow *win)
+{
+    const int window_id = win->creation_id;
+    if (!validate_window_id(window_id))
+        return;
+    if (render_workers_on_worker())
+    {
+        glps_pace_frame(window_id);
+        glps_render_on_main_thread(win);
+        return;
+    }
+
+    RenderBatch *batch = &ctx.batches[window_id];
+    glps_make_current(window_id);
+    if (ctx.threaded)
+    {
+        // Every window is presented from here, a swap waiting for the display would hold the others up.
+        GlpsWindowPacing *pacing = &ctx.pacing[window_id];
+        if (!ctx.headless && THREADED_FRAME_INTERVAL_MS > 0 && !pacing->swap_set_up)
         {
-            if (ctx.text_programs[i] != 0)
-            {
-                glDeleteProgram(ctx.text_programs[i]);
-            }
+            pacing->swap_set_up = true;
+            atomic_store(&pacing->unsynced, partial_present_set_swap_interval(0));
         }
-        free(ctx.text_programs);
-        ctx.text_programs = NULL;
+
+        // The worker that drew the frame could not reach the context. Other windows' calls went in
+        // since it was cleared, only the ones from here on are the frame's.
+        ctx.gl_calls[window_id].frame_start = glps_gl_state(window_id)->stats;
+        gl_state_viewport(0, 0, batch->width, batch->height);
+        glps_apply_frame_state(win);
     }
 
-    if (ctx.shape_program != 0)
+    DamageRegion repaint = {.full = true};
+#if (ENABLE_DAMAGE_TRACKING)
+    GlpsWindowDamage *damage = &ctx.damage[window_id];
+
+    glps_sync_glyph_evictions();
+    render_batch_report_damage(batch, &damage->tracker);
+    // A framebuffer keeps its pixels from one frame to the next, like a back buffer of age 1.
+    if (!damage_tracker_end_frame(&damage->tracker, batch->width, batch->height,
+                                  ctx.headless ? 1 : partial_present_buffer_age(), &repaint))
     {
-        glDeleteProgram(ctx.shape_program);
-        ctx.shape_program = 0;
+        // Pixel for pixel what is already on screen: neither draw nor present.
+        render_batch_discard(batch);
+        batch->draw_calls = 0;
+        damage->repainted_pixels = 0;
+        glps_end_frame_calls(window_id);
+        glps_unpin_frame(window_id);
+        return;
     }
-    if (ctx.text_vertex_shader != 0)
+    if (!ctx.headless)
+        partial_present_set_damage(&repaint, batch->height);
+    damage->repainted_pixels = damage_region_area(&repaint, batch->width, batch->height);
+#endif
+
+    render_batch_flush(batch, &ctx.shape, &ctx.quad, &repaint);
+    glps_end_frame_calls(window_id);
+    glps_unpin_frame(window_id);
+    if (ctx.headless)
     {
-        glDeleteShader(ctx.text_vertex_shader);
-        ctx.text_vertex_shader = 0;
+        headless_surface_present(&ctx.surface, window_id);
     }
-    if (ctx.text_fragment_shader != 0)
+    else
     {
-        glDeleteShader(ctx.text_fragment_shader);
-        ctx.text_fragment_shader = 0;
+        glps_wm_swap_buffers(ctx.wm, window_id);
+        glps_forget_current();
     }
+}
+/** Size GetTextWidth and GetTextHeight measure at, the one most widgets draw with. */
+#define GLPS_DEFAULT_MEASURE_SIZE 18.0f
 
-    if (ctx.text_vbo != 0)
-    {
-        glDeleteBuffers(1, &ctx.text_vbo);
-        ctx.text_vbo = 0;
-    }
-    if (ctx.shape_vbo != 0)
+static void glps_measure_glyph_run(GlyphAtlas *atlas, const char *text, int length, float font_size, GooeyTextMetrics *metrics)
+{
+    // Advances and bearings are stored at the atlas raster size, the same scale glps_draw_text applies.
+    float scale = font_size / atlas->pixel_height;
+
+    const char *p = text;
+    const char *end = text + length;
+    while (p < end && *p)
     {
-        glDeleteBuffers(1, &ctx.shape_vbo);
-        ctx.shape_vbo = 0;
+        const AtlasGlyph *ch = glyph_atlas_lookup(atlas, glyph_atlas_decode_utf8(&p, (size_t)(end - p)));
+        if (!ch)
+            continue;
+
+        metrics->width += ch->advance * scale;
+        if (ch->height * scale > metrics->height)
+            metrics->height = ch->height * scale;
+        if (ch->bearingY * scale > metrics->ascent)
+            metrics->ascent = ch->bearingY * scale;
+        if ((ch->height - ch->bearingY) * scale > metrics->descent)
+            metrics->descent = (ch->height - ch->bearingY) * scale;
     }
+}
+
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_measure_text, (const char *, text), (int, length), (float, font_size),
+                            (GooeyTextMetrics *, metrics))
 
-    if (ctx.timers)
+void glps_measure_text(const char *text, int length, float font_size, GooeyTextMetrics *metrics)
+{
+    memset(metrics, 0, sizeof(*metrics));
+    if (!text || length <= 0)
+        return;
+
+    glps_lock();
+    if (render_workers_on_worker() && !glps_text_resident(text, length))
     {
-        for (size_t i = 0; i < ctx.timer_count; i++)
-        {
-            if (ctx.timers[i])
-            {
-                glps_timer_destroy(ctx.timers[i]);
-            }
-        }
-        free(ctx.timers);
-        ctx.timers = NULL;
+        glps_unlock();
+        glps_measure_text_on_main_thread(text, length, font_size, metrics);
+        return;
     }
 
-    if (ctx.wm)
+    // Nothing to measure with before the first window, and nothing worth caching either.
+    GlyphAtlas *atlas = glps_text_atlas();
+    if (atlas->texture == 0)
     {
-        glps_wm_destroy(ctx.wm);
-        ctx.wm = NULL;
+        glps_unlock();
+        return;
     }
 
-    NFD_Quit();
-}
+    if (!ctx.text_metrics.entries)
+        text_metrics_cache_init(&ctx.text_metrics, TEXT_METRICS_CACHE_ENTRIES);
 
-void glps_update_background(GooeyWindow *win)
-{
-    if (!win || !win->active_theme)
-        return;
-    vec3 color;
-    glps_wm_set_window_ctx_curr(ctx.wm, win->creation_id);
-    convert_hex_to_rgb(&color, win->active_theme->base);
-    glClearColor(color[0], color[1], color[2], 1.0f);
+    // Switching between the bitmap and SDF atlas changes the raster size, and with it rounding of every advance.
+    if (ctx.text_metrics_atlas != atlas)
+    {
+        text_metrics_cache_invalidate(&ctx.text_metrics);
+        ctx.text_metrics_atlas = atlas;
+    }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    uint64_t key = text_metrics_cache_key(text, length, font_size);
+    const GooeyTextMetrics *cached = text_metrics_cache_get(&ctx.text_metrics, key);
+    if (cached)
+        *metrics = *cached;
+    else
+    {
+        glps_measure_glyph_run(atlas, text, length, font_size, metrics);
+        text_metrics_cache_put(&ctx.text_metrics, key, metrics);
+    }
+    glps_unlock();
 }
 
-void glps_render(GooeyWindow *win)
-{
-    glps_wm_swap_buffers(ctx.wm, win->creation_id);
-}
 float glps_get_text_width(const char *text, int length)
 {
-    float total_width = 0.0f;
-    float scale = 18.0f / 28.0f;
-
-    for (int i = 0; i < length; ++i)
-    {
-        Glyph ch = ctx.glyph_cache[(int)text[i]];
-        if (ch.textureID != 0)
-        {
-            total_width += ch.advance * scale;
-        }
-    }
-    return total_width;
+    GooeyTextMetrics metrics;
+    glps_measure_text(text, length, GLPS_DEFAULT_MEASURE_SIZE, &metrics);
+    return metrics.width;
 }
 
 float glps_get_text_height(const char *text, int length)
 {
-    float max_height = 0;
-    float scale = 18.0f / 28.0f;
-
-    for (int i = 0; i < length; ++i)
-    {
-        Glyph ch = ctx.glyph_cache[(int)text[i]];
-        if (ch.textureID != 0 && ch.height > max_height)
-        {
-            max_height = ch.height * scale;
-        }
-    }
-    return max_height;
+    GooeyTextMetrics metrics;
+    glps_measure_text(text, length, GLPS_DEFAULT_MEASURE_SIZE, &metrics);
+    return metrics.height;
 }
 
 const char *glps_get_key_from_code(void *gooey_event)
@@ -1099,8 +1939,18 @@ const char *glps_get_key_from_code(void *gooey_event)
     return event->key_press.value;
 }
 
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_set_cursor, (GOOEY_CURSOR, cursor))
+
 void glps_set_cursor(GOOEY_CURSOR cursor)
 {
+    if (ctx.headless)
+        return;
+    if (render_workers_on_worker())
+    {
+        glps_set_cursor_on_main_thread(cursor);
+        return;
+    }
+
     switch (cursor)
     {
     case GOOEY_CURSOR_HAND:
@@ -1131,9 +1981,42 @@ void glps_stop_cursor_reset(bool state)
     ctx.inhibit_reset = state;
 }
 
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_destroy_window_from_id, (int, window_id))
+
 void glps_destroy_window_from_id(int window_id)
 {
-    glps_wm_window_destroy(ctx.wm, window_id);
+    if (render_workers_on_worker())
+    {
+        glps_destroy_window_from_id_on_main_thread(window_id);
+        return;
+    }
+
+    if (validate_window_id(window_id))
+    {
+        // Its worker exits after the pass it is in, the one closing the window.
+        render_workers_stop(&ctx.workers, window_id);
+        // VAOs belong to the window's context, release them while it still exists.
+        glps_make_current(window_id);
+        render_batch_destroy(&ctx.batches[window_id]);
+        damage_tracker_destroy(&ctx.damage[window_id].tracker);
+        glps_unpin_frame(window_id);
+        ctx.pacing[window_id].swap_set_up = false;
+        atomic_store(&ctx.pacing[window_id].unsynced, false);
+        ctx.pacing[window_id].frame_ms = 0;
+        if (ctx.layer_targets)
+            layer_target_destroy(&ctx.layer_targets[window_id]);
+    }
+    if (ctx.headless)
+    {
+        headless_surface_destroy_target(&ctx.surface, window_id);
+    }
+    else
+    {
+        if (validate_window_id(window_id))
+            gl_state_destroy(&ctx.gl_states[window_id]);
+        glps_wm_window_destroy(ctx.wm, window_id);
+        glps_forget_current();
+    }
     ctx.active_window_count--;
 }
 
@@ -1151,11 +2034,29 @@ static void drag_n_drop_callback(size_t origin_window_id, char *mime, char *buff
     strncpy(event->drop_data.mime, buff, sizeof(event->drop_data.mime) - 1);
     event->drop_data.mime[sizeof(event->drop_data.mime) - 1] = '\0';
     LOG_INFO("%ld", origin_window_id);
+    glps_mark_pending(window->creation_id);
     glps_wm_window_update(ctx.wm, window->creation_id);
 }
 
 void glps_setup_callbacks(void (*callback)(size_t window_id, void *data), void *data)
 {
+    ctx.frame_callback = callback;
+    ctx.frame_data = data;
+    if (ctx.headless)
+        return;
+
+    if (ctx.threaded)
+    {
+        glps_wm_set_keyboard_callback(ctx.wm, queue_keyboard_callback, data);
+        glps_wm_set_mouse_move_callback(ctx.wm, queue_mouse_move_callback, data);
+        glps_wm_set_mouse_click_callback(ctx.wm, queue_mouse_click_callback, data);
+        glps_wm_set_scroll_callback(ctx.wm, queue_mouse_scroll_callback, data);
+        glps_wm_window_set_resize_callback(ctx.wm, queue_window_resize_callback, data);
+        glps_wm_window_set_close_callback(ctx.wm, queue_window_close_callback, data);
+        glps_wm_window_set_frame_update_callback(ctx.wm, queue_pass_callback, data);
+        return;
+    }
+
     glps_wm_set_keyboard_callback(ctx.wm, keyboard_callback, data);
     glps_wm_set_mouse_move_callback(ctx.wm, mouse_move_callback, data);
     glps_wm_set_mouse_click_callback(ctx.wm, mouse_click_callback, data);
@@ -1163,42 +2064,172 @@ void glps_setup_callbacks(void (*callback)(size_t window_id, void *data), void *
     glps_wm_window_set_resize_callback(ctx.wm, window_resize_callback,
                                        data);
     glps_wm_window_set_close_callback(ctx.wm, window_close_callback, data);
-    glps_wm_window_set_frame_update_callback(ctx.wm, callback, data);
+    glps_wm_window_set_frame_update_callback(ctx.wm, glps_run_frame, data);
+}
+
+/**
+ * Lets a loop that polls input poll at its fastest again once input came in.
+ */
+static void glps_note_input(void)
+{
+    if (!ctx.input_seen)
+        return;
+    ctx.input_seen = false;
+    event_loop_note_input(&ctx.loop);
+}
+
+/**
+ * glps_run without a display: every pass handles the windows' pending events
+ * and redraws, input only comes from glps_inject_event.
+ */
+static void glps_run_headless(void)
+{
+    while (ctx.is_running && ctx.active_window_count > 0)
+    {
+        for (size_t i = 0; i < ctx.active_window_count && ctx.frame_callback; ++i)
+        {
+            glps_run_frame(i, ctx.frame_data);
+        }
+
+        timer_heap_run_expired(&ctx.timers, event_loop_now_ms());
+        glps_upload_decoded_images();
+
+        event_loop_wait(&ctx.loop, image_decoder_has_results(&ctx.decoder)
+                                       ? 0
+                                       : timer_heap_timeout(&ctx.timers, event_loop_now_ms()));
+    }
+}
+
+/**
+ * glps_run with every window on its own worker: the loop gathers input,
+ * ticks the workers and submits what they hand over.
+ *
+ * @return false when the workers could not be set up, nothing ran.
+ */
+static bool glps_run_threaded(void)
+{
+    if (!render_workers_init(&ctx.workers, MAX_WINDOWS, glps_worker_pass, ctx.frame_data, &ctx.loop))
+    {
+        // Back to the callbacks that hand input straight to the windows.
+        ctx.threaded = false;
+        glps_setup_callbacks(ctx.frame_callback, ctx.frame_data);
+        return false;
+    }
+    for (size_t i = 0; i < ctx.active_window_count; ++i)
+        render_workers_start(&ctx.workers, i);
+    if (!ctx.headless)
+        event_loop_attach_display(&ctx.loop);
+
+    bool input = true;
+    while (ctx.is_running && ctx.active_window_count > 0 && (ctx.headless || !glps_wm_should_close(ctx.wm)))
+    {
+        if (ctx.headless)
+        {
+            for (size_t i = 0; i < ctx.active_window_count; ++i)
+            {
+                if (glps_take_due(i))
+                    render_workers_post(&ctx.workers, i, NULL);
+            }
+        }
+        else
+        {
+            // Queues input for the workers, and a pass for the windows that have something to handle.
+            for (size_t i = 0; i < ctx.active_window_count; ++i)
+            {
+                if (input || glps_window_due(i))
+                    glps_wm_window_update(ctx.wm, i);
+            }
+            glps_forget_current();
+            glps_note_input();
+        }
+        render_workers_service(&ctx.workers);
+
+        // Timer and image callbacks are application code, they run between the windows' passes as they do without workers.
+        render_workers_lock_state(&ctx.workers);
+        const bool timers_due = timer_heap_timeout(&ctx.timers, event_loop_now_ms()) == 0;
+        render_workers_unlock_state(&ctx.workers);
+        if (timers_due || image_decoder_has_results(&ctx.decoder))
+        {
+            render_workers_pause(&ctx.workers);
+            timer_heap_run_expired(&ctx.timers, event_loop_now_ms());
+            glps_upload_decoded_images();
+            render_workers_resume(&ctx.workers);
+        }
+
+        // Calls from the workers wake the loop too.
+        render_workers_lock_state(&ctx.workers);
+        const int64_t timeout = timer_heap_timeout(&ctx.timers, event_loop_now_ms());
+        render_workers_unlock_state(&ctx.workers);
+        input = event_loop_wait(&ctx.loop, image_decoder_has_results(&ctx.decoder) ? 0 : timeout);
+    }
+
+    render_workers_destroy(&ctx.workers);
+    return true;
 }
 
 void glps_run()
 {
+    if (ctx.threaded && glps_run_threaded())
+        return;
+
+    if (ctx.headless)
+    {
+        glps_run_headless();
+        return;
+    }
+
+    event_loop_attach_display(&ctx.loop);
+
+    // The first pass draws every window and reads the input that came in meanwhile.
+    bool input = true;
     while (!glps_wm_should_close(ctx.wm) && ctx.is_running)
     {
+        // The window system hands input over while its windows are updated. Unless some may be
+        // waiting, only windows with a redraw request or a notification on screen are updated.
         for (size_t i = 0; i < ctx.active_window_count; ++i)
         {
-            glps_wm_window_update(ctx.wm, i);
+            if (input || glps_window_due(i))
+                glps_wm_window_update(ctx.wm, i);
         }
+        glps_forget_current();
+        glps_note_input();
 
-        for (size_t i = 0; i < ctx.timer_count; ++i)
-            glps_timer_check_and_call(ctx.timers[i]);
+        timer_heap_run_expired(&ctx.timers, event_loop_now_ms());
+        glps_upload_decoded_images();
 
-        usleep(500);
+        // Redraw requests made above wake the loop, their frame is drawn on the next pass.
+        // Images left over the upload budget go up on the next pass, without sleeping first.
+        input = event_loop_wait(&ctx.loop, image_decoder_has_results(&ctx.decoder)
+                                               ? 0
+                                               : timer_heap_timeout(&ctx.timers, event_loop_now_ms()));
     }
 }
 
 GooeyTimer *glps_create_timer()
 {
-    glps_timer *timer = glps_timer_init();
-
-    ctx.timers[ctx.timer_count++] = timer;
-
+    HeapTimer *timer = (HeapTimer *)malloc(sizeof(HeapTimer));
     GooeyTimer *gooey_timer = (GooeyTimer *)calloc(1, sizeof(GooeyTimer));
+    if (!timer || !gooey_timer)
+    {
+        LOG_ERROR("Failed to create timer");
+        free(timer);
+        free(gooey_timer);
+        return NULL;
+    }
+
+    timer_heap_timer_init(timer);
     gooey_timer->timer_ptr = timer;
 
     return gooey_timer;
 }
-
 void glps_stop_timer(GooeyTimer *timer)
 {
-    glps_timer_stop((glps_timer *)timer->timer_ptr);
+    if (!timer || !timer->timer_ptr)
+        return;
+    glps_lock();
+    timer_heap_cancel(&ctx.timers, (HeapTimer *)timer->timer_ptr);
+    glps_unlock();
 }
-
 void glps_destroy_timer(GooeyTimer *gooey_timer)
 {
     if (!gooey_timer || !gooey_timer->timer_ptr)
@@ -1206,31 +2237,32 @@ void glps_destroy_timer(GooeyTimer *gooey_timer)
         return;
     }
 
-    glps_timer *internal_timer = (glps_timer *)gooey_timer->timer_ptr;
-
-    for (size_t i = 0; i < ctx.timer_count; ++i)
-    {
-        if (ctx.timers[i] == internal_timer)
-        {
-            glps_timer_destroy(internal_timer);
-
-            memmove(&ctx.timers[i], &ctx.timers[i + 1],
-                    (ctx.timer_count - i - 1) * sizeof(glps_timer *));
-            ctx.timer_count--;
-            ctx.timers[ctx.timer_count] = NULL;
-
-            break;
-        }
-    }
-
+    HeapTimer *internal_timer = (HeapTimer *)gooey_timer->timer_ptr;
+    glps_lock();
+    timer_heap_cancel(&ctx.timers, internal_timer);
+    glps_unlock();
+    free(internal_timer);
     free(gooey_timer);
 }
-
 void glps_set_callback_for_timer(uint64_t time, GooeyTimer *timer, void (*callback)(void *user_data), void *user_data)
 {
-    glps_timer_start((glps_timer *)timer->timer_ptr, time, callback, user_data);
+    if (!timer || !timer->timer_ptr)
+        return;
+
+    HeapTimer *internal_timer = (HeapTimer *)timer->timer_ptr;
+    glps_lock();
+    internal_timer->callback = callback;
+    internal_timer->user_data = user_data;
+    // Timers belong to the main thread, the loop is awake here and sleeps by the new deadline next.
+    timer_heap_arm(&ctx.timers, internal_timer, time, event_loop_now_ms());
+    glps_unlock();
+    // A worker arms it while the loop may be asleep on an older deadline.
+    if (render_workers_on_worker())
+        event_loop_wake(&ctx.loop);
 }
 
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_window_toggle_decorations, (GooeyWindow *, win), (bool, enable))
+
 void glps_window_toggle_decorations(GooeyWindow *win, bool enable)
 {
     if (!win)
@@ -1238,6 +2270,13 @@ void glps_window_toggle_decorations(GooeyWindow *win, bool enable)
         LOG_ERROR("Window is null.");
         return;
     }
+    if (ctx.headless)
+        return;
+    if (render_workers_on_worker())
+    {
+        glps_window_toggle_decorations_on_main_thread(win, enable);
+        return;
+    }
 
     glps_wm_toggle_window_decorations(ctx.wm, enable, win->creation_id);
 }
@@ -1249,6 +2288,8 @@ size_t glps_get_active_window_count()
 
 size_t glps_get_total_window_count()
 {
+    if (ctx.headless)
+        return ctx.surface.target_count;
     return glps_wm_get_window_count(ctx.wm);
 }
 
@@ -1258,16 +2299,31 @@ void glps_reset_events(GooeyWindow *win)
     event->type = GOOEY_EVENT_RESET;
 }
 
+/**
+ * Frames per second the window manager measured, or the headless surface since the last call.
+ */
+static double glps_window_fps(int window_id)
+{
+    if (ctx.headless)
+        return headless_surface_frame_rate(&ctx.surface, window_id, event_loop_now_ms());
+    return glps_wm_get_fps(ctx.wm, window_id);
+}
+
+RENDER_WORKERS_FORWARD(&ctx.workers, double, glps_get_window_framerate, (int, window_id))
+
 double glps_get_window_framerate(int window_id)
 {
     static struct timespec last_time[MAX_WINDOWS] = {0};
     static double last_fps[MAX_WINDOWS] = {0};
     static struct timespec now;
 
+    if (render_workers_on_worker())
+        return glps_get_window_framerate_on_main_thread(window_id);
+
     if (last_time[window_id].tv_sec == 0 && last_time[window_id].tv_nsec == 0)
     {
         clock_gettime(CLOCK_MONOTONIC, &last_time[window_id]);
-        last_fps[window_id] = glps_wm_get_fps(ctx.wm, window_id);
+        last_fps[window_id] = glps_window_fps(window_id);
         return last_fps[window_id];
     }
 
@@ -1277,7 +2333,7 @@ double glps_get_window_framerate(int window_id)
 
     if (elapsed >= 1.0)
     {
-        last_fps[window_id] = glps_wm_get_fps(ctx.wm, window_id);
+        last_fps[window_id] = glps_window_fps(window_id);
         last_time[window_id] = now;
     }
 
@@ -1321,6 +2377,9 @@ void glps_draw_webview(GooeyWindow *win, void *webview, int x, int y, int width,
 void glps_request_close()
 {
     ctx.is_running = false;
+    // May come from a window's worker while the loop sleeps.
+    if (glps_workers_running())
+        event_loop_wake(&ctx.loop);
 }
 
 void glps_init_fdialog()
@@ -1335,8 +2394,23 @@ static nfdwindowhandle_t nfd_get_window_type()
     return parentWindow;
 }
 
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_open_fdialog, (const char *, start_path),
+                            (nfdu8filteritem_t *, filters), (size_t, filter_count),
+                            (void (*)(const char *), on_file_selected))
+
 void glps_open_fdialog(const char *start_path, nfdu8filteritem_t *filters, size_t filter_count, void (*on_file_selected)(const char *file_path))
 {
+    if (ctx.headless)
+    {
+        LOG_WARNING("File dialogs need a display");
+        return;
+    }
+    if (render_workers_on_worker())
+    {
+        glps_open_fdialog_on_main_thread(start_path, filters, filter_count, on_file_selected);
+        return;
+    }
+
     nfdwindowhandle_t parentWindow = nfd_get_window_type();
 
     nfdu8char_t *outPath = NULL;
@@ -1366,6 +2440,13 @@ void glps_open_fdialog(const char *start_path, nfdu8filteritem_t *filters, size_
 
 void glps_get_platform_name(char *platform, size_t max_length)
 {
+    if (ctx.headless)
+    {
+        strncpy(platform, "Headless", max_length - 1);
+        platform[max_length - 1] = '\0';
+        return;
+    }
+
     const uint8_t platform_type = glps_wm_get_platform();
     char platform_name[1024];
     switch (platform_type)
@@ -1396,6 +2477,264 @@ void glps_get_platform_name(char *platform, size_t max_length)
     platform[max_length - 1] = '\0';
 }
 
+void glps_get_render_stats(int window_id, GooeyRenderStats *stats)
+{
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    glps_lock();
+    if (validate_window_id(window_id) && ctx.batches)
+        stats->draw_calls = ctx.batches[window_id].draw_calls;
+    if (validate_window_id(window_id) && ctx.damage)
+        stats->repainted_pixels = ctx.damage[window_id].repainted_pixels;
+    if (validate_window_id(window_id) && ctx.gl_calls)
+    {
+        stats->gl_calls_issued = ctx.gl_calls[window_id].last_frame.issued;
+        stats->gl_calls_skipped = ctx.gl_calls[window_id].last_frame.skipped;
+    }
+
+    const GlyphAtlas *atlas = glps_text_atlas();
+    stats->glyph_cache_hits = atlas->stats.hits;
+    stats->glyph_cache_misses = atlas->stats.misses;
+    stats->glyph_cache_evictions = atlas->stats.evictions;
+    stats->glyph_cache_glyphs = atlas->glyph_count;
+    stats->glyph_cache_pages = (size_t)atlas->page_count;
+    stats->glyph_cache_bytes = glyph_atlas_bytes(&ctx.atlas) + glyph_atlas_bytes(&ctx.sdf_atlas);
+    stats->text_metrics_hits = ctx.text_metrics.stats.hits;
+    stats->text_metrics_misses = ctx.text_metrics.stats.misses;
+    stats->layer_hits = ctx.layers.stats.hits;
+    stats->layer_renders = ctx.layers.stats.renders;
+    stats->layer_bytes = ctx.layers.bytes;
+    stats->texture_cache_hits = ctx.textures.stats.hits;
+    stats->texture_cache_misses = ctx.textures.stats.misses;
+    stats->texture_cache_evictions = ctx.textures.stats.evictions;
+    stats->texture_cache_textures = ctx.textures.count;
+    stats->texture_cache_bytes = ctx.textures.bytes;
+    glps_unlock();
+}
+
+void glps_begin_display_list(int window_id)
+{
+    if (!validate_window_id(window_id) || ctx.recording[window_id].list)
+        return;
+
+    render_batch_begin_list(&ctx.batches[window_id], &ctx.recording[window_id].mark);
+    ctx.recording[window_id].list = true;
+}
+
+GooeyDisplayList *glps_end_display_list(int window_id, GooeyDisplayList *list)
+{
+    if (!validate_window_id(window_id) || !ctx.recording[window_id].list)
+        return list;
+
+    RenderBatch *batch = &ctx.batches[window_id];
+    ctx.recording[window_id].list = false;
+
+    if (!list && !(list = (GooeyDisplayList *)calloc(1, sizeof(GooeyDisplayList))))
+    {
+        LOG_ERROR("Failed to allocate display list");
+        batch->merge_floor = 0;
+        return NULL;
+    }
+
+    list->generation = 0;
+    if (!render_batch_end_list(batch, &ctx.recording[window_id].mark, &list->commands))
+        return list;
+
+    // An eviction may have moved glyphs this recording already placed, it is recorded again next frame.
+    glps_lock();
+    const size_t seen_evictions = ctx.seen_glyph_evictions;
+    glps_sync_glyph_evictions();
+    if (seen_evictions != ctx.seen_glyph_evictions)
+    {
+        glps_unlock();
+        return list;
+    }
+
+    list->glyph_pages = 0;
+    for (size_t i = 0; i < list->commands.instance_count; ++i)
+    {
+        const QuadInstance *instance = &list->commands.instances[i];
+        if (instance->shape[2] != QUAD_KIND_GLYPH && instance->shape[2] != QUAD_KIND_SDF_GLYPH)
+            continue;
+        if (instance->shape[3] >= 32.0f)
+        {
+            glps_unlock();
+            return list;
+        }
+        list->glyph_pages |= 1u << (int)instance->shape[3];
+    }
+
+    list->generation = ctx.display_list_generation;
+    list->atlas = glps_text_atlas();
+    glps_unlock();
+    list->width = batch->width;
+    list->height = batch->height;
+    return list;
+}
+
+bool glps_replay_display_list(int window_id, const GooeyDisplayList *list)
+{
+    if (!validate_window_id(window_id) || !list || ctx.recording[window_id].list)
+        return false;
+
+    glps_lock();
+    glps_sync_glyph_evictions();
+
+    RenderBatch *batch = &ctx.batches[window_id];
+    GlyphAtlas *atlas = glps_text_atlas();
+    if (list->generation != ctx.display_list_generation || list->atlas != atlas ||
+        list->width != batch->width || list->height != batch->height)
+    {
+        glps_unlock();
+        return false;
+    }
+
+    // No lookups happen on replay, so the pages are marked used by hand or they could be evicted under it.
+    for (int page = 0; page < 32; ++page)
+    {
+        if (list->glyph_pages & (1u << page))
+            glyph_atlas_touch_page(atlas, page);
+    }
+    glps_unlock();
+    return render_batch_append_list(batch, &list->commands);
+}
+
+void glps_destroy_display_list(GooeyDisplayList *list)
+{
+    if (!list)
+        return;
+
+    render_batch_list_free(&list->commands);
+    free(list);
+}
+
+/**
+ * Draws the layer texture where its content was, and reports its version so
+ * a re-render damages those pixels even though the quad itself is unchanged.
+ */
+static void glps_composite_layer(int window_id, const GooeyLayer *layer)
+{
+    glps_draw_image(layer->texture, layer->x, layer->y, layer->width, layer->height, window_id);
+#if (ENABLE_DAMAGE_TRACKING)
+    uint64_t hash = damage_hash_bytes(DAMAGE_HASH_SEED, &layer, sizeof(layer));
+    hash = damage_hash_bytes(hash, &layer->version, sizeof(layer->version));
+    damage_tracker_add(&ctx.damage[window_id].tracker, hash, (float)layer->x, (float)layer->y,
+                       (float)(layer->x + layer->width), (float)(layer->y + layer->height));
+#endif
+}
+
+/**
+ * Whether @p layer still holds what the widget would draw at @p x, @p y, it is then drawn from its texture.
+ */
+static bool glps_layer_reusable(int window_id, const GooeyLayer *layer, int x, int y, int width, int height,
+                                uint64_t key)
+{
+    const RenderBatch *batch = &ctx.batches[window_id];
+    return layer->window_id == window_id &&
+           layer_cache_is_valid(layer, x, y, width, height, key, batch->width, batch->height);
+}
+
+RENDER_WORKERS_FORWARD(&ctx.workers, bool, glps_begin_layer, (int, window_id), (GooeyLayer **, layer), (int, x),
+                       (int, y), (int, width), (int, height), (uint64_t, key))
+
+bool glps_begin_layer(int window_id, GooeyLayer **layer, int x, int y, int width, int height, uint64_t key)
+{
+    if (!validate_window_id(window_id) || !layer || ctx.recording[window_id].layer ||
+        ctx.recording[window_id].list || !ctx.layer_targets)
+        return true;
+
+    if (render_workers_on_worker())
+    {
+        // Reusing the texture only draws it, rendering into it needs the context.
+        glps_lock();
+        GooeyLayer *current = *layer;
+        const bool reused = current && glps_layer_reusable(window_id, current, x, y, width, height, key);
+        if (reused)
+        {
+            current->last_used = ctx.layers.frame;
+            ctx.layers.stats.hits++;
+            glps_composite_layer(window_id, current);
+        }
+        glps_unlock();
+        if (reused)
+            return false;
+        return glps_begin_layer_on_main_thread(window_id, layer, x, y, width, height, key);
+    }
+
+    if (!*layer && !(*layer = layer_cache_create(&ctx.layers, window_id)))
+        return true;
+
+    GooeyLayer *current = *layer;
+    current->last_used = ctx.layers.frame;
+    if (glps_layer_reusable(window_id, current, x, y, width, height, key))
+    {
+        ctx.layers.stats.hits++;
+        glps_composite_layer(window_id, current);
+        return false;
+    }
+
+    // Over budget the content is simply drawn into the window, as if the widget had no layer.
+    if (!layer_cache_reserve(current, width, height))
+        return true;
+
+    current->window_id = window_id;
+    current->x = x;
+    current->y = y;
+    current->key = key;
+    render_batch_begin_list(&ctx.batches[window_id], &current->mark);
+    ctx.recording[window_id].layer = current;
+    return true;
+}
+
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_end_layer, (int, window_id), (GooeyLayer *, layer))
+
+void glps_end_layer(int window_id, GooeyLayer *layer)
+{
+    if (!layer || !validate_window_id(window_id) || layer != ctx.recording[window_id].layer)
+        return;
+    if (render_workers_on_worker())
+    {
+        glps_end_layer_on_main_thread(window_id, layer);
+        return;
+    }
+
+    ctx.recording[window_id].layer = NULL;
+    glps_make_current(window_id);
+    if (layer_target_render(&ctx.layer_targets[window_id], &ctx.batches[window_id], layer, &ctx.shape, &ctx.quad))
+        glps_composite_layer(window_id, layer);
+}
+
+void glps_invalidate_layer(GooeyLayer *layer)
+{
+    if (layer)
+        layer->generation = 0;
+}
+
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_destroy_layer, (GooeyLayer *, layer))
+
+void glps_destroy_layer(GooeyLayer *layer)
+{
+    if (!layer)
+        return;
+    if (render_workers_on_worker())
+    {
+        glps_destroy_layer_on_main_thread(layer);
+        return;
+    }
+
+    if (validate_window_id(layer->window_id) && ctx.recording[layer->window_id].layer == layer)
+    {
+        ctx.batches[layer->window_id].merge_floor = 0;
+        ctx.recording[layer->window_id].layer = NULL;
+    }
+    layer_cache_destroy_layer(layer);
+}
+
+RENDER_WORKERS_FORWARD_VOID(&ctx.workers, glps_make_window_transparent, (GooeyWindow *, win), (int, blur_radius),
+                            (float, opacity))
+
 void glps_make_window_transparent(GooeyWindow *win, int blur_radius, float opacity)
 {
     if (!win)
@@ -1403,6 +2742,13 @@ void glps_make_window_transparent(GooeyWindow *win, int blur_radius, float opaci
         LOG_ERROR("Window is null.");
         return;
     }
+    if (ctx.headless)
+        return;
+    if (render_workers_on_worker())
+    {
+        glps_make_window_transparent_on_main_thread(win, blur_radius, opacity);
+        return;
+    }
 
     glps_wm_set_window_background_transparent(ctx.wm, win->creation_id);
     glps_wm_set_window_opacity(ctx.wm, win->creation_id, opacity);
@@ -1465,6 +2811,31 @@ GooeyBackend glps_backend = {
     .OpenFileDialog = glps_open_fdialog,
     .GetPlatformName = glps_get_platform_name,
     .MakeWindowTransparent = glps_make_window_transparent,
+    .RenderBatch = glps_render_batch,
+    .GetRenderStats = glps_get_render_stats,
+    .SetTextRenderMode = glps_set_text_render_mode,
+    .MeasureText = glps_measure_text,
+    .BeginDisplayList = glps_begin_display_list,
+    .EndDisplayList = glps_end_display_list,
+    .ReplayDisplayList = glps_replay_display_list,
+    .DestroyDisplayList = glps_destroy_display_list,
+    .BeginLayer = glps_begin_layer,
+    .EndLayer = glps_end_layer,
+    .InvalidateLayer = glps_invalidate_layer,
+    .DestroyLayer = glps_destroy_layer,
+    .LoadImageAsync = glps_load_image_async,
+    .CancelImageLoad = glps_cancel_image_load,
+    .LoadImageScaled = glps_load_image_scaled,
+    .LoadImageTile = glps_load_image_tile,
+    .LoadImageTileAsync = glps_load_image_tile_async,
+    .DrawImageRegion = glps_draw_image_region,
+    .UpdateImagePixels = glps_update_image_pixels,
+    .DrawArc = glps_draw_arc,
+    .DrawPolyline = glps_draw_polyline,
+    .InitHeadless = glps_init_headless,
+    .InjectEvent = glps_inject_event,
+    .ReadPixels = glps_read_pixels,
+    .SetThreadedRendering = glps_set_threaded_rendering,
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,1093 @@
+/**
+ * Software backend: every window is a framebuffer in memory, drawn by the
+ * CPU and shown through soft_output_internal.h. Nothing here needs a GPU or
+ * a display server, which is what boards without either and pixel exact
+ * tests need. Input only comes from soft_inject_event.
+ */
+
+#include "backends/utils/backend_utils_internal.h"
+#if (TFT_ESPI_ENABLED == 0)
+#include "backends/utils/soft_raster_internal.h"
+#include "backends/utils/soft_output_internal.h"
+#include "backends/utils/text_metrics_cache_internal.h"
+#include "backends/utils/event_loop_internal.h"
+#include "backends/utils/timer_heap_internal.h"
+#include "backends/utils/image_decoder_internal.h"
+#include "backends/utils/svg_cache_internal.h"
+#include "backends/utils/utf8_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <time.h>
+
+/** Defined with the GLPS backend, which embeds it. */
+extern unsigned char roboto_ttf[];
+extern unsigned int roboto_ttf_len;
+
+/** Size GetTextWidth and GetTextHeight measure at, the one most widgets draw with. */
+#define SOFT_DEFAULT_MEASURE_SIZE 18.0f
+
+typedef struct
+{
+    bool exists;
+    SoftFramebuffer fb;
+    SoftOutputWindow output;
+    uint64_t frames;        /**< Presented since the frame rate was last measured. */
+    uint64_t measured_at_ms;
+    double frame_rate;
+} SoftWindow;
+
+/**
+ * A glyph rasterized at one pixel size, in the direct mapped glyph cache.
+ */
+typedef struct
+{
+    uint32_t codepoint;
+    int size;           /**< Pixel size, 0 for an empty slot. */
+    int left, top;      /**< Bitmap offset from the pen position, top up from the baseline. */
+    int width, height;
+    float advance;
+    uint8_t *bitmap;    /**< width x height coverage, NULL for blank glyphs. */
+} SoftGlyph;
+
+typedef struct
+{
+    SoftImage image; /**< pixels NULL for a free id. */
+} SoftImageSlot;
+
+typedef struct
+{
+    SoftWindow windows[MAX_WINDOWS];
+    size_t window_count; /**< Windows created so far, ids are never reused. */
+    size_t active_window_count;
+    SoftOutput output;
+    SoftImageSlot *images; /**< Image id n lives in images[n - 1]. */
+    size_t image_count;
+    FT_Library ft;
+    FT_Face face;
+    int face_size; /**< Pixel size the face is set to. */
+    SoftGlyph *glyphs;
+    size_t glyph_count;
+    size_t glyph_bytes;
+    size_t glyph_hits;
+    size_t glyph_misses;
+    size_t glyph_evictions;
+    TextMetricsCache text_metrics;
+    TimerHeap timers;
+    EventLoop loop;
+    ImageDecoder decoder;
+    SvgCache svgs;
+    void (*frame_callback)(size_t window_id, void *data); /**< Handles a window's events and redraws it. */
+    void *frame_data;
+    unsigned int selected_color;
+    bool inhibit_reset;
+    bool is_running;
+} SoftBackendContext;
+
+static SoftBackendContext ctx = {0};
+
+static bool validate_window_id(int window_id)
+{
+    return window_id >= 0 && window_id < MAX_WINDOWS && ctx.windows[window_id].exists;
+}
+
+static void soft_image_decoded(void *data)
+{
+    event_loop_wake((EventLoop *)data);
+}
+
+int soft_init(int project_branch)
+{
+    set_logging_enabled(project_branch);
+    if (!soft_output_open(&ctx.output, NULL))
+        return -1;
+
+    if (FT_Init_FreeType(&ctx.ft))
+    {
+        LOG_ERROR("Could not initialize FreeType\n");
+        ctx.ft = NULL;
+    }
+    else if (FT_New_Memory_Face(ctx.ft, roboto_ttf, roboto_ttf_len, 0, &ctx.face))
+    {
+        LOG_ERROR("Failed to load Roboto font\n");
+        ctx.face = NULL;
+    }
+    ctx.glyphs = (SoftGlyph *)calloc(SOFT_GLYPH_CACHE_ENTRIES, sizeof(SoftGlyph));
+    text_metrics_cache_init(&ctx.text_metrics, TEXT_METRICS_CACHE_ENTRIES);
+
+    ctx.selected_color = 0x000000;
+    ctx.inhibit_reset = false;
+    timer_heap_init(&ctx.timers);
+    event_loop_init(&ctx.loop);
+    image_decoder_init(&ctx.decoder, IMAGE_DECODE_WORKERS, soft_image_decoded, &ctx.loop);
+    ctx.decoder.downscale_min_ratio = IMAGE_DOWNSCALE_MIN_RATIO;
+    svg_cache_init(&ctx.svgs, SVG_CACHE_ENTRIES);
+    ctx.decoder.svg_cache = &ctx.svgs;
+    ctx.is_running = true;
+    return 0;
+}
+
+static void soft_clear_glyphs(void)
+{
+    if (!ctx.glyphs)
+        return;
+    for (size_t i = 0; i < SOFT_GLYPH_CACHE_ENTRIES; ++i)
+        free(ctx.glyphs[i].bitmap);
+    memset(ctx.glyphs, 0, SOFT_GLYPH_CACHE_ENTRIES * sizeof(SoftGlyph));
+    ctx.glyph_count = 0;
+    ctx.glyph_bytes = 0;
+}
+
+/**
+ * The glyph of @p codepoint at @p size pixels, rasterized on a miss over
+ * whatever glyph held its slot.
+ */
+static const SoftGlyph *soft_lookup_glyph(uint32_t codepoint, int size)
+{
+    if (!ctx.face || !ctx.glyphs)
+        return NULL;
+
+    const size_t slot = (codepoint * 2654435761u ^ (uint32_t)size * 40503u) % SOFT_GLYPH_CACHE_ENTRIES;
+    SoftGlyph *glyph = &ctx.glyphs[slot];
+    if (glyph->size == size && glyph->codepoint == codepoint)
+    {
+        ctx.glyph_hits++;
+        return glyph;
+    }
+    ctx.glyph_misses++;
+
+    if (ctx.face_size != size)
+    {
+        FT_Set_Pixel_Sizes(ctx.face, 0, (FT_UInt)size);
+        ctx.face_size = size;
+    }
+    if (FT_Load_Char(ctx.face, codepoint, FT_LOAD_RENDER) &&
+        FT_Load_Char(ctx.face, UTF8_REPLACEMENT_CHAR, FT_LOAD_RENDER))
+        return NULL;
+
+    const FT_GlyphSlot rendered = ctx.face->glyph;
+    const FT_Bitmap *bitmap = &rendered->bitmap;
+    uint8_t *pixels = NULL;
+    if (bitmap->width > 0 && bitmap->rows > 0)
+    {
+        pixels = (uint8_t *)malloc((size_t)bitmap->width * bitmap->rows);
+        if (!pixels)
+            return NULL;
+        for (unsigned int row = 0; row < bitmap->rows; ++row)
+            memcpy(pixels + (size_t)row * bitmap->width, bitmap->buffer + (ptrdiff_t)row * bitmap->pitch,
+                   bitmap->width);
+    }
+
+    if (glyph->size != 0)
+    {
+        ctx.glyph_evictions++;
+        ctx.glyph_count--;
+        ctx.glyph_bytes -= (size_t)glyph->width * glyph->height;
+        free(glyph->bitmap);
+    }
+    *glyph = (SoftGlyph){
+        .codepoint = codepoint,
+        .size = size,
+        .left = rendered->bitmap_left,
+        .top = rendered->bitmap_top,
+        .width = pixels ? (int)bitmap->width : 0,
+        .height = pixels ? (int)bitmap->rows : 0,
+        .advance = (float)rendered->advance.x / 64.0f,
+        .bitmap = pixels};
+    ctx.glyph_count++;
+    ctx.glyph_bytes += (size_t)glyph->width * glyph->height;
+    return glyph;
+}
+
+static int soft_pixel_size(float font_size)
+{
+    const int size = (int)lroundf(font_size);
+    return size > 0 ? size : 1;
+}
+
+void soft_draw_text(int x, int y, const char *text, uint32_t color, float font_size, int window_id,
+                    GooeyTFT_Sprite *sprite)
+{
+    if (!validate_window_id(window_id) || !text)
+        return;
+
+    SoftFramebuffer *fb = &ctx.windows[window_id].fb;
+    const int size = soft_pixel_size(font_size);
+    float cursor_x = (float)x;
+    float baseline_y = (float)y;
+
+    const char *p = text;
+    while (*p)
+    {
+        const uint32_t codepoint = utf8_decode(&p, SIZE_MAX);
+        if (codepoint == '\n')
+        {
+            cursor_x = (float)x;
+            baseline_y += font_size * 1.2f;
+            continue;
+        }
+
+        const SoftGlyph *glyph = soft_lookup_glyph(codepoint, size);
+        if (!glyph)
+            continue;
+        if (glyph->bitmap)
+            soft_raster_glyph(fb, glyph->bitmap, glyph->width, (int)lroundf(cursor_x) + glyph->left,
+                              (int)lroundf(baseline_y) - glyph->top, glyph->width, glyph->height, color);
+        cursor_x += glyph->advance;
+    }
+}
+
+void soft_measure_text(const char *text, int length, float font_size, GooeyTextMetrics *metrics)
+{
+    memset(metrics, 0, sizeof(*metrics));
+    if (!text || length <= 0)
+        return;
+
+    const uint64_t key = text_metrics_cache_key(text, length, font_size);
+    const GooeyTextMetrics *cached = text_metrics_cache_get(&ctx.text_metrics, key);
+    if (cached)
+    {
+        *metrics = *cached;
+        return;
+    }
+
+    const int size = soft_pixel_size(font_size);
+    const char *p = text;
+    const char *end = text + length;
+    while (p < end && *p)
+    {
+        const SoftGlyph *glyph = soft_lookup_glyph(utf8_decode(&p, (size_t)(end - p)), size);
+        if (!glyph)
+            continue;
+
+        metrics->width += glyph->advance;
+        if (glyph->height > metrics->height)
+            metrics->height = (float)glyph->height;
+        if (glyph->top > metrics->ascent)
+            metrics->ascent = (float)glyph->top;
+        if (glyph->height - glyph->top > metrics->descent)
+            metrics->descent = (float)(glyph->height - glyph->top);
+    }
+    text_metrics_cache_put(&ctx.text_metrics, key, metrics);
+}
+
+float soft_get_text_width(const char *text, int length)
+{
+    GooeyTextMetrics metrics;
+    soft_measure_text(text, length, SOFT_DEFAULT_MEASURE_SIZE, &metrics);
+    return metrics.width;
+}
+
+float soft_get_text_height(const char *text, int length)
+{
+    GooeyTextMetrics metrics;
+    soft_measure_text(text, length, SOFT_DEFAULT_MEASURE_SIZE, &metrics);
+    return metrics.height;
+}
+
+void soft_fill_rectangle(int x, int y, int width, int height, uint32_t color, int window_id, bool isRounded,
+                         float cornerRadius, GooeyTFT_Sprite *sprite)
+{
+    if (!validate_window_id(window_id))
+        return;
+
+    soft_raster_rect(&ctx.windows[window_id].fb, (float)x, (float)y, (float)width, (float)height,
+                     isRounded ? cornerRadius : 0.0f, 0.0f, color);
+}
+
+void soft_draw_rectangle(int x, int y, int width, int height, uint32_t color, float thickness, int window_id,
+                         bool isRounded, float cornerRadius, GooeyTFT_Sprite *sprite)
+{
+    if (!validate_window_id(window_id))
+        return;
+
+    soft_raster_rect(&ctx.windows[window_id].fb, (float)x, (float)y, (float)width, (float)height,
+                     isRounded ? cornerRadius : 0.0f, thickness > 0.0f ? thickness : 1.0f, color);
+}
+
+void soft_draw_line(int x1, int y1, int x2, int y2, uint32_t color, int window_id, GooeyTFT_Sprite *sprite)
+{
+    if (!validate_window_id(window_id))
+        return;
+
+    // Through pixel centers, where GL_LINES puts its one pixel wide lines.
+    soft_raster_line(&ctx.windows[window_id].fb, (float)x1 + 0.5f, (float)y1 + 0.5f, (float)x2 + 0.5f,
+                     (float)y2 + 0.5f, 1.0f, color);
+}
+
+void soft_draw_polyline(const float *points, size_t count, float width, uint32_t color, GooeyLineJoin join,
+                        int window_id)
+{
+    if (!validate_window_id(window_id))
+        return;
+
+    soft_raster_polyline(&ctx.windows[window_id].fb, points, count, width, color);
+}
+
+void soft_draw_arc(int x_center, int y_center, int width, int height, float angle1, float angle2, float thickness,
+                   uint32_t color, int window_id)
+{
+    if (!validate_window_id(window_id))
+        return;
+
+    float start = angle1, sweep = angle2 - angle1;
+    if (sweep < 0.0f)
+    {
+        start = angle2;
+        sweep = -sweep;
+    }
+    soft_raster_arc(&ctx.windows[window_id].fb, (float)x_center, (float)y_center, (float)width * 0.5f,
+                    (float)height * 0.5f, start * (float)M_PI / 180.0f, fminf(sweep, 360.0f) * (float)M_PI / 180.0f,
+                    thickness, color);
+}
+
+void soft_fill_arc(int x_center, int y_center, int width, int height, int angle1, int angle2, int window_id,
+                   GooeyTFT_Sprite *sprite)
+{
+    if (!validate_window_id(window_id) || width <= 0)
+        return;
+
+    // The vertical radius scaled by height / width, as the GL backend draws it.
+    const float radius_y = (float)height * 0.5f * ((float)height / (float)width);
+    float start = (float)angle1, sweep = (float)(angle2 - angle1);
+    if (sweep < 0.0f)
+    {
+        start = (float)angle2;
+        sweep = -sweep;
+    }
+    soft_raster_arc(&ctx.windows[window_id].fb, (float)x_center, (float)y_center, (float)width * 0.5f, radius_y,
+                    start * (float)M_PI / 180.0f, fminf(sweep, 360.0f) * (float)M_PI / 180.0f, 0.0f,
+                    ctx.selected_color);
+}
+
+void soft_set_foreground(uint32_t color)
+{
+    ctx.selected_color = color;
+}
+
+static SoftImage *soft_find_image(unsigned int image_id)
+{
+    if (image_id == 0 || image_id > ctx.image_count || !ctx.images[image_id - 1].image.pixels)
+        return NULL;
+    return &ctx.images[image_id - 1].image;
+}
+
+/**
+ * Takes ownership of @p pixels under a new id, 0 when out of memory.
+ */
+static unsigned int soft_add_image(uint32_t *pixels, int width, int height)
+{
+    size_t slot = 0;
+    while (slot < ctx.image_count && ctx.images[slot].image.pixels)
+        slot++;
+    if (slot == ctx.image_count)
+    {
+        SoftImageSlot *images = (SoftImageSlot *)realloc(ctx.images, (ctx.image_count + 1) * sizeof(SoftImageSlot));
+        if (!images)
+        {
+            LOG_ERROR("Failed to allocate memory for images");
+            free(pixels);
+            return 0;
+        }
+        ctx.images = images;
+        ctx.image_count++;
+    }
+
+    ctx.images[slot].image = (SoftImage){.pixels = pixels, .width = width, .height = height};
+    return (unsigned int)slot + 1;
+}
+
+/**
+ * Converts decoded pixels, bottom-up and 1 to 4 channels, into an image.
+ */
+static unsigned int soft_add_decoded_image(const DecodedImage *image)
+{
+    uint32_t *pixels = (uint32_t *)malloc((size_t)image->width * image->height * sizeof(uint32_t));
+    if (!pixels)
+    {
+        LOG_ERROR("Failed to allocate memory for an image");
+        return 0;
+    }
+
+    const int channels = image->channels;
+    for (int y = 0; y < image->height; ++y)
+    {
+        const unsigned char *src = image->pixels + (size_t)(image->height - 1 - y) * image->width * channels;
+        uint8_t *dst = (uint8_t *)(pixels + (size_t)y * image->width);
+        for (int x = 0; x < image->width; ++x, src += channels, dst += 4)
+        {
+            dst[0] = src[0];
+            dst[1] = channels >= 3 ? src[1] : src[0];
+            dst[2] = channels >= 3 ? src[2] : src[0];
+            dst[3] = channels == 4 ? src[3] : channels == 2 ? src[1] : 255;
+        }
+    }
+    return soft_add_image(pixels, image->width, image->height);
+}
+
+static unsigned int soft_load_image_file(const char *image_path, int width, int height, bool disk_cache)
+{
+    if (!image_path)
+        return 0;
+
+    DecodedImage image;
+    bool downscaled;
+    if (!image_decoder_load(&ctx.decoder, image_path, width, height, disk_cache, &image, &downscaled))
+    {
+        LOG_ERROR("Failed to load image: %s", image_path);
+        return 0;
+    }
+
+    const unsigned int image_id = soft_add_decoded_image(&image);
+    decoded_image_free(&image);
+    return image_id;
+}
+
+unsigned int soft_load_image_scaled(const char *image_path, int width, int height)
+{
+    return soft_load_image_file(image_path, width, height, true);
+}
+
+unsigned int soft_load_image_tile(const char *image_path)
+{
+    return soft_load_image_file(image_path, 0, 0, false);
+}
+
+unsigned int soft_load_image(const char *image_path)
+{
+    return soft_load_image_scaled(image_path, 0, 0);
+}
+
+unsigned int soft_load_image_from_bin(unsigned char *data, size_t binary_len)
+{
+    DecodedImage image;
+    if (!image_decode_memory(data, binary_len, &image))
+    {
+        LOG_ERROR("Failed to load image");
+        return 0;
+    }
+
+    const unsigned int image_id = soft_add_decoded_image(&image);
+    decoded_image_free(&image);
+    return image_id;
+}
+
+unsigned int soft_load_image_async(const char *image_path, int window_id, int width, int height,
+                                   void (*callback)(unsigned int texture_id, void *user_data), void *user_data)
+{
+    if (!image_path || !validate_window_id(window_id))
+        return 0;
+    return image_decoder_submit(&ctx.decoder, image_path, window_id, width, height, true, callback, user_data);
+}
+
+unsigned int soft_load_image_tile_async(const char *image_path, int window_id,
+                                        void (*callback)(unsigned int texture_id, void *user_data), void *user_data)
+{
+    if (!image_path || !validate_window_id(window_id))
+        return 0;
+    return image_decoder_submit(&ctx.decoder, image_path, window_id, 0, 0, false, callback, user_data);
+}
+
+void soft_cancel_image_load(unsigned int request)
+{
+    image_decoder_cancel(&ctx.decoder, request);
+}
+
+/**
+ * Hands decoded images to their owners, IMAGE_UPLOAD_BUDGET_KB at a time.
+ */
+static void soft_take_decoded_images(void)
+{
+    const size_t budget = (size_t)IMAGE_UPLOAD_BUDGET_KB * 1024;
+    size_t converted = 0;
+
+    ImageDecodeJob *job;
+    while (converted < budget && (job = image_decoder_take(&ctx.decoder)))
+    {
+        unsigned int image_id = 0;
+        if (job->decoded)
+        {
+            image_id = soft_add_decoded_image(&job->image);
+            converted += (size_t)job->image.width * job->image.height * 4;
+        }
+        if (job->callback)
+            job->callback(image_id, job->user_data);
+        image_decoder_job_free(job);
+    }
+}
+
+unsigned int soft_update_image_pixels(unsigned int texture_id, const unsigned char *rgba, int width, int height,
+                                      int window_id)
+{
+    if (!rgba || width <= 0 || height <= 0)
+        return 0;
+
+    // Same memory layout as the framebuffer, frames are copied as they come.
+    const size_t size = (size_t)width * height * sizeof(uint32_t);
+    SoftImage *image = soft_find_image(texture_id);
+    if (image && image->width == width && image->height == height)
+    {
+        memcpy(image->pixels, rgba, size);
+        return texture_id;
+    }
+
+    uint32_t *pixels = (uint32_t *)malloc(size);
+    if (!pixels)
+    {
+        LOG_ERROR("Failed to allocate memory for streamed pixels");
+        return 0;
+    }
+    memcpy(pixels, rgba, size);
+    return soft_add_image(pixels, width, height);
+}
+
+void soft_unload_image(unsigned int texture_id)
+{
+    SoftImage *image = soft_find_image(texture_id);
+    if (!image)
+        return;
+    free(image->pixels);
+    image->pixels = NULL;
+}
+
+void soft_draw_image(unsigned int texture_id, int x, int y, int width, int height, int window_id)
+{
+    if (!validate_window_id(window_id))
+        return;
+
+    soft_raster_image(&ctx.windows[window_id].fb, soft_find_image(texture_id), 0.0f, 0.0f, 1.0f, 1.0f, x, y, width,
+                      height);
+}
+
+void soft_draw_image_region(unsigned int texture_id, float u0, float v0, float u1, float v1, int x, int y, int width,
+                            int height, int window_id)
+{
+    if (!validate_window_id(window_id))
+        return;
+
+    soft_raster_image(&ctx.windows[window_id].fb, soft_find_image(texture_id), u0, v0, u1, v1, x, y, width, height);
+}
+
+GooeyWindow *soft_create_window(const char *title, int x, int y, int width, int height)
+{
+    if (ctx.window_count >= MAX_WINDOWS)
+    {
+        LOG_ERROR("Too many windows");
+        return NULL;
+    }
+
+    GooeyWindow *window = (GooeyWindow *)malloc(sizeof(GooeyWindow));
+    if (!window)
+        return NULL;
+
+    const size_t window_id = ctx.window_count;
+    SoftWindow *soft = &ctx.windows[window_id];
+    memset(soft, 0, sizeof(*soft));
+    if (!soft_raster_resize(&soft->fb, width, height))
+    {
+        LOG_ERROR("Failed to allocate a %dx%d framebuffer", width, height);
+        free(window);
+        return NULL;
+    }
+    soft_output_window_init(&soft->output, x, y);
+    soft->exists = true;
+    soft->measured_at_ms = event_loop_now_ms();
+
+    window->creation_id = window_id;
+    ctx.window_count++;
+    ctx.active_window_count++;
+    return window;
+}
+
+void soft_destroy_window_from_id(int window_id)
+{
+    if (!validate_window_id(window_id))
+        return;
+
+    SoftWindow *window = &ctx.windows[window_id];
+    soft_output_window_release(&ctx.output, &window->output, window_id);
+    soft_raster_destroy(&window->fb);
+    window->exists = false;
+    ctx.active_window_count--;
+}
+
+void soft_window_dim(int *width, int *height, int window_id)
+{
+    const bool exists = validate_window_id(window_id);
+    if (width)
+        *width = exists ? ctx.windows[window_id].fb.width : 0;
+    if (height)
+        *height = exists ? ctx.windows[window_id].fb.height : 0;
+}
+
+void soft_set_viewport(size_t window_id, int width, int height)
+{
+    if (!validate_window_id((int)window_id))
+        return;
+    if (!soft_raster_resize(&ctx.windows[window_id].fb, width, height))
+        LOG_ERROR("Failed to resize the framebuffer to %dx%d", width, height);
+}
+
+void soft_clear(GooeyWindow *win)
+{
+    if (!validate_window_id(win->creation_id))
+        return;
+    soft_raster_clear(&ctx.windows[win->creation_id].fb, win->active_theme->base);
+}
+
+void soft_update_background(GooeyWindow *win)
+{
+}
+
+void soft_render(GooeyWindow *win)
+{
+    const int window_id = win->creation_id;
+    if (!validate_window_id(window_id))
+        return;
+
+    SoftWindow *window = &ctx.windows[window_id];
+    soft_output_present(&ctx.output, &window->output, window_id, &window->fb);
+    window->frames++;
+}
+
+static void keyboard_callback(size_t window_id, bool state, const char *value, unsigned long keycode, void *data)
+{
+    GooeyWindow **windows = (GooeyWindow **)data;
+    GooeyEvent *event = (GooeyEvent *)windows[window_id]->current_event;
+
+    event->type = state ? GOOEY_EVENT_KEY_PRESS : GOOEY_EVENT_KEY_RELEASE;
+    event->key_press.state = state;
+    strncpy(event->key_press.value, value, sizeof(event->key_press.value));
+    event->key_press.keycode = keycode;
+}
+
+static void mouse_click_callback(size_t window_id, bool state, void *data)
+{
+    GooeyWindow **windows = (GooeyWindow **)data;
+    GooeyEvent *event = (GooeyEvent *)windows[window_id]->current_event;
+    event->type = state ? GOOEY_EVENT_CLICK_PRESS : GOOEY_EVENT_CLICK_RELEASE;
+    event->click.x = event->mouse_move.x;
+    event->click.y = event->mouse_move.y;
+}
+
+static void mouse_move_callback(size_t window_id, double posX, double posY, void *data)
+{
+    GooeyWindow **windows = (GooeyWindow **)data;
+    GooeyEvent *event = (GooeyEvent *)windows[window_id]->current_event;
+    event->mouse_move.x = posX;
+    event->mouse_move.y = posY;
+}
+
+void soft_inject_event(int window_id, const GooeyEvent *input)
+{
+    if (!validate_window_id(window_id) || !input)
+        return;
+    if (!ctx.frame_callback)
+    {
+        LOG_WARNING("Events can only be injected once the window runs");
+        return;
+    }
+
+    GooeyWindow **windows = (GooeyWindow **)ctx.frame_data;
+    if (!windows[window_id])
+        return;
+
+    // The same path as the GLPS input callbacks, so widgets see what real input produces.
+    GooeyEvent *event = (GooeyEvent *)windows[window_id]->current_event;
+    switch (input->type)
+    {
+    case GOOEY_EVENT_MOUSE_MOVE:
+        mouse_move_callback(window_id, input->mouse_move.x, input->mouse_move.y, ctx.frame_data);
+        break;
+    case GOOEY_EVENT_CLICK_PRESS:
+    case GOOEY_EVENT_CLICK_RELEASE:
+        mouse_move_callback(window_id, input->click.x, input->click.y, ctx.frame_data);
+        mouse_click_callback(window_id, input->type == GOOEY_EVENT_CLICK_PRESS, ctx.frame_data);
+        break;
+    case GOOEY_EVENT_KEY_PRESS:
+    case GOOEY_EVENT_KEY_RELEASE:
+        keyboard_callback(window_id, input->type == GOOEY_EVENT_KEY_PRESS, input->key_press.value,
+                          input->key_press.keycode, ctx.frame_data);
+        break;
+    case GOOEY_EVENT_MOUSE_SCROLL:
+        event->type = GOOEY_EVENT_MOUSE_SCROLL;
+        event->mouse_scroll = input->mouse_scroll;
+        break;
+    default:
+        *event = *input;
+        break;
+    }
+
+    ctx.frame_callback(window_id, ctx.frame_data);
+}
+
+bool soft_read_pixels(int window_id, unsigned char *rgba, int width, int height)
+{
+    if (!validate_window_id(window_id) || !rgba)
+        return false;
+
+    const SoftFramebuffer *fb = &ctx.windows[window_id].fb;
+    if (width <= 0 || height <= 0 || width > fb->width || height > fb->height)
+        return false;
+
+    for (int row = 0; row < height; ++row)
+        memcpy(rgba + (size_t)row * width * 4, fb->pixels + (size_t)row * fb->width, (size_t)width * 4);
+    return true;
+}
+
+void soft_request_redraw(GooeyWindow *win)
+{
+    GooeyEvent *event = (GooeyEvent *)win->current_event;
+    event->type = GOOEY_EVENT_REDRAWREQ;
+    // May come from another thread while the loop sleeps.
+    event_loop_wake(&ctx.loop);
+}
+
+void soft_force_redraw(void)
+{
+}
+
+void soft_setup_callbacks(void (*callback)(size_t window_id, void *data), void *data)
+{
+    ctx.frame_callback = callback;
+    ctx.frame_data = data;
+}
+
+/**
+ * Every pass handles the windows' pending events and redraws, then sleeps
+ * until a timer is due or something asks for a redraw.
+ */
+void soft_run(void)
+{
+    while (ctx.is_running && ctx.active_window_count > 0)
+    {
+        for (size_t i = 0; i < ctx.window_count && ctx.frame_callback; ++i)
+        {
+            if (ctx.windows[i].exists)
+                ctx.frame_callback(i, ctx.frame_data);
+        }
+
+        timer_heap_run_expired(&ctx.timers, event_loop_now_ms());
+        soft_take_decoded_images();
+
+        event_loop_wait(&ctx.loop, image_decoder_has_results(&ctx.decoder)
+                                       ? 0
+                                       : timer_heap_timeout(&ctx.timers, event_loop_now_ms()));
+    }
+}
+
+void soft_cleanup(void)
+{
+    ctx.is_running = false;
+
+    for (size_t i = 0; i < ctx.window_count; ++i)
+        soft_destroy_window_from_id((int)i);
+    ctx.window_count = 0;
+
+    for (size_t i = 0; i < ctx.image_count; ++i)
+        free(ctx.images[i].image.pixels);
+    free(ctx.images);
+    ctx.images = NULL;
+    ctx.image_count = 0;
+
+    soft_clear_glyphs();
+    free(ctx.glyphs);
+    ctx.glyphs = NULL;
+    text_metrics_cache_destroy(&ctx.text_metrics);
+    if (ctx.face)
+    {
+        FT_Done_Face(ctx.face);
+        ctx.face = NULL;
+    }
+    if (ctx.ft)
+    {
+        FT_Done_FreeType(ctx.ft);
+        ctx.ft = NULL;
+    }
+    ctx.face_size = 0;
+
+    // Timers stay owned by their GooeyTimer, only the schedule goes.
+    timer_heap_destroy(&ctx.timers);
+    image_decoder_destroy(&ctx.decoder);
+    svg_cache_destroy(&ctx.svgs);
+    event_loop_destroy(&ctx.loop);
+    soft_output_close(&ctx.output);
+}
+
+GooeyTimer *soft_create_timer(void)
+{
+    HeapTimer *timer = (HeapTimer *)malloc(sizeof(HeapTimer));
+    GooeyTimer *gooey_timer = (GooeyTimer *)calloc(1, sizeof(GooeyTimer));
+    if (!timer || !gooey_timer)
+    {
+        LOG_ERROR("Failed to create timer");
+        free(timer);
+        free(gooey_timer);
+        return NULL;
+    }
+
+    timer_heap_timer_init(timer);
+    gooey_timer->timer_ptr = timer;
+    return gooey_timer;
+}
+
+void soft_stop_timer(GooeyTimer *timer)
+{
+    if (!timer || !timer->timer_ptr)
+        return;
+    timer_heap_cancel(&ctx.timers, (HeapTimer *)timer->timer_ptr);
+}
+
+void soft_destroy_timer(GooeyTimer *gooey_timer)
+{
+    if (!gooey_timer || !gooey_timer->timer_ptr)
+        return;
+
+    HeapTimer *internal_timer = (HeapTimer *)gooey_timer->timer_ptr;
+    timer_heap_cancel(&ctx.timers, internal_timer);
+    free(internal_timer);
+    free(gooey_timer);
+}
+
+void soft_set_callback_for_timer(uint64_t time, GooeyTimer *timer, void (*callback)(void *user_data),
+                                 void *user_data)
+{
+    if (!timer || !timer->timer_ptr)
+        return;
+
+    HeapTimer *internal_timer = (HeapTimer *)timer->timer_ptr;
+    internal_timer->callback = callback;
+    internal_timer->user_data = user_data;
+    timer_heap_arm(&ctx.timers, internal_timer, time, event_loop_now_ms());
+}
+
+size_t soft_get_active_window_count(void)
+{
+    return ctx.active_window_count;
+}
+
+size_t soft_get_total_window_count(void)
+{
+    return ctx.window_count;
+}
+
+/**
+ * Frames presented per second, measured over at least a second.
+ */
+double soft_get_window_framerate(int window_id)
+{
+    if (!validate_window_id(window_id))
+        return 0.0;
+
+    SoftWindow *window = &ctx.windows[window_id];
+    const uint64_t now = event_loop_now_ms();
+    const uint64_t elapsed = now - window->measured_at_ms;
+    if (elapsed >= 1000)
+    {
+        window->frame_rate = (double)window->frames * 1000.0 / (double)elapsed;
+        window->frames = 0;
+        window->measured_at_ms = now;
+    }
+    return window->frame_rate;
+}
+
+void soft_get_render_stats(int window_id, GooeyRenderStats *stats)
+{
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->glyph_cache_hits = ctx.glyph_hits;
+    stats->glyph_cache_misses = ctx.glyph_misses;
+    stats->glyph_cache_evictions = ctx.glyph_evictions;
+    stats->glyph_cache_glyphs = ctx.glyph_count;
+    stats->glyph_cache_bytes = ctx.glyph_bytes;
+    stats->text_metrics_hits = ctx.text_metrics.stats.hits;
+    stats->text_metrics_misses = ctx.text_metrics.stats.misses;
+    if (!validate_window_id(window_id))
+        return;
+
+    const SoftRasterStats *raster = &ctx.windows[window_id].fb.stats;
+    for (int i = 0; i < GOOEY_RASTER_PRIMITIVE_COUNT; ++i)
+    {
+        stats->raster_pixels[i] = raster->pixels[i];
+        if (raster->nanoseconds[i] > 0)
+            stats->raster_pixels_per_second[i] = (double)raster->pixels[i] * 1e9 / (double)raster->nanoseconds[i];
+    }
+}
+
+const char *soft_get_key_from_code(void *gooey_event)
+{
+    if (!gooey_event)
+    {
+        LOG_ERROR("Invalid event.");
+        return NULL;
+    }
+    return ((GooeyEvent *)gooey_event)->key_press.value;
+}
+
+void soft_reset_events(GooeyWindow *win)
+{
+    GooeyEvent *event = (GooeyEvent *)win->current_event;
+    event->type = GOOEY_EVENT_RESET;
+}
+
+GooeyEvent *soft_get_events(GooeyWindow *window)
+{
+    return window->current_event;
+}
+
+void soft_request_close(size_t window_id)
+{
+    ctx.is_running = false;
+}
+
+void soft_set_cursor(GOOEY_CURSOR cursor)
+{
+}
+
+void soft_stop_cursor_reset(bool state)
+{
+    ctx.inhibit_reset = state;
+}
+
+int soft_get_current_clicked_window(void)
+{
+    return -1;
+}
+
+void soft_make_window_visible(int window_id, bool visibility)
+{
+}
+
+void soft_set_window_resizable(bool value, int window_id)
+{
+}
+
+void soft_window_toggle_decorations(GooeyWindow *win, bool enable)
+{
+}
+
+void soft_make_window_transparent(GooeyWindow *win, int blur_radius, float opacity)
+{
+}
+
+void soft_hide_current_child(void)
+{
+}
+
+void soft_destroy_windows(void)
+{
+}
+
+GooeyTFT_Sprite *soft_create_widget_sprite(int x, int y, int width, int height)
+{
+    return NULL;
+}
+
+void soft_redraw_sprite(GooeyTFT_Sprite *sprite)
+{
+}
+
+void soft_clear_area(int x, int y, int width, int height)
+{
+}
+
+void soft_clear_old_widget(GooeyTFT_Sprite *sprite)
+{
+}
+
+void soft_create_view(void)
+{
+}
+
+void soft_destroy_ultralight(void)
+{
+}
+
+void soft_draw_webview(int x, int y, int width, int height, int window_id, GooeyTFT_Sprite *sprite)
+{
+}
+
+void soft_open_fdialog(const char *start_path, void *filters, size_t filter_count,
+                       void (*on_file_selected)(const char *file_path))
+{
+    LOG_WARNING("File dialogs need a display");
+}
+
+void soft_get_platform_name(char *platform, size_t max_length)
+{
+    strncpy(platform, "Software", max_length - 1);
+    platform[max_length - 1] = '\0';
+}
+
+GooeyBackend soft_backend = {
+    .Init = soft_init,
+    .Run = soft_run,
+    .Cleanup = soft_cleanup,
+    .SetupCallbacks = soft_setup_callbacks,
+    .RequestRedraw = soft_request_redraw,
+    .SetViewport = soft_set_viewport,
+    .GetActiveWindowCount = soft_get_active_window_count,
+    .GetTotalWindowCount = soft_get_total_window_count,
+    .CreateGooeyWindow = soft_create_window,
+    .MakeWindowVisible = soft_make_window_visible,
+    .MakeWindowResizable = soft_set_window_resizable,
+    .WindowToggleDecorations = soft_window_toggle_decorations,
+    .GetCurrentClickedWindow = soft_get_current_clicked_window,
+    .DestroyWindows = soft_destroy_windows,
+    .DestroyWindowFromId = soft_destroy_window_from_id,
+    .HideCurrentChild = soft_hide_current_child,
+    .UpdateBackground = soft_update_background,
+    .Clear = soft_clear,
+    .Render = soft_render,
+    .SetForeground = soft_set_foreground,
+    .DrawGooeyText = soft_draw_text,
+    .LoadGooeyImage = soft_load_image,
+    .LoadImageFromBin = soft_load_image_from_bin,
+    .DrawImage = soft_draw_image,
+    .FillRectangle = soft_fill_rectangle,
+    .DrawRectangle = soft_draw_rectangle,
+    .FillArc = soft_fill_arc,
+    .GetKeyFromCode = soft_get_key_from_code,
+    .ResetEvents = soft_reset_events,
+    .GetEvents = soft_get_events,
+    .GetWinDim = soft_window_dim,
+    .GetWinFramerate = soft_get_window_framerate,
+    .DrawLine = soft_draw_line,
+    .GetTextWidth = soft_get_text_width,
+    .GetTextHeight = soft_get_text_height,
+    .SetCursor = soft_set_cursor,
+    .UnloadImage = soft_unload_image,
+    .CreateTimer = soft_create_timer,
+    .SetTimerCallback = soft_set_callback_for_timer,
+    .StopTimer = soft_stop_timer,
+    .DestroyTimer = soft_destroy_timer,
+    .CursorChange = soft_set_cursor,
+    .StopCursorReset = soft_stop_cursor_reset,
+    .ForceCallRedraw = soft_force_redraw,
+    .RequestClose = soft_request_close,
+    .CreateSpriteForWidget = soft_create_widget_sprite,
+    .RedrawSprite = soft_redraw_sprite,
+    .ClearArea = soft_clear_area,
+    .ClearOldWidget = soft_clear_old_widget,
+    .CreateView = soft_create_view,
+    .DestroyUltralight = soft_destroy_ultralight,
+    .DrawWebview = soft_draw_webview,
+    .OpenFileDialog = soft_open_fdialog,
+    .GetPlatformName = soft_get_platform_name,
+    .MakeWindowTransparent = soft_make_window_transparent,
+    .GetRenderStats = soft_get_render_stats,
+    .MeasureText = soft_measure_text,
+    .LoadImageAsync = soft_load_image_async,
+    .CancelImageLoad = soft_cancel_image_load,
+    .LoadImageScaled = soft_load_image_scaled,
+    .LoadImageTile = soft_load_image_tile,
+    .LoadImageTileAsync = soft_load_image_tile_async,
+    .DrawImageRegion = soft_draw_image_region,
+    .UpdateImagePixels = soft_update_image_pixels,
+    .DrawArc = soft_draw_arc,
+    .DrawPolyline = soft_draw_polyline,
+    .InjectEvent = soft_inject_event,
+    .ReadPixels = soft_read_pixels,
+};
+
+#endif
@@ -17,19 +17,84 @@
 
 #include "gooey.h"
 #include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
 #include "backends/gooey_backend_internal.h"
 #include "logger/pico_logger_internal.h"
 
 int called = 0;
 
 int Gooey_Init()
+{
+    return Gooey_InitWithFlags(GOOEY_INIT_DEFAULT);
+}
+
+int Gooey_InitWithFlags(GooeyInitFlags flags)
 {
 #if (TFT_ESPI_ENABLED)
     active_backend = &tft_backend;
 #else
     active_backend = &glps_backend;
+
+    // CI runs unmodified applications headless.
+    const char *headless = getenv("GOOEY_HEADLESS");
+    if (headless && *headless && strcmp(headless, "0") != 0)
+        flags |= GOOEY_INIT_HEADLESS;
+    const char *software = getenv("GOOEY_SOFTWARE");
+    if (software && *software && strcmp(software, "0") != 0)
+        flags |= GOOEY_INIT_SOFTWARE;
+    const char *threaded = getenv("GOOEY_THREADED");
+    if (threaded && *threaded && strcmp(threaded, "0") != 0)
+        flags |= GOOEY_INIT_THREADED;
+
+    // Needs no display either, so it also stands for headless.
+    if (flags & GOOEY_INIT_SOFTWARE)
+        active_backend = &soft_backend;
 #endif
 
+    if (flags & GOOEY_INIT_THREADED)
+    {
+        if (active_backend->SetThreadedRendering)
+            active_backend->SetThreadedRendering(true);
+        else
+            LOG_WARNING("The backend draws every window on one thread");
+    }
+
+#if (!TFT_ESPI_ENABLED)
+    if (flags & GOOEY_INIT_SOFTWARE)
+        return active_backend->Init(PROJECT_BRANCH);
+#endif
+
+    if (flags & GOOEY_INIT_HEADLESS)
+    {
+        if (!active_backend->InitHeadless)
+        {
+            LOG_ERROR("The backend cannot run headless");
+            return -1;
+        }
+        return active_backend->InitHeadless(PROJECT_BRANCH);
+    }
+
     active_backend->Init(PROJECT_BRANCH);
     return 0;
 }
+
+void Gooey_SetTextRenderMode(GooeyTextRenderMode mode)
+{
+    if (!active_backend || !active_backend->SetTextRenderMode)
+        return;
+
+    active_backend->SetTextRenderMode(mode);
+}
+
+void Gooey_MeasureText(const char *text, float font_size, GooeyTextMetrics *metrics)
+{
+    if (!metrics)
+        return;
+
+    memset(metrics, 0, sizeof(*metrics));
+    if (!text || !active_backend || !active_backend->MeasureText)
+        return;
+
+    active_backend->MeasureText(text, (int)strlen(text), font_size, metrics);
+}
@@ -31,4 +31,14 @@ void GooeyWidget_MoveTo(void *widget, int x, int y)
 void GooeyWidget_Resize(void *widget, int w, int h)
 {
     GooeyWidget_Resize_Internal(widget, w, h);
+}
+
+void GooeyWidget_Invalidate(void *widget)
+{
+    GooeyWidget_Invalidate_Internal(widget);
+}
+
+void GooeyWidget_SetLayerCached(void *widget, bool cached)
+{
+    GooeyWidget_SetLayerCached_Internal(widget, cached);
 }
\ No newline at end of file
@@ -17,8 +17,11 @@
 
 #include "core/gooey_widget_internal.h"
 #include "common/gooey_common.h"
+#include "backends/gooey_backend_internal.h"
+#include "backends/utils/damage_tracker_internal.h"
 #include "logger/pico_logger_internal.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 
 void GooeyWidget_MakeVisible_Internal(void* widget, bool state)
@@ -60,4 +63,136 @@ void GooeyWidget_Resize_Internal(void* widget, int w, int h)
     GooeyWidget *core = (GooeyWidget *) widget;
     core->width = w < 0 ? core->width : w;
     core->height = h < 0 ? core->height : h;
-}
\ No newline at end of file
+}
+
+#if (ENABLE_DISPLAY_LISTS)
+static uint64_t GooeyWidget_DisplayKey(GooeyWindow *win, void *widget, size_t size)
+{
+    // Everything but the recording itself: the core up to it, then the widget's own fields.
+    uint64_t key = damage_hash_bytes(DAMAGE_HASH_SEED, widget, offsetof(GooeyWidget, display_list));
+    key = damage_hash_bytes(key, (const char *)widget + sizeof(GooeyWidget), size - sizeof(GooeyWidget));
+    key = damage_hash_bytes(key, win->active_theme, sizeof(*win->active_theme));
+    return key ? key : 1;
+}
+
+static bool GooeyWidget_DisplayListsSupported(void)
+{
+    return active_backend && active_backend->BeginDisplayList && active_backend->EndDisplayList &&
+           active_backend->ReplayDisplayList && active_backend->DestroyDisplayList;
+}
+#endif
+
+bool GooeyWidget_Replay_Internal(GooeyWindow *win, void *widget, size_t size)
+{
+#if (ENABLE_DISPLAY_LISTS)
+    GooeyWidget *core = (GooeyWidget *)widget;
+    if (!core->display_list || !core->display_key || !GooeyWidget_DisplayListsSupported())
+        return false;
+    if (core->display_key != GooeyWidget_DisplayKey(win, widget, size))
+        return false;
+    return active_backend->ReplayDisplayList(win->creation_id, core->display_list);
+#else
+    (void)win;
+    (void)widget;
+    (void)size;
+    return false;
+#endif
+}
+
+void GooeyWidget_BeginRecord_Internal(GooeyWindow *win, void *widget)
+{
+#if (ENABLE_DISPLAY_LISTS)
+    (void)widget;
+    if (GooeyWidget_DisplayListsSupported())
+        active_backend->BeginDisplayList(win->creation_id);
+#else
+    (void)win;
+    (void)widget;
+#endif
+}
+
+void GooeyWidget_EndRecord_Internal(GooeyWindow *win, void *widget, size_t size)
+{
+#if (ENABLE_DISPLAY_LISTS)
+    if (!GooeyWidget_DisplayListsSupported())
+        return;
+
+    GooeyWidget *core = (GooeyWidget *)widget;
+    core->display_list = active_backend->EndDisplayList(win->creation_id, core->display_list);
+    core->display_key = core->display_list ? GooeyWidget_DisplayKey(win, widget, size) : 0;
+#else
+    (void)win;
+    (void)widget;
+    (void)size;
+#endif
+}
+
+void GooeyWidget_Invalidate_Internal(void *widget)
+{
+    if (!widget)
+    {
+        LOG_ERROR("Couldn't invalidate widget, widget is NULL.");
+        return;
+    }
+
+    GooeyWidget *core = (GooeyWidget *)widget;
+    core->display_key = 0;
+    if (core->layer && active_backend && active_backend->InvalidateLayer)
+        active_backend->InvalidateLayer(core->layer);
+}
+
+void GooeyWidget_ReleaseDisplayList_Internal(void *widget)
+{
+    GooeyWidget *core = (GooeyWidget *)widget;
+    if (!core || !core->display_list)
+        return;
+
+    if (active_backend && active_backend->DestroyDisplayList)
+        active_backend->DestroyDisplayList(core->display_list);
+    core->display_list = NULL;
+    core->display_key = 0;
+}
+
+void GooeyWidget_SetLayerCached_Internal(void *widget, bool cached)
+{
+    if (!widget)
+    {
+        LOG_ERROR("Couldn't change widget layer caching, widget is NULL.");
+        return;
+    }
+
+    GooeyWidget *core = (GooeyWidget *)widget;
+    core->layer_cached = cached;
+    if (!cached)
+        GooeyWidget_ReleaseLayer_Internal(widget);
+}
+
+bool GooeyWidget_BeginLayer_Internal(GooeyWindow *win, void *widget, int x, int y, int width, int height,
+                                     const void *state, size_t state_size)
+{
+    GooeyWidget *core = (GooeyWidget *)widget;
+    if (!core->layer_cached || !active_backend || !active_backend->BeginLayer || !active_backend->EndLayer)
+        return true;
+
+    uint64_t key = damage_hash_bytes(DAMAGE_HASH_SEED, state, state_size);
+    key = damage_hash_bytes(key, win->active_theme, sizeof(*win->active_theme));
+    return active_backend->BeginLayer(win->creation_id, &core->layer, x, y, width, height, key);
+}
+
+void GooeyWidget_EndLayer_Internal(GooeyWindow *win, void *widget)
+{
+    GooeyWidget *core = (GooeyWidget *)widget;
+    if (core->layer && active_backend && active_backend->EndLayer)
+        active_backend->EndLayer(win->creation_id, core->layer);
+}
+
+void GooeyWidget_ReleaseLayer_Internal(void *widget)
+{
+    GooeyWidget *core = (GooeyWidget *)widget;
+    if (!core || !core->layer)
+        return;
+
+    if (active_backend && active_backend->DestroyLayer)
+        active_backend->DestroyLayer(core->layer);
+    core->layer = NULL;
+}
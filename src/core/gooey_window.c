@@ -9,6 +9,7 @@
 #include "widgets/gooey_drop_surface_internal.h"
 #include "widgets/gooey_dropdown_internal.h"
 #include "widgets/gooey_image_internal.h"
+#include "widgets/gooey_image_viewer_internal.h"
 #include "widgets/gooey_label_internal.h"
 #include "widgets/gooey_layout.h"
 #include "widgets/gooey_layout_internal.h"
@@ -27,6 +28,7 @@
 #include "virtual/gooey_keyboard_internal.h"
 #include "widgets/gooey_webview_internal.h"
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 #include "widgets/gooey_ctxmenu_internal.h"
 #include "widgets/gooey_node_editor_internal.h"
 #include "widgets/gooey_notifications_internal.h"
@@ -197,7 +199,7 @@ void GooeyWindow_SetTheme(GooeyWindow *win, GooeyTheme *theme)
 
 bool GooeyWindow_AllocateResources(GooeyWindow *win)
 {
-    const size_t total_widget_ptrs = MAX_WIDGETS * 20;
+    const size_t total_widget_ptrs = MAX_WIDGETS * 21;
     const size_t total_byte_size = (total_widget_ptrs * sizeof(void *)) +
                                    (MAX_PLOT_COUNT * sizeof(GooeyPlot *)) +
                                    (MAX_SWITCHES * sizeof(GooeySwitch *)) +
@@ -256,6 +258,8 @@ bool GooeyWindow_AllocateResources(GooeyWindow *win)
     pool_ptr += MAX_WIDGETS * sizeof(GooeyNodeEditor *);
     win->webviews = (GooeyWebview **)pool_ptr;
     pool_ptr += MAX_WIDGETS * sizeof(GooeyWebview *);
+    win->image_viewers = (GooeyImageViewer **)pool_ptr;
+    pool_ptr += MAX_WIDGETS * sizeof(GooeyImageViewer *);
 
     win->current_event = (GooeyEvent *)pool_ptr;
     pool_ptr += sizeof(GooeyEvent);
@@ -309,6 +313,41 @@ static void __free_widget_array(void **array, size_t count)
     }
 }
 
+static void __release_display_lists(void **array, size_t count)
+{
+    if (!array)
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+        GooeyWidget_ReleaseDisplayList_Internal(array[i]);
+}
+
+static void __release_images(GooeyWindow *win)
+{
+#if (ENABLE_IMAGE)
+    if (!win->images)
+        return;
+
+    for (size_t i = 0; i < win->image_count; ++i)
+    {
+        GooeyImage_CancelLoad_Internal(win->images[i]);
+        GooeyImage_DestroyStream_Internal(win->images[i]->stream);
+        win->images[i]->stream = NULL;
+    }
+#endif
+}
+
+static void __release_image_viewers(GooeyWindow *win)
+{
+#if (ENABLE_IMAGE_VIEWER)
+    if (!win->image_viewers)
+        return;
+
+    for (size_t i = 0; i < win->image_viewer_count; ++i)
+        GooeyImageViewer_Release_Internal(win->image_viewers[i]);
+#endif
+}
+
 static void __free_canvas_elements(GooeyWindow *win)
 {
     if (!win->canvas)
@@ -395,6 +434,7 @@ static void __free_plots(GooeyWindow *win)
         GooeyPlot *plot = win->plots[i];
         if (!plot)
             continue;
+        GooeyWidget_ReleaseLayer_Internal(plot);
         free(plot);
     }
 }
@@ -464,6 +504,7 @@ static void __free_node_editors(GooeyWindow *win)
             continue;
 
         GooeyNodeEditor_Internal_Clear(editor);
+        GooeyWidget_ReleaseLayer_Internal(editor);
         free(editor);
     }
 }
@@ -530,8 +571,19 @@ void GooeyWindow_FreeResources(GooeyWindow *win)
     __free_webviews(win);
     __free_notifications(win);
 
+    // Only widgets that record display lists, the others may not start with a GooeyWidget.
+    __release_display_lists((void **)win->progressbars, win->progressbar_count);
+    __release_display_lists((void **)win->switches, win->switch_count);
+    __release_display_lists((void **)win->buttons, win->button_count);
+    __release_display_lists((void **)win->labels, win->label_count);
+    __release_display_lists((void **)win->checkboxes, win->checkbox_count);
+    __release_display_lists((void **)win->sliders, win->slider_count);
+
     __free_widget_array((void **)win->drop_surface, win->drop_surface_count);
+    __release_images(win);
     __free_widget_array((void **)win->images, win->image_count);
+    __release_image_viewers(win);
+    __free_widget_array((void **)win->image_viewers, win->image_viewer_count);
     __free_widget_array((void **)win->progressbars, win->progressbar_count);
     __free_widget_array((void **)win->switches, win->switch_count);
     __free_widget_array((void **)win->buttons, win->button_count);
@@ -551,6 +603,7 @@ void GooeyWindow_FreeResources(GooeyWindow *win)
 
     win->tab_count = 0;
     win->image_count = 0;
+    win->image_viewer_count = 0;
     win->drop_surface_count = 0;
     win->canvas_count = 0;
     win->button_count = 0;
@@ -602,6 +655,7 @@ GooeyWindow *GooeyWindow_Create(const char *title, int x, int y, int width, int
 
     win->tab_count = 0;
     win->image_count = 0;
+    win->image_viewer_count = 0;
     win->drop_surface_count = 0;
     win->canvas_count = 0;
     win->button_count = 0;
@@ -656,6 +710,7 @@ GooeyWindow GooeyWindow_CreateChild(const char *title, int width, int height, bo
     win.widget_count = 0;
     win.node_editor_count = 0;
     win.webview_count = 0;
+    win.image_viewer_count = 0;
     win.notification_count = 0;
 
     return win;
@@ -701,6 +756,7 @@ void GooeyWindow_DrawUIElements(GooeyWindow *win)
     DRAW_WIDGET_IF_ENABLED(ENABLE_PROGRESSBAR, GooeyProgressBar_Draw);
     DRAW_WIDGET_IF_ENABLED(ENABLE_PLOT, GooeyPlot_Draw);
     DRAW_WIDGET_IF_ENABLED(ENABLE_IMAGE, GooeyImage_Draw);
+    DRAW_WIDGET_IF_ENABLED(ENABLE_IMAGE_VIEWER, GooeyImageViewer_Draw);
     DRAW_WIDGET_IF_ENABLED(ENABLE_LABEL, GooeyLabel_Draw);
     DRAW_WIDGET_IF_ENABLED(ENABLE_LIST, GooeyList_Draw);
     DRAW_WIDGET_IF_ENABLED(ENABLE_SLIDER, GooeySlider_Draw);
@@ -768,6 +824,7 @@ void GooeyWindow_Redraw(size_t window_id, void *data)
 
     HANDLE_EVENT_IF_ENABLED_BOOL(ENABLE_SLIDER, GooeySlider_HandleDrag, window, event);
     HANDLE_EVENT_IF_ENABLED_BOOL(ENABLE_LIST, GooeyList_HandleThumbScroll, window, event);
+    HANDLE_EVENT_IF_ENABLED_BOOL(ENABLE_IMAGE_VIEWER, GooeyImageViewer_HandleDrag, window, event);
 
     HANDLE_EVENT_IF_ENABLED_VOID(ENABLE_NOTIFICATIONS, GooeyNotification_Internal_Update, window);
 
@@ -784,6 +841,7 @@ void GooeyWindow_Redraw(size_t window_id, void *data)
     {
     case GOOEY_EVENT_MOUSE_SCROLL:
         HANDLE_EVENT_IF_ENABLED_BOOL(ENABLE_LIST, GooeyList_HandleScroll, window, event);
+        HANDLE_EVENT_IF_ENABLED_BOOL(ENABLE_IMAGE_VIEWER, GooeyImageViewer_HandleScroll, window, event);
         break;
 
     case GOOEY_EVENT_RESIZE:
@@ -1163,6 +1221,22 @@ void GooeyWindow_UnRegisterWidget(GooeyWindow *win, void *widget)
         }
         break;
     }
+    case WIDGET_IMAGE_VIEWER:
+    {
+        for (size_t i = 0; i < win->image_viewer_count; i++)
+        {
+            if (win->image_viewers[i] == (GooeyImageViewer *)widget)
+            {
+                for (size_t j = i; j + 1 < win->image_viewer_count; j++)
+                {
+                    win->image_viewers[j] = win->image_viewers[j + 1];
+                }
+                win->image_viewer_count--;
+                break;
+            }
+        }
+        break;
+    }
     case WIDGET_LIST:
     {
         for (int i = 0; i < win->list_count; i++)
@@ -1293,3 +1367,31 @@ void GooeyWindow_MakeTransparent(GooeyWindow *win, int blur_radius, float opacit
 {
     active_backend->MakeWindowTransparent(win, blur_radius, opacity);
 }
+
+void GooeyWindow_GetRenderStats(GooeyWindow *win, GooeyRenderStats *stats)
+{
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!win || !active_backend || !active_backend->GetRenderStats)
+        return;
+
+    active_backend->GetRenderStats(win->creation_id, stats);
+}
+
+void GooeyWindow_InjectEvent(GooeyWindow *win, const GooeyEvent *event)
+{
+    if (!win || !event || !active_backend || !active_backend->InjectEvent)
+        return;
+
+    active_backend->InjectEvent(win->creation_id, event);
+}
+
+bool GooeyWindow_ReadPixels(GooeyWindow *win, unsigned char *rgba, int width, int height)
+{
+    if (!win || !rgba || !active_backend || !active_backend->ReadPixels)
+        return false;
+
+    return active_backend->ReadPixels(win->creation_id, rgba, width, height);
+}
@@ -5,6 +5,7 @@
 #include <time.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 
 #if (TFT_ESPI_ENABLED == 0)
 
@@ -22,6 +23,9 @@ typedef struct LogEntry
     char *message;
 } LogEntry;
 
+// Image decoding threads log too, messages are formatted and stored one at a time.
+static atomic_flag log_lock = ATOMIC_FLAG_INIT;
+
 static LogEntry *log_entries = NULL;
 static size_t log_capacity = 0;
 static size_t log_count = 0;
@@ -96,6 +100,15 @@ void log_message(DebugLevel level, const char *file, int line, const char *func,
         break;
     }
 
+    char log_line[512];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(log_line, sizeof(log_line), fmt, args);
+    va_end(args);
+
+    while (atomic_flag_test_and_set_explicit(&log_lock, memory_order_acquire))
+        ;
+
     time_t raw_time;
     struct tm *time_info;
     char time_buffer[20];
@@ -103,17 +116,13 @@ void log_message(DebugLevel level, const char *file, int line, const char *func,
     time_info = localtime(&raw_time);
     strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%d %H:%M:%S", time_info);
 
-    char log_line[512];
-    va_list args;
-    va_start(args, fmt);
-    vsnprintf(log_line, sizeof(log_line), fmt, args);
-    va_end(args);
-
     printf("[%s] %s%s%s [%s:%d] %s: %s\n", time_buffer, color, level_str, KNRM, file, line, func, log_line);
 
     char full_log[1024];
     snprintf(full_log, sizeof(full_log), "[%s] %s [%s:%d] %s: %s", time_buffer, level_str, file, line, func, log_line);
     add_log_entry(full_log);
+
+    atomic_flag_clear_explicit(&log_lock, memory_order_release);
 }
 
 void set_logging_enabled(bool enabled)
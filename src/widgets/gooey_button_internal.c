@@ -1,6 +1,7 @@
 #include "widgets/gooey_button_internal.h"
 #if (ENABLE_BUTTON)
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 
 #define GOOEY_BUTTON_DEFAULT_RADIUS 2.0f
 
@@ -11,7 +12,15 @@ void GooeyButton_Draw(GooeyWindow *win)
         GooeyButton *button = win->buttons[i];
         if (!button->core.is_visible)
             continue;
+        if (GooeyWidget_Replay_Internal(win, button, sizeof(*button)))
+        {
+            // Drawn as recorded, which is all a redraw of its sprite asks for.
+            if (button->core.sprite && button->core.sprite->needs_redraw)
+                active_backend->ResetRedrawSprite(button->core.sprite);
+            continue;
+        }
 
+        GooeyWidget_BeginRecord_Internal(win, button);
         unsigned long button_color = win->active_theme->widget_base;
 
         if (button->is_disabled || button->hover)
@@ -31,8 +40,7 @@ void GooeyButton_Draw(GooeyWindow *win)
         active_backend->DrawGooeyText(text_x,
                                  text_y, button->label, win->active_theme->neutral, 18.0f, win->creation_id, button->core.sprite);
         active_backend->SetForeground(win->active_theme->neutral);
-
-
+        GooeyWidget_EndRecord_Internal(win, button, sizeof(*button));
 
         if (button->core.sprite && button->core.sprite->needs_redraw)
             active_backend->ResetRedrawSprite(button->core.sprite);
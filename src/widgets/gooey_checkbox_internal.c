@@ -1,6 +1,7 @@
 #include "widgets/gooey_checkbox_internal.h"
 #if (ENABLE_CHECKBOX)
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 #define CHECKBOX_SIZE 20 /** Size of a checkbox widget. */
 
 void GooeyCheckbox_Draw(GooeyWindow *win)
@@ -11,6 +12,10 @@ void GooeyCheckbox_Draw(GooeyWindow *win)
         GooeyCheckbox *checkbox = win->checkboxes[i];
         if (!checkbox->core.is_visible)
             continue;
+        if (GooeyWidget_Replay_Internal(win, checkbox, sizeof(*checkbox)))
+            continue;
+
+        GooeyWidget_BeginRecord_Internal(win, checkbox);
         int label_width = active_backend->GetTextWidth(checkbox->label, strlen(checkbox->label));
         int label_x = checkbox->core.x + CHECKBOX_SIZE + 10;
         int label_y = checkbox->core.y + (CHECKBOX_SIZE / 2) + 5;
@@ -26,6 +31,7 @@ void GooeyCheckbox_Draw(GooeyWindow *win)
             active_backend->FillRectangle(checkbox->core.x + 5, checkbox->core.y + 5,
                                           checkbox->core.width - 10, checkbox->core.height - 10, win->active_theme->primary, win->creation_id, false, 0.0f, checkbox->core.sprite);
         }
+        GooeyWidget_EndRecord_Internal(win, checkbox, sizeof(*checkbox));
     }
 }
 
@@ -86,7 +86,7 @@ void GooeyDebugOverlay_Draw(GooeyWindow *win)
     active_backend->GetWinDim(&window_width, &window_height, win->creation_id);
 
     const int overlay_width = 300;
-    const int overlay_height = 180;
+    const int overlay_height = 252;
     const int x_pos = window_width - overlay_width - 10;
     const int y_pos = window_height - overlay_height - 10;
     const int line_height = 18;
@@ -138,6 +138,38 @@ void GooeyDebugOverlay_Draw(GooeyWindow *win)
     active_backend->DrawGooeyText(x_pos + padding, current_y, widget_text,
                                   win->active_theme->neutral, 18.0f, win->creation_id, NULL);
     current_y += line_height;
+
+    GooeyRenderStats stats = {0};
+    if (active_backend->GetRenderStats)
+        active_backend->GetRenderStats(win->creation_id, &stats);
+    char glyph_text[96];
+    snprintf(glyph_text, sizeof(glyph_text), "Glyphs: %zu hit %zu miss %zu evict",
+             stats.glyph_cache_hits, stats.glyph_cache_misses, stats.glyph_cache_evictions);
+    active_backend->DrawGooeyText(x_pos + padding, current_y, glyph_text,
+                                  win->active_theme->neutral, 18.0f, win->creation_id, NULL);
+    current_y += line_height;
+
+    char layer_text[96];
+    snprintf(layer_text, sizeof(layer_text), "Layers: %zu hit %zu render %.1f MB",
+             stats.layer_hits, stats.layer_renders, (float)stats.layer_bytes / (1024.0f * 1024.0f));
+    active_backend->DrawGooeyText(x_pos + padding, current_y, layer_text,
+                                  win->active_theme->neutral, 18.0f, win->creation_id, NULL);
+    current_y += line_height;
+
+    char texture_text[96];
+    snprintf(texture_text, sizeof(texture_text), "Textures: %zu, %zu hit %zu miss %.1f MB",
+             stats.texture_cache_textures, stats.texture_cache_hits, stats.texture_cache_misses,
+             (float)stats.texture_cache_bytes / (1024.0f * 1024.0f));
+    active_backend->DrawGooeyText(x_pos + padding, current_y, texture_text,
+                                  win->active_theme->neutral, 18.0f, win->creation_id, NULL);
+    current_y += line_height;
+
+    char gl_text[96];
+    snprintf(gl_text, sizeof(gl_text), "GL calls: %zu issued %zu skipped", stats.gl_calls_issued,
+             stats.gl_calls_skipped);
+    active_backend->DrawGooeyText(x_pos + padding, current_y, gl_text,
+                                  win->active_theme->neutral, 18.0f, win->creation_id, NULL);
+    current_y += line_height;
 #if GLES_ON
     active_backend->DrawGooeyText(x_pos + padding, current_y, "Renderer: OpenGL ES 3.0 [GLPS]",
                                   win->active_theme->neutral, 18.0f, win->creation_id, NULL);
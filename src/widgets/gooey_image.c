@@ -1,5 +1,6 @@
 #include "widgets/gooey_image.h"
 #if (ENABLE_IMAGE)
+#include "widgets/gooey_image_internal.h"
 #include "backends/gooey_backend_internal.h"
 #include "logger/pico_logger_internal.h"
 #include <fcntl.h>
@@ -27,6 +28,7 @@ GooeyImage *GooeyImage_Create(const char *image_path, int x, int y, int width, i
     image->core.is_visible = true;
     image->callback = callback;
     image->needs_refresh = false;
+    image->downscale = true;
     image->user_data = user_data;
     image->core.disable_input = false;
 
@@ -47,6 +49,15 @@ GooeyImage *GooeyImage_Create(const char *image_path, int x, int y, int width, i
         LOG_WARNING("Image path is NULL");
     }
 
+    image->stream = GooeyImage_CreateStream_Internal();
+    if (!image->stream)
+    {
+        LOG_ERROR("Failed to allocate memory for image stream");
+        free((void *)image->image_path);
+        free(image);
+        return NULL;
+    }
+
     image->core.sprite = active_backend->CreateSpriteForWidget(x, y, width, height);
     
     LOG_INFO("Created image widget with path: %s", image_path ? image_path : "NULL");
@@ -62,6 +73,10 @@ void GooeyImage_SetImage(GooeyImage *image, const char *image_path)
         return;
     }
 
+    // Same file, the texture already shows it. GooeyImage_Damage() forces a reload.
+    if (image_path && image->image_path && strcmp(image_path, image->image_path) == 0)
+        return;
+
     // Free the old path if it exists
     if (image->image_path)
     {
@@ -92,10 +107,107 @@ void GooeyImage_Damage(GooeyImage *image)
     image->needs_refresh = true;
 }
 
+void GooeyImage_SetLoadCallback(GooeyImage *image, void (*callback)(GooeyImage *image, bool loaded, void *user_data),
+                                void *user_data)
+{
+    if (!image)
+    {
+        LOG_ERROR("Image widget is NULL");
+        return;
+    }
+
+    image->load_callback = callback;
+    image->load_user_data = user_data;
+}
+
+void GooeyImage_SetDownscale(GooeyImage *image, bool downscale)
+{
+    if (!image)
+    {
+        LOG_ERROR("Image widget is NULL");
+        return;
+    }
+
+    if (image->downscale == downscale)
+        return;
+    image->downscale = downscale;
+    image->needs_refresh = true;
+}
+
+bool GooeyImage_UpdatePixels(GooeyImage *image, const unsigned char *rgba, int stride, int width, int height)
+{
+    if (!image || !image->stream || !rgba || width <= 0 || height <= 0)
+    {
+        LOG_ERROR("Invalid frame for image widget");
+        return false;
+    }
+
+    const size_t row = (size_t)width * 4;
+    if (stride == 0)
+        stride = (int)row;
+    if ((size_t)stride < row)
+    {
+        LOG_ERROR("Image frame stride %d is shorter than a row of %d pixels", stride, width);
+        return false;
+    }
+
+    GooeyImageStream *stream = image->stream;
+    GooeyImageFrame *frame = &stream->frames[stream->producer];
+    const size_t size = row * height;
+    if (frame->capacity < size)
+    {
+        unsigned char *pixels = realloc(frame->pixels, size);
+        if (!pixels)
+        {
+            LOG_ERROR("Failed to allocate memory for image frame");
+            return false;
+        }
+        frame->pixels = pixels;
+        frame->capacity = size;
+    }
+
+    if ((size_t)stride == row)
+        memcpy(frame->pixels, rgba, size);
+    else
+    {
+        for (int y = 0; y < height; ++y)
+            memcpy(frame->pixels + row * y, rgba + (size_t)stride * y, row);
+    }
+    frame->width = width;
+    frame->height = height;
+
+    atomic_store_explicit(&stream->active, true, memory_order_release);
+    const int previous = atomic_exchange_explicit(&stream->ready, stream->producer | GOOEY_IMAGE_FRAME_FRESH,
+                                                  memory_order_acq_rel);
+    stream->producer = previous & ~GOOEY_IMAGE_FRAME_FRESH;
+
+    // The frame replaced was never shown, and already asked for the redraw that will show this one.
+    if (previous & GOOEY_IMAGE_FRAME_FRESH)
+    {
+        atomic_fetch_add_explicit(&stream->dropped, 1, memory_order_relaxed);
+        return true;
+    }
+    GooeyWindow *window = atomic_load_explicit(&stream->window, memory_order_acquire);
+    if (window)
+        active_backend->RequestRedraw(window);
+    return true;
+}
+
+uint64_t GooeyImage_GetDroppedFrames(const GooeyImage *image)
+{
+    if (!image || !image->stream)
+        return 0;
+    return atomic_load_explicit(&image->stream->dropped, memory_order_relaxed);
+}
+
 void GooeyImage_Destroy(GooeyImage *image)
 {
     if (!image) return;
-    
+
+    // A load still in flight would call back into the freed widget.
+    GooeyImage_CancelLoad_Internal(image);
+    GooeyImage_DestroyStream_Internal(image->stream);
+
     // Free the copied image path
     if (image->image_path)
     {
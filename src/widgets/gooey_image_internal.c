@@ -3,6 +3,9 @@
 #include "backends/gooey_backend_internal.h"
 #include "logger/pico_logger_internal.h"
 #include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <strings.h>
 #include <unistd.h>
 
 bool GooeyImage_HandleClick(GooeyWindow *win, int mouseX, int mouseY)
@@ -24,6 +27,177 @@ bool GooeyImage_HandleClick(GooeyWindow *win, int mouseX, int mouseY)
     return true;
 }
 
+static void GooeyImage_Loaded(GooeyImage *image, unsigned int texture_id)
+{
+    // A texture kept on screen while a sharper one loaded, it goes once replaced.
+    const unsigned int previous = image->texture_id;
+    image->is_loaded = true;
+    if (texture_id == 0 && previous != 0)
+    {
+        LOG_WARNING("Failed to reload image at %dx%d: %s", image->texture_width, image->texture_height, image->image_path);
+        return;
+    }
+
+    image->texture_id = texture_id;
+    if (previous != 0)
+        active_backend->UnloadImage(previous);
+    if (texture_id == 0)
+        LOG_ERROR("Failed to load image: %s", image->image_path);
+    if (image->load_callback)
+        image->load_callback(image, texture_id != 0, image->load_user_data);
+}
+
+#if (ENABLE_ASYNC_IMAGE_LOADING)
+static void GooeyImage_Decoded(unsigned int texture_id, void *user_data)
+{
+    GooeyImage *image = (GooeyImage *)user_data;
+    image->load_request = 0;
+    GooeyImage_Loaded(image, texture_id);
+    active_backend->RequestRedraw(image->window);
+}
+#endif
+
+/**
+ * SVGs have no resolution of their own, they are rasterized for the widget.
+ */
+static bool GooeyImage_IsVector(const GooeyImage *image)
+{
+    const char *ext = image->image_path ? strrchr(image->image_path, '.') : NULL;
+    return ext && strcasecmp(ext + 1, "svg") == 0;
+}
+
+/**
+ * Size in display pixels the texture is needed at, 0 x 0 for the full image.
+ */
+static void GooeyImage_TargetSize(const GooeyImage *image, int *width, int *height)
+{
+    *width = *height = 0;
+    if (!image->downscale || image->core.width <= 0 || image->core.height <= 0)
+        return;
+    if (IMAGE_DOWNSCALE_MIN_RATIO <= 0 && !GooeyImage_IsVector(image))
+        return;
+    *width = (int)ceilf((float)image->core.width * IMAGE_DOWNSCALE_DPI_SCALE);
+    *height = (int)ceilf((float)image->core.height * IMAGE_DOWNSCALE_DPI_SCALE);
+}
+
+/**
+ * Whether the widget grew past the size its texture was shrunk to, or for
+ * an SVG whether it was resized at all: a smaller raster saves the memory.
+ */
+static bool GooeyImage_NeedsSharper(const GooeyImage *image)
+{
+    if (image->texture_id == 0 || image->texture_width == 0)
+        return false;
+
+    int width, height;
+    GooeyImage_TargetSize(image, &width, &height);
+    if (GooeyImage_IsVector(image))
+        return width != image->texture_width || height != image->texture_height;
+    return width == 0 || width > image->texture_width || height > image->texture_height;
+}
+
+/**
+ * Starts loading the image's file, asynchronously when the backend can.
+ */
+static void GooeyImage_Load(GooeyWindow *win, GooeyImage *image)
+{
+    // Loads the current path, a change made before the first draw needs no reload.
+    image->needs_refresh = false;
+    GooeyImage_TargetSize(image, &image->texture_width, &image->texture_height);
+    if (!image->image_path)
+    {
+        LOG_ERROR("Image path is NULL for image widget");
+        image->is_loaded = true;
+        return;
+    }
+
+    LOG_INFO("Loading image: %s", image->image_path);
+#if (ENABLE_ASYNC_IMAGE_LOADING)
+    if (active_backend->LoadImageAsync)
+    {
+        image->window = win;
+        image->load_request = active_backend->LoadImageAsync(image->image_path, win->creation_id, image->texture_width,
+                                                             image->texture_height, GooeyImage_Decoded, image);
+        if (image->load_request != 0)
+            return;
+    }
+#endif
+    if (active_backend->LoadImageScaled)
+        GooeyImage_Loaded(image, active_backend->LoadImageScaled(image->image_path, image->texture_width, image->texture_height));
+    else
+        GooeyImage_Loaded(image, active_backend->LoadGooeyImage(image->image_path));
+}
+
+void GooeyImage_CancelLoad_Internal(GooeyImage *image)
+{
+    if (!image || image->load_request == 0)
+        return;
+    if (active_backend->CancelImageLoad)
+        active_backend->CancelImageLoad(image->load_request);
+    image->load_request = 0;
+}
+
+GooeyImageStream *GooeyImage_CreateStream_Internal(void)
+{
+    GooeyImageStream *stream = (GooeyImageStream *)calloc(1, sizeof(GooeyImageStream));
+    if (!stream)
+        return NULL;
+
+    stream->producer = 0;
+    stream->consumer = 2;
+    atomic_init(&stream->ready, 1);
+    atomic_init(&stream->active, false);
+    atomic_init(&stream->dropped, 0);
+    atomic_init(&stream->window, NULL);
+    return stream;
+}
+
+void GooeyImage_DestroyStream_Internal(GooeyImageStream *stream)
+{
+    if (!stream)
+        return;
+    for (int i = 0; i < 3; ++i)
+        free(stream->frames[i].pixels);
+    free(stream);
+}
+
+/**
+ * Uploads the newest pushed frame if one arrived since the last draw.
+ *
+ * @return false while no frame was ever pushed, the image then shows its file.
+ */
+static bool GooeyImage_UpdateStream(GooeyWindow *win, GooeyImage *image)
+{
+    GooeyImageStream *stream = image->stream;
+    if (!stream)
+        return false;
+    atomic_store_explicit(&stream->window, win, memory_order_release);
+    if (!atomic_load_explicit(&stream->active, memory_order_acquire))
+        return false;
+
+    if (!(atomic_load_explicit(&stream->ready, memory_order_acquire) & GOOEY_IMAGE_FRAME_FRESH))
+        return true;
+    stream->consumer = atomic_exchange_explicit(&stream->ready, stream->consumer, memory_order_acq_rel) &
+                       ~GOOEY_IMAGE_FRAME_FRESH;
+    if (!active_backend->UpdateImagePixels)
+    {
+        LOG_WARNING("The backend cannot stream image pixels");
+        return true;
+    }
+
+    // The file is not coming back, a texture it left behind goes.
+    GooeyImage_CancelLoad_Internal(image);
+    image->needs_refresh = false;
+    const GooeyImageFrame *frame = &stream->frames[stream->consumer];
+    const unsigned int texture = active_backend->UpdateImagePixels(image->texture_id, frame->pixels, frame->width,
+                                                                   frame->height, win->creation_id);
+    if (image->texture_id != 0 && texture != image->texture_id)
+        active_backend->UnloadImage(image->texture_id);
+    image->texture_id = texture;
+    image->is_loaded = true;
+    return true;
+}
+
 void GooeyImage_Draw(GooeyWindow *win)
 {
     for (size_t i = 0; i < win->image_count; ++i)
@@ -31,38 +205,25 @@ void GooeyImage_Draw(GooeyWindow *win)
         GooeyImage *image = win->images[i];
         if (!image || !image->core.is_visible)
             continue;
-        
-        if(!image->is_loaded)
-        {
-            if (image->image_path)
-            {
-                LOG_INFO("Loading image: %s", image->image_path);
-                image->texture_id = active_backend->LoadGooeyImage(image->image_path);
-                if (image->texture_id == 0)
-                {
-                    LOG_ERROR("Failed to load image: %s", image->image_path);
-                    // You could set a fallback texture here
-                }
-                image->is_loaded = true;
-            }
-            else
-            {
-                LOG_ERROR("Image path is NULL for image widget");
-            }
-        }
 
-        if (image->needs_refresh && image->is_loaded)
+        const bool streamed = GooeyImage_UpdateStream(win, image);
+
+        if (!streamed && image->needs_refresh && (image->is_loaded || image->load_request != 0))
         {
             LOG_INFO("Refreshing image: %s", image->image_path);
-            active_backend->UnloadImage(image->texture_id);
-            if (image->image_path)
-            {
-                image->texture_id = active_backend->LoadGooeyImage(image->image_path);
-            }
+            GooeyImage_CancelLoad_Internal(image);
+            if (image->texture_id != 0)
+                active_backend->UnloadImage(image->texture_id);
+            image->texture_id = 0;
+            image->is_loaded = false;
             image->needs_refresh = false;
             active_backend->RequestRedraw(win);
         }
-        
+
+        // The current texture stays on screen until the sharper one replaces it.
+        if (!streamed && (!image->is_loaded || GooeyImage_NeedsSharper(image)) && image->load_request == 0)
+            GooeyImage_Load(win, image);
+
         // Only draw if we have a valid texture
         if (image->texture_id != 0)
         {
@@ -74,6 +235,12 @@ void GooeyImage_Draw(GooeyWindow *win)
             active_backend->FillRectangle(image->core.x, image->core.y, image->core.width, image->core.height, 
                                         0xFF0000, win->creation_id, false, 0.0f, image->core.sprite);
         }
+        else
+        {
+            // Still decoding, hold its place with the widget color until the texture arrives.
+            active_backend->FillRectangle(image->core.x, image->core.y, image->core.width, image->core.height,
+                                          win->active_theme->widget_base, win->creation_id, false, 0.0f, image->core.sprite);
+        }
     }
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "widgets/gooey_image_viewer.h"
+#if (ENABLE_IMAGE_VIEWER)
+#include "widgets/gooey_image_viewer_internal.h"
+#include "backends/gooey_backend_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The pattern is handed to snprintf, it must take three ints and nothing else.
+ */
+static bool GooeyImageViewer_ValidPattern(const char *pattern)
+{
+    int conversions = 0;
+    for (const char *c = pattern; *c; ++c)
+    {
+        if (*c != '%')
+            continue;
+        ++c;
+        if (*c == '%')
+            continue;
+        if (*c != 'd')
+            return false;
+        conversions++;
+    }
+    return conversions == 3;
+}
+
+GooeyImageViewer *GooeyImageViewer_Create(const char *tile_path, int image_width, int image_height, int tile_size,
+                                          int x, int y, int width, int height)
+{
+    if (!tile_path || !GooeyImageViewer_ValidPattern(tile_path))
+    {
+        LOG_ERROR("Image viewer tile path needs exactly three %%d (level, column, row): %s",
+                  tile_path ? tile_path : "NULL");
+        return NULL;
+    }
+    if (image_width <= 0 || image_height <= 0 || tile_size <= 0)
+    {
+        LOG_ERROR("Invalid image viewer size: %dx%d image, %d pixel tiles", image_width, image_height, tile_size);
+        return NULL;
+    }
+
+    GooeyImageViewer *viewer = (GooeyImageViewer *)calloc(1, sizeof(GooeyImageViewer));
+    if (!viewer)
+    {
+        LOG_ERROR("Couldn't allocate memory for image viewer.");
+        return NULL;
+    }
+
+    viewer->tiles = (GooeyImageViewerTile *)calloc(IMAGE_VIEWER_MAX_TILES, sizeof(GooeyImageViewerTile));
+    viewer->tile_path = strdup(tile_path);
+    if (!viewer->tiles || !viewer->tile_path)
+    {
+        LOG_ERROR("Couldn't allocate memory for image viewer tiles.");
+        free(viewer->tiles);
+        free(viewer->tile_path);
+        free(viewer);
+        return NULL;
+    }
+
+    viewer->core.type = WIDGET_IMAGE_VIEWER;
+    viewer->core.x = x;
+    viewer->core.y = y;
+    viewer->core.width = width;
+    viewer->core.height = height;
+    viewer->core.is_visible = true;
+    viewer->core.disable_input = false;
+    viewer->core.sprite = active_backend->CreateSpriteForWidget(x, y, width, height);
+    viewer->image_width = image_width;
+    viewer->image_height = image_height;
+    viewer->tile_size = tile_size;
+
+    // Halve until the whole image fits in one tile.
+    const int largest = image_width > image_height ? image_width : image_height;
+    viewer->levels = 1;
+    while (viewer->levels < 31 && (((int64_t)largest + (1 << (viewer->levels - 1)) - 1) >> (viewer->levels - 1)) > tile_size)
+        viewer->levels++;
+
+    GooeyImageViewer_FitToView(viewer);
+    LOG_INFO("Created image viewer: %s (%dx%d, %d levels)", tile_path, image_width, image_height, viewer->levels);
+    return viewer;
+}
+
+void GooeyImageViewer_SetView(GooeyImageViewer *viewer, double center_x, double center_y, double zoom)
+{
+    if (!viewer)
+    {
+        LOG_ERROR("Image viewer widget is NULL");
+        return;
+    }
+
+    viewer->center_x = center_x;
+    viewer->center_y = center_y;
+    viewer->zoom = zoom;
+    GooeyImageViewer_ClampView_Internal(viewer);
+}
+
+void GooeyImageViewer_GetView(const GooeyImageViewer *viewer, double *center_x, double *center_y, double *zoom)
+{
+    if (!viewer)
+    {
+        LOG_ERROR("Image viewer widget is NULL");
+        return;
+    }
+
+    if (center_x)
+        *center_x = viewer->center_x;
+    if (center_y)
+        *center_y = viewer->center_y;
+    if (zoom)
+        *zoom = viewer->zoom;
+}
+
+void GooeyImageViewer_FitToView(GooeyImageViewer *viewer)
+{
+    if (!viewer)
+    {
+        LOG_ERROR("Image viewer widget is NULL");
+        return;
+    }
+
+    const double fit_x = (double)viewer->core.width / viewer->image_width;
+    const double fit_y = (double)viewer->core.height / viewer->image_height;
+    GooeyImageViewer_SetView(viewer, viewer->image_width / 2.0, viewer->image_height / 2.0, fit_x < fit_y ? fit_x : fit_y);
+}
+#endif
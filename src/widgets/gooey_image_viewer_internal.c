@@ -0,0 +1,472 @@
+#include "widgets/gooey_image_viewer_internal.h"
+#if (ENABLE_IMAGE_VIEWER)
+#include "backends/gooey_backend_internal.h"
+#include "logger/pico_logger_internal.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define IMAGE_VIEWER_MAX_ZOOM 16.0
+
+/** Zoom factor of one scroll step. */
+#define IMAGE_VIEWER_ZOOM_STEP 1.25
+
+#define IMAGE_VIEWER_PATH_MAX 4096
+
+/**
+ * An area of the image in full resolution pixels.
+ */
+typedef struct
+{
+    double x0, y0, x1, y1;
+} GooeyImageViewerRect;
+
+void GooeyImageViewer_ClampView_Internal(GooeyImageViewer *viewer)
+{
+    const double fit_x = (double)viewer->core.width / viewer->image_width;
+    const double fit_y = (double)viewer->core.height / viewer->image_height;
+    double min_zoom = (fit_x < fit_y ? fit_x : fit_y) / 2.0;
+    if (!(min_zoom > 0.0))
+        min_zoom = 1.0 / (double)(1 << (viewer->levels - 1)) / 2.0;
+    if (min_zoom > IMAGE_VIEWER_MAX_ZOOM)
+        min_zoom = IMAGE_VIEWER_MAX_ZOOM;
+
+    // Comparisons written so that NaN lands on a bound too.
+    if (!(viewer->zoom >= min_zoom))
+        viewer->zoom = min_zoom;
+    if (!(viewer->zoom <= IMAGE_VIEWER_MAX_ZOOM))
+        viewer->zoom = IMAGE_VIEWER_MAX_ZOOM;
+    if (!(viewer->center_x >= 0.0))
+        viewer->center_x = 0.0;
+    if (!(viewer->center_x <= viewer->image_width))
+        viewer->center_x = viewer->image_width;
+    if (!(viewer->center_y >= 0.0))
+        viewer->center_y = 0.0;
+    if (!(viewer->center_y <= viewer->image_height))
+        viewer->center_y = viewer->image_height;
+}
+
+static double GooeyImageViewer_ScreenX(const GooeyImageViewer *viewer, double x)
+{
+    return viewer->core.x + viewer->core.width / 2.0 + (x - viewer->center_x) * viewer->zoom;
+}
+
+static double GooeyImageViewer_ScreenY(const GooeyImageViewer *viewer, double y)
+{
+    return viewer->core.y + viewer->core.height / 2.0 + (y - viewer->center_y) * viewer->zoom;
+}
+
+/**
+ * Part of the image inside the widget.
+ */
+static GooeyImageViewerRect GooeyImageViewer_ViewRect(const GooeyImageViewer *viewer)
+{
+    const double half_width = viewer->core.width / 2.0 / viewer->zoom;
+    const double half_height = viewer->core.height / 2.0 / viewer->zoom;
+    GooeyImageViewerRect view = {viewer->center_x - half_width, viewer->center_y - half_height,
+                                 viewer->center_x + half_width, viewer->center_y + half_height};
+    view.x0 = fmax(view.x0, 0.0);
+    view.y0 = fmax(view.y0, 0.0);
+    view.x1 = fmin(view.x1, viewer->image_width);
+    view.y1 = fmin(view.y1, viewer->image_height);
+    return view;
+}
+
+/**
+ * Coarsest level with at least one texel per screen pixel.
+ */
+static int GooeyImageViewer_Level(const GooeyImageViewer *viewer)
+{
+    const int level = (int)floor(log2(1.0 / viewer->zoom));
+    return level < 0 ? 0 : level >= viewer->levels ? viewer->levels - 1 : level;
+}
+
+static int GooeyImageViewer_LevelSize(int size, int level)
+{
+    return (int)(((int64_t)size + (1 << level) - 1) >> level);
+}
+
+/**
+ * Area a tile covers. Edge tiles hold whole level pixels, they may reach a little past the image.
+ */
+static GooeyImageViewerRect GooeyImageViewer_TileRect(const GooeyImageViewer *viewer, int level, int column, int row)
+{
+    const double scale = (double)(1 << level);
+    const int level_width = GooeyImageViewer_LevelSize(viewer->image_width, level);
+    const int level_height = GooeyImageViewer_LevelSize(viewer->image_height, level);
+    const int x1 = (column + 1) * viewer->tile_size;
+    const int y1 = (row + 1) * viewer->tile_size;
+    return (GooeyImageViewerRect){column * viewer->tile_size * scale, row * viewer->tile_size * scale,
+                                  (x1 < level_width ? x1 : level_width) * scale,
+                                  (y1 < level_height ? y1 : level_height) * scale};
+}
+
+static GooeyImageViewerTile *GooeyImageViewer_FindTile(GooeyImageViewer *viewer, int level, int column, int row)
+{
+    for (size_t i = 0; i < IMAGE_VIEWER_MAX_TILES; ++i)
+    {
+        GooeyImageViewerTile *tile = &viewer->tiles[i];
+        if (tile->used && tile->level == level && tile->column == column && tile->row == row)
+            return tile;
+    }
+    return NULL;
+}
+
+static void GooeyImageViewer_DropTile(GooeyImageViewer *viewer, GooeyImageViewerTile *tile)
+{
+    if (tile->load_request != 0)
+    {
+        if (active_backend->CancelImageLoad)
+            active_backend->CancelImageLoad(tile->load_request);
+        viewer->pending--;
+    }
+    if (tile->texture_id != 0)
+        active_backend->UnloadImage(tile->texture_id);
+    memset(tile, 0, sizeof(*tile));
+}
+
+/**
+ * An empty slot, made by dropping the least recently used tile not needed this frame.
+ */
+static GooeyImageViewerTile *GooeyImageViewer_FreeSlot(GooeyImageViewer *viewer)
+{
+    GooeyImageViewerTile *oldest = NULL;
+    for (size_t i = 0; i < IMAGE_VIEWER_MAX_TILES; ++i)
+    {
+        GooeyImageViewerTile *tile = &viewer->tiles[i];
+        if (!tile->used)
+            return tile;
+        // The single tile of the coarsest level backs every other one, it stays.
+        if (tile->last_used == viewer->frame || tile->level == viewer->levels - 1)
+            continue;
+        if (!oldest || tile->last_used < oldest->last_used)
+            oldest = tile;
+    }
+
+    if (oldest)
+        GooeyImageViewer_DropTile(viewer, oldest);
+    return oldest;
+}
+
+#if (ENABLE_ASYNC_IMAGE_LOADING)
+static void GooeyImageViewer_TileDecoded(unsigned int texture_id, void *user_data)
+{
+    GooeyImageViewerTile *tile = (GooeyImageViewerTile *)user_data;
+    GooeyImageViewer *viewer = tile->viewer;
+    tile->load_request = 0;
+    tile->texture_id = texture_id;
+    tile->loaded = true;
+    viewer->pending--;
+    active_backend->RequestRedraw(viewer->window);
+}
+#endif
+
+/**
+ * Starts loading a tile, asynchronously when the backend can.
+ */
+static void GooeyImageViewer_RequestTile(GooeyWindow *win, GooeyImageViewer *viewer, int level, int column, int row)
+{
+    GooeyImageViewerTile *tile = GooeyImageViewer_FreeSlot(viewer);
+    if (!tile)
+        return;
+
+    char path[IMAGE_VIEWER_PATH_MAX];
+    snprintf(path, sizeof(path), viewer->tile_path, level, column, row);
+    *tile = (GooeyImageViewerTile){
+        .viewer = viewer,
+        .level = level,
+        .column = column,
+        .row = row,
+        .used = true,
+        .last_used = viewer->frame};
+
+    // Tiles are small and quick to decode, and there are too many of them for the disk cache.
+#if (ENABLE_ASYNC_IMAGE_LOADING)
+    if (active_backend->LoadImageTileAsync || active_backend->LoadImageAsync)
+    {
+        tile->load_request =
+            active_backend->LoadImageTileAsync
+                ? active_backend->LoadImageTileAsync(path, win->creation_id, GooeyImageViewer_TileDecoded, tile)
+                : active_backend->LoadImageAsync(path, win->creation_id, 0, 0, GooeyImageViewer_TileDecoded, tile);
+        if (tile->load_request != 0)
+        {
+            viewer->pending++;
+            return;
+        }
+    }
+#endif
+    tile->texture_id = active_backend->LoadImageTile ? active_backend->LoadImageTile(path)
+                                                     : active_backend->LoadGooeyImage(path);
+    tile->loaded = true;
+}
+
+/**
+ * Draws the @p part of a texture covering @p area, both in full resolution pixels.
+ */
+static void GooeyImageViewer_DrawPart(GooeyWindow *win, const GooeyImageViewer *viewer, unsigned int texture_id,
+                                      const GooeyImageViewerRect *area, const GooeyImageViewerRect *part)
+{
+    // Edges are rounded on their own so that neighbouring tiles meet without gaps.
+    const int x0 = (int)lround(GooeyImageViewer_ScreenX(viewer, part->x0));
+    const int y0 = (int)lround(GooeyImageViewer_ScreenY(viewer, part->y0));
+    const int x1 = (int)lround(GooeyImageViewer_ScreenX(viewer, part->x1));
+    const int y1 = (int)lround(GooeyImageViewer_ScreenY(viewer, part->y1));
+    if (x1 <= x0 || y1 <= y0)
+        return;
+
+    const double width = area->x1 - area->x0;
+    const double height = area->y1 - area->y0;
+    active_backend->DrawImageRegion(texture_id, (float)((part->x0 - area->x0) / width),
+                                    (float)((part->y0 - area->y0) / height), (float)((part->x1 - area->x0) / width),
+                                    (float)((part->y1 - area->y0) / height), x0, y0, x1 - x0, y1 - y0,
+                                    win->creation_id);
+}
+
+/**
+ * Draws a tile, or the part of the nearest coarser resident tile it would cover.
+ *
+ * @return false when nothing could be drawn in its place.
+ */
+static bool GooeyImageViewer_DrawTile(GooeyWindow *win, GooeyImageViewer *viewer, const GooeyImageViewerTile *tile,
+                                      int level, int column, int row, const GooeyImageViewerRect *view)
+{
+    const GooeyImageViewerRect area = GooeyImageViewer_TileRect(viewer, level, column, row);
+
+    if (!active_backend->DrawImageRegion)
+    {
+        // Whole tiles only, those on the border of the view spill out of the widget.
+        if (!tile || tile->texture_id == 0)
+            return false;
+        const int x = (int)lround(GooeyImageViewer_ScreenX(viewer, area.x0));
+        const int y = (int)lround(GooeyImageViewer_ScreenY(viewer, area.y0));
+        active_backend->DrawImage(tile->texture_id, x, y, (int)lround(GooeyImageViewer_ScreenX(viewer, area.x1)) - x,
+                                  (int)lround(GooeyImageViewer_ScreenY(viewer, area.y1)) - y, win->creation_id);
+        return true;
+    }
+
+    const GooeyImageViewerRect part = {fmax(area.x0, view->x0), fmax(area.y0, view->y0),
+                                       fmin(area.x1, view->x1), fmin(area.y1, view->y1)};
+    if (tile && tile->texture_id != 0)
+    {
+        GooeyImageViewer_DrawPart(win, viewer, tile->texture_id, &area, &part);
+        return true;
+    }
+
+    for (int coarser = level + 1; coarser < viewer->levels; ++coarser)
+    {
+        const int shift = coarser - level;
+        GooeyImageViewerTile *parent = GooeyImageViewer_FindTile(viewer, coarser, column >> shift, row >> shift);
+        if (!parent || parent->texture_id == 0)
+            continue;
+
+        parent->last_used = viewer->frame;
+        const GooeyImageViewerRect parent_area = GooeyImageViewer_TileRect(viewer, coarser, column >> shift, row >> shift);
+        GooeyImageViewer_DrawPart(win, viewer, parent->texture_id, &parent_area, &part);
+        return true;
+    }
+    return false;
+}
+
+typedef struct
+{
+    int column, row;
+    double distance;
+} GooeyImageViewerWanted;
+
+/**
+ * Keeps the @p capacity missing tiles closest to the center of the view, nearest first.
+ */
+static void GooeyImageViewer_Want(GooeyImageViewerWanted *wanted, int *count, int capacity, int column, int row,
+                                  double distance)
+{
+    int i;
+    if (*count == capacity)
+    {
+        if (capacity == 0 || distance >= wanted[capacity - 1].distance)
+            return;
+        i = capacity - 1;
+    }
+    else
+    {
+        i = (*count)++;
+    }
+    for (; i > 0 && wanted[i - 1].distance > distance; --i)
+        wanted[i] = wanted[i - 1];
+    wanted[i] = (GooeyImageViewerWanted){column, row, distance};
+}
+
+static void GooeyImageViewer_DrawViewer(GooeyWindow *win, GooeyImageViewer *viewer)
+{
+    viewer->frame++;
+    viewer->window = win;
+
+    active_backend->FillRectangle(viewer->core.x, viewer->core.y, viewer->core.width, viewer->core.height,
+                                  win->active_theme->widget_base, win->creation_id, false, 0.0f, viewer->core.sprite);
+
+    // Whatever the zoom, the whole image can be drawn from this one tile.
+    GooeyImageViewerTile *root = GooeyImageViewer_FindTile(viewer, viewer->levels - 1, 0, 0);
+    if (root)
+        root->last_used = viewer->frame;
+    else
+        GooeyImageViewer_RequestTile(win, viewer, viewer->levels - 1, 0, 0);
+
+    const GooeyImageViewerRect view = GooeyImageViewer_ViewRect(viewer);
+    if (view.x1 <= view.x0 || view.y1 <= view.y0)
+        return;
+
+    const int level = GooeyImageViewer_Level(viewer);
+    const double span = (double)viewer->tile_size * (1 << level);
+    const int columns = (GooeyImageViewer_LevelSize(viewer->image_width, level) + viewer->tile_size - 1) / viewer->tile_size;
+    const int rows = (GooeyImageViewer_LevelSize(viewer->image_height, level) + viewer->tile_size - 1) / viewer->tile_size;
+    const int first_column = (int)(view.x0 / span);
+    const int first_row = (int)(view.y0 / span);
+    const int last_column = (int)fmin(ceil(view.x1 / span) - 1, columns - 1);
+    const int last_row = (int)fmin(ceil(view.y1 / span) - 1, rows - 1);
+
+    GooeyImageViewerWanted wanted[IMAGE_VIEWER_MAX_PENDING];
+    const int capacity = viewer->pending < IMAGE_VIEWER_MAX_PENDING ? (int)(IMAGE_VIEWER_MAX_PENDING - viewer->pending) : 0;
+    int wanted_count = 0;
+
+    for (int row = first_row; row <= last_row; ++row)
+    {
+        for (int column = first_column; column <= last_column; ++column)
+        {
+            GooeyImageViewerTile *tile = GooeyImageViewer_FindTile(viewer, level, column, row);
+            if (tile)
+                tile->last_used = viewer->frame;
+            GooeyImageViewer_DrawTile(win, viewer, tile, level, column, row, &view);
+
+            if (!tile)
+            {
+                const double dx = (column + 0.5) * span - viewer->center_x;
+                const double dy = (row + 0.5) * span - viewer->center_y;
+                GooeyImageViewer_Want(wanted, &wanted_count, capacity, column, row, dx * dx + dy * dy);
+            }
+        }
+    }
+
+    for (int i = 0; i < wanted_count; ++i)
+        GooeyImageViewer_RequestTile(win, viewer, level, wanted[i].column, wanted[i].row);
+
+    // Tiles that left the view before they were decoded are not worth the wait anymore.
+    for (size_t i = 0; i < IMAGE_VIEWER_MAX_TILES; ++i)
+    {
+        GooeyImageViewerTile *tile = &viewer->tiles[i];
+        if (tile->used && tile->load_request != 0 && tile->last_used != viewer->frame)
+            GooeyImageViewer_DropTile(viewer, tile);
+    }
+}
+
+void GooeyImageViewer_Draw(GooeyWindow *win)
+{
+    for (size_t i = 0; i < win->image_viewer_count; ++i)
+    {
+        GooeyImageViewer *viewer = win->image_viewers[i];
+        if (!viewer || !viewer->core.is_visible)
+            continue;
+        GooeyImageViewer_DrawViewer(win, viewer);
+    }
+}
+
+static bool GooeyImageViewer_Contains(const GooeyImageViewer *viewer, int x, int y)
+{
+    return x >= viewer->core.x && x < viewer->core.x + viewer->core.width && y >= viewer->core.y &&
+           y < viewer->core.y + viewer->core.height;
+}
+
+bool GooeyImageViewer_HandleDrag(GooeyWindow *win, void *drag_event)
+{
+    GooeyEvent *event = (GooeyEvent *)drag_event;
+    const int mouse_x = event->mouse_move.x;
+    const int mouse_y = event->mouse_move.y;
+    bool moved = false;
+
+    for (size_t i = 0; i < win->image_viewer_count; ++i)
+    {
+        GooeyImageViewer *viewer = win->image_viewers[i];
+        if (!viewer || !viewer->core.is_visible || viewer->core.disable_input)
+        {
+            if (viewer)
+                viewer->dragging = false;
+            continue;
+        }
+
+        // The press stays the current event until a redraw, only the first one grabs the image.
+        if (event->type == GOOEY_EVENT_CLICK_PRESS && !viewer->dragging &&
+            GooeyImageViewer_Contains(viewer, mouse_x, mouse_y))
+        {
+            viewer->dragging = true;
+            viewer->drag_x = mouse_x;
+            viewer->drag_y = mouse_y;
+            continue;
+        }
+        if (!viewer->dragging)
+            continue;
+
+        if (mouse_x != viewer->drag_x || mouse_y != viewer->drag_y)
+        {
+            viewer->center_x -= (mouse_x - viewer->drag_x) / viewer->zoom;
+            viewer->center_y -= (mouse_y - viewer->drag_y) / viewer->zoom;
+            viewer->drag_x = mouse_x;
+            viewer->drag_y = mouse_y;
+            GooeyImageViewer_ClampView_Internal(viewer);
+            moved = true;
+        }
+        if (event->type == GOOEY_EVENT_CLICK_RELEASE)
+            viewer->dragging = false;
+    }
+
+    return moved;
+}
+
+bool GooeyImageViewer_HandleScroll(GooeyWindow *win, void *scroll_event)
+{
+    GooeyEvent *event = (GooeyEvent *)scroll_event;
+    if (event->type != GOOEY_EVENT_MOUSE_SCROLL || event->mouse_scroll.y == 0)
+        return false;
+
+    const int mouse_x = event->mouse_move.x;
+    const int mouse_y = event->mouse_move.y;
+    for (size_t i = 0; i < win->image_viewer_count; ++i)
+    {
+        GooeyImageViewer *viewer = win->image_viewers[i];
+        if (!viewer || !viewer->core.is_visible || viewer->core.disable_input ||
+            !GooeyImageViewer_Contains(viewer, mouse_x, mouse_y))
+            continue;
+
+        // The image point under the pointer stays under it.
+        const double offset_x = mouse_x - (viewer->core.x + viewer->core.width / 2.0);
+        const double offset_y = mouse_y - (viewer->core.y + viewer->core.height / 2.0);
+        const double anchor_x = viewer->center_x + offset_x / viewer->zoom;
+        const double anchor_y = viewer->center_y + offset_y / viewer->zoom;
+
+        viewer->zoom *= event->mouse_scroll.y > 0 ? 1.0 / IMAGE_VIEWER_ZOOM_STEP : IMAGE_VIEWER_ZOOM_STEP;
+        GooeyImageViewer_ClampView_Internal(viewer);
+        viewer->center_x = anchor_x - offset_x / viewer->zoom;
+        viewer->center_y = anchor_y - offset_y / viewer->zoom;
+        GooeyImageViewer_ClampView_Internal(viewer);
+        return true;
+    }
+
+    return false;
+}
+
+void GooeyImageViewer_Release_Internal(GooeyImageViewer *viewer)
+{
+    if (!viewer)
+        return;
+
+    if (viewer->tiles)
+    {
+        for (size_t i = 0; i < IMAGE_VIEWER_MAX_TILES; ++i)
+        {
+            if (viewer->tiles[i].used)
+                GooeyImageViewer_DropTile(viewer, &viewer->tiles[i]);
+        }
+        free(viewer->tiles);
+        viewer->tiles = NULL;
+    }
+    free(viewer->tile_path);
+    viewer->tile_path = NULL;
+}
+#endif
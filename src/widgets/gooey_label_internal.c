@@ -1,6 +1,7 @@
 #include "widgets/gooey_label_internal.h"
 #if(ENABLE_LABEL)
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 #include "logger/pico_logger_internal.h"
 
 void GooeyLabel_Draw(GooeyWindow *win)
@@ -12,7 +13,10 @@ void GooeyLabel_Draw(GooeyWindow *win)
         
         if (!widget->is_visible)
             continue;
+        if (GooeyWidget_Replay_Internal(win, label, sizeof(*label)))
+            continue;
 
+        GooeyWidget_BeginRecord_Internal(win, label);
         active_backend->DrawGooeyText(
             widget->x, 
             widget->y, 
@@ -21,6 +25,7 @@ void GooeyLabel_Draw(GooeyWindow *win)
             label->font_size, 
             win->creation_id, widget->sprite
         );
+        GooeyWidget_EndRecord_Internal(win, label, sizeof(*label));
     }
 }
 #endif
\ No newline at end of file
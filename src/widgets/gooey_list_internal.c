@@ -60,6 +60,10 @@ void GooeyList_Draw(GooeyWindow *win)
 
         for (size_t j = 0; j < list->item_count; ++j)
         {
+            // Items are laid out top to bottom, nothing past the bottom edge is drawn.
+            if (current_y_offset >= list->core.y + list->core.height)
+                break;
+
             GooeyListItem item = list->items[j];
 
             int title_y = current_y_offset + active_backend->GetTextHeight(item.title, strlen(item.title));
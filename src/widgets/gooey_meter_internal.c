@@ -2,6 +2,7 @@
 #if(ENABLE_METER)
 #include "common/gooey_common.h"
 #include "backends/gooey_backend_internal.h"
+#include <math.h>
 
 #define MIN_SIZE 80
 #define ASPECT_RATIO 1.0f
@@ -28,6 +29,14 @@ void GooeyMeter_RecalculateLayout(GooeyMeter *meter)
     }
 }
 
+/**
+ * Height to pass FillArc for the vertical radius DrawArc gives @p height: FillArc scales it by height / width.
+ */
+static int GooeyMeter_FillArcHeight(int width, int height)
+{
+    return (int)lroundf(sqrtf((float)width * (float)height));
+}
+
 void GooeyMeter_Draw(GooeyWindow *win)
 {
     if (!win)
@@ -68,16 +77,6 @@ void GooeyMeter_Draw(GooeyWindow *win)
         const int label_text_x = meter->core.x + (card_width - label_text_width) / 2;
         const int label_text_y = meter->core.y + padding + meter->core.height / 2;
 
-        active_backend->SetForeground(win->active_theme->base);
-        active_backend->FillArc(
-            arc_center_x,
-            arc_center_y,
-            meter->core.width,
-            meter->core.height,
-            0,
-            180,
-            win->creation_id,meter->core.sprite);
-
         unsigned long color = win->active_theme->primary;
         if(meter->value < 50)
         {
@@ -89,25 +88,51 @@ void GooeyMeter_Draw(GooeyWindow *win)
         } else {
             color = win->active_theme->primary;
         }
-        active_backend->SetForeground(color);
-        active_backend->FillArc(
-            arc_center_x,
-            arc_center_y,
-            meter->core.width,
-            meter->core.height,
-            0,
-            180 * ((float) meter->value/100),
-            win->creation_id,meter->core.sprite);
-
-        active_backend->SetForeground(win->active_theme->widget_base);
-        active_backend->FillArc(
-            arc_center_x,
-            arc_center_y,
-            meter->core.width * INNER_CIRCLE_SCALE,
-            meter->core.height * INNER_CIRCLE_SCALE,
-            0,
-            180,
-            win->creation_id, meter->core.sprite);
+
+        if (active_backend->DrawArc)
+        {
+            // A ring straight away, nothing to cover with the card color.
+            const float thickness = meter->core.width * 0.5f * (1.0f - INNER_CIRCLE_SCALE);
+            active_backend->DrawArc(arc_center_x, arc_center_y, meter->core.width, meter->core.height, 0.0f, 180.0f,
+                                    thickness, win->active_theme->base, win->creation_id);
+            active_backend->DrawArc(arc_center_x, arc_center_y, meter->core.width, meter->core.height, 0.0f,
+                                    180.0f * ((float)meter->value / 100), thickness, color, win->creation_id);
+        }
+        else
+        {
+            const int arc_height = GooeyMeter_FillArcHeight(meter->core.width, meter->core.height);
+            const int inner_height = GooeyMeter_FillArcHeight(meter->core.width * INNER_CIRCLE_SCALE,
+                                                              meter->core.height * INNER_CIRCLE_SCALE);
+            active_backend->SetForeground(win->active_theme->base);
+            active_backend->FillArc(
+                arc_center_x,
+                arc_center_y,
+                meter->core.width,
+                arc_height,
+                0,
+                180,
+                win->creation_id,meter->core.sprite);
+
+            active_backend->SetForeground(color);
+            active_backend->FillArc(
+                arc_center_x,
+                arc_center_y,
+                meter->core.width,
+                arc_height,
+                0,
+                180 * ((float) meter->value/100),
+                win->creation_id,meter->core.sprite);
+
+            active_backend->SetForeground(win->active_theme->widget_base);
+            active_backend->FillArc(
+                arc_center_x,
+                arc_center_y,
+                meter->core.width * INNER_CIRCLE_SCALE,
+                inner_height,
+                0,
+                180,
+                win->creation_id, meter->core.sprite);
+        }
 
         active_backend->DrawGooeyText(
             label_text_x,
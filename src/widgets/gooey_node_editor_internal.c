@@ -2,6 +2,7 @@
 #include <string.h>
 #if (ENABLE_NODE_EDITOR)
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 #include "theme/gooey_theme.h"
 #include "logger/pico_logger_internal.h"
 #include <stdlib.h>
@@ -14,6 +15,7 @@
 #define NODE_CLICK_CONFIDENCE 10
 #define CONNECTION_CURVE_STRENGTH 50
 #define BEZIER_SEGMENTS 20
+#define CONNECTION_WIDTH 2.0f
 #define CONNECTION_HIT_TOLERANCE 8
 
 static int global_mouse_x = 0;
@@ -128,6 +130,16 @@ static void DeselectAllConnections(GooeyNodeEditor* editor) {
 }
 
 static void DrawBezierCurve(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, unsigned long color, int creation_id) {
+    if (active_backend->DrawPolyline) {
+        float points[(BEZIER_SEGMENTS + 1) * 2];
+        for (int i = 0; i <= BEZIER_SEGMENTS; i++) {
+            float t = (float)i / BEZIER_SEGMENTS;
+            points[i * 2] = bezier_interp(t, x0, x1, x2, x3);
+            points[i * 2 + 1] = bezier_interp(t, y0, y1, y2, y3);
+        }
+        active_backend->DrawPolyline(points, BEZIER_SEGMENTS + 1, CONNECTION_WIDTH, color, GOOEY_LINE_JOIN_ROUND, creation_id);
+        return;
+    }
     int prev_x = x0;
     int prev_y = y0;
     for (int i = 1; i <= BEZIER_SEGMENTS; i++) {
@@ -517,12 +529,22 @@ void GooeyNodeEditor_Draw(GooeyWindow* win) {
     for (size_t i = 0; i < win->node_editor_count; i++) {
         GooeyNodeEditor* editor = win->node_editors[i];
         if (!editor || !editor->core.is_visible) continue;
-        active_backend->FillRectangle(
-            editor->core.x, editor->core.y,
-            editor->core.width, editor->core.height,
-            win->active_theme->base, win->creation_id, false, 0.0f, NULL
-        );
-        DrawGrid(editor, win);
+        // Background and grid only change with the editor's geometry, they are cached when it has a layer.
+        const int grid_state[] = {
+            editor->core.x, editor->core.y, editor->core.width, editor->core.height,
+            editor->grid_size, editor->show_grid
+        };
+        if (GooeyWidget_BeginLayer_Internal(win, editor, editor->core.x, editor->core.y,
+                                            editor->core.width, editor->core.height,
+                                            &grid_state, sizeof(grid_state))) {
+            active_backend->FillRectangle(
+                editor->core.x, editor->core.y,
+                editor->core.width, editor->core.height,
+                win->active_theme->base, win->creation_id, false, 0.0f, NULL
+            );
+            DrawGrid(editor, win);
+            GooeyWidget_EndLayer_Internal(win, editor);
+        }
         DrawConnections(editor, win);
         if (editor->dragging_socket) {
             DrawDraggingConnection(editor, win);
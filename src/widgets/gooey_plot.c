@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 #include "logger/pico_logger_internal.h"
 
 typedef struct
@@ -252,6 +253,8 @@ void GooeyPlot_Update(GooeyPlot *plot, GooeyPlotData *new_data)
     }
 
     plot->data = new_data;
+    // The title may have changed behind the same pointer.
+    GooeyWidget_Invalidate_Internal(plot);
 
     if (plot->data->data_count > 0)
     {
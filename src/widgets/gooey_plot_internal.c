@@ -1,6 +1,7 @@
 #include "widgets/gooey_plot_internal.h"
 #if (ENABLE_PLOT)
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 #include "logger/pico_logger_internal.h"
 
 #include "stdint.h"
@@ -13,6 +14,7 @@
 #define MAX_TICK_COUNT 20
 #define LABEL_BUFFER_SIZE 32
 #define MAX_POINTS_FOR_DETAILED_DRAW 1000
+#define PLOT_LINE_WIDTH 2.0f
 
 typedef struct
 {
@@ -28,7 +30,44 @@ typedef struct
     float last_height;
 } PlotCache;
 
-static PlotCache plot_cache = {0};
+// Per thread, plots of different windows may be drawn at the same time.
+static _Thread_local PlotCache plot_cache = {0};
+
+/**
+ * Everything the background, axes, ticks and grid are drawn from, the key of the plot's layer.
+ */
+typedef struct
+{
+    int x, y, width, height;
+    float min_x_value, min_y_value;
+    float x_step, y_step;
+    float x_value_spacing, y_value_spacing;
+    uint32_t x_tick_count, y_tick_count;
+    GOOEY_PLOT_TYPE plot_type;
+    const char *title;
+    const char **bar_labels;
+} PlotLayerState;
+
+static void get_plot_layer_state(GooeyPlot *plot, PlotLayerState *state)
+{
+    // Zeroed first, the padding is hashed too.
+    memset(state, 0, sizeof(*state));
+    state->x = plot->core.x;
+    state->y = plot->core.y;
+    state->width = plot->core.width;
+    state->height = plot->core.height;
+    state->min_x_value = plot->data->min_x_value;
+    state->min_y_value = plot->data->min_y_value;
+    state->x_step = plot->data->x_step;
+    state->y_step = plot->data->y_step;
+    state->x_value_spacing = plot_cache.x_value_spacing;
+    state->y_value_spacing = plot_cache.y_value_spacing;
+    state->x_tick_count = plot_cache.x_tick_count;
+    state->y_tick_count = plot_cache.y_tick_count;
+    state->plot_type = plot->data->plot_type;
+    state->title = plot->data->title;
+    state->bar_labels = plot->data->bar_labels;
+}
 
 static void draw_plot_background(GooeyPlot *plot, GooeyWindow *win)
 {
@@ -191,14 +230,11 @@ static void draw_x_axis_ticks(GooeyPlot *plot, GooeyWindow *win, float min_value
     }
 }
 
-static void draw_y_axis_ticks(GooeyPlot *plot, GooeyWindow *win, float min_value, float *plot_y_grid_coords)
+static void draw_y_axis_ticks(GooeyPlot *plot, GooeyWindow *win, float *plot_y_grid_coords)
 {
     if (!plot || !win || !plot_y_grid_coords)
         return;
 
-    float current_value = min_value;
-    char value_str[LABEL_BUFFER_SIZE];
-
     for (uint32_t idx = 0; idx < plot_cache.y_tick_count; ++idx)
     {
         float y_pos = plot->core.y + plot->core.height - PLOT_MARGIN - (plot_cache.y_value_spacing * idx);
@@ -210,6 +246,23 @@ static void draw_y_axis_ticks(GooeyPlot *plot, GooeyWindow *win, float min_value
             win->creation_id, plot->core.sprite);
 
         plot_y_grid_coords[idx] = y_pos;
+    }
+}
+
+/**
+ * Kept apart from the ticks: wide labels reach left of the plot, outside of its layer.
+ */
+static void draw_y_axis_labels(GooeyPlot *plot, GooeyWindow *win, float min_value)
+{
+    if (!plot || !win)
+        return;
+
+    float current_value = min_value;
+    char value_str[LABEL_BUFFER_SIZE];
+
+    for (uint32_t idx = 0; idx < plot_cache.y_tick_count; ++idx)
+    {
+        float y_pos = plot->core.y + plot->core.height - PLOT_MARGIN - (plot_cache.y_value_spacing * idx);
 
         if (plot_cache.y_tick_count <= 10 || idx % 2 == 0)
         {
@@ -305,13 +358,29 @@ static void draw_line_plot_fast(GooeyPlot *plot, GooeyWindow *win, float *plot_x
     if (!plot || !win || !plot_x_coords || !plot_y_coords)
         return;
 
-    if (plot->data->data_count > MAX_POINTS_FOR_DETAILED_DRAW)
-    {
-
-        size_t step = plot->data->data_count / MAX_POINTS_FOR_DETAILED_DRAW;
-        if (step < 1)
-            step = 1;
+    size_t step = plot->data->data_count / MAX_POINTS_FOR_DETAILED_DRAW;
+    if (step < 1)
+        step = 1;
 
+    // The whole line in one draw, antialiased, when the backend can.
+    float *points = active_backend->DrawPolyline
+                        ? malloc((plot->data->data_count / step + 1) * 2 * sizeof(float))
+                        : NULL;
+    if (points)
+    {
+        size_t count = 0;
+        for (size_t j = 0; j < plot->data->data_count; j += step)
+        {
+            points[count * 2] = plot_x_coords[j];
+            points[count * 2 + 1] = plot_y_coords[j];
+            count++;
+        }
+        active_backend->DrawPolyline(points, count, PLOT_LINE_WIDTH, win->active_theme->primary,
+                                     GOOEY_LINE_JOIN_ROUND, win->creation_id);
+        free(points);
+    }
+    else if (plot->data->data_count > MAX_POINTS_FOR_DETAILED_DRAW)
+    {
         for (size_t j = 0; j < plot->data->data_count - step; j += step)
         {
             size_t next_j = j + step;
@@ -336,18 +405,18 @@ static void draw_line_plot_fast(GooeyPlot *plot, GooeyWindow *win, float *plot_x
                 win->active_theme->primary,
                 win->creation_id, plot->core.sprite);
         }
+    }
 
-        if (plot->data->data_count <= 100)
+    if (plot->data->data_count <= 100)
+    {
+        for (size_t j = 0; j < plot->data->data_count; ++j)
         {
-            for (size_t j = 0; j < plot->data->data_count; ++j)
-            {
-                active_backend->FillRectangle(
-                    (int)(plot_x_coords[j] - POINT_SIZE / 2),
-                    (int)(plot_y_coords[j] - POINT_SIZE / 2),
-                    POINT_SIZE, POINT_SIZE,
-                    win->active_theme->primary,
-                    win->creation_id, false, 0.0f, plot->core.sprite);
-            }
+            active_backend->FillRectangle(
+                (int)(plot_x_coords[j] - POINT_SIZE / 2),
+                (int)(plot_y_coords[j] - POINT_SIZE / 2),
+                POINT_SIZE, POINT_SIZE,
+                win->active_theme->primary,
+                win->creation_id, false, 0.0f, plot->core.sprite);
         }
     }
 }
@@ -522,13 +591,22 @@ void GooeyPlot_Draw(GooeyWindow *win)
             continue;
         }
 
-        draw_plot_background(plot, win);
-        draw_axes(plot, win);
-        draw_plot_title(plot, win);
-
-        draw_x_axis_ticks(plot, win, plot->data->min_x_value, plot_x_grid_coords);
-        draw_y_axis_ticks(plot, win, plot->data->min_y_value, plot_y_grid_coords);
-        draw_grid_lines(plot, win, plot_x_grid_coords, plot_y_grid_coords);
+        // Only the data changes from frame to frame, the rest comes from the plot's layer when it has one.
+        PlotLayerState layer_state;
+        get_plot_layer_state(plot, &layer_state);
+        if (GooeyWidget_BeginLayer_Internal(win, plot, plot->core.x, plot->core.y, plot->core.width,
+                                            plot->core.height, &layer_state, sizeof(layer_state)))
+        {
+            draw_plot_background(plot, win);
+            draw_axes(plot, win);
+            draw_plot_title(plot, win);
+
+            draw_x_axis_ticks(plot, win, plot->data->min_x_value, plot_x_grid_coords);
+            draw_y_axis_ticks(plot, win, plot_y_grid_coords);
+            draw_grid_lines(plot, win, plot_x_grid_coords, plot_y_grid_coords);
+            GooeyWidget_EndLayer_Internal(win, plot);
+        }
+        draw_y_axis_labels(plot, win, plot->data->min_y_value);
         draw_data_points_optimized(plot, win, plot_x_coords, plot_y_coords);
 
         free(plot_x_coords);
@@ -18,6 +18,7 @@
 #include "widgets/gooey_progressbar_internal.h"
 #if(ENABLE_PROGRESSBAR)
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 #include "logger/pico_logger_internal.h"
 #include <string.h>
 
@@ -115,9 +116,14 @@ void GooeyProgressBar_Draw(GooeyWindow *win)
             continue;
         }
 
+        if (GooeyWidget_Replay_Internal(win, progressbar, sizeof(*progressbar)))
+            continue;
+
+        GooeyWidget_BeginRecord_Internal(win, progressbar);
         DrawProgressBarBackground(progressbar, win);
         DrawProgressBarFill(progressbar, win);
         DrawProgressPercentage(progressbar, win);
+        GooeyWidget_EndRecord_Internal(win, progressbar, sizeof(*progressbar));
     }
 }
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "widgets/gooey_slider_internal.h"
 #if (ENABLE_SLIDER)
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 
 #define GOOEY_SLIDER_DEFAULT_RADIUS 2.0f
 void GooeySlider_Draw(GooeyWindow *win)
@@ -11,6 +12,15 @@ void GooeySlider_Draw(GooeyWindow *win)
         GooeySlider *slider = win->sliders[i];
         if (!slider || !slider->core.is_visible)
             continue;
+        if (GooeyWidget_Replay_Internal(win, slider, sizeof(*slider)))
+        {
+            // Drawn as recorded, which is all a redraw of its sprite asks for.
+            if (slider->core.sprite && slider->core.sprite->needs_redraw)
+                active_backend->ResetRedrawSprite(slider->core.sprite);
+            continue;
+        }
+
+        GooeyWidget_BeginRecord_Internal(win, slider);
         active_backend->FillRectangle(slider->core.x,
                                       slider->core.y, slider->core.width, slider->core.height, win->active_theme->widget_base, win->creation_id, false, 0.0f, slider->core.sprite);
 
@@ -48,6 +58,7 @@ void GooeySlider_Draw(GooeyWindow *win)
                                          slider->core.y + 25, value, win->active_theme->neutral, 18.0f, win->creation_id,  slider->core.sprite);
         }
         active_backend->SetForeground(win->active_theme->neutral);
+        GooeyWidget_EndRecord_Internal(win, slider, sizeof(*slider));
         if (slider->core.sprite && slider->core.sprite->needs_redraw)
             active_backend->ResetRedrawSprite(slider->core.sprite);
     }
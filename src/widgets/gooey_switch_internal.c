@@ -1,6 +1,7 @@
 #include "widgets/gooey_switch_internal.h"
 #if (ENABLE_SWITCH)
 #include "backends/gooey_backend_internal.h"
+#include "core/gooey_widget_internal.h"
 #include "core/gooey_timers_internal.h"
 #include "animations/gooey_animations_internal.h"
 
@@ -134,7 +135,10 @@ void GooeySwitch_Draw(GooeyWindow *win)
         GooeySwitch *gswitch = win->switches[i];
         if (!gswitch->core.is_visible)
             continue;
+        if (GooeyWidget_Replay_Internal(win, gswitch, sizeof(*gswitch)))
+            continue;
 
+        GooeyWidget_BeginRecord_Internal(win, gswitch);
         const int track_x = gswitch->core.x;
         const int track_y = gswitch->core.y;
         const int track_width = gswitch->core.width;
@@ -260,6 +264,7 @@ void GooeySwitch_Draw(GooeyWindow *win)
                     gswitch->core.sprite);
             }
         }
+        GooeyWidget_EndRecord_Internal(win, gswitch, sizeof(*gswitch));
     }
 }
 
@@ -32,12 +32,25 @@ void GooeyTextbox_Draw(GooeyWindow *win)
     size_t len = strlen(textbox->text);
     size_t start_index = textbox->scroll_offset;
 
-    while (start_index < len &&
-           active_backend->GetTextWidth(textbox->text + start_index,
-                                        len - start_index) > max_text_width)
+    // Grow the visible suffix backwards one character at a time until it no
+    // longer fits, so every character is measured once per frame.
+    size_t fit_index = len;
+    float suffix_width = 0.0f;
+    while (fit_index > start_index)
     {
-      start_index++;
+      size_t char_index = fit_index - 1;
+      while (char_index > start_index && (textbox->text[char_index] & 0xC0) == 0x80)
+        char_index--;
+
+      float char_width = active_backend->GetTextWidth(textbox->text + char_index,
+                                                      fit_index - char_index);
+      if (suffix_width + char_width > max_text_width)
+        break;
+
+      suffix_width += char_width;
+      fit_index = char_index;
     }
+    start_index = fit_index;
 
     char display_text[256];
     strncpy(display_text, textbox->text + start_index,
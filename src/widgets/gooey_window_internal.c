@@ -94,6 +94,11 @@ void GooeyWindow_Internal_RegisterWidget(GooeyWindow *win, void *widget)
         win->images[win->image_count++] = (GooeyImage *)widget;
         break;
     }
+    case WIDGET_IMAGE_VIEWER:
+    {
+        win->image_viewers[win->image_viewer_count++] = (GooeyImageViewer *)widget;
+        break;
+    }
     case WIDGET_LIST:
     {
         win->lists[win->list_count++] = (GooeyList *)widget;